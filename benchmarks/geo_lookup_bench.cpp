@@ -0,0 +1,153 @@
+// GeoIP 记录解码基准: 对比逐字段 MMDB_get_value (旧实现) 与单趟解码 + 字符串驻留
+// 用法: geo_lookup_bench [DB_PATH] [LOOKUPS]
+#include "geo/geo_location_service.hpp"
+#include "geo/mmdb_decoder.hpp"
+#include "geo/string_table.hpp"
+
+#include <arpa/inet.h>
+#include <maxminddb.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+#ifdef GEOIP_BENCH_DB_PATH
+constexpr const char* kDefaultDbPath = GEOIP_BENCH_DB_PATH;
+#else
+constexpr const char* kDefaultDbPath = "ip_data/GeoLite2-City.mmdb";
+#endif
+
+// 旧实现: 每个字段从记录根部重新查找一次, 并拷贝为 std::string
+struct LegacyInfo {
+    std::string country, region, city, iso_code, timezone;
+    double latitude = 0.0;
+    double longitude = 0.0;
+};
+
+void AssignString(MMDB_entry_s* entry, std::string* out, const char* const* path) {
+    MMDB_entry_data_s data;
+    if (MMDB_aget_value(entry, &data, path) == MMDB_SUCCESS && data.has_data
+        && data.type == MMDB_DATA_TYPE_UTF8_STRING) {
+        out->assign(data.utf8_string, data.data_size);
+    }
+}
+
+void AssignDouble(MMDB_entry_s* entry, double* out, const char* const* path) {
+    MMDB_entry_data_s data;
+    if (MMDB_aget_value(entry, &data, path) == MMDB_SUCCESS && data.has_data) {
+        *out = data.type == MMDB_DATA_TYPE_DOUBLE ? data.double_value : data.float_value;
+    }
+}
+
+LegacyInfo LegacyDecode(MMDB_entry_s entry) {
+    static const char* const kIso[] = {"country", "iso_code", nullptr};
+    static const char* const kCountry[] = {"country", "names", "en", nullptr};
+    static const char* const kRegion[] = {"subdivisions", "0", "names", "en", nullptr};
+    static const char* const kCity[] = {"city", "names", "en", nullptr};
+    static const char* const kTimezone[] = {"location", "time_zone", nullptr};
+    static const char* const kLatitude[] = {"location", "latitude", nullptr};
+    static const char* const kLongitude[] = {"location", "longitude", nullptr};
+    LegacyInfo info;
+    AssignString(&entry, &info.iso_code, kIso);
+    AssignString(&entry, &info.country, kCountry);
+    AssignString(&entry, &info.region, kRegion);
+    AssignString(&entry, &info.city, kCity);
+    AssignString(&entry, &info.timezone, kTimezone);
+    AssignDouble(&entry, &info.latitude, kLatitude);
+    AssignDouble(&entry, &info.longitude, kLongitude);
+    return info;
+}
+
+meeting::geo::GeoInfo SinglePassDecode(const MMDB_entry_s& entry) {
+    meeting::geo::GeoRecordView record;
+    meeting::geo::GeoInfo info;
+    if (!meeting::geo::DecodeGeoRecord(entry, &record)) {
+        return info;
+    }
+    auto& strings = meeting::geo::StringTable::Shared();
+    info.iso_code = strings.Intern(record.iso_code);
+    info.country = strings.Intern(record.country);
+    info.region = strings.Intern(record.region);
+    info.timezone = strings.Intern(record.timezone);
+    info.city.assign(record.city.data(), record.city.size());
+    info.latitude = record.latitude.value_or(0.0);
+    info.longitude = record.longitude.value_or(0.0);
+    return info;
+}
+
+template <typename Fn>
+void Run(const char* name, std::size_t iterations, Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    std::uint64_t sink = 0;
+    for (std::size_t i = 0; i < iterations; ++i) {
+        sink += fn(i);
+    }
+    const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%-28s %10.1f ns/op  %10.0f ops/s  (checksum %llu)\n", name, elapsed / static_cast<double>(iterations),
+                1e9 * static_cast<double>(iterations) / elapsed, static_cast<unsigned long long>(sink));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const std::string db_path = argc >= 2 ? argv[1] : kDefaultDbPath;
+    const std::size_t lookups = argc >= 3 ? std::strtoull(argv[2], nullptr, 10) : 1000000;
+
+    MMDB_s mmdb{};
+    if (MMDB_open(db_path.c_str(), MMDB_MODE_MMAP, &mmdb) != MMDB_SUCCESS) {
+        std::fprintf(stderr, "failed to open %s\n", db_path.c_str());
+        return 1;
+    }
+
+    // 预先生成公网 IPv4 地址并定位记录, 使解码基准不含树查找
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<unsigned> octet(0, 255);
+    std::vector<std::string> ips;
+    std::vector<MMDB_entry_s> entries;
+    while (entries.size() < 10000) {
+        char ip[INET_ADDRSTRLEN];
+        const unsigned a = 1 + octet(rng) % 222;
+        const unsigned b = octet(rng);
+        const unsigned c = octet(rng);
+        const unsigned d = 1 + octet(rng) % 254;
+        std::snprintf(ip, sizeof(ip), "%u.%u.%u.%u", a, b, c, d);
+        int gai_error = 0;
+        int mmdb_error = 0;
+        auto result = MMDB_lookup_string(&mmdb, ip, &gai_error, &mmdb_error);
+        if (gai_error == 0 && mmdb_error == MMDB_SUCCESS && result.found_entry) {
+            ips.emplace_back(ip);
+            entries.push_back(result.entry);
+        }
+    }
+    std::printf("db=%s lookups=%zu distinct_ips=%zu\n", db_path.c_str(), lookups, ips.size());
+
+    Run("decode: MMDB_get_value x7", lookups, [&](std::size_t i) {
+        return LegacyDecode(entries[i % entries.size()]).country.size();
+    });
+    Run("decode: single pass", lookups, [&](std::size_t i) {
+        return SinglePassDecode(entries[i % entries.size()]).country.size();
+    });
+
+    meeting::geo::GeoCacheOptions no_cache;
+    no_cache.capacity = 0;
+    meeting::geo::GeoLocationService service(db_path, no_cache);
+    Run("Lookup (no cache)", lookups, [&](std::size_t i) {
+        auto res = service.Lookup(ips[i % ips.size()]);
+        return res.IsOk() ? res.Value().country.size() : 0;
+    });
+
+    meeting::geo::GeoLocationService cached(db_path);
+    Run("Lookup (cache)", lookups, [&](std::size_t i) {
+        auto res = cached.Lookup(ips[i % ips.size()]);
+        return res.IsOk() ? res.Value().country.size() : 0;
+    });
+
+    MMDB_close(&mmdb);
+    return 0;
+}
@@ -0,0 +1,96 @@
+// 会议存储争用基准: 1 到 MAX_THREADS 个线程并发对随机会议执行加入/查询/离开
+// 对比单分片 (等同于一把全局读写锁) 与按会议ID哈希分片的 InMemoryMeetingRepository
+// 用法: meeting_repository_bench [MAX_THREADS] [OPS_PER_THREAD] [MEETINGS]
+#include "core/meeting/meeting_repository.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using meeting::core::InMemoryMeetingRepository;
+using meeting::core::MeetingData;
+using meeting::core::MeetingState;
+
+// 每次操作: 加入一个会议, 列出其参与者, 再离开 (两次写锁 + 一次读锁)
+double JoinLeave(std::size_t shards, std::size_t threads, std::size_t ops, const std::vector<std::string>& ids) {
+    InMemoryMeetingRepository repository(shards);
+    for (const auto& id : ids) {
+        MeetingData data;
+        data.meeting_id = id;
+        data.state = MeetingState::kRunning;
+        repository.CreateMeeting(data);
+    }
+
+    std::atomic<std::size_t> ready{0};
+    std::atomic<bool> go{false};
+    std::atomic<std::size_t> failures{0};
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            std::mt19937_64 rng(t + 1);
+            std::uniform_int_distribution<std::size_t> pick(0, ids.size() - 1);
+            const std::uint64_t participant = t + 1;
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (std::size_t i = 0; i < ops; ++i) {
+                const std::string& id = ids[pick(rng)];
+                const bool ok = repository.AddParticipant(id, participant, false, meeting::core::kNextRevision).IsOk()
+                                && repository.ListParticipants(id).IsOk()
+                                && repository.RemoveParticipant(id, participant, meeting::core::kNextRevision).IsOk();
+                if (!ok) {
+                    failures.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    while (ready.load() < threads) {
+        std::this_thread::yield();
+    }
+    const auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    if (failures.load() != 0) {
+        std::fprintf(stderr, "unexpected failures: %zu\n", failures.load());
+    }
+    return ns;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const std::size_t max_threads = argc >= 2 ? std::strtoull(argv[1], nullptr, 10) : 64;
+    const std::size_t ops = argc >= 3 ? std::strtoull(argv[2], nullptr, 10) : 100000;
+    const std::size_t meetings = argc >= 4 ? std::strtoull(argv[3], nullptr, 10) : 1024;
+    std::printf("max_threads=%zu ops_per_thread=%zu meetings=%zu hardware_threads=%u\n", max_threads, ops, meetings,
+                std::thread::hardware_concurrency());
+
+    std::vector<std::string> ids;
+    ids.reserve(meetings);
+    for (std::size_t i = 0; i < meetings; ++i) {
+        ids.push_back("meeting-" + std::to_string(i));
+    }
+
+    const std::size_t shard_configs[] = {1, InMemoryMeetingRepository::kDefaultShards};
+    std::printf("%8s %8s %14s %14s\n", "threads", "shards", "ns/op", "ops/s");
+    for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+        for (std::size_t shards : shard_configs) {
+            const double ns = JoinLeave(shards, threads, ops, ids);
+            const double total = static_cast<double>(threads * ops);
+            std::printf("%8zu %8zu %14.1f %14.0f\n", threads, shards, ns / total, 1e9 * total / ns);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+// 参与者集合基准: 100 / 1k / 10k 人的会议逐个加入 (含重复检查), 成员查询, 再以随机顺序逐个离开
+// 对比原先的 std::vector + std::find 与 ParticipantSet
+// 用法: participant_set_bench [ROUNDS]
+#include "core/meeting/meeting_manager.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+
+using meeting::core::ParticipantSet;
+
+struct VectorSet {
+    std::vector<std::uint64_t> ids;
+
+    bool Contains(std::uint64_t id) const {
+        return std::find(ids.begin(), ids.end(), id) != ids.end();
+    }
+    bool Insert(std::uint64_t id) {
+        if (Contains(id)) {
+            return false;
+        }
+        ids.push_back(id);
+        return true;
+    }
+    bool Erase(std::uint64_t id) {
+        auto pos = std::find(ids.begin(), ids.end(), id);
+        if (pos == ids.end()) {
+            return false;
+        }
+        ids.erase(pos);
+        return true;
+    }
+};
+
+// 返回每次操作的平均纳秒数 (加入 + 查询 + 离开 各计一次操作)
+template <typename Set>
+double JoinQueryLeave(const std::vector<std::uint64_t>& joins, const std::vector<std::uint64_t>& leaves,
+                      std::size_t rounds) {
+    std::size_t misses = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t r = 0; r < rounds; ++r) {
+        Set set;
+        for (auto id : joins) {
+            misses += set.Insert(id) ? 0 : 1;
+        }
+        for (auto id : leaves) {
+            misses += set.Contains(id) ? 0 : 1;
+        }
+        for (auto id : leaves) {
+            misses += set.Erase(id) ? 0 : 1;
+        }
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    if (misses != 0) {
+        std::fprintf(stderr, "unexpected misses: %zu\n", misses);
+    }
+    return ns / static_cast<double>(rounds * joins.size() * 3);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const std::size_t rounds = argc >= 2 ? std::strtoull(argv[1], nullptr, 10) : 20;
+    std::printf("rounds=%zu linear_limit=%zu\n", rounds, ParticipantSet::kLinearLimit);
+    std::printf("%12s %16s %16s %10s\n", "participants", "vector ns/op", "set ns/op", "speedup");
+
+    std::mt19937_64 rng(2024);
+    for (std::size_t participants : {std::size_t{100}, std::size_t{1000}, std::size_t{10000}}) {
+        // 用户ID取随机值, 离开顺序与加入顺序无关
+        std::vector<std::uint64_t> joins(participants);
+        for (auto& id : joins) {
+            id = rng();
+        }
+        std::vector<std::uint64_t> leaves = joins;
+        std::shuffle(leaves.begin(), leaves.end(), rng);
+
+        // 按人数缩放轮数, 让 10k 的 O(N^2) 基线不至于跑太久
+        const std::size_t scaled = std::max<std::size_t>(1, rounds * 1000 / participants);
+        const double vector_ns = JoinQueryLeave<VectorSet>(joins, leaves, scaled);
+        const double set_ns = JoinQueryLeave<ParticipantSet>(joins, leaves, scaled);
+        std::printf("%12zu %16.1f %16.1f %9.1fx\n", participants, vector_ns, set_ns, vector_ns / set_ns);
+    }
+    return 0;
+}
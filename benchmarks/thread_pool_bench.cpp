@@ -0,0 +1,362 @@
+// 线程池调度器基准: 对比共享 MPMC 队列 (Mpmc) 与每线程 Chase-Lev 双端队列 + 窃取 (WorkStealing)
+// 另对比同步往返 (std::future 与 Completion) 并统计稳态下每个任务的堆分配次数 (全局 operator new 计数)
+// 以及 BlockingQueueAdapter 的唤醒延迟 (消费者自旋命中与休眠后被唤醒两种情况)
+// 和空任务下统计计数器的缓存未命中 (Linux perf_event_open, 内核不允许时输出 n/a)
+// 以及时间轮定时器的插入/取消/到期开销 (百万级待触发定时器)
+// 用法: thread_pool_bench [THREADS] [TASKS]
+#include "mpmc/blocking_queue_adapter.hpp"
+#include "thread_pool/task_allocator.hpp"
+#include "thread_pool/thread_pool.hpp"
+#include "thread_pool/timer_wheel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+std::atomic<std::size_t> g_heap_allocs{0};
+} // namespace
+
+// 计数所有经过全局 operator new 的分配 (含工作线程)
+void* operator new(std::size_t size) {
+    g_heap_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+// GCC 把内联后的 free 与 operator new 配对时会误报 -Wmismatched-new-delete
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpragmas"
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace {
+
+// queue_cap 需容纳全部在途任务: Block 策略下工作线程向满队列派生任务会互相阻塞
+thread_pool::ThreadPoolConfig MakeConfig(thread_pool::SchedulerMode mode, std::size_t threads, std::size_t queue_cap) {
+    thread_pool::ThreadPoolConfig cfg;
+    cfg.core_threads = threads;
+    cfg.max_threads = threads;  // 固定线程数, 排除动态扩缩容的干扰
+    cfg.queue_cap = queue_cap;
+    cfg.pending_hi = cfg.queue_cap;
+    cfg.pending_low = 0;
+    cfg.scheduler = mode;
+    return cfg;
+}
+
+void Report(const char* scenario, thread_pool::SchedulerMode mode, std::size_t tasks,
+            std::chrono::steady_clock::duration elapsed) {
+    const double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+    std::printf("%-26s %-13s %10.1f ns/task  %12.0f tasks/s\n", scenario, fmt::format("{}", mode).c_str(),
+                ns / static_cast<double>(tasks), 1e9 * static_cast<double>(tasks) / ns);
+}
+
+void WaitFor(const std::atomic<std::size_t>& counter, std::size_t target) {
+    while (counter.load(std::memory_order_acquire) < target) {
+        std::this_thread::yield();
+    }
+}
+
+// 硬件缓存未命中计数, 覆盖调用线程及之后创建的子线程 (inherit); 不可用时 Stop 返回 -1
+class CacheMissCounter {
+public:
+    CacheMissCounter() {
+#if defined(__linux__)
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fd_ >= 0) {
+            ::ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+            ::ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+    ~CacheMissCounter() {
+#if defined(__linux__)
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+#endif
+    }
+    CacheMissCounter(const CacheMissCounter&) = delete;
+    CacheMissCounter& operator=(const CacheMissCounter&) = delete;
+
+    long long Stop() {
+#if defined(__linux__)
+        if (fd_ >= 0) {
+            ::ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+            long long count = 0;
+            if (::read(fd_, &count, sizeof(count)) == static_cast<ssize_t>(sizeof(count))) {
+                return count;
+            }
+        }
+#endif
+        return -1;
+    }
+
+private:
+    int fd_{-1};
+};
+
+// 外部线程 Post 空任务: 衡量注入路径 (两种模式都经过共享队列)
+void ExternalPost(thread_pool::SchedulerMode mode, std::size_t threads, std::size_t producers, std::size_t tasks) {
+    thread_pool::ThreadPool pool(MakeConfig(mode, threads, 65536));
+    pool.Start();
+    std::atomic<std::size_t> done{0};
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> senders;
+    for (std::size_t p = 0; p < producers; ++p) {
+        senders.emplace_back([&, p]() {
+            for (std::size_t i = p; i < tasks; i += producers) {
+                pool.Post([&done]() { done.fetch_add(1, std::memory_order_relaxed); });
+            }
+        });
+    }
+    for (auto& t : senders) {
+        t.join();
+    }
+    WaitFor(done, tasks);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    pool.Stop();
+    Report(producers == 1 ? "external post (1 prod)" : "external post (4 prod)", mode, tasks, elapsed);
+}
+
+// 统计计数器流量: 4 个生产者投递不写任何共享数据的空任务, 以优雅停止等待执行完毕
+// 每个任务仍会更新 submitted/completed/exec_time/active 计数器, 未命中数反映计数器所在缓存行的争用
+void CounterTraffic(thread_pool::SchedulerMode mode, std::size_t threads, std::size_t tasks) {
+    constexpr std::size_t kProducers = 4;
+    CacheMissCounter misses;
+    const auto start = std::chrono::steady_clock::now();
+    thread_pool::ThreadPool pool(MakeConfig(mode, threads, 65536));
+    pool.Start();
+    std::vector<std::thread> senders;
+    for (std::size_t p = 0; p < kProducers; ++p) {
+        senders.emplace_back([&, p]() {
+            for (std::size_t i = p; i < tasks; i += kProducers) {
+                pool.Post([]() {});
+            }
+        });
+    }
+    for (auto& t : senders) {
+        t.join();
+    }
+    pool.Stop();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    const long long count = misses.Stop();
+    Report("counter traffic (4 prod)", mode, tasks, elapsed);
+    if (count >= 0) {
+        std::printf("%-26s %-13s %10.2f cache misses/task\n", "", fmt::format("{}", mode).c_str(),
+                    static_cast<double>(count) / static_cast<double>(tasks));
+    } else {
+        std::printf("%-26s %-13s cache misses n/a (perf_event_open unavailable)\n", "", fmt::format("{}", mode).c_str());
+    }
+}
+
+// 工作线程内递归派生: 衡量本地队列与窃取 (Mpmc 模式下全部经过共享队列)
+void ForkJoin(thread_pool::SchedulerMode mode, std::size_t threads, int depth) {
+    const std::size_t total_leaves = std::size_t{1} << depth;
+    thread_pool::ThreadPool pool(MakeConfig(mode, threads, total_leaves * 2));
+    pool.Start();
+    std::atomic<std::size_t> leaves{0};
+    std::function<void(int)> spawn = [&](int d) {
+        if (d == 0) {
+            leaves.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        pool.Post([&spawn, d]() { spawn(d - 1); });
+        pool.Post([&spawn, d]() { spawn(d - 1); });
+    };
+    const auto start = std::chrono::steady_clock::now();
+    pool.Post([&spawn, depth]() { spawn(depth); });
+    WaitFor(leaves, total_leaves);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    pool.Stop();
+    Report("fork-join (tree)", mode, total_leaves * 2 - 1, elapsed);
+}
+
+// 同步往返: 提交后立即阻塞等待结果 (同步 RPC 处理路径), 对比 std::future 与 Completion
+void RoundTrip(thread_pool::SchedulerMode mode, std::size_t threads, std::size_t tasks, bool completion) {
+    thread_pool::ThreadPool pool(MakeConfig(mode, threads, 1024));
+    pool.Start();
+    std::size_t sum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < tasks; ++i) {
+        sum += completion ? pool.SubmitCompletion([i]() { return i; }).Get() : pool.Submit([i]() { return i; }).get();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    pool.Stop();
+    if (sum != tasks * (tasks - 1) / 2) {
+        std::printf("round trip checksum mismatch\n");
+    }
+    Report(completion ? "round trip (Completion)" : "round trip (future)", mode, tasks, elapsed);
+}
+
+// 唤醒延迟: 生产者写入发送时间戳, 阻塞在 WaitPop 的消费者取出后计算延迟
+// gap 为 0 时消费者多在自旋阶段取到; gap 较大时消费者已休眠, 衡量 futex 唤醒路径
+void WakeLatency(std::chrono::microseconds gap, std::size_t pings) {
+    using Clock = std::chrono::steady_clock;
+    BlockingQueueAdapter<std::int64_t> queue(64);
+    std::vector<std::int64_t> latencies;
+    latencies.reserve(pings);
+    std::thread consumer([&]() {
+        std::int64_t sent = 0;
+        while (queue.WaitPop(sent)) {
+            latencies.push_back(Clock::now().time_since_epoch().count() - sent);
+        }
+    });
+    for (std::size_t i = 0; i < pings; ++i) {
+        if (gap.count() > 0) {
+            std::this_thread::sleep_for(gap);
+        }
+        queue.WaitPush(Clock::now().time_since_epoch().count());
+    }
+    queue.Close();
+    consumer.join();
+    std::sort(latencies.begin(), latencies.end());
+    auto pct = [&](double p) {
+        const auto idx = static_cast<std::size_t>(p * static_cast<double>(latencies.size() - 1));
+        return std::chrono::duration<double, std::micro>(Clock::duration(latencies[idx])).count();
+    };
+    std::printf("%-26s gap %5lld us   p50 %8.2f us  p99 %8.2f us  max %9.2f us\n", "queue wake latency",
+                static_cast<long long>(gap.count()), pct(0.5), pct(0.99), pct(1.0));
+}
+
+// 时间轮: 插入 count 个分布在 0~10 分钟内的定时器, 取消一半, 再推进时钟让其余全部到期
+void TimerWheelOps(std::size_t count) {
+    using Clock = thread_pool::TimerWheel::Clock;
+    std::size_t fired = 0;
+    thread_pool::TimerWheel wheel(std::chrono::milliseconds(1), [&fired](thread_pool::TimerWheel::Callback cb) {
+        cb();
+        ++fired;
+    });
+    const auto t0 = Clock::now();
+    std::vector<thread_pool::TimerId> ids;
+    ids.reserve(count);
+    auto phase_start = Clock::now();
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto delay = std::chrono::milliseconds(1 + (i * 7919) % 600000);
+        ids.push_back(wheel.Add(t0 + delay, Clock::duration::zero(), []() {}));
+    }
+    const double insert_ns = std::chrono::duration<double, std::nano>(Clock::now() - phase_start).count();
+    phase_start = Clock::now();
+    for (std::size_t i = 0; i < count; i += 2) {
+        wheel.Cancel(ids[i]);
+    }
+    const double cancel_ns = std::chrono::duration<double, std::nano>(Clock::now() - phase_start).count();
+    phase_start = Clock::now();
+    for (auto now = t0; wheel.Size() > 0; now += std::chrono::milliseconds(50)) {
+        wheel.Poll(now);
+    }
+    const double expire_ns = std::chrono::duration<double, std::nano>(Clock::now() - phase_start).count();
+    const auto n = static_cast<double>(count);
+    std::printf("%-26s %zu timers  insert %.1f ns  cancel %.1f ns  expire %.1f ns (per timer, fired %zu)\n",
+                "timer wheel", count, insert_ns / n, cancel_ns / (n / 2), expire_ns / static_cast<double>(fired),
+                fired);
+}
+
+// 稳态下每个任务的堆分配次数: 预热后统计 Post / Submit 期间的全局 operator new 调用
+void AllocsPerTask(thread_pool::SchedulerMode mode, std::size_t threads, std::size_t tasks) {
+    thread_pool::ThreadPool pool(MakeConfig(mode, threads, 65536));
+    pool.Start();
+    std::atomic<std::size_t> done{0};
+    auto post_round = [&](std::size_t n) {
+        const std::size_t target = done.load(std::memory_order_relaxed) + n;
+        for (std::size_t i = 0; i < n; ++i) {
+            pool.Post([&done]() { done.fetch_add(1, std::memory_order_relaxed); });
+        }
+        WaitFor(done, target);
+    };
+    auto submit_round = [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            pool.Submit([i]() { return i; }).get();
+        }
+    };
+    const std::size_t warmup = std::min<std::size_t>(tasks, 10000);
+    post_round(warmup);
+    submit_round(warmup);
+
+    const std::size_t slabs = thread_pool::TaskAllocator::GetStats().slabs;
+    std::size_t before = g_heap_allocs.load(std::memory_order_relaxed);
+    post_round(tasks);
+    const std::size_t post_allocs = g_heap_allocs.load(std::memory_order_relaxed) - before;
+    before = g_heap_allocs.load(std::memory_order_relaxed);
+    submit_round(tasks);
+    const std::size_t submit_allocs = g_heap_allocs.load(std::memory_order_relaxed) - before;
+    pool.Stop();
+    std::printf("%-26s %-13s post %.4f allocs/task  submit %.4f allocs/task  new slabs %zu\n", "heap allocations",
+                fmt::format("{}", mode).c_str(), static_cast<double>(post_allocs) / static_cast<double>(tasks),
+                static_cast<double>(submit_allocs) / static_cast<double>(tasks),
+                thread_pool::TaskAllocator::GetStats().slabs - slabs);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const std::size_t threads =
+        argc >= 2 ? std::strtoull(argv[1], nullptr, 10) : std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t tasks = argc >= 3 ? std::strtoull(argv[2], nullptr, 10) : 1000000;
+    std::printf("threads=%zu tasks=%zu\n", threads, tasks);
+
+    const thread_pool::SchedulerMode modes[] = {thread_pool::SchedulerMode::Mpmc,
+                                                thread_pool::SchedulerMode::WorkStealing};
+    for (auto mode : modes) {
+        ExternalPost(mode, threads, 1, tasks);
+    }
+    for (auto mode : modes) {
+        ExternalPost(mode, threads, 4, tasks);
+    }
+    for (auto mode : modes) {
+        CounterTraffic(mode, threads, tasks);
+    }
+    int depth = 1;
+    while ((std::size_t{2} << depth) <= tasks) {
+        ++depth;
+    }
+    for (auto mode : modes) {
+        ForkJoin(mode, threads, depth);
+    }
+    for (auto mode : modes) {
+        RoundTrip(mode, threads, std::min<std::size_t>(tasks, 100000), false);
+        RoundTrip(mode, threads, std::min<std::size_t>(tasks, 100000), true);
+    }
+    for (auto mode : modes) {
+        AllocsPerTask(mode, threads, std::min<std::size_t>(tasks, 100000));
+    }
+    WakeLatency(std::chrono::microseconds(0), std::min<std::size_t>(tasks, 100000));
+    WakeLatency(std::chrono::microseconds(200), 2000);
+    TimerWheelOps(std::max<std::size_t>(tasks * 5, 1000000));
+    return 0;
+}
@@ -0,0 +1,6 @@
+-- Meeting revision: bumped on every join / leave / state change so clients can request
+-- participant deltas since the revision they already have (GetMeeting.since_revision)
+USE meeting;
+
+ALTER TABLE meetings
+    ADD COLUMN revision BIGINT UNSIGNED NOT NULL DEFAULT 1 AFTER state;
@@ -135,5 +135,22 @@ meeting::common::StatusOr<bool> RedisClient::Exists(const std::string& key) {
     }
 }
 
+// 执行 Lua 脚本
+meeting::common::StatusOr<long long> RedisClient::Eval(const std::string& script,
+                                                       const std::vector<std::string>& keys,
+                                                       const std::vector<std::string>& args) {
+    auto status = Connect();
+    if (!status.IsOk()) {
+        return status;
+    }
+
+    try {
+        auto result = redis_->eval<long long>(script, keys.begin(), keys.end(), args.begin(), args.end());
+        return meeting::common::StatusOr<long long>(result);
+    } catch (const sw::redis::Error& err) {
+        return meeting::common::Status::Unavailable("Failed to eval script in Redis: " + std::string(err.what()));
+    }
+}
+
 } // namespace cache
 } // namespace meeting
\ No newline at end of file
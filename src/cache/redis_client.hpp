@@ -9,6 +9,7 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 
 namespace meeting {
 namespace cache {
@@ -34,6 +35,11 @@ public:
 
     // 检查键是否存在
     meeting::common::StatusOr<bool> Exists(const std::string& key);
+
+    // 执行 Lua 脚本 (脚本内的多条命令原子执行), 返回脚本的整数结果
+    meeting::common::StatusOr<long long> Eval(const std::string& script,
+                                              const std::vector<std::string>& keys,
+                                              const std::vector<std::string>& args);
     
 private:
     meeting::common::RedisConfig config_; // Redis配置
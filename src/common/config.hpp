@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <string_view>
 
@@ -10,6 +11,12 @@ namespace common {
 struct ServerConfig {
     std::string host = "0.0.0.0";
     int port = 50051;
+    // RPC 处理模式: "sync" (gRPC 同步线程等待线程池结果) 或 "callback" (线程池工作线程直接完成 RPC)
+    std::string rpc_mode = "sync";
+    // 节点坐标, 配置后写入注册信息供就近选择使用
+    bool has_location = false;
+    double latitude = 0.0;
+    double longitude = 0.0;
 };
 
 // 日志配置结构体
@@ -29,6 +36,10 @@ struct ThreadPoolConfigPath {
 // GeoIP配置结构体
 struct GeoIPConfig {
     std::string db_path = "";
+    std::size_t cache_capacity = 65536; // 查询缓存条目上限, 0 表示关闭
+    std::size_t cache_shards = 16;      // 缓存分片数
+    int cache_ttl_seconds = 3600;       // 缓存条目有效期, 0 表示不过期
+    int reload_interval_seconds = 0;    // 检查数据库文件更新的周期, 0 表示不自动重新加载
 };
 
 // Zookeeper配置结构体
@@ -36,6 +47,24 @@ struct ZookeeperConfig {
     std::string hosts = "127.0.0.1:2181";
 };
 
+// 调度配置结构体
+struct SchedulerConfig {
+    // 节点选择策略: "weighted_round_robin" | "power_of_two" | "least_loaded"
+    std::string strategy = "weighted_round_robin";
+    int load_report_interval_ms = 2000; // 本节点负载发布周期
+    bool meeting_affinity = true;       // JoinMeeting 按 meeting_id 一致性哈希返回会议归属节点
+    int virtual_nodes = 160;            // 哈希环上每个节点的虚拟节点数
+    int nearest_n = 0;                  // 就近选择的候选节点数, 0 表示按 region 匹配
+};
+
+// 会议执行配置结构体
+struct MeetingExecutionConfig {
+    // "direct": 每个请求直接读写存储库; "mailbox": 按会议串行执行, 存储库写入批量落后执行 (只支持单节点部署)
+    std::string execution = "direct";
+    int mailboxes = 64;  // 邮箱数 (mailbox 模式)
+    int idle_ttl_ms = 300000;  // 空闲会议移出邮箱内存的时间, 0 表示不移除 (mailbox 模式)
+};
+
 // Redis配置结构体
 struct RedisConfig {
     std::string host = "127.0.0.1";
@@ -79,6 +108,8 @@ struct AppConfig {
     ThreadPoolConfigPath thread_pool;
     GeoIPConfig geoip;
     ZookeeperConfig zookeeper;
+    SchedulerConfig scheduler;
+    MeetingExecutionConfig meeting;
     StorageConfig storage;
     CacheConfig cache;
 };
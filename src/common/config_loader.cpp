@@ -58,6 +58,19 @@ AppConfig ConfigLoader::FromJson(const nlohmann::json& j) {
         const auto& server = j["server"];
         cfg.server.host = server.value("host", cfg.server.host);
         cfg.server.port = server.value("port", cfg.server.port);
+        cfg.server.rpc_mode = server.value("rpc_mode", cfg.server.rpc_mode);
+        if (cfg.server.rpc_mode != "sync" && cfg.server.rpc_mode != "callback") {
+            throw std::runtime_error("Invalid server.rpc_mode: " + cfg.server.rpc_mode + " (expected sync|callback)");
+        }
+        if (server.contains("latitude") && server.contains("longitude")) {
+            cfg.server.latitude = server["latitude"].get<double>();
+            cfg.server.longitude = server["longitude"].get<double>();
+            if (cfg.server.latitude < -90.0 || cfg.server.latitude > 90.0
+                || cfg.server.longitude < -180.0 || cfg.server.longitude > 180.0) {
+                throw std::runtime_error("Invalid server.latitude / server.longitude");
+            }
+            cfg.server.has_location = true;
+        }
     }
     // Logging配置
     if (j.contains("logging")) {
@@ -75,12 +88,53 @@ AppConfig ConfigLoader::FromJson(const nlohmann::json& j) {
     }
     // GeoIP配置
     if (j.contains("geoip")) {
-        cfg.geoip.db_path = j["geoip"].value("db_path", cfg.geoip.db_path);
+        const auto& geoip = j["geoip"];
+        cfg.geoip.db_path = geoip.value("db_path", cfg.geoip.db_path);
+        cfg.geoip.cache_capacity = geoip.value("cache_capacity", cfg.geoip.cache_capacity);
+        cfg.geoip.cache_shards = geoip.value("cache_shards", cfg.geoip.cache_shards);
+        cfg.geoip.cache_ttl_seconds = geoip.value("cache_ttl_seconds", cfg.geoip.cache_ttl_seconds);
+        cfg.geoip.reload_interval_seconds = geoip.value("reload_interval_seconds", cfg.geoip.reload_interval_seconds);
+        if (cfg.geoip.cache_ttl_seconds < 0 || cfg.geoip.reload_interval_seconds < 0) {
+            throw std::runtime_error("Invalid geoip.cache_ttl_seconds / geoip.reload_interval_seconds");
+        }
     }
     // Zookeeper配置
     if (j.contains("zookeeper")) {
         cfg.zookeeper.hosts = j["zookeeper"].value("hosts", cfg.zookeeper.hosts);
     }
+    // Scheduler配置
+    if (j.contains("scheduler")) {
+        const auto& scheduler = j["scheduler"];
+        cfg.scheduler.strategy = scheduler.value("strategy", cfg.scheduler.strategy);
+        cfg.scheduler.load_report_interval_ms =
+            scheduler.value("load_report_interval_ms", cfg.scheduler.load_report_interval_ms);
+        cfg.scheduler.meeting_affinity = scheduler.value("meeting_affinity", cfg.scheduler.meeting_affinity);
+        cfg.scheduler.virtual_nodes = scheduler.value("virtual_nodes", cfg.scheduler.virtual_nodes);
+        cfg.scheduler.nearest_n = scheduler.value("nearest_n", cfg.scheduler.nearest_n);
+        if (cfg.scheduler.strategy != "weighted_round_robin" && cfg.scheduler.strategy != "power_of_two"
+            && cfg.scheduler.strategy != "least_loaded") {
+            throw std::runtime_error("Invalid scheduler.strategy: " + cfg.scheduler.strategy);
+        }
+        if (cfg.scheduler.virtual_nodes <= 0 || cfg.scheduler.nearest_n < 0) {
+            throw std::runtime_error("Invalid scheduler.virtual_nodes / scheduler.nearest_n");
+        }
+    }
+    // 会议执行配置
+    if (j.contains("meeting")) {
+        const auto& meeting = j["meeting"];
+        cfg.meeting.execution = meeting.value("execution", cfg.meeting.execution);
+        cfg.meeting.mailboxes = meeting.value("mailboxes", cfg.meeting.mailboxes);
+        cfg.meeting.idle_ttl_ms = meeting.value("idle_ttl_ms", cfg.meeting.idle_ttl_ms);
+        if (cfg.meeting.execution != "direct" && cfg.meeting.execution != "mailbox") {
+            throw std::runtime_error("Invalid meeting.execution: " + cfg.meeting.execution + " (expected direct|mailbox)");
+        }
+        if (cfg.meeting.mailboxes <= 0) {
+            throw std::runtime_error("Invalid meeting.mailboxes");
+        }
+        if (cfg.meeting.idle_ttl_ms < 0) {
+            throw std::runtime_error("Invalid meeting.idle_ttl_ms");
+        }
+    }
     // Storage配置
     if (j.contains("storage")) {
         const auto& storage = j["storage"];
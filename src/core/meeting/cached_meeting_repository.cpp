@@ -10,6 +10,45 @@ namespace {
 // 定义会议ID缓存键的前缀
 constexpr std::string_view kIdPrefix = "meeting:info:";
 
+// 在缓存的会议 JSON 上原地应用一次加入/离开, 键不存在时不写入 (下次读取时从主存储库加载).
+// 增量只在其版本号紧接缓存版本 (缓存版本 + 1) 时应用: 不大于缓存版本说明缓存已包含该变更;
+// 更大说明中间的变更还没到, 乱序应用会得到主存储库从未有过的状态, 此时删除缓存.
+// KEYS[1]: 缓存键; ARGV: "join" | "leave", 参与者ID, 会议状态, 更新时间, 过期秒数, 版本号
+constexpr const char* kApplyDeltaScript = R"lua(
+local raw = redis.call('GET', KEYS[1])
+if not raw then
+    return 0
+end
+local data = cjson.decode(raw)
+local revision = tonumber(ARGV[6])
+local cached = tonumber(data.revision) or 0
+if revision <= cached then
+    return 0
+end
+if revision ~= cached + 1 then
+    redis.call('DEL', KEYS[1])
+    return 0
+end
+local participant = tonumber(ARGV[2])
+local participants = {}
+if type(data.participants) == 'table' then
+    for _, id in ipairs(data.participants) do
+        if id ~= participant then
+            participants[#participants + 1] = id
+        end
+    end
+end
+if ARGV[1] == 'join' then
+    participants[#participants + 1] = participant
+end
+data.participants = participants
+data.state = tonumber(ARGV[3])
+data.updated_at = tonumber(ARGV[4])
+data.revision = revision
+redis.call('SET', KEYS[1], cjson.encode(data), 'EX', ARGV[5])
+return 1
+)lua";
+
 }
 
 // 构造函数
@@ -63,9 +102,10 @@ meeting::common::StatusOr<MeetingData> CachedMeetingRepository::GetMeeting(const
 // 更新会议信息 (写逻辑: 先写主存储库, 再更新缓存)
 meeting::common::Status CachedMeetingRepository::UpdateMeetingState(const std::string& meeting_id,
                                                                     MeetingState state,
-                                                                    std::int64_t updated_at) {
+                                                                    std::int64_t updated_at,
+                                                                    std::uint64_t revision) {
     // 先写主存储库
-    auto status = primary_->UpdateMeetingState(meeting_id, state, updated_at);
+    auto status = primary_->UpdateMeetingState(meeting_id, state, updated_at, revision);
     if (!HasCache()) {
         return status;
     }
@@ -80,8 +120,9 @@ meeting::common::Status CachedMeetingRepository::UpdateMeetingState(const std::s
 // 添加会议参与者 (写逻辑: 先写主存储库, 再更新缓存)
 meeting::common::Status CachedMeetingRepository::AddParticipant(const std::string& meeting_id,
                                                                 std::uint64_t participant_id,
-                                                                bool is_organizer) {
-    auto status = primary_->AddParticipant(meeting_id, participant_id, is_organizer);
+                                                                bool is_organizer,
+                                                                std::uint64_t revision) {
+    auto status = primary_->AddParticipant(meeting_id, participant_id, is_organizer, revision);
     if (!HasCache()) {
         return status;
     }
@@ -94,8 +135,9 @@ meeting::common::Status CachedMeetingRepository::AddParticipant(const std::strin
 
 // 移除会议参与者 (写逻辑: 先写主存储库, 再更新缓存)
 meeting::common::Status CachedMeetingRepository::RemoveParticipant(const std::string& meeting_id,
-                                                                   std::uint64_t participant_id) {
-    auto status = primary_->RemoveParticipant(meeting_id, participant_id);
+                                                                   std::uint64_t participant_id,
+                                                                   std::uint64_t revision) {
+    auto status = primary_->RemoveParticipant(meeting_id, participant_id, revision);
     if (!HasCache()) {
         return status;
     }
@@ -112,6 +154,38 @@ meeting::common::StatusOr<std::vector<std::uint64_t>> CachedMeetingRepository::L
     return primary_->ListParticipants(meeting_id);
 }
 
+// 会议增量 (读逻辑: 缓存命中时按缓存中的会议计算, 缓存不保存变更记录; 未命中时由主存储库计算)
+meeting::common::StatusOr<MeetingDelta> CachedMeetingRepository::DiffSince(const std::string& meeting_id,
+                                                                           std::uint64_t since_revision) const {
+    if (HasCache()) {
+        auto cached = CacheGet(meeting_id);
+        if (cached.IsOk()) {
+            return meeting::common::StatusOr<MeetingDelta>(DiffMeeting(std::move(cached).Value(), nullptr, since_revision));
+        }
+    }
+    return primary_->DiffSince(meeting_id, since_revision);
+}
+
+// 加入会议 (写逻辑: 主存储库原子加入后, 用 Lua 脚本在缓存上应用同一增量)
+meeting::common::StatusOr<MeetingData> CachedMeetingRepository::JoinAndLoad(const JoinRequest& request) {
+    auto joined = primary_->JoinAndLoad(request);
+    if (!joined.IsOk() || !HasCache()) {
+        return joined;
+    }
+    CacheApply("join", joined.Value(), request.participant_id);
+    return joined;
+}
+
+// 离开会议 (写逻辑: 主存储库原子离开后, 用 Lua 脚本在缓存上应用同一增量)
+meeting::common::StatusOr<LeaveResult> CachedMeetingRepository::LeaveAndLoad(const LeaveRequest& request) {
+    auto left = primary_->LeaveAndLoad(request);
+    if (!left.IsOk() || !HasCache()) {
+        return left;
+    }
+    CacheApply("leave", left.Value().meeting, request.participant_id);
+    return left;
+}
+
 // 生成 Redis 键
 std::string CachedMeetingRepository::KeyForId(const std::string& meeting_id) const {
     return std::string(kIdPrefix).append(meeting_id);
@@ -128,7 +202,8 @@ meeting::common::Status CachedMeetingRepository::CachePut(const MeetingData& dat
         {"state", static_cast<int>(data.state)},
         {"created_at", data.created_at},
         {"updated_at", data.updated_at},
-        {"participants", data.participants},
+        {"revision", data.revision},
+        {"participants", data.participants.Ids()},
     };
     auto payload = j.dump();
 
@@ -140,6 +215,26 @@ meeting::common::Status CachedMeetingRepository::CachePut(const MeetingData& dat
     return meeting::common::Status::OK();
 }
 
+// 在缓存上应用一次加入/离开, 失败时删除缓存避免读到旧数据
+void CachedMeetingRepository::CacheApply(const char* op, const MeetingData& data, std::uint64_t participant_id) const {
+    auto applied = redis_->Eval(kApplyDeltaScript,
+                                {KeyForId(data.meeting_id)},
+                                {op,
+                                 std::to_string(participant_id),
+                                 std::to_string(static_cast<int>(data.state)),
+                                 std::to_string(data.updated_at),
+                                 std::to_string(ttl_seconds_),
+                                 std::to_string(data.revision)});
+    if (applied.IsOk()) {
+        return;
+    }
+    MEETING_LOG_WARN("[MeetingCache] apply {} failed: {}", op, applied.GetStatus().Message());
+    auto del = CacheDelete(data.meeting_id);
+    if (!del.IsOk()) {
+        MEETING_LOG_WARN("[MeetingCache] invalidate on {} failed: {}", op, del.Message());
+    }
+}
+
 // 删除缓存中的会议数据
 meeting::common::Status CachedMeetingRepository::CacheDelete(const std::string& meeting_id) const {
     auto status = redis_->Del(KeyForId(meeting_id));
@@ -172,9 +267,10 @@ meeting::common::StatusOr<MeetingData> CachedMeetingRepository::CacheGet(const s
     data.state = static_cast<MeetingState>(json.value("state", 0));
     data.created_at = json.value("created_at", 0LL);
     data.updated_at = json.value("updated_at", 0LL);
+    data.revision = json.value("revision", std::uint64_t{0});
 
     if (json.contains("participants") && json["participants"].is_array()) {
-        data.participants = json["participants"].get<std::vector<std::uint64_t>>();
+        data.participants = ParticipantSet(json["participants"].get<std::vector<std::uint64_t>>());
     }
     return meeting::common::StatusOr<MeetingData>(data);
 }
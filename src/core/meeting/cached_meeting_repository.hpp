@@ -23,13 +23,22 @@ public:
     // 根据会议ID查找会议
     meeting::common::StatusOr<MeetingData> GetMeeting(const std::string& meeting_id) const override;
     // 更新会议信息
-    meeting::common::Status UpdateMeetingState(const std::string& meeting_id, MeetingState state, std::int64_t updated_at) override;
+    meeting::common::Status UpdateMeetingState(const std::string& meeting_id, MeetingState state, std::int64_t updated_at,
+                                               std::uint64_t revision) override;
     // 添加会议参与者
-    meeting::common::Status AddParticipant(const std::string& meeting_id, std::uint64_t participant_id, bool is_organizer) override;
+    meeting::common::Status AddParticipant(const std::string& meeting_id, std::uint64_t participant_id, bool is_organizer,
+                                           std::uint64_t revision) override;
     // 移除会议参与者
-    meeting::common::Status RemoveParticipant(const std::string& meeting_id, std::uint64_t participant_id) override;
+    meeting::common::Status RemoveParticipant(const std::string& meeting_id, std::uint64_t participant_id,
+                                              std::uint64_t revision) override;
     // 列出会议参与者
     meeting::common::StatusOr<std::vector<std::uint64_t>> ListParticipants(const std::string& meeting_id) const override;
+    // 会议增量
+    meeting::common::StatusOr<MeetingDelta> DiffSince(const std::string& meeting_id, std::uint64_t since_revision) const override;
+    // 加入会议
+    meeting::common::StatusOr<MeetingData> JoinAndLoad(const JoinRequest& request) override;
+    // 离开会议
+    meeting::common::StatusOr<LeaveResult> LeaveAndLoad(const LeaveRequest& request) override;
 
 private:
     // 辅助函数: 确认缓存是否可用
@@ -39,6 +48,8 @@ private:
 
     // 辅助函数: 缓存会议数据
     meeting::common::Status CachePut(const MeetingData& data) const;
+    // 辅助函数: 在缓存上应用一次加入/离开 (Lua 脚本)
+    void CacheApply(const char* op, const MeetingData& data, std::uint64_t participant_id) const;
     // 辅助函数: 删除缓存中的会议数据
     meeting::common::Status CacheDelete(const std::string& meeting_id) const;
     // 辅助函数: 从缓存中获取会议数据
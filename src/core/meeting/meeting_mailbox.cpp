@@ -0,0 +1,368 @@
+#include "core/meeting/meeting_mailbox.hpp"
+#include "core/meeting/meeting_repository.hpp"
+#include "common/logger.hpp"
+#include "thread_pool/thread_pool.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <unordered_set>
+#include <utility>
+
+namespace meeting {
+namespace core {
+
+namespace {
+
+std::size_t RoundUpMailboxes(std::size_t count) {
+    std::size_t mailboxes = 1;
+    while (mailboxes < count && mailboxes < MeetingMailboxes::kMaxMailboxes) {
+        mailboxes <<= 1;
+    }
+    return mailboxes;
+}
+
+meeting::common::Status ApplyWrite(MeetingRepository& repository, const MeetingWrite& write) {
+    switch (write.kind) {
+        case MeetingWrite::Kind::kAddParticipant:
+            return repository.AddParticipant(write.meeting_id, write.participant_id, write.is_organizer, write.revision);
+        case MeetingWrite::Kind::kRemoveParticipant:
+            return repository.RemoveParticipant(write.meeting_id, write.participant_id, write.revision);
+        case MeetingWrite::Kind::kUpdateState:
+            return repository.UpdateMeetingState(write.meeting_id, write.state, write.updated_at, write.revision);
+    }
+    return meeting::common::Status::Internal("unknown meeting write");
+}
+
+} // namespace
+
+// 按缓存行对齐, 相邻邮箱的锁不落在同一缓存行上
+struct alignas(64) MeetingMailboxes::Mailbox {
+    std::mutex                mutex;             // 保护以下除 context 外的成员
+    std::deque<Message>       queue;             // 等待执行的命令
+    bool                      draining = false;  // 是否已有线程在消费
+    std::vector<MeetingWrite> pending;           // 等待落库的变更
+    bool                      flushing = false;  // 是否已有落库任务在写 pending
+    std::condition_variable   flushed;           // flushing 变为 false 时通知
+    meeting::common::Status   write_error = meeting::common::Status::OK();  // 尚未被 Flush 取走的第一条落库错误
+    Context                   context;           // 只由当前消费者访问
+};
+
+meeting::common::StatusOr<MailboxMeeting*> MeetingMailboxContext::Load(const std::string& meeting_id) {
+    const auto now = Clock::now();
+    EvictIdle(now);
+    auto it = meetings_.find(meeting_id);
+    if (it != meetings_.end() && it->second.stale) {
+        // 落库失败后内存状态已不可信, 等其余变更落库后移出内存再从存储库重新加载
+        return meeting::common::Status::Unavailable("meeting state is being reloaded after a failed write");
+    }
+    if (it == meetings_.end()) {
+        auto loaded = repository_->GetMeeting(meeting_id);
+        if (!loaded.IsOk()) {
+            return loaded.GetStatus();
+        }
+        it = meetings_.emplace(meeting_id, Entry{MailboxMeeting{std::move(loaded).Value(), ParticipantLog{}}}).first;
+    }
+    it->second.last_used = now;
+    return meeting::common::StatusOr<MailboxMeeting*>(&it->second.meeting);
+}
+
+MailboxMeeting& MeetingMailboxContext::Adopt(MeetingData meeting) {
+    const auto now = Clock::now();
+    EvictIdle(now);
+    std::string meeting_id = meeting.meeting_id;
+    auto& entry = meetings_[std::move(meeting_id)];
+    entry.meeting = MailboxMeeting{std::move(meeting), ParticipantLog{}};
+    entry.last_used = now;
+    return entry.meeting;
+}
+
+void MeetingMailboxContext::Write(MeetingWrite write) {
+    ++meetings_[write.meeting_id].unflushed;
+    writes_.push_back(std::move(write));
+}
+
+std::size_t MeetingMailboxContext::CachedMeetings() const noexcept {
+    return meetings_.size();
+}
+
+void MeetingMailboxContext::OnFlushed(const std::string& meeting_id, std::size_t writes, bool failed) {
+    auto it = meetings_.find(meeting_id);
+    if (it == meetings_.end()) {
+        return;
+    }
+    auto& entry = it->second;
+    entry.unflushed -= std::min(entry.unflushed, writes);
+    entry.stale = entry.stale || failed;
+    if (entry.unflushed == 0 && (entry.stale || entry.meeting.data.state == MeetingState::kEnded)) {
+        meetings_.erase(it);
+    }
+}
+
+void MeetingMailboxContext::EvictIdle(Clock::time_point now) {
+    if (idle_ttl_ <= Clock::duration::zero() || now < next_sweep_) {
+        return;
+    }
+    next_sweep_ = now + idle_ttl_;
+    for (auto it = meetings_.begin(); it != meetings_.end();) {
+        const auto& entry = it->second;
+        if (entry.unflushed == 0 && now - entry.last_used >= idle_ttl_) {
+            it = meetings_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+MeetingMailboxes::MeetingMailboxes(std::size_t mailbox_count, std::shared_ptr<MeetingRepository> repository,
+                                   thread_pool::ThreadPool* pool, std::chrono::milliseconds idle_ttl)
+    : repository_(std::move(repository))
+    , pool_(pool)
+    , mailbox_mask_(RoundUpMailboxes(mailbox_count) - 1) {
+    mailboxes_.reserve(mailbox_mask_ + 1);
+    for (std::size_t i = 0; i <= mailbox_mask_; ++i) {
+        mailboxes_.push_back(std::make_unique<Mailbox>());
+        auto& context = mailboxes_.back()->context;
+        context.repository_ = repository_.get();
+        context.idle_ttl_ = std::chrono::duration_cast<Context::Clock::duration>(idle_ttl);
+    }
+}
+
+MeetingMailboxes::~MeetingMailboxes() {
+    {
+        std::unique_lock<std::mutex> lock(flight_mutex_);
+        flight_cv_.wait(lock, [this]() { return in_flight_ == 0; });
+    }
+    // 已没有消费者与落库任务, 直接在当前线程写完剩余变更
+    for (auto& box : mailboxes_) {
+        {
+            std::lock_guard<std::mutex> lock(box->mutex);
+            auto& writes = box->context.writes_;
+            box->pending.insert(box->pending.end(), std::make_move_iterator(writes.begin()),
+                                std::make_move_iterator(writes.end()));
+            writes.clear();
+            box->flushing = true;
+        }
+        RunFlush(*box);
+    }
+}
+
+meeting::common::Status MeetingMailboxes::Flush() {
+    auto result = meeting::common::Status::OK();
+    for (auto& box : mailboxes_) {
+        // 屏障命令执行时, 之前命令的变更都已移入 pending 并触发落库
+        thread_pool::CompletionPromise<void> barrier;
+        auto reached = barrier.GetCompletion();
+        Submit(*box, [barrier = std::move(barrier)](Context&) mutable { barrier.SetValue(); });
+        reached.Get();
+        std::unique_lock<std::mutex> lock(box->mutex);
+        box->flushed.wait(lock, [&box]() { return !box->flushing; });
+        if (result.IsOk()) {
+            result = box->write_error;
+        }
+        box->write_error = meeting::common::Status::OK();
+    }
+    return result;
+}
+
+std::size_t MeetingMailboxes::MailboxCount() const noexcept {
+    return mailbox_mask_ + 1;
+}
+
+MeetingMailboxes::Mailbox& MeetingMailboxes::MailboxFor(const std::string& meeting_id) {
+    const std::uint64_t hash = static_cast<std::uint64_t>(std::hash<std::string>{}(meeting_id)) * 0x9E3779B97F4A7C15ull;
+    return *mailboxes_[(hash >> 32) & mailbox_mask_];
+}
+
+void MeetingMailboxes::Submit(Mailbox& box, Message message) {
+    {
+        std::lock_guard<std::mutex> lock(box.mutex);
+        box.queue.push_back(std::move(message));
+        if (box.draining) {
+            return;
+        }
+        box.draining = true;
+    }
+    Drain(box);
+}
+
+void MeetingMailboxes::Drain(Mailbox& box) {
+    Message message;
+    for (;;) {
+        bool start_flush = false;
+        {
+            std::lock_guard<std::mutex> lock(box.mutex);
+            // 上一条命令的变更移交给落库批次, 之后的命令 (包括 Flush 的屏障) 都排在它们后面
+            auto& writes = box.context.writes_;
+            if (!writes.empty()) {
+                if (box.pending.empty()) {
+                    box.pending.swap(writes);
+                } else {
+                    box.pending.insert(box.pending.end(), std::make_move_iterator(writes.begin()),
+                                       std::make_move_iterator(writes.end()));
+                    writes.clear();
+                }
+                start_flush = !box.flushing;
+                box.flushing = true;
+            }
+            if (box.queue.empty()) {
+                box.draining = false;
+            } else {
+                message = std::move(box.queue.front());
+                box.queue.pop_front();
+            }
+        }
+        if (start_flush) {
+            ScheduleFlush(box);
+        }
+        if (!message) {
+            return;
+        }
+        message(box.context);
+        message = nullptr;
+    }
+}
+
+void MeetingMailboxes::ScheduleFlush(Mailbox& box) {
+    if (pool_ == nullptr) {
+        RunFlush(box);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(flight_mutex_);
+        ++in_flight_;
+    }
+    try {
+        pool_->SubmitWithCallback([this, &box]() { RunFlush(box); }, [this, &box](thread_pool::Completion<void> done) {
+            try {
+                done.Get();
+            } catch (...) {
+                // 线程池拒绝或丢弃了落库任务: 在当前线程写入, 变更不丢失
+                RunFlush(box);
+            }
+            EndFlight();
+        });
+    } catch (...) {
+        RunFlush(box);
+        EndFlight();
+    }
+}
+
+void MeetingMailboxes::RunFlush(Mailbox& box) {
+    for (;;) {
+        std::vector<MeetingWrite> batch;
+        {
+            std::lock_guard<std::mutex> lock(box.mutex);
+            if (box.pending.empty()) {
+                box.flushing = false;
+                box.flushed.notify_all();
+                return;
+            }
+            batch.swap(box.pending);
+        }
+        ApplyBatch(box, std::move(batch));
+    }
+}
+
+void MeetingMailboxes::ApplyBatch(Mailbox& box, std::vector<MeetingWrite> batch) {
+    // 合并: 同一会议只保留最后一次状态变更, 批内先加入后离开的参与者两次写入都省去
+    std::vector<bool> skip(batch.size(), false);
+    std::unordered_map<std::string, std::size_t> last_state;
+    std::unordered_map<std::string, std::unordered_map<std::uint64_t, std::size_t>> added;
+    std::unordered_map<std::string, std::size_t> acks;
+    std::unordered_map<std::string, std::size_t> last_write;  // 会议在批内的最后一次变更
+    std::unordered_map<std::size_t, std::size_t> paired;      // 被省去的离开 -> 对应的加入
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        const auto& write = batch[i];
+        ++acks[write.meeting_id];
+        last_write[write.meeting_id] = i;
+        switch (write.kind) {
+            case MeetingWrite::Kind::kUpdateState: {
+                auto [it, inserted] = last_state.try_emplace(write.meeting_id, i);
+                if (!inserted) {
+                    skip[it->second] = true;
+                    it->second = i;
+                }
+                break;
+            }
+            case MeetingWrite::Kind::kAddParticipant:
+                added[write.meeting_id][write.participant_id] = i;
+                break;
+            case MeetingWrite::Kind::kRemoveParticipant: {
+                auto meeting_it = added.find(write.meeting_id);
+                if (meeting_it == added.end()) {
+                    break;
+                }
+                auto it = meeting_it->second.find(write.participant_id);
+                if (it != meeting_it->second.end()) {
+                    skip[it->second] = true;
+                    skip[i] = true;
+                    paired[i] = it->second;
+                    meeting_it->second.erase(it);
+                }
+                break;
+            }
+        }
+    }
+
+    // 落库后的版本号须等于会议最后一次变更的版本号: 最后一次变更被省去时由批内保留的最后一条写入带上,
+    // 批内没有保留的写入时恢复最后一对加入/离开
+    std::unordered_map<std::string, std::size_t> last_kept;
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        if (!skip[i]) {
+            last_kept[batch[i].meeting_id] = i;
+        }
+    }
+    for (const auto& [meeting_id, last] : last_write) {
+        if (!skip[last]) {
+            continue;
+        }
+        auto kept = last_kept.find(meeting_id);
+        if (kept != last_kept.end()) {
+            batch[kept->second].revision = batch[last].revision;
+        } else {
+            skip[last] = false;
+            skip[paired[last]] = false;
+        }
+    }
+
+    // 命令已返回, 失败的写入无法撤回: 把会议移出内存, 下一条命令从存储库重新加载, 错误由 Flush 返回
+    std::unordered_set<std::string> failed;
+    auto first_error = meeting::common::Status::OK();
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        if (skip[i]) {
+            continue;
+        }
+        auto status = ApplyWrite(*repository_, batch[i]);
+        if (!status.IsOk()) {
+            MEETING_LOG_ERROR("[MeetingMailbox] write-behind for {} failed, reloading the meeting: {}",
+                              batch[i].meeting_id, status.Message());
+            failed.insert(batch[i].meeting_id);
+            if (first_error.IsOk()) {
+                first_error = status;
+            }
+        }
+    }
+    if (!first_error.IsOk()) {
+        std::lock_guard<std::mutex> lock(box.mutex);
+        if (box.write_error.IsOk()) {
+            box.write_error = first_error;
+        }
+    }
+
+    // 回到邮箱中扣减未落库计数, 已结束或落库失败的会议在其变更全部落库后移出内存
+    Submit(box, [acks = std::move(acks), failed = std::move(failed)](Context& context) {
+        for (const auto& [meeting_id, writes] : acks) {
+            context.OnFlushed(meeting_id, writes, failed.count(meeting_id) > 0);
+        }
+    });
+}
+
+void MeetingMailboxes::EndFlight() {
+    std::lock_guard<std::mutex> lock(flight_mutex_);
+    if (--in_flight_ == 0) {
+        flight_cv_.notify_all();
+    }
+}
+
+} // namespace core
+} // namespace meeting
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "common/status_or.hpp"
+#include "core/meeting/meeting_manager.hpp"
+#include "thread_pool/completion.hpp"
+#include "thread_pool/move_only_function.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace thread_pool {
+class ThreadPool;
+}
+
+namespace meeting {
+namespace core {
+
+class MeetingRepository;
+
+// 待落库的一次会议变更
+struct MeetingWrite {
+    enum class Kind {
+        kAddParticipant,
+        kRemoveParticipant,
+        kUpdateState,
+    };
+
+    Kind          kind = Kind::kUpdateState;
+    std::string   meeting_id;             // 会议ID
+    std::uint64_t participant_id = 0;     // 参与者用户ID (参与者变更)
+    bool          is_organizer = false;   // 是否组织者 (加入参与者)
+    MeetingState  state = MeetingState::kScheduled;  // 新状态 (状态变更)
+    std::int64_t  updated_at = 0;         // 状态更新时间
+    std::uint64_t revision = 0;           // 本次变更后的会议版本号, 落库时直接覆盖存储库中的值
+};
+
+// 邮箱内缓存的会议: 权威内存状态与其参与者变更记录
+struct MailboxMeeting {
+    MeetingData    data;
+    ParticipantLog changes;
+};
+
+// 邮箱内命令可见的会议状态; 只由邮箱当前的消费者访问, 因此无需加锁
+class MeetingMailboxContext {
+public:
+    // 返回会议的权威内存状态, 首次访问时从存储库加载; 指针在本次命令内有效
+    // 会议有变更落库失败时, 其余变更落库前返回 Unavailable, 之后从存储库重新加载
+    meeting::common::StatusOr<MailboxMeeting*> Load(const std::string& meeting_id);
+
+    // 登记一个已同步写入存储库的会议 (创建会议后调用)
+    MailboxMeeting& Adopt(MeetingData meeting);
+
+    // 记录一次变更, 由邮箱在命令之后批量写入存储库; 会议须已 Load 或 Adopt
+    void Write(MeetingWrite write);
+
+    std::size_t CachedMeetings() const noexcept;
+
+private:
+    friend class MeetingMailboxes;
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        MailboxMeeting    meeting;
+        std::size_t       unflushed = 0;   // 尚未落库的变更数, 为 0 时已结束的会议可以从内存中移除
+        bool              stale = false;   // 有变更落库失败, 内存状态与存储库不一致
+        Clock::time_point last_used{};     // 最近一次被命令访问的时间
+    };
+
+    // 距上次清理超过 idle_ttl_ 时, 移除空闲超过 idle_ttl_ 且没有未落库变更的会议
+    void EvictIdle(Clock::time_point now);
+
+    // 一批变更落库后回到邮箱中执行: 扣减未落库计数, 移除已结束或落库失败且无未落库变更的会议
+    void OnFlushed(const std::string& meeting_id, std::size_t writes, bool failed);
+
+    MeetingRepository*                     repository_ = nullptr;
+    Clock::duration                        idle_ttl_{};   // 0 表示不按空闲时间移除
+    Clock::time_point                      next_sweep_{};
+    std::unordered_map<std::string, Entry> meetings_;
+    std::vector<MeetingWrite>              writes_;  // 本轮命令产生的变更
+};
+
+// 按会议ID哈希把命令路由到固定数量的单消费者邮箱: 同一会议的命令严格串行执行,
+// 检查与修改都作用于邮箱内的权威内存状态, 存储库写入在命令返回后按邮箱批量执行 (写后落库).
+// 邮箱没有专属线程: 邮箱空闲时由提交命令的线程 (通常是线程池工作线程) 直接消费,
+// 顺带执行期间排到后面的命令; 否则等待当前消费者执行到它. 等待只依赖正在运行的消费者,
+// 不需要空闲的工作线程, 因此在线程池中调用不会死锁. 落库批次投递到线程池执行,
+// 没有线程池或线程池拒绝时在当前线程同步执行.
+class MeetingMailboxes {
+public:
+    using Context = MeetingMailboxContext;
+    using Message = thread_pool::MoveOnlyFunction<void(Context&)>;
+
+    static constexpr std::size_t kDefaultMailboxes = 64;
+    static constexpr std::size_t kMaxMailboxes = 4096;
+
+    // 邮箱数向上取整为 2 的幂, 取值范围 [1, kMaxMailboxes]; pool 须比本对象存活更久.
+    // 没有未落库变更且空闲超过 idle_ttl 的会议从内存中移除, 再次访问时从存储库加载; 0 表示不移除
+    MeetingMailboxes(std::size_t mailbox_count, std::shared_ptr<MeetingRepository> repository,
+                     thread_pool::ThreadPool* pool = nullptr,
+                     std::chrono::milliseconds idle_ttl = std::chrono::milliseconds::zero());
+    // 等待进行中的落库批次, 再同步写入剩余变更; 调用前不得再有命令在执行
+    ~MeetingMailboxes();
+
+    MeetingMailboxes(const MeetingMailboxes&) = delete;
+    MeetingMailboxes& operator=(const MeetingMailboxes&) = delete;
+
+    // 在 meeting_id 所属邮箱上执行 fn(context) 并返回其结果 (异常原样抛出)
+    template <typename Fn>
+    auto Execute(const std::string& meeting_id, Fn&& fn) -> std::invoke_result_t<Fn&, Context&>;
+
+    // 等待此前产生的全部变更写入存储库; 落库可能在线程池中执行, 不要在工作线程上调用
+    // 返回上次 Flush 以来第一条落库失败的错误 (失败的会议已从内存中移除或等待移除)
+    meeting::common::Status Flush();
+
+    std::size_t MailboxCount() const noexcept;
+
+private:
+    struct Mailbox;
+
+    Mailbox& MailboxFor(const std::string& meeting_id);
+    void     Submit(Mailbox& box, Message message);  // 入队, 邮箱空闲时在当前线程消费
+    void     Drain(Mailbox& box);
+    void     ScheduleFlush(Mailbox& box);
+    void     RunFlush(Mailbox& box);                  // 写入 box 的待落库批次直到为空
+    void     ApplyBatch(Mailbox& box, std::vector<MeetingWrite> batch);
+    void     EndFlight();
+
+    std::shared_ptr<MeetingRepository>   repository_;
+    thread_pool::ThreadPool*             pool_;
+    std::vector<std::unique_ptr<Mailbox>> mailboxes_;
+    std::size_t                          mailbox_mask_;
+
+    std::mutex              flight_mutex_;
+    std::condition_variable flight_cv_;
+    std::size_t             in_flight_ = 0;  // 已投递到线程池尚未结束的落库任务
+};
+
+template <typename Fn>
+auto MeetingMailboxes::Execute(const std::string& meeting_id, Fn&& fn) -> std::invoke_result_t<Fn&, Context&> {
+    using Result = std::invoke_result_t<Fn&, Context&>;
+    thread_pool::CompletionPromise<Result> promise;
+    auto completion = promise.GetCompletion();
+    // fn 按引用捕获: 本函数在命令执行完之前不会返回
+    Submit(MailboxFor(meeting_id), [&fn, promise = std::move(promise)](Context& context) mutable {
+        try {
+            if constexpr (std::is_void_v<Result>) {
+                fn(context);
+                promise.SetValue();
+            } else {
+                promise.SetValue(fn(context));
+            }
+        } catch (...) {
+            promise.SetException(std::current_exception());
+        }
+    });
+    return completion.Get();
+}
+
+}
+}
@@ -1,10 +1,12 @@
 #include "core/meeting/meeting_manager.hpp"
+#include "core/meeting/meeting_mailbox.hpp"
 #include "core/meeting/meeting_repository.hpp"
 
 #include <algorithm>
 #include <mutex>
 #include <random>
 #include <sstream>
+#include <unordered_map>
 
 namespace meeting {
 namespace core {
@@ -34,14 +36,163 @@ std::string RandomAlphanumericString(std::size_t length) {
 
 } // namespace
 
-MeetingManager::MeetingManager(MeetingConfig config, std::shared_ptr<MeetingRepository> repository)
+ParticipantSet::ParticipantSet(std::initializer_list<std::uint64_t> ids) {
+    Reserve(ids.size());
+    for (auto id : ids) {
+        Insert(id);
+    }
+}
+
+ParticipantSet::ParticipantSet(const std::vector<std::uint64_t>& ids) {
+    Reserve(ids.size());
+    for (auto id : ids) {
+        Insert(id);
+    }
+}
+
+bool ParticipantSet::Insert(std::uint64_t id) {
+    if (Contains(id)) {
+        return false;
+    }
+    ids_.push_back(id);
+    if (slots_.empty()) {
+        if (ids_.size() > kLinearLimit) {
+            Rebuild(ids_.size());
+        }
+    } else if (ids_.size() * 2 > slots_.size()) {
+        Rebuild(ids_.size());  // 负载因子保持在 1/2 以下
+    } else {
+        Place(ids_.size() - 1);
+    }
+    return true;
+}
+
+bool ParticipantSet::Erase(std::uint64_t id) {
+    const std::size_t index = Find(id);
+    if (index == kNotFound) {
+        return false;
+    }
+    const std::size_t last = ids_.size() - 1;
+    if (!slots_.empty()) {
+        // 删除槽位后把同一探测链上的后继前移 (backward shift), 不留墓碑
+        const std::size_t mask = slots_.size() - 1;
+        std::size_t hole = SlotOf(index);
+        for (std::size_t slot = (hole + 1) & mask; slots_[slot] != 0; slot = (slot + 1) & mask) {
+            const std::size_t home = Home(ids_[slots_[slot] - 1]);
+            if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+                slots_[hole] = slots_[slot];
+                hole = slot;
+            }
+        }
+        slots_[hole] = 0;
+        if (index != last) {
+            slots_[SlotOf(last)] = static_cast<std::uint32_t>(index + 1);
+        }
+    }
+    ids_[index] = ids_[last];
+    ids_.pop_back();
+    return true;
+}
+
+void ParticipantSet::Reserve(std::size_t count) {
+    ids_.reserve(count);
+    if (count > kLinearLimit && count * 2 > slots_.size()) {
+        Rebuild(count);
+    }
+}
+
+void ParticipantSet::Clear() noexcept {
+    ids_.clear();
+    slots_.clear();
+    shift_ = 64;
+}
+
+std::size_t ParticipantSet::SlotOf(std::size_t index) const noexcept {
+    const std::size_t mask = slots_.size() - 1;
+    std::size_t slot = Home(ids_[index]);
+    while (slots_[slot] != index + 1) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void ParticipantSet::Place(std::size_t index) noexcept {
+    const std::size_t mask = slots_.size() - 1;
+    std::size_t slot = Home(ids_[index]);
+    while (slots_[slot] != 0) {
+        slot = (slot + 1) & mask;
+    }
+    slots_[slot] = static_cast<std::uint32_t>(index + 1);
+}
+
+void ParticipantSet::Rebuild(std::size_t min_entries) {
+    const std::size_t wanted = std::max(min_entries, kLinearLimit) * 2;
+    unsigned bits = 0;
+    while ((std::size_t{1} << bits) < wanted) {
+        ++bits;
+    }
+    slots_.assign(std::size_t{1} << bits, 0);
+    shift_ = 64 - bits;
+    for (std::size_t i = 0; i < ids_.size(); ++i) {
+        Place(i);
+    }
+}
+
+void ParticipantLog::Record(std::uint64_t revision, std::uint64_t participant_id, bool joined) {
+    if (base_ == kNoHistory) {
+        base_ = revision - 1;
+    }
+    changes_.push_back(Change{revision, participant_id, joined});
+    if (changes_.size() > kMaxChanges) {
+        base_ = changes_.front().revision;
+        changes_.pop_front();
+    }
+}
+
+void ParticipantLog::CollectSince(std::uint64_t since_revision, std::vector<std::uint64_t>* added,
+                                  std::vector<std::uint64_t>* removed) const {
+    auto first = std::upper_bound(changes_.begin(), changes_.end(), since_revision,
+                                  [](std::uint64_t revision, const Change& change) { return revision < change.revision; });
+    // 每个参与者只看首次与最后一次变更: 首次是加入说明之前不在会中, 最后一次是加入说明现在在会中
+    struct Net {
+        bool first_joined;
+        bool last_joined;
+    };
+    std::unordered_map<std::uint64_t, Net> net;
+    std::vector<std::uint64_t> order;
+    for (auto it = first; it != changes_.end(); ++it) {
+        auto [entry, inserted] = net.try_emplace(it->participant_id, Net{it->joined, it->joined});
+        if (inserted) {
+            order.push_back(it->participant_id);
+        } else {
+            entry->second.last_joined = it->joined;
+        }
+    }
+    for (auto id : order) {
+        const Net& change = net[id];
+        if (change.first_joined && change.last_joined) {
+            added->push_back(id);
+        } else if (!change.first_joined && !change.last_joined) {
+            removed->push_back(id);
+        }
+    }
+}
+
+MeetingManager::MeetingManager(MeetingConfig config, std::shared_ptr<MeetingRepository> repository, thread_pool::ThreadPool* pool)
     : config_(std::move(config))
     , repository_(std::move(repository)) {
     if (!repository_) {
         repository_ = std::make_shared<InMemoryMeetingRepository>();
     }
+    if (config_.serialize_per_meeting) {
+        mailboxes_ = std::make_unique<MeetingMailboxes>(config_.mailbox_count, repository_, pool,
+                                                        config_.mailbox_idle_ttl);
+    }
 }
 
+// 销毁邮箱时写完剩余变更
+MeetingManager::~MeetingManager() = default;
+
 MeetingManager::StatusOrMeeting MeetingManager::CreateMeeting(const CreateMeetingCommand& command) {
     if (command.organizer_id == 0) {
         return Status::InvalidArgument("Organizer ID cannot be empty.");
@@ -60,7 +211,8 @@ MeetingManager::StatusOrMeeting MeetingManager::CreateMeeting(const CreateMeetin
     meeting.state = MeetingState::kScheduled;
     meeting.created_at = CurrentUnixSeconds();
     meeting.updated_at = meeting.created_at;
-    meeting.participants.push_back(command.organizer_id);
+    meeting.participants.Insert(command.organizer_id);
+    meeting.revision = 1;
 
     // 存储会议数据
     auto status = repository_->CreateMeeting(meeting);
@@ -69,11 +221,17 @@ MeetingManager::StatusOrMeeting MeetingManager::CreateMeeting(const CreateMeetin
     }
 
     // 添加组织者为参与者
-    auto add_status = repository_->AddParticipant(meeting.meeting_id, meeting.organizer_id, true);
+    auto add_status = repository_->AddParticipant(meeting.meeting_id, meeting.organizer_id, true, meeting.revision);
     if (!add_status.IsOk() &&  add_status.Code() != meeting::common::StatusCode::kAlreadyExists) {
         return add_status;
     }
+    active_meetings_.fetch_add(1, std::memory_order_relaxed);
+    active_participants_.fetch_add(1, std::memory_order_relaxed);
 
+    if (mailboxes_) {
+        // 会议已同步落库, 登记到所属邮箱后无需再从存储库加载
+        mailboxes_->Execute(meeting.meeting_id, [&meeting](MeetingMailboxContext& context) { context.Adopt(meeting); });
+    }
     return StatusOrMeeting(std::move(meeting));
 }
 
@@ -84,40 +242,19 @@ MeetingManager::StatusOrMeeting MeetingManager::JoinMeeting(const JoinMeetingCom
     if (command.participant_id == 0) {
         return Status::InvalidArgument("Participant ID cannot be empty.");
     }
-
-    // 获取会议信息
-    auto meeting_or = repository_->GetMeeting(command.meeting_id);
-    if (!meeting_or.IsOk()) {
-        return meeting_or.GetStatus();
-    }
-    auto meeting = meeting_or.Value();
-
-    if (meeting.state == MeetingState::kEnded) {
-        return Status::InvalidArgument("Cannot join a meeting that has ended.");
+    if (mailboxes_) {
+        return mailboxes_->Execute(command.meeting_id, [this, &command](MeetingMailboxContext& context) {
+            return JoinInMailbox(context, command);
+        });
     }
 
-    if (std::find(meeting.participants.begin(), meeting.participants.end(), command.participant_id) != meeting.participants.end()) {
-        return Status::AlreadyExists("Participant already in the meeting.");
+    // 校验, 加入与状态推进在存储库中一次完成
+    auto joined = repository_->JoinAndLoad(MakeJoinRequest(command));
+    if (!joined.IsOk()) {
+        return joined.GetStatus();
     }
-
-    if (meeting.participants.size() >= config_.max_participants) {
-        return Status::Unavailable("Meeting has reached maximum participant limit.");
-    }
-
-    // 添加参与者
-    auto status = repository_->AddParticipant(command.meeting_id, command.participant_id, false);
-    if (!status.IsOk()) {
-        return status;
-    }
-    if (meeting.state == MeetingState::kScheduled && command.participant_id != meeting.organizer_id) {
-        meeting.state = MeetingState::kRunning;
-        repository_->UpdateMeetingState(meeting.meeting_id, meeting.state, CurrentUnixSeconds());
-    }
-    meeting.participants.push_back(command.participant_id);
-    // 更新会议的更新时间戳
-    Touch(meeting);
-
-    return StatusOrMeeting(std::move(meeting));
+    active_participants_.fetch_add(1, std::memory_order_relaxed);
+    return joined;
 }
 
 MeetingManager::Status MeetingManager::LeaveMeeting(const LeaveMeetingCommand& command) {
@@ -127,38 +264,20 @@ MeetingManager::Status MeetingManager::LeaveMeeting(const LeaveMeetingCommand& c
     if (command.participant_id == 0) {
         return Status::InvalidArgument("Participant ID cannot be empty.");
     }
-
-    // 获取会议信息
-    auto meeting_or = repository_->GetMeeting(command.meeting_id);
-    if (!meeting_or.IsOk()) {
-        return meeting_or.GetStatus();
-    }
-    auto meeting = meeting_or.Value();
-    auto iter = std::find(meeting.participants.begin(), meeting.participants.end(), command.participant_id);
-    if (iter == meeting.participants.end()) {
-        return Status::AlreadyExists("Participant not found in the meeting.");
+    if (mailboxes_) {
+        return mailboxes_->Execute(command.meeting_id, [this, &command](MeetingMailboxContext& context) {
+            return LeaveInMailbox(context, command);
+        });
     }
 
-    // 移除参与者
-    auto rm_status = repository_->RemoveParticipant(command.meeting_id, command.participant_id);
-    if (!rm_status.IsOk()) {
-        return rm_status;
+    // 移除参与者与按配置结束会议在存储库中一次完成
+    auto left = repository_->LeaveAndLoad(MakeLeaveRequest(command));
+    if (!left.IsOk()) {
+        return left.GetStatus();
     }
-
-    if (command.participant_id == meeting.organizer_id && config_.end_when_organizer_leaves) {
-        // 组织者离开，结束会议
-        meeting.state = MeetingState::kEnded;
-        repository_->UpdateMeetingState(meeting.meeting_id, meeting.state, CurrentUnixSeconds());
-    } else {
-        // 非组织者离开，更新参与者列表
-        auto list = repository_->ListParticipants(meeting.meeting_id);
-        if (list.IsOk()) {
-            meeting.participants = list.Value();
-        }
-        if (meeting.participants.empty() && config_.end_when_empty) {
-            meeting.state = MeetingState::kEnded;
-            repository_->UpdateMeetingState(meeting.meeting_id, meeting.state, CurrentUnixSeconds());
-        }
+    active_participants_.fetch_sub(1, std::memory_order_relaxed);
+    if (left.Value().ended) {
+        OnMeetingEnded(left.Value().meeting.participants.size());
     }
     return Status::OK();
 }
@@ -170,6 +289,11 @@ MeetingManager::Status MeetingManager::EndMeeting(const EndMeetingCommand& comma
     if (command.requester_id == 0) {
         return Status::InvalidArgument("Requester ID cannot be empty.");
     }
+    if (mailboxes_) {
+        return mailboxes_->Execute(command.meeting_id, [this, &command](MeetingMailboxContext& context) {
+            return EndInMailbox(context, command);
+        });
+    }
 
     // 获取会议信息
     auto meeting_or = repository_->GetMeeting(command.meeting_id);
@@ -178,21 +302,32 @@ MeetingManager::Status MeetingManager::EndMeeting(const EndMeetingCommand& comma
     }
     auto meeting = meeting_or.Value();
 
-    if (meeting.state == MeetingState::kEnded) {
-        return Status::InvalidArgument("Meeting has already ended.");
-    }
-    if (command.requester_id != meeting.organizer_id) {
-        return Status::Unauthenticated("Only the organizer can end the meeting.");
+    auto check = CheckEnd(meeting, command.requester_id);
+    if (!check.IsOk()) {
+        return check;
     }
 
     // 更新会议状态为已结束
-    return repository_->UpdateMeetingState(command.meeting_id, MeetingState::kEnded, CurrentUnixSeconds());
+    auto status = repository_->UpdateMeetingState(command.meeting_id, MeetingState::kEnded, CurrentUnixSeconds(), kNextRevision);
+    if (status.IsOk()) {
+        OnMeetingEnded(meeting.participants.size());
+    }
+    return status;
 }
 
 MeetingManager::StatusOrMeeting MeetingManager::GetMeeting(const std::string& meeting_id) {
     if (meeting_id.empty()) {
         return Status::InvalidArgument("Meeting ID cannot be empty.");
     }
+    if (mailboxes_) {
+        return mailboxes_->Execute(meeting_id, [&meeting_id](MeetingMailboxContext& context) -> StatusOrMeeting {
+            auto loaded = context.Load(meeting_id);
+            if (!loaded.IsOk()) {
+                return loaded.GetStatus();
+            }
+            return StatusOrMeeting(loaded.Value()->data);
+        });
+    }
 
     auto meeting = repository_->GetMeeting(meeting_id);
     if (!meeting.IsOk()) {
@@ -201,6 +336,155 @@ MeetingManager::StatusOrMeeting MeetingManager::GetMeeting(const std::string& me
     return meeting;
 }
 
+meeting::common::StatusOr<MeetingDelta> MeetingManager::GetMeetingSince(const std::string& meeting_id,
+                                                                        std::uint64_t since_revision) {
+    using StatusOrDelta = meeting::common::StatusOr<MeetingDelta>;
+    if (meeting_id.empty()) {
+        return Status::InvalidArgument("Meeting ID cannot be empty.");
+    }
+    if (mailboxes_) {
+        // 在邮箱内直接读权威状态, 增量时不复制参与者列表
+        return mailboxes_->Execute(meeting_id, [&meeting_id, since_revision](MeetingMailboxContext& context) -> StatusOrDelta {
+            auto loaded = context.Load(meeting_id);
+            if (!loaded.IsOk()) {
+                return loaded.GetStatus();
+            }
+            const MailboxMeeting& meeting = *loaded.Value();
+            return StatusOrDelta(DiffMeeting(meeting.data, &meeting.changes, since_revision));
+        });
+    }
+
+    // 存储库在自己的锁内计算增量, 只复制变化部分
+    return repository_->DiffSince(meeting_id, since_revision);
+}
+
+MeetingLoad MeetingManager::GetLoad() const {
+    // 会议可能由其他节点创建而在本节点结束, 计数可能暂时为负, 对外截断为 0
+    MeetingLoad load;
+    load.active_meetings = static_cast<std::uint64_t>(std::max<std::int64_t>(active_meetings_.load(std::memory_order_relaxed), 0));
+    load.participants = static_cast<std::uint64_t>(std::max<std::int64_t>(active_participants_.load(std::memory_order_relaxed), 0));
+    return load;
+}
+
+MeetingManager::Status MeetingManager::Flush() {
+    if (mailboxes_) {
+        return mailboxes_->Flush();
+    }
+    return Status::OK();
+}
+
+MeetingManager::StatusOrMeeting MeetingManager::JoinInMailbox(MeetingMailboxContext& context, const JoinMeetingCommand& command) {
+    auto loaded = context.Load(command.meeting_id);
+    if (!loaded.IsOk()) {
+        return loaded.GetStatus();
+    }
+    MeetingData& meeting = loaded.Value()->data;
+    const MeetingState previous = meeting.state;
+    auto status = ApplyJoin(meeting, MakeJoinRequest(command), &loaded.Value()->changes);
+    if (!status.IsOk()) {
+        return status;
+    }
+
+    MeetingWrite add;
+    add.kind = MeetingWrite::Kind::kAddParticipant;
+    add.meeting_id = meeting.meeting_id;
+    add.participant_id = command.participant_id;
+    add.revision = meeting.revision;
+    context.Write(std::move(add));
+    if (meeting.state != previous) {
+        WriteState(context, meeting);
+    }
+    active_participants_.fetch_add(1, std::memory_order_relaxed);
+    return StatusOrMeeting(meeting);
+}
+
+MeetingManager::Status MeetingManager::LeaveInMailbox(MeetingMailboxContext& context, const LeaveMeetingCommand& command) {
+    auto loaded = context.Load(command.meeting_id);
+    if (!loaded.IsOk()) {
+        return loaded.GetStatus();
+    }
+    MeetingData& meeting = loaded.Value()->data;
+    auto ended = ApplyLeave(meeting, MakeLeaveRequest(command), &loaded.Value()->changes);
+    if (!ended.IsOk()) {
+        return ended.GetStatus();
+    }
+
+    MeetingWrite remove;
+    remove.kind = MeetingWrite::Kind::kRemoveParticipant;
+    remove.meeting_id = meeting.meeting_id;
+    remove.participant_id = command.participant_id;
+    remove.revision = meeting.revision;
+    context.Write(std::move(remove));
+    active_participants_.fetch_sub(1, std::memory_order_relaxed);
+    if (ended.Value()) {
+        WriteState(context, meeting);
+        OnMeetingEnded(meeting.participants.size());
+    }
+    return Status::OK();
+}
+
+MeetingManager::Status MeetingManager::EndInMailbox(MeetingMailboxContext& context, const EndMeetingCommand& command) {
+    auto loaded = context.Load(command.meeting_id);
+    if (!loaded.IsOk()) {
+        return loaded.GetStatus();
+    }
+    MeetingData& meeting = loaded.Value()->data;
+    auto check = CheckEnd(meeting, command.requester_id);
+    if (!check.IsOk()) {
+        return check;
+    }
+
+    meeting.state = MeetingState::kEnded;
+    meeting.updated_at = CurrentUnixSeconds();
+    ++meeting.revision;
+    WriteState(context, meeting);
+    OnMeetingEnded(meeting.participants.size());
+    return Status::OK();
+}
+
+JoinRequest MeetingManager::MakeJoinRequest(const JoinMeetingCommand& command) const {
+    JoinRequest request;
+    request.meeting_id = command.meeting_id;
+    request.participant_id = command.participant_id;
+    request.max_participants = config_.max_participants;
+    request.updated_at = CurrentUnixSeconds();
+    return request;
+}
+
+LeaveRequest MeetingManager::MakeLeaveRequest(const LeaveMeetingCommand& command) const {
+    LeaveRequest request;
+    request.meeting_id = command.meeting_id;
+    request.participant_id = command.participant_id;
+    request.end_when_empty = config_.end_when_empty;
+    request.end_when_organizer_leaves = config_.end_when_organizer_leaves;
+    request.updated_at = CurrentUnixSeconds();
+    return request;
+}
+
+void MeetingManager::WriteState(MeetingMailboxContext& context, const MeetingData& meeting) {
+    MeetingWrite update;
+    update.meeting_id = meeting.meeting_id;
+    update.state = meeting.state;
+    update.updated_at = meeting.updated_at;
+    update.revision = meeting.revision;
+    context.Write(std::move(update));
+}
+
+MeetingManager::Status MeetingManager::CheckEnd(const MeetingData& meeting, std::uint64_t requester_id) const {
+    if (meeting.state == MeetingState::kEnded) {
+        return Status::InvalidArgument("Meeting has already ended.");
+    }
+    if (requester_id != meeting.organizer_id) {
+        return Status::Unauthenticated("Only the organizer can end the meeting.");
+    }
+    return Status::OK();
+}
+
+void MeetingManager::OnMeetingEnded(std::size_t remaining_participants) {
+    active_meetings_.fetch_sub(1, std::memory_order_relaxed);
+    active_participants_.fetch_sub(static_cast<std::int64_t>(remaining_participants), std::memory_order_relaxed);
+}
+
 std::string MeetingManager::GenerateMeetingID() {
     return "meeting_-" + RandomAlphanumericString(16);
 }
@@ -209,9 +493,5 @@ std::string MeetingManager::GenerateMeetingCode() {
     return RandomAlphanumericString(config_.meeting_code_length);
 }
 
-void MeetingManager::Touch(MeetingData& meeting) {
-    meeting.updated_at = CurrentUnixSeconds();
-}
-
 } // namespace core
 } // namespace meeting
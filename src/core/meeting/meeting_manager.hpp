@@ -3,37 +3,177 @@
 #include "common/status.hpp"
 #include "common/status_or.hpp"
 
+#include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <deque>
+#include <initializer_list>
 #include <memory>
 #include <string>
 #include <vector>
 
+namespace thread_pool {
+class ThreadPool;
+}
+
 namespace meeting {
 namespace core {
 
+class MeetingMailboxes;
+class MeetingMailboxContext;
+struct JoinRequest;
+struct LeaveRequest;
+
 enum class MeetingState {
     kScheduled = 0,
     kRunning,
     kEnded,
 };
 
+// 会议参与者集合: 参与者ID按加入顺序存放在连续数组中, 迭代与序列化都直接走这个数组;
+// 人数超过 kLinearLimit 后另建开放寻址 (线性探测) 的下标索引, 成员判断/加入/离开均为 O(1).
+// 离开时用最后一个参与者填补空位, 因此有人离开后的顺序不再严格是加入顺序.
+class ParticipantSet {
+public:
+    using const_iterator = std::vector<std::uint64_t>::const_iterator;
+
+    static constexpr std::size_t kLinearLimit = 32;  // 不超过此人数时直接顺序扫描, 不建索引
+
+    ParticipantSet() = default;
+    ParticipantSet(std::initializer_list<std::uint64_t> ids);
+    explicit ParticipantSet(const std::vector<std::uint64_t>& ids);  // 重复的ID只保留第一个
+
+    bool Contains(std::uint64_t id) const noexcept {
+        return Find(id) != kNotFound;
+    }
+    bool Insert(std::uint64_t id);  // 已存在时返回 false
+    bool Erase(std::uint64_t id);   // 不存在时返回 false
+    void Reserve(std::size_t count);
+    void Clear() noexcept;
+
+    const std::vector<std::uint64_t>& Ids() const noexcept {
+        return ids_;
+    }
+    std::size_t size() const noexcept {
+        return ids_.size();
+    }
+    bool empty() const noexcept {
+        return ids_.empty();
+    }
+    const_iterator begin() const noexcept {
+        return ids_.begin();
+    }
+    const_iterator end() const noexcept {
+        return ids_.end();
+    }
+    std::uint64_t operator[](std::size_t index) const noexcept {
+        return ids_[index];
+    }
+
+private:
+    static constexpr std::size_t kNotFound = static_cast<std::size_t>(-1);
+
+    std::size_t Home(std::uint64_t id) const noexcept {
+        return static_cast<std::size_t>((id * 0x9E3779B97F4A7C15ull) >> shift_);
+    }
+    std::size_t Find(std::uint64_t id) const noexcept;  // 返回在 ids_ 中的下标
+    std::size_t SlotOf(std::size_t index) const noexcept;
+    void        Place(std::size_t index) noexcept;
+    void        Rebuild(std::size_t min_slots);
+
+    std::vector<std::uint64_t> ids_;
+    std::vector<std::uint32_t> slots_;     // ids_ 下标 + 1, 0 表示空槽; 未建索引时为空
+    unsigned                   shift_ = 64;  // 64 - log2(slots_.size())
+};
+
+inline std::size_t ParticipantSet::Find(std::uint64_t id) const noexcept {
+    if (slots_.empty()) {
+        for (std::size_t i = 0; i < ids_.size(); ++i) {
+            if (ids_[i] == id) {
+                return i;
+            }
+        }
+        return kNotFound;
+    }
+    const std::size_t mask = slots_.size() - 1;
+    for (std::size_t slot = Home(id);; slot = (slot + 1) & mask) {
+        const std::uint32_t entry = slots_[slot];
+        if (entry == 0) {
+            return kNotFound;
+        }
+        if (ids_[entry - 1] == id) {
+            return entry - 1;
+        }
+    }
+}
+
+// 最近的参与者变更记录, 用于按版本号计算增量; 只保存在内存中, 超过 kMaxChanges 条时丢弃最早的.
+// 每个会议一份, 由 InMemoryMeetingRepository 与邮箱在 MeetingData 之外单独保存, 复制会议数据时不随之复制.
+// 从存储库加载的会议没有历史, 从其后第一次变更开始记录.
+class ParticipantLog {
+public:
+    static constexpr std::size_t kMaxChanges = 1024;
+
+    // 记录把会议推进到 revision 的一次加入/离开; 调用时会议须处于 revision - 1
+    void Record(std::uint64_t revision, std::uint64_t participant_id, bool joined);
+
+    // 是否保留了 since_revision 之后的全部参与者变更
+    bool Covers(std::uint64_t since_revision) const noexcept {
+        return base_ != kNoHistory && since_revision >= base_;
+    }
+
+    // since_revision 之后的净变化 (先加入后离开的参与者不出现); 须先确认 Covers
+    void CollectSince(std::uint64_t since_revision, std::vector<std::uint64_t>* added,
+                      std::vector<std::uint64_t>* removed) const;
+
+    std::size_t size() const noexcept {
+        return changes_.size();
+    }
+
+private:
+    static constexpr std::uint64_t kNoHistory = static_cast<std::uint64_t>(-1);
+
+    struct Change {
+        std::uint64_t revision;
+        std::uint64_t participant_id;
+        bool          joined;
+    };
+
+    std::deque<Change> changes_;
+    std::uint64_t      base_ = kNoHistory;  // 记录起点: 此版本之后的变更都在 changes_ 中
+};
+
 struct MeetingData {
     std::string              meeting_id;    // 会议ID
     std::string              meeting_code;  // 会议码
     std::uint64_t            organizer_id = 0;  // 组织者用户ID
     std::string              topic;         // 会议主题
     MeetingState             state;         // 会议状态
-    std::vector<std::uint64_t> participants;  // 参与者用户ID列表
+    ParticipantSet           participants;  // 参与者用户ID集合
+    std::uint64_t            revision = 0;  // 会议版本号, 创建时为 1, 每次加入/离开/状态变更加 1
     std::int64_t             created_at;    // 会议创建时间
     std::int64_t             updated_at;    // 会议更新时间
 };
 
+// 会议相对某个版本的参与者增量; incremental 为 false 时 meeting 携带完整参与者列表
+struct MeetingDelta {
+    MeetingData                meeting;               // incremental 时不含参与者列表
+    bool                       incremental = false;
+    std::uint64_t              since_revision = 0;
+    std::vector<std::uint64_t> added;                 // since_revision 之后加入的参与者
+    std::vector<std::uint64_t> removed;               // since_revision 之后离开的参与者
+};
+
 struct MeetingConfig {
     std::size_t max_participants          = 100;   // 最大参与者数量
     bool        end_when_empty            = true;  // 当没有参与者时结束会议
     bool        end_when_organizer_leaves = true;  // 当组织者离开时结束会议
     std::size_t meeting_code_length       = 8;     // 会议码长度
+    // 按会议串行执行: 命令路由到会议所属的邮箱, 在内存中的权威状态上检查与修改, 存储库写入批量落后执行
+    bool        serialize_per_meeting     = false;
+    std::size_t mailbox_count             = 64;    // 邮箱数 (serialize_per_meeting 时生效)
+    // 没有未落库变更且空闲超过该时长的会议移出邮箱内存, 0 表示不移除 (serialize_per_meeting 时生效)
+    std::chrono::milliseconds mailbox_idle_ttl{300000};
 };
 
 struct CreateMeetingCommand {
@@ -56,12 +196,21 @@ struct EndMeetingCommand {
     std::uint64_t requester_id{0};  // 请求者用户ID
 };
 
+// 本节点处理的会议负载 (近似值, 用于发布到注册中心)
+struct MeetingLoad {
+    std::uint64_t active_meetings = 0; // 进行中的会议数
+    std::uint64_t participants = 0;    // 在线参与者数
+};
+
 class MeetingManager {
 public:
     using Status = meeting::common::Status;
     using StatusOrMeeting = meeting::common::StatusOr<MeetingData>;
 
-    explicit MeetingManager(MeetingConfig config = MeetingConfig{}, std::shared_ptr<class MeetingRepository> repository = nullptr);
+    // pool 用于执行邮箱的批量落库 (serialize_per_meeting 时), 为空则在命令线程上同步落库; pool 须比本对象存活更久
+    explicit MeetingManager(MeetingConfig config = MeetingConfig{}, std::shared_ptr<class MeetingRepository> repository = nullptr,
+                            thread_pool::ThreadPool* pool = nullptr);
+    ~MeetingManager();
 
     StatusOrMeeting CreateMeeting(const CreateMeetingCommand& command);
     StatusOrMeeting JoinMeeting(const JoinMeetingCommand& command);
@@ -69,14 +218,34 @@ public:
     Status EndMeeting(const EndMeetingCommand& command);
 
     StatusOrMeeting GetMeeting(const std::string& meeting_id);
+    // 返回 since_revision 之后的参与者增删; 0, 比当前版本新, 或变更记录已不覆盖时返回完整参与者列表
+    meeting::common::StatusOr<MeetingDelta> GetMeetingSince(const std::string& meeting_id, std::uint64_t since_revision);
+
+    // 获取当前负载
+    MeetingLoad GetLoad() const;
+
+    // 等待邮箱中尚未落库的变更写入存储库 (直接模式下立即返回 OK); 返回其间第一条落库失败的错误
+    Status Flush();
 
 private:
     std::string GenerateMeetingID();
     std::string GenerateMeetingCode();
-    void Touch(MeetingData& meeting); // 更新会议的更新时间戳
+    void OnMeetingEnded(std::size_t remaining_participants); // 会议结束时扣减负载
+    Status CheckEnd(const MeetingData& meeting, std::uint64_t requester_id) const;
+    JoinRequest MakeJoinRequest(const JoinMeetingCommand& command) const;
+    LeaveRequest MakeLeaveRequest(const LeaveMeetingCommand& command) const;
+
+    // 邮箱模式下在会议所属邮箱中执行的命令
+    StatusOrMeeting JoinInMailbox(MeetingMailboxContext& context, const JoinMeetingCommand& command);
+    Status LeaveInMailbox(MeetingMailboxContext& context, const LeaveMeetingCommand& command);
+    Status EndInMailbox(MeetingMailboxContext& context, const EndMeetingCommand& command);
+    static void WriteState(MeetingMailboxContext& context, const MeetingData& meeting); // 记录会议当前状态的落库变更
 private:
     MeetingConfig config_;
     std::shared_ptr<class MeetingRepository> repository_;
+    std::unique_ptr<MeetingMailboxes> mailboxes_; // serialize_per_meeting 时创建
+    std::atomic<std::int64_t> active_meetings_{0}; // 进行中的会议数
+    std::atomic<std::int64_t> active_participants_{0}; // 在线参与者数
 };
 
 }
@@ -1,83 +1,257 @@
 #include "core/meeting/meeting_repository.hpp"
 
-#include <algorithm>
 #include <mutex>
 
 namespace meeting {
 namespace core {
 
+namespace {
+
+std::size_t RoundUpShards(std::size_t count) {
+    std::size_t shards = 1;
+    while (shards < count && shards < InMemoryMeetingRepository::kMaxShards) {
+        shards <<= 1;
+    }
+    return shards;
+}
+
+std::uint64_t RevisionAfterWrite(const MeetingData& meeting, std::uint64_t revision) {
+    return revision == kNextRevision ? meeting.revision + 1 : revision;
+}
+
+// since_revision 之后的变化能否只用增量表示: 版本未变, 或变更记录覆盖了 since_revision 之后的全部变更
+bool CanDiffSince(const MeetingData& meeting, const ParticipantLog* changes, std::uint64_t since_revision) {
+    if (since_revision == 0 || since_revision > meeting.revision) {
+        return false;
+    }
+    return since_revision == meeting.revision || (changes != nullptr && changes->Covers(since_revision));
+}
+
+// 只复制会议基本信息, 参与者以增量给出
+MeetingDelta IncrementalDelta(const MeetingData& meeting, const ParticipantLog* changes, std::uint64_t since_revision) {
+    MeetingDelta delta;
+    delta.incremental = true;
+    delta.since_revision = since_revision;
+    delta.meeting.meeting_id = meeting.meeting_id;
+    delta.meeting.meeting_code = meeting.meeting_code;
+    delta.meeting.organizer_id = meeting.organizer_id;
+    delta.meeting.topic = meeting.topic;
+    delta.meeting.state = meeting.state;
+    delta.meeting.revision = meeting.revision;
+    delta.meeting.created_at = meeting.created_at;
+    delta.meeting.updated_at = meeting.updated_at;
+    if (changes != nullptr && since_revision != meeting.revision) {
+        changes->CollectSince(since_revision, &delta.added, &delta.removed);
+    }
+    return delta;
+}
+
+} // namespace
+
+meeting::common::Status ApplyJoin(MeetingData& meeting, const JoinRequest& request, ParticipantLog* changes) {
+    if (meeting.state == MeetingState::kEnded) {
+        return meeting::common::Status::InvalidArgument("Cannot join a meeting that has ended.");
+    }
+    if (meeting.participants.Contains(request.participant_id)) {
+        return meeting::common::Status::AlreadyExists("Participant already in the meeting.");
+    }
+    if (meeting.participants.size() >= request.max_participants) {
+        return meeting::common::Status::Unavailable("Meeting has reached maximum participant limit.");
+    }
+
+    meeting.participants.Insert(request.participant_id);
+    if (meeting.state == MeetingState::kScheduled && request.participant_id != meeting.organizer_id) {
+        meeting.state = MeetingState::kRunning;
+    }
+    meeting.updated_at = request.updated_at;
+    ++meeting.revision;
+    if (changes != nullptr) {
+        changes->Record(meeting.revision, request.participant_id, true);
+    }
+    return meeting::common::Status::OK();
+}
+
+meeting::common::StatusOr<bool> ApplyLeave(MeetingData& meeting, const LeaveRequest& request, ParticipantLog* changes) {
+    if (!meeting.participants.Erase(request.participant_id)) {
+        return meeting::common::Status::AlreadyExists("Participant not found in the meeting.");
+    }
+
+    meeting.updated_at = request.updated_at;
+    ++meeting.revision;
+    if (changes != nullptr) {
+        changes->Record(meeting.revision, request.participant_id, false);
+    }
+    // 已结束的会议不再重复结束
+    const bool organizer_left = request.participant_id == meeting.organizer_id && request.end_when_organizer_leaves;
+    const bool empty = meeting.participants.empty() && request.end_when_empty;
+    if (meeting.state == MeetingState::kEnded || !(organizer_left || empty)) {
+        return meeting::common::StatusOr<bool>(false);
+    }
+    meeting.state = MeetingState::kEnded;
+    return meeting::common::StatusOr<bool>(true);
+}
+
+MeetingDelta DiffMeeting(const MeetingData& meeting, const ParticipantLog* changes, std::uint64_t since_revision) {
+    if (CanDiffSince(meeting, changes, since_revision)) {
+        return IncrementalDelta(meeting, changes, since_revision);
+    }
+    MeetingDelta delta;
+    delta.since_revision = since_revision;
+    delta.meeting = meeting;
+    return delta;
+}
+
+MeetingDelta DiffMeeting(MeetingData&& meeting, const ParticipantLog* changes, std::uint64_t since_revision) {
+    if (CanDiffSince(meeting, changes, since_revision)) {
+        return IncrementalDelta(meeting, changes, since_revision);
+    }
+    MeetingDelta delta;
+    delta.since_revision = since_revision;
+    delta.meeting = std::move(meeting);
+    return delta;
+}
+
+InMemoryMeetingRepository::InMemoryMeetingRepository(std::size_t shard_count)
+    : shard_mask_(RoundUpShards(shard_count) - 1)
+    , shards_(std::make_unique<Shard[]>(shard_mask_ + 1)) {}
+
+std::size_t InMemoryMeetingRepository::ShardCount() const noexcept {
+    return shard_mask_ + 1;
+}
+
+// 哈希值再乘黄金分割常数取高位, 避免字符串哈希低位分布不均时挤在少数分片
+InMemoryMeetingRepository::Shard& InMemoryMeetingRepository::ShardFor(const std::string& meeting_id) const noexcept {
+    const std::uint64_t hash = static_cast<std::uint64_t>(MeetingIdHash{}(meeting_id)) * 0x9E3779B97F4A7C15ull;
+    return shards_[(hash >> 32) & shard_mask_];
+}
+
 // 创建新会议
 meeting::common::StatusOr<MeetingData> InMemoryMeetingRepository::CreateMeeting(const MeetingData& data) {
-    std::unique_lock<std::shared_mutex> lock(mutex_);
-    auto it = meetings_.find(data.meeting_id);
-    if (it != meetings_.end()) {
+    auto& shard = ShardFor(data.meeting_id);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    if (!shard.meetings.try_emplace(data.meeting_id, StoredMeeting{data, ParticipantLog{}}).second) {
         return meeting::common::Status::AlreadyExists("meeting already exists");
     }
-    meetings_.emplace(data.meeting_id, data);
     return meeting::common::StatusOr<MeetingData>(data);
 }
 
 // 根据会议ID查找会议
 meeting::common::StatusOr<MeetingData> InMemoryMeetingRepository::GetMeeting(const std::string& meeting_id) const {
-    std::shared_lock<std::shared_mutex> lock(mutex_);
-    auto it = meetings_.find(meeting_id);
-    if (it == meetings_.end()) {
+    auto& shard = ShardFor(meeting_id);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.meetings.find(meeting_id);
+    if (it == shard.meetings.end()) {
         return meeting::common::Status::NotFound("meeting not found");
     }
-    return meeting::common::StatusOr<MeetingData>(it->second);
+    return meeting::common::StatusOr<MeetingData>(it->second.data);
 }
 
 // 更新会议信息
-meeting::common::Status InMemoryMeetingRepository::UpdateMeetingState(const std::string& meeting_id, MeetingState state, std::int64_t updated_at) {
-    std::unique_lock<std::shared_mutex> lock(mutex_);
-    auto it = meetings_.find(meeting_id);
-    if (it == meetings_.end()) {
+meeting::common::Status InMemoryMeetingRepository::UpdateMeetingState(const std::string& meeting_id, MeetingState state, std::int64_t updated_at,
+                                                                      std::uint64_t revision) {
+    auto& shard = ShardFor(meeting_id);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.meetings.find(meeting_id);
+    if (it == shard.meetings.end()) {
         return meeting::common::Status::NotFound("meeting not found");
     }
-    it->second.state = state;
-    it->second.updated_at = updated_at;
+    auto& meeting = it->second.data;
+    meeting.state = state;
+    meeting.updated_at = updated_at;
+    meeting.revision = RevisionAfterWrite(meeting, revision);
     return meeting::common::Status::OK();
 }
 
 // 添加会议参与者
-meeting::common::Status InMemoryMeetingRepository::AddParticipant(const std::string& meeting_id, std::uint64_t participant_id, bool /*is_organizer*/) {
-    std::unique_lock<std::shared_mutex> lock(mutex_);
-    auto it = meetings_.find(meeting_id);
-    if (it == meetings_.end()) {
+meeting::common::Status InMemoryMeetingRepository::AddParticipant(const std::string& meeting_id, std::uint64_t participant_id, bool /*is_organizer*/,
+                                                                  std::uint64_t revision) {
+    auto& shard = ShardFor(meeting_id);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.meetings.find(meeting_id);
+    if (it == shard.meetings.end()) {
         return meeting::common::Status::NotFound("meeting not found");
     }
-    auto& participants = it->second.participants;
-    if (std::find(participants.begin(), participants.end(), participant_id) != participants.end()) {
+    auto& meeting = it->second.data;
+    if (!meeting.participants.Insert(participant_id)) {
         return meeting::common::Status::AlreadyExists("participant already in meeting");
     }
-    participants.push_back(participant_id);
+    meeting.revision = RevisionAfterWrite(meeting, revision);
+    it->second.changes.Record(meeting.revision, participant_id, true);
     return meeting::common::Status::OK();
 }
 
 // 移除会议参与者
-meeting::common::Status InMemoryMeetingRepository::RemoveParticipant(const std::string& meeting_id, std::uint64_t participant_id) {
-    std::unique_lock<std::shared_mutex> lock(mutex_);
-    auto it = meetings_.find(meeting_id);
-    if (it == meetings_.end()) {
+meeting::common::Status InMemoryMeetingRepository::RemoveParticipant(const std::string& meeting_id, std::uint64_t participant_id,
+                                                                     std::uint64_t revision) {
+    auto& shard = ShardFor(meeting_id);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.meetings.find(meeting_id);
+    if (it == shard.meetings.end()) {
         return meeting::common::Status::NotFound("meeting not found");
     }
-    auto& participants = it->second.participants;
-    auto pos = std::find(participants.begin(), participants.end(), participant_id);
-    if (pos == participants.end()) {
+    auto& meeting = it->second.data;
+    if (!meeting.participants.Erase(participant_id)) {
         return meeting::common::Status::NotFound("participant not in meeting");
     }
-    participants.erase(pos);
+    meeting.revision = RevisionAfterWrite(meeting, revision);
+    it->second.changes.Record(meeting.revision, participant_id, false);
     return meeting::common::Status::OK();
 }
 
 // 列出会议参与者
 meeting::common::StatusOr<std::vector<std::uint64_t>> InMemoryMeetingRepository::ListParticipants(const std::string& meeting_id) const {
-    std::shared_lock<std::shared_mutex> lock(mutex_);
-    auto it = meetings_.find(meeting_id);
-    if (it == meetings_.end()) {
+    auto& shard = ShardFor(meeting_id);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.meetings.find(meeting_id);
+    if (it == shard.meetings.end()) {
+        return meeting::common::Status::NotFound("meeting not found");
+    }
+    return meeting::common::StatusOr<std::vector<std::uint64_t>>(it->second.data.participants.Ids());
+}
+
+// 会议增量
+meeting::common::StatusOr<MeetingDelta> InMemoryMeetingRepository::DiffSince(const std::string& meeting_id,
+                                                                             std::uint64_t since_revision) const {
+    auto& shard = ShardFor(meeting_id);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.meetings.find(meeting_id);
+    if (it == shard.meetings.end()) {
+        return meeting::common::Status::NotFound("meeting not found");
+    }
+    return meeting::common::StatusOr<MeetingDelta>(DiffMeeting(it->second.data, &it->second.changes, since_revision));
+}
+
+// 加入会议
+meeting::common::StatusOr<MeetingData> InMemoryMeetingRepository::JoinAndLoad(const JoinRequest& request) {
+    auto& shard = ShardFor(request.meeting_id);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.meetings.find(request.meeting_id);
+    if (it == shard.meetings.end()) {
         return meeting::common::Status::NotFound("meeting not found");
     }
-    return meeting::common::StatusOr<std::vector<std::uint64_t>>(it->second.participants);
+    auto status = ApplyJoin(it->second.data, request, &it->second.changes);
+    if (!status.IsOk()) {
+        return status;
+    }
+    return meeting::common::StatusOr<MeetingData>(it->second.data);
+}
+
+// 离开会议
+meeting::common::StatusOr<LeaveResult> InMemoryMeetingRepository::LeaveAndLoad(const LeaveRequest& request) {
+    auto& shard = ShardFor(request.meeting_id);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.meetings.find(request.meeting_id);
+    if (it == shard.meetings.end()) {
+        return meeting::common::Status::NotFound("meeting not found");
+    }
+    auto ended = ApplyLeave(it->second.data, request, &it->second.changes);
+    if (!ended.IsOk()) {
+        return ended.GetStatus();
+    }
+    LeaveResult result;
+    result.meeting = it->second.data;
+    result.ended = ended.Value();
+    return meeting::common::StatusOr<LeaveResult>(std::move(result));
 }
 
 
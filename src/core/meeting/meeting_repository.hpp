@@ -4,6 +4,8 @@
 #include "common/status_or.hpp"
 #include "core/meeting/meeting_manager.hpp"
 
+#include <cstddef>
+#include <functional>
 #include <memory>
 #include <shared_mutex>
 #include <string>
@@ -13,6 +15,45 @@
 namespace meeting {
 namespace core {
 
+// 单条写入的版本号参数取此值时, 存储库在会议当前版本号上加 1
+inline constexpr std::uint64_t kNextRevision = 0;
+
+// 加入会议请求: 存储库在一次原子操作中完成校验, 写入与状态推进
+struct JoinRequest {
+    std::string   meeting_id;            // 会议ID
+    std::uint64_t participant_id = 0;    // 参与者用户ID
+    std::size_t   max_participants = 0;  // 最大参与者数量
+    std::int64_t  updated_at = 0;        // 本次变更时间
+};
+
+// 离开会议请求
+struct LeaveRequest {
+    std::string   meeting_id;                     // 会议ID
+    std::uint64_t participant_id = 0;             // 参与者用户ID
+    bool          end_when_empty = true;          // 最后一人离开时结束会议
+    bool          end_when_organizer_leaves = true;  // 组织者离开时结束会议
+    std::int64_t  updated_at = 0;                 // 本次变更时间
+};
+
+// 离开会议结果
+struct LeaveResult {
+    MeetingData meeting;       // 离开后的会议数据
+    bool        ended = false; // 本次离开是否结束了会议
+};
+
+// 加入规则: 会议未结束, 参与者不在会议中且未达人数上限时加入, 非组织者加入使未开始的会议进入进行中.
+// 成功时版本号加 1, changes 非空时记入变更记录, 失败时均不变; 各存储库的 JoinAndLoad 与按会议串行执行的 MeetingManager 共用
+meeting::common::Status ApplyJoin(MeetingData& meeting, const JoinRequest& request, ParticipantLog* changes = nullptr);
+
+// 离开规则: 移除参与者 (版本号加 1), 组织者离开或最后一人离开时按配置结束会议; 返回本次离开是否结束了会议
+meeting::common::StatusOr<bool> ApplyLeave(MeetingData& meeting, const LeaveRequest& request, ParticipantLog* changes = nullptr);
+
+// 会议相对 since_revision 的增量: 版本未变或 changes 覆盖之后的全部变更时只复制基本信息与净变化,
+// 否则复制完整会议数据; changes 为空表示没有变更记录
+MeetingDelta DiffMeeting(const MeetingData& meeting, const ParticipantLog* changes, std::uint64_t since_revision);
+// 同上, 返回完整会议数据时移动 meeting
+MeetingDelta DiffMeeting(MeetingData&& meeting, const ParticipantLog* changes, std::uint64_t since_revision);
+
 // 会议存储库接口
 class MeetingRepository {
 public:
@@ -24,21 +65,42 @@ public:
     // 根据会议ID查找会议
     virtual meeting::common::StatusOr<MeetingData> GetMeeting(const std::string& meeting_id) const = 0;
 
+    // 以下单条写入的 revision 为写入后会议的版本号 (写后落库按命令产生时的版本号覆盖), kNextRevision 表示加 1
+
     // 更新会议信息
-    virtual meeting::common::Status UpdateMeetingState(const std::string& meeting_id, MeetingState state, std::int64_t updated_at) = 0;
+    virtual meeting::common::Status UpdateMeetingState(const std::string& meeting_id, MeetingState state, std::int64_t updated_at,
+                                                       std::uint64_t revision) = 0;
 
     // 添加会议参与者
-    virtual meeting::common::Status AddParticipant(const std::string& meeting_id, std::uint64_t participant_id, bool is_organizer) = 0;
+    virtual meeting::common::Status AddParticipant(const std::string& meeting_id, std::uint64_t participant_id, bool is_organizer,
+                                                   std::uint64_t revision) = 0;
 
     // 移除会议参与者
-    virtual meeting::common::Status RemoveParticipant(const std::string& meeting_id, std::uint64_t participant_id) = 0;
+    virtual meeting::common::Status RemoveParticipant(const std::string& meeting_id, std::uint64_t participant_id,
+                                                      std::uint64_t revision) = 0;
 
     // 列出会议参与者
     virtual meeting::common::StatusOr<std::vector<std::uint64_t>> ListParticipants(const std::string& meeting_id) const = 0;
+
+    // 按 DiffMeeting 的规则返回会议相对 since_revision 的增量, 增量时不复制参与者列表
+    virtual meeting::common::StatusOr<MeetingDelta> DiffSince(const std::string& meeting_id, std::uint64_t since_revision) const = 0;
+
+    // 按 ApplyJoin 的规则原子地加入会议, 返回加入后的会议数据
+    virtual meeting::common::StatusOr<MeetingData> JoinAndLoad(const JoinRequest& request) = 0;
+
+    // 按 ApplyLeave 的规则原子地离开会议, 返回离开后的会议数据
+    virtual meeting::common::StatusOr<LeaveResult> LeaveAndLoad(const LeaveRequest& request) = 0;
 };
 
+// 进程内会议存储: 按会议ID哈希分片, 每个分片独立的读写锁与哈希表, 不同会议的加入/离开互不阻塞
 class InMemoryMeetingRepository : public MeetingRepository {
 public:
+    static constexpr std::size_t kDefaultShards = 64;
+    static constexpr std::size_t kMaxShards = 4096;
+
+    // 分片数向上取整为 2 的幂, 取值范围 [1, kMaxShards]
+    explicit InMemoryMeetingRepository(std::size_t shard_count = kDefaultShards);
+
     // 创建新会议
     meeting::common::StatusOr<MeetingData> CreateMeeting(const MeetingData& data) override;
 
@@ -46,24 +108,57 @@ public:
     meeting::common::StatusOr<MeetingData> GetMeeting(const std::string& meeting_id) const override;
 
     // 更新会议信息
-    meeting::common::Status UpdateMeetingState(const std::string& meeting_id, MeetingState state, std::int64_t updated_at) override;
+    meeting::common::Status UpdateMeetingState(const std::string& meeting_id, MeetingState state, std::int64_t updated_at,
+                                               std::uint64_t revision) override;
 
     // 添加会议参与者
-    meeting::common::Status AddParticipant(const std::string& meeting_id, std::uint64_t participant_id, bool is_organizer) override;
+    meeting::common::Status AddParticipant(const std::string& meeting_id, std::uint64_t participant_id, bool is_organizer,
+                                           std::uint64_t revision) override;
 
     // 移除会议参与者
-    meeting::common::Status RemoveParticipant(const std::string& meeting_id, std::uint64_t participant_id) override;
+    meeting::common::Status RemoveParticipant(const std::string& meeting_id, std::uint64_t participant_id,
+                                              std::uint64_t revision) override;
 
     // 列出会议参与者
     meeting::common::StatusOr<std::vector<std::uint64_t>> ListParticipants(const std::string& meeting_id) const override;
 
-private:
-    mutable std::shared_mutex mutex_; // 保护 meetings_ 的读写锁
-    std::unordered_map<std::string, MeetingData> meetings_; // 会议ID 到 会议数据的映射
-};
+    // 会议增量 (在分片读锁内按变更记录计算)
+    meeting::common::StatusOr<MeetingDelta> DiffSince(const std::string& meeting_id, std::uint64_t since_revision) const override;
+
+    // 加入会议 (在分片写锁内校验与修改)
+    meeting::common::StatusOr<MeetingData> JoinAndLoad(const JoinRequest& request) override;
 
+    // 离开会议 (在分片写锁内校验与修改)
+    meeting::common::StatusOr<LeaveResult> LeaveAndLoad(const LeaveRequest& request) override;
 
+    std::size_t ShardCount() const noexcept;
 
+private:
+    // 与 std::hash 相同的哈希值; 自定义类型使 libstdc++ 不对小表 (<= 20 个元素) 逐个比较键,
+    // 分片后每个表通常只有十几个会议, 逐个比较字符串比一次哈希查找更慢
+    struct MeetingIdHash {
+        std::size_t operator()(const std::string& meeting_id) const noexcept {
+            return std::hash<std::string>{}(meeting_id);
+        }
+    };
+
+    // 会议数据与其参与者变更记录; 读取会议时只复制 data
+    struct StoredMeeting {
+        MeetingData    data;
+        ParticipantLog changes;
+    };
+
+    // 按缓存行对齐, 相邻分片的锁不落在同一缓存行上
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;                                          // 保护 meetings 的读写锁
+        std::unordered_map<std::string, StoredMeeting, MeetingIdHash> meetings;   // 会议ID 到 会议数据的映射
+    };
+
+    Shard& ShardFor(const std::string& meeting_id) const noexcept;
+
+    std::size_t              shard_mask_;  // 分片数 - 1
+    std::unique_ptr<Shard[]> shards_;
+};
 
 } // namespace core
 } // namespace meeting
@@ -0,0 +1,109 @@
+#include "geo/geo_cache.hpp"
+
+#include <algorithm>
+
+namespace meeting{
+namespace geo{
+
+std::size_t IpKeyHash::operator()(const IpKey& key) const {
+    // FNV-1a, IPv4 只参与前 4 字节
+    const std::size_t len = key.is_v6 ? key.bytes.size() : 4;
+    std::uint64_t hash = key.is_v6 ? 1469598103934665603ULL : 1099511628211ULL;
+    for (std::size_t i = 0; i < len; ++i) {
+        hash ^= key.bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return static_cast<std::size_t>(hash ^ (hash >> 32));
+}
+
+GeoLookupCache::GeoLookupCache(const GeoCacheOptions& options)
+    : ttl_(options.ttl) {
+    std::size_t shards = 1;
+    while (shards < std::max<std::size_t>(options.shards, 1)) {
+        shards <<= 1;
+    }
+    shards = std::min(shards, std::max<std::size_t>(options.capacity, 1));
+    // 向下取 2 的幂, 保证掩码取分片有效
+    while ((shards & (shards - 1)) != 0) {
+        shards &= shards - 1;
+    }
+    shard_mask_ = shards - 1;
+    shard_capacity_ = (options.capacity + shards - 1) / shards;
+    shards_.reserve(shards);
+    for (std::size_t i = 0; i < shards; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+GeoLookupCache::Shard& GeoLookupCache::ShardFor(const IpKey& key) {
+    // 高位参与分片选择, 低位留给分片内的哈希表
+    const std::size_t hash = IpKeyHash{}(key);
+    return *shards_[(hash >> 16) & shard_mask_];
+}
+
+std::optional<GeoInfo> GeoLookupCache::Get(const IpKey& key) {
+    auto& shard = ShardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    if (ttl_.count() > 0 && it->second->expires_at <= Clock::now()) {
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+        expirations_.fetch_add(1, std::memory_order_relaxed);
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return it->second->info;
+}
+
+void GeoLookupCache::Put(const IpKey& key, const GeoInfo& info) {
+    if (shard_capacity_ == 0) {
+        return;
+    }
+    const auto expires_at = Clock::now() + ttl_;
+    auto& shard = ShardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        it->second->info = info;
+        it->second->expires_at = expires_at;
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return;
+    }
+    if (shard.lru.size() >= shard_capacity_) {
+        shard.index.erase(shard.lru.back().key);
+        shard.lru.pop_back();
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+    shard.lru.push_front(Entry{key, info, expires_at});
+    shard.index.emplace(key, shard.lru.begin());
+}
+
+void GeoLookupCache::Clear() {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->index.clear();
+        shard->lru.clear();
+    }
+}
+
+GeoLookupCache::Stats GeoLookupCache::GetStats() const {
+    Stats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    stats.expirations = expirations_.load(std::memory_order_relaxed);
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        stats.size += shard->lru.size();
+    }
+    return stats;
+}
+
+} // namespace geo
+} // namespace meeting
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "geo/geo_info.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace meeting{
+namespace geo{
+
+// 二进制 IP 地址, IPv4 与 IPv6 分别作为不同的键
+struct IpKey {
+    std::array<std::uint8_t, 16> bytes{}; // IPv4 只使用前 4 字节
+    bool is_v6 = false;
+
+    bool operator==(const IpKey& other) const { return is_v6 == other.is_v6 && bytes == other.bytes; }
+};
+
+struct IpKeyHash {
+    std::size_t operator()(const IpKey& key) const;
+};
+
+// 查询缓存参数
+struct GeoCacheOptions {
+    std::size_t capacity = 65536;                 // 总条目上限, 0 表示关闭缓存
+    std::size_t shards = 16;                      // 分片数 (向上取整为 2 的幂)
+    std::chrono::milliseconds ttl{3600 * 1000};   // 条目有效期, 0 表示不过期
+};
+
+// IP -> GeoInfo 的分片 LRU 缓存
+// 每个分片独立加锁, 各自维护 LRU 链表与容量上限; 命中/未命中等计数为无锁原子量
+class GeoLookupCache {
+public:
+    struct Stats {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t evictions = 0;   // 因容量淘汰
+        std::uint64_t expirations = 0; // 因 TTL 过期
+        std::size_t size = 0;
+    };
+
+    explicit GeoLookupCache(const GeoCacheOptions& options);
+
+    GeoLookupCache(const GeoLookupCache&) = delete;
+    GeoLookupCache& operator=(const GeoLookupCache&) = delete;
+
+    // 命中且未过期时返回缓存结果, 并将条目移到 LRU 头部
+    std::optional<GeoInfo> Get(const IpKey& key);
+    // 写入或覆盖条目, 分片满时淘汰最久未使用的条目
+    void Put(const IpKey& key, const GeoInfo& info);
+    // 清空所有分片 (数据库更新后使用)
+    void Clear();
+
+    Stats GetStats() const;
+    std::size_t Capacity() const { return shard_capacity_ * shards_.size(); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        IpKey key;
+        GeoInfo info;
+        Clock::time_point expires_at;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::list<Entry> lru; // 头部为最近使用
+        std::unordered_map<IpKey, std::list<Entry>::iterator, IpKeyHash> index;
+    };
+
+    Shard& ShardFor(const IpKey& key);
+
+private:
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::size_t shard_mask_ = 0;
+    std::size_t shard_capacity_ = 0;
+    std::chrono::milliseconds ttl_;
+
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+    std::atomic<std::uint64_t> evictions_{0};
+    std::atomic<std::uint64_t> expirations_{0};
+};
+
+} // namespace geo
+} // namespace meeting
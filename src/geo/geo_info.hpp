@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace meeting{
+namespace geo{
+
+// country / region / iso_code / timezone 取值有限, 指向进程级驻留表 (StringTable), 拷贝不分配内存
+struct GeoInfo {
+    std::string_view country;
+    std::string_view region;
+    std::string city;
+    std::string_view iso_code;
+    std::string_view timezone;
+    double latitude = 0.0;
+    double longitude = 0.0;
+    bool is_private = false;
+};
+
+} // namespace geo
+} // namespace meeting
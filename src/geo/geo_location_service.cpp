@@ -1,32 +1,231 @@
 #include "geo/geo_location_service.hpp"
+#include "geo/mmdb_decoder.hpp"
+#include "geo/string_table.hpp"
+#include "thread_pool/thread_pool.hpp"
 
 #include <arpa/inet.h>
 #include <sys/stat.h>
 
+#include <algorithm>
 #include <cstring>
+#include <future>
+#include <unordered_map>
 
 namespace meeting{
 namespace geo{
 
+namespace {
+
+// 数据库文件标识, 用于检测文件被替换或修改
+struct FileStamp {
+    bool exists = false;
+    dev_t device = 0;
+    ino_t inode = 0;
+    off_t size = 0;
+    std::int64_t mtime_ns = 0;
+
+    bool operator==(const FileStamp& other) const {
+        return exists == other.exists && device == other.device && inode == other.inode && size == other.size
+            && mtime_ns == other.mtime_ns;
+    }
+    bool operator!=(const FileStamp& other) const { return !(*this == other); }
+};
+
+FileStamp StatFile(const std::string& path) {
+    FileStamp stamp;
+    struct stat st {};
+    if (stat(path.c_str(), &st) == 0) {
+        stamp.exists = true;
+        stamp.device = st.st_dev;
+        stamp.inode = st.st_ino;
+        stamp.size = st.st_size;
+        stamp.mtime_ns = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+    }
+    return stamp;
+}
+
+} // namespace
+
+// 已打开的数据库, 发布后只读, 最后一个读者离开后由 Reload 关闭
+struct GeoLocationService::Database {
+    MMDB_s mmdb{};
+    FileStamp stamp;
+    bool opened = false;
+    // 数据区字符串位置 -> 驻留字符串; 打开时遍历全部记录建立, 查询路径只读不加锁
+    std::unordered_map<const char*, std::string_view> interned;
+
+    // 取 value (指向本库数据区) 对应的驻留字符串
+    std::string_view Interned(std::string_view value) const {
+        if (value.empty()) {
+            return {};
+        }
+        auto it = interned.find(value.data());
+        if (it != interned.end()) {
+            return it->second;
+        }
+        // 仅当打开时的遍历提前结束才会走到这里
+        return StringTable::Shared().Intern(value);
+    }
+
+    ~Database() {
+        if (opened) {
+            MMDB_close(&mmdb);
+        }
+    }
+};
+
+// 读侧临界区: 进入时登记到当前纪元的计数槽, 析构时离开
+// 若登记期间纪元已翻转则撤销并重试, 保证 SynchronizeReaders 等待的槽中包含所有可能看到旧库的读者
+class GeoLocationService::ReadGuard {
+public:
+    explicit ReadGuard(const GeoLocationService& service) {
+        for (;;) {
+            const auto epoch = service.epoch_.load(std::memory_order_seq_cst);
+            slot_ = &service.readers_[epoch & 1].count;
+            slot_->fetch_add(1, std::memory_order_seq_cst);
+            if (service.epoch_.load(std::memory_order_seq_cst) == epoch) {
+                break;
+            }
+            slot_->fetch_sub(1, std::memory_order_release);
+        }
+        db_ = service.db_.load(std::memory_order_acquire);
+    }
+
+    ~ReadGuard() {
+        slot_->fetch_sub(1, std::memory_order_release);
+    }
+
+    ReadGuard(const ReadGuard&) = delete;
+    ReadGuard& operator=(const ReadGuard&) = delete;
+
+    const Database* Get() const { return db_; }
+
+private:
+    std::atomic<std::int64_t>* slot_ = nullptr;
+    const Database* db_ = nullptr;
+};
+
 // 构造函数，初始化数据库路径并检查可用性
-GeoLocationService::GeoLocationService(const std::string& db_path)
+GeoLocationService::GeoLocationService(const std::string& db_path, const GeoCacheOptions& cache_options)
     : db_path_(std::move(db_path)) {
+    if (cache_options.capacity > 0) {
+        cache_ = std::make_unique<GeoLookupCache>(cache_options);
+    }
     // 尝试打开数据库文件
-    struct stat st {};
-    if (stat(db_path_.c_str(), &st) == 0) {
-        // 打开数据库文件
-        int status = MMDB_open(db_path_.c_str(), MMDB_MODE_MMAP, &mmdb_);
-        if (status == MMDB_SUCCESS) {
-            db_available_ = true;
-            opened_ = true;
-        }
+    meeting::common::Status status;
+    auto db = Open(db_path_, &status);
+    if (db) {
+        db_.store(db.release(), std::memory_order_release);
+        generation_.store(1, std::memory_order_release);
     }
 }
 
 // 析构函数，关闭数据库
 GeoLocationService::~GeoLocationService() {
-    if (opened_) {
-        MMDB_close(&mmdb_);
+    StopWatching();
+    delete db_.exchange(nullptr, std::memory_order_acq_rel);
+}
+
+std::unique_ptr<GeoLocationService::Database> GeoLocationService::Open(const std::string& path,
+                                                                       meeting::common::Status* status) {
+    auto db = std::make_unique<Database>();
+    db->stamp = StatFile(path);
+    if (!db->stamp.exists) {
+        *status = meeting::common::Status::Unavailable("GeoIP database not found: " + path);
+        return nullptr;
+    }
+    int rc = MMDB_open(path.c_str(), MMDB_MODE_MMAP, &db->mmdb);
+    if (rc != MMDB_SUCCESS) {
+        *status = meeting::common::Status::Unavailable(MMDB_strerror(rc));
+        return nullptr;
+    }
+    db->opened = true;
+    // 国家/地区/时区取值有限, 在发布前一次性驻留, 之后的查询不再访问进程级驻留表
+    auto& strings = StringTable::Shared();
+    auto intern = [&db, &strings](std::string_view value) {
+        if (!value.empty() && db->interned.find(value.data()) == db->interned.end()) {
+            db->interned.emplace(value.data(), strings.Intern(value));
+        }
+    };
+    // 数据损坏导致遍历提前结束时, 未覆盖的字符串在查询时回退到进程级驻留表
+    ForEachGeoRecord(db->mmdb, [&intern](const GeoRecordView& record) {
+        intern(record.iso_code);
+        intern(record.country);
+        intern(record.region);
+        intern(record.timezone);
+    });
+    *status = meeting::common::Status::OK();
+    return db;
+}
+
+meeting::common::Status GeoLocationService::Reload() {
+    std::lock_guard<std::mutex> lock(reload_mutex_);
+    meeting::common::Status status;
+    auto fresh = Open(db_path_, &status);
+    if (!fresh) {
+        return status;
+    }
+    Database* old = db_.exchange(fresh.release(), std::memory_order_acq_rel);
+    SynchronizeReaders();
+    delete old;
+    // 旧库的查询均已结束, 清空后缓存中不再有旧库的结果
+    if (cache_) {
+        cache_->Clear();
+    }
+    generation_.fetch_add(1, std::memory_order_acq_rel);
+    return meeting::common::Status::OK();
+}
+
+void GeoLocationService::SynchronizeReaders() {
+    // 翻转纪元后新读者使用另一个槽, 旧槽清零即表示替换前进入的读者已全部离开
+    const auto epoch = epoch_.fetch_add(1, std::memory_order_seq_cst);
+    auto& slot = readers_[epoch & 1].count;
+    while (slot.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+    }
+}
+
+void GeoLocationService::StartWatching(std::chrono::milliseconds interval) {
+    if (interval.count() <= 0 || watch_thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(watch_mutex_);
+        watch_stop_ = false;
+    }
+    watch_thread_ = std::thread([this, interval]() { WatchLoop(interval); });
+}
+
+void GeoLocationService::StopWatching() {
+    {
+        std::lock_guard<std::mutex> lock(watch_mutex_);
+        watch_stop_ = true;
+    }
+    watch_cv_.notify_all();
+    if (watch_thread_.joinable()) {
+        watch_thread_.join();
+    }
+}
+
+void GeoLocationService::WatchLoop(std::chrono::milliseconds interval) {
+    std::unique_lock<std::mutex> lock(watch_mutex_);
+    while (!watch_cv_.wait_for(lock, interval, [this]() { return watch_stop_; })) {
+        FileStamp loaded;
+        {
+            ReadGuard guard(*this);
+            if (guard.Get() != nullptr) {
+                loaded = guard.Get()->stamp;
+            }
+        }
+        const FileStamp current = StatFile(db_path_);
+        if (!current.exists || current == loaded) {
+            continue;
+        }
+        // 在后台线程打开新库, 不阻塞查询
+        lock.unlock();
+        auto status = Reload();
+        lock.lock();
+        (void)status; // 文件可能仍在写入, 下个周期重试
     }
 }
 
@@ -72,53 +271,50 @@ bool GeoLocationService::IsPrivateIpv6(const unsigned char* addr) const {
            ((addr[0] & 0xfe) == 0xfc);
 }
 
-// 根据 IP 获取地理位置信息
-meeting::common::StatusOr<GeoInfo> GeoLocationService::Lookup(const std::string& ip) const {
-    // IP 校验与私网判断
+meeting::common::Status GeoLocationService::ParseAddress(const std::string& ip, IpKey* key) {
     if (ip.empty()) {
         return meeting::common::Status::InvalidArgument("ip is empty");
     }
-
     in_addr ipv4 {};
     in6_addr ipv6 {};
-    // ipv4 地址检查
-    bool is_v4 = inet_pton(AF_INET, ip.c_str(), &ipv4) == 1;
-    // ipv6 地址检查
-    bool is_v6 = false;
-    // 如果不是 ipv4，再检查 ipv6
-    if (!is_v4) {
-        is_v6 = inet_pton(AF_INET6, ip.c_str(), &ipv6) == 1;
+    if (inet_pton(AF_INET, ip.c_str(), &ipv4) == 1) {
+        key->is_v6 = false;
+        std::memcpy(key->bytes.data(), &ipv4, sizeof(ipv4));
+        return meeting::common::Status::OK();
     }
-
-    // 非法地址返回错误
-    if (!is_v4 && !is_v6) {
-        return meeting::common::Status::InvalidArgument("invalid ip");
+    if (inet_pton(AF_INET6, ip.c_str(), &ipv6) == 1) {
+        key->is_v6 = true;
+        std::memcpy(key->bytes.data(), &ipv6, sizeof(ipv6));
+        return meeting::common::Status::OK();
     }
+    // 非法地址返回错误
+    return meeting::common::Status::InvalidArgument("invalid ip");
+}
 
-    // 私有地址检查
-    if (is_v4 && IsPrivateIpv4(ipv4.s_addr)) {
-        GeoInfo info;
-        info.is_private = true;
-        return meeting::common::StatusOr<GeoInfo>(info);
-    }
-    if (is_v6 && IsPrivateIpv6(ipv6.s6_addr)) {
-        GeoInfo info;
-        info.is_private = true;
-        return meeting::common::StatusOr<GeoInfo>(info);
+bool GeoLocationService::IsPrivate(const IpKey& key) const {
+    if (key.is_v6) {
+        return IsPrivateIpv6(key.bytes.data());
     }
+    std::uint32_t addr = 0;
+    std::memcpy(&addr, key.bytes.data(), sizeof(addr));
+    return IsPrivateIpv4(addr);
+}
 
-    if (!db_available_) {
-        return meeting::common::Status::Unavailable("GeoIP database not available");
+meeting::common::StatusOr<GeoInfo> GeoLocationService::LookupInDatabase(const Database* db, const IpKey& key) {
+    // 直接使用已解析的地址查询, 避免 MMDB_lookup_string 再次 getaddrinfo
+    sockaddr_storage storage {};
+    if (key.is_v6) {
+        auto* v6 = reinterpret_cast<sockaddr_in6*>(&storage);
+        v6->sin6_family = AF_INET6;
+        std::memcpy(&v6->sin6_addr, key.bytes.data(), sizeof(v6->sin6_addr));
+    } else {
+        auto* v4 = reinterpret_cast<sockaddr_in*>(&storage);
+        v4->sin_family = AF_INET;
+        std::memcpy(&v4->sin_addr, key.bytes.data(), sizeof(v4->sin_addr));
     }
 
-    int gai_error = 0;
     int mmdb_error = 0;
-    // 在数据库中查询 IP 地址
-    auto result = MMDB_lookup_string(const_cast<MMDB_s*>(&mmdb_), ip.c_str(), &gai_error, &mmdb_error);
-    // 处理查询结果
-    if (gai_error != 0) {
-        return meeting::common::Status::InvalidArgument("invalid ip format");
-    }
+    auto result = MMDB_lookup_sockaddr(&db->mmdb, reinterpret_cast<const sockaddr*>(&storage), &mmdb_error);
     // 数据库查询错误处理
     if (mmdb_error != MMDB_SUCCESS) {
         return meeting::common::Status::Unavailable(MMDB_strerror(mmdb_error));
@@ -128,62 +324,148 @@ meeting::common::StatusOr<GeoInfo> GeoLocationService::Lookup(const std::string&
         return meeting::common::Status::NotFound("ip not found in database");
     }
 
-    // 解析查询结果
+    // 单趟解码记录, 低基数字段换成打开数据库时驻留的字符串
+    GeoRecordView record;
+    if (!DecodeGeoRecord(result.entry, &record)) {
+        return meeting::common::Status::Internal("malformed GeoIP record");
+    }
     GeoInfo info;
-    MMDB_entry_s entry = result.entry;
-    MMDB_entry_data_s data;
+    info.iso_code = db->Interned(record.iso_code);
+    info.country = db->Interned(record.country);
+    info.region = db->Interned(record.region);
+    info.timezone = db->Interned(record.timezone);
+    info.city.assign(record.city.data(), record.city.size());
+    info.latitude = record.latitude.value_or(0.0);
+    info.longitude = record.longitude.value_or(0.0);
+    return meeting::common::StatusOr<GeoInfo>(std::move(info));
+}
 
-     // 查询国家 ISO 代码
-    if (MMDB_get_value(&entry, &data, "country", "iso_code", NULL) == MMDB_SUCCESS && 
-        data.has_data && data.type == MMDB_DATA_TYPE_UTF8_STRING) {
-        info.iso_code = std::string(data.utf8_string, data.data_size);
+// 根据 IP 获取地理位置信息
+meeting::common::StatusOr<GeoInfo> GeoLocationService::Lookup(const std::string& ip) const {
+    // 只解析一次地址: 同时用于私网判断、缓存键与数据库查询
+    IpKey key;
+    auto parsed = ParseAddress(ip, &key);
+    if (!parsed.IsOk()) {
+        return parsed;
     }
 
-    // 查询国家名称
-    if (MMDB_get_value(&entry, &data, "country", "names", "en", NULL) == MMDB_SUCCESS && 
-        data.has_data && data.type == MMDB_DATA_TYPE_UTF8_STRING) {
-        info.country = std::string(data.utf8_string, data.data_size);
+    // 私有地址检查
+    if (IsPrivate(key)) {
+        GeoInfo info;
+        info.is_private = true;
+        return meeting::common::StatusOr<GeoInfo>(info);
     }
 
-    // 查询地区/州
-    if (MMDB_get_value(&entry, &data, "subdivisions", "0", "names", "en", NULL) == MMDB_SUCCESS && 
-        data.has_data && data.type == MMDB_DATA_TYPE_UTF8_STRING) {
-        info.region = std::string(data.utf8_string, data.data_size);
+    if (!IsAvailable()) {
+        return meeting::common::Status::Unavailable("GeoIP database not available");
     }
 
-    // 查询城市
-    if (MMDB_get_value(&entry, &data, "city", "names", "en", NULL) == MMDB_SUCCESS && 
-        data.has_data && data.type == MMDB_DATA_TYPE_UTF8_STRING) {
-        info.city = std::string(data.utf8_string, data.data_size);
+    if (cache_) {
+        if (auto cached = cache_->Get(key)) {
+            return meeting::common::StatusOr<GeoInfo>(std::move(*cached));
+        }
     }
 
-    // 查询时区
-    if (MMDB_get_value(&entry, &data, "location", "time_zone", NULL) == MMDB_SUCCESS && 
-        data.has_data && data.type == MMDB_DATA_TYPE_UTF8_STRING) {
-        info.timezone = std::string(data.utf8_string, data.data_size);
+    // 读侧临界区覆盖查询、解码与写缓存, 期间当前数据库不会被关闭
+    ReadGuard guard(*this);
+    if (guard.Get() == nullptr) {
+        return meeting::common::Status::Unavailable("GeoIP database not available");
     }
+    auto result = LookupInDatabase(guard.Get(), key);
+    if (result.IsOk() && cache_) {
+        cache_->Put(key, result.Value());
+    }
+    return result;
+}
+
+void GeoLocationService::LookupBatch(const std::string* ips
+                                     , std::size_t count
+                                     , std::vector<meeting::common::StatusOr<GeoInfo>>* results
+                                     , thread_pool::ThreadPool* pool) const {
+    results->assign(count, meeting::common::StatusOr<GeoInfo>(
+                               meeting::common::Status::Unavailable("GeoIP database not available")));
 
-    // 查询纬度
-    if (MMDB_get_value(&entry, &data, "location", "latitude", NULL) == MMDB_SUCCESS && data.has_data) {
-        if (data.type == MMDB_DATA_TYPE_DOUBLE) {
-            info.latitude = data.double_value;
-        } else if (data.type == MMDB_DATA_TYPE_FLOAT) {
-            info.latitude = data.float_value;
+    struct Item {
+        IpKey key;
+        std::size_t index; // 在输入中的位置
+    };
+    std::vector<Item> items;
+    items.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        Item item{IpKey{}, i};
+        auto parsed = ParseAddress(ips[i], &item.key);
+        if (!parsed.IsOk()) {
+            (*results)[i] = meeting::common::StatusOr<GeoInfo>(parsed);
+        } else if (IsPrivate(item.key)) {
+            GeoInfo info;
+            info.is_private = true;
+            (*results)[i] = meeting::common::StatusOr<GeoInfo>(std::move(info));
+        } else {
+            items.push_back(item);
         }
     }
+    if (items.empty() || !IsAvailable()) {
+        return;
+    }
 
-    // 查询经度
-    if (MMDB_get_value(&entry, &data, "location", "longitude", NULL) == MMDB_SUCCESS && data.has_data) {
-        if (data.type == MMDB_DATA_TYPE_DOUBLE) {
-            info.longitude = data.double_value;
-        } else if (data.type == MMDB_DATA_TYPE_FLOAT) {
-            info.longitude = data.float_value;
+    // 按 (地址族, 地址) 排序: 相邻地址共享搜索树前缀, 树节点与数据区的访问更集中
+    std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+        if (a.key.is_v6 != b.key.is_v6) {
+            return !a.key.is_v6;
         }
-    }
+        return a.key.bytes < b.key.bytes;
+    });
+
+    // 每段只进入一次读侧临界区; 各段写入 results 的不同元素, 无需同步
+    auto run = [this, &items, results](std::size_t begin, std::size_t end) {
+        ReadGuard guard(*this);
+        if (guard.Get() == nullptr) {
+            return;
+        }
+        for (std::size_t i = begin; i < end; ++i) {
+            (*results)[items[i].index] = LookupInDatabase(guard.Get(), items[i].key);
+        }
+    };
 
-    return meeting::common::StatusOr<GeoInfo>(info);
+    constexpr std::size_t kMinChunk = 1024; // 单段最少地址数, 避免任务调度开销超过查询本身
+    const std::size_t workers = pool != nullptr ? std::max<std::size_t>(pool->CurrentThreads(), 1) : 1;
+    // 在该线程池的工作线程中调用时直接执行: 等待自己投递的任务会占住工作线程, 任务留在本线程队列时还会死锁
+    if (pool == nullptr || !pool->Running() || pool->InWorkerThread() || items.size() < 2 * kMinChunk) {
+        run(0, items.size());
+        return;
+    }
+    const std::size_t chunk = std::max(kMinChunk, (items.size() + workers * 4 - 1) / (workers * 4));
+    struct Pending {
+        std::size_t begin;
+        std::size_t end;
+        std::future<void> done;
+    };
+    std::vector<Pending> pending;
+    pending.reserve(items.size() / chunk + 1);
+    for (std::size_t begin = 0; begin < items.size(); begin += chunk) {
+        const std::size_t end = std::min(items.size(), begin + chunk);
+        try {
+            pending.push_back(Pending{begin, end, pool->Submit(run, begin, end)});
+        } catch (const std::exception&) {
+            run(begin, end); // 线程池拒绝任务时在调用线程执行
+        }
+    }
+    for (auto& p : pending) {
+        try {
+            p.done.get();
+        } catch (const std::exception&) {
+            // 任务被丢弃/取消 (如线程池停止): 在调用线程补跑该段, 不留下占位的 Unavailable
+            run(p.begin, p.end);
+        }
+    }
 }
 
+GeoLookupCache::Stats GeoLocationService::CacheStats() const {
+    if (!cache_) {
+        return {};
+    }
+    return cache_->GetStats();
+}
 
 } // namespace geo
 } // namespace meeting
\ No newline at end of file
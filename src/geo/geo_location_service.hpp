@@ -2,51 +2,113 @@
 
 #include "common/status.hpp"
 #include "common/status_or.hpp"
+#include "geo/geo_cache.hpp"
+#include "geo/geo_info.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <string>
 #include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <maxminddb.h>
 
+namespace thread_pool {
+class ThreadPool;
+}
+
 namespace meeting{
 namespace geo{
 
-struct GeoInfo {
-    std::string country;
-    std::string region;
-    std::string city;
-    std::string iso_code;
-    std::string timezone;
-    double latitude = 0.0;
-    double longitude = 0.0;
-    bool is_private = false;
-};
-
 // GeoLite2 封装类
+// 数据库句柄以 RCU 方式发布: 查询只做原子读与计数, 不加锁;
+// 重新加载时先打开新文件并原子替换, 等待仍在使用旧映射的查询结束后再关闭旧库
 class GeoLocationService {
 public:
-    explicit GeoLocationService(const std::string& db_path);
+    explicit GeoLocationService(const std::string& db_path, const GeoCacheOptions& cache_options = {});
     ~GeoLocationService();
 
-    // 根据 IP 获取地理位置信息
+    GeoLocationService(const GeoLocationService&) = delete;
+    GeoLocationService& operator=(const GeoLocationService&) = delete;
+
+    // 根据 IP 获取地理位置信息, 数据库命中的结果写入查询缓存
     meeting::common::StatusOr<GeoInfo> Lookup(const std::string& ip) const;
 
+    // 批量查询, 适用于离线富化等大批量场景; results 按输入顺序填充, 长度与输入一致
+    // 地址先按二进制值排序, 使相邻查询访问数据库搜索树的相同路径; 结果不读写查询缓存
+    // pool 非空时把排序后的地址分段投递到线程池并等待完成, 被拒绝或取消的分段在调用线程补跑;
+    // 在该线程池的工作线程中调用时不投递, 直接在当前线程执行
+    void LookupBatch(const std::string* ips
+                     , std::size_t count
+                     , std::vector<meeting::common::StatusOr<GeoInfo>>* results
+                     , thread_pool::ThreadPool* pool = nullptr) const;
+    void LookupBatch(const std::vector<std::string>& ips
+                     , std::vector<meeting::common::StatusOr<GeoInfo>>* results
+                     , thread_pool::ThreadPool* pool = nullptr) const {
+        LookupBatch(ips.data(), ips.size(), results, pool);
+    }
+
+    // 重新打开 DbPath() 并替换当前数据库, 成功后清空查询缓存; 失败时保留旧库
+    meeting::common::Status Reload();
+    // 后台线程按 interval 检查数据库文件, 文件变化 (mtime/大小/inode) 时自动 Reload
+    void StartWatching(std::chrono::milliseconds interval);
+    void StopWatching();
+    // 成功加载的次数 (含首次打开)
+    std::uint64_t Generation() const {
+        return generation_.load(std::memory_order_acquire);
+    }
+
+    // 查询缓存统计, 未启用缓存时全部为 0
+    GeoLookupCache::Stats CacheStats() const;
+
     const std::string& DbPath() const {
         return db_path_;
     }
 
     bool IsAvailable() const {
-        return db_available_;
+        return db_.load(std::memory_order_acquire) != nullptr;
     }
 private:
+    struct Database;
+    class ReadGuard;
+
+    // 解析 IP 字符串为二进制地址
+    static meeting::common::Status ParseAddress(const std::string& ip, IpKey* key);
+    // 在指定数据库中查询已解析的公网地址
+    static meeting::common::StatusOr<GeoInfo> LookupInDatabase(const Database* db, const IpKey& key);
+    // 私有地址直接返回 is_private 结果
+    bool IsPrivate(const IpKey& key) const;
+    // 打开数据库文件, 失败时返回空
+    static std::unique_ptr<Database> Open(const std::string& path, meeting::common::Status* status);
+    // 等待所有可能持有旧数据库的查询结束 (仅在 reload_mutex_ 下调用)
+    void SynchronizeReaders();
+    void WatchLoop(std::chrono::milliseconds interval);
+
     // 检查是否为私有 IP 地址
     bool IsPrivateIpv4(std::uint32_t addr) const;
     bool IsPrivateIpv6(const unsigned char* addr) const;
 private:
+    // 读者计数槽, 独占缓存行避免与其他成员伪共享
+    struct alignas(64) ReaderSlot {
+        std::atomic<std::int64_t> count{0};
+    };
+
     std::string db_path_; // 数据库路径
-    bool db_available_ = false; // 数据库是否可用
-    bool opened_ = false; // 数据库是否已打开
-    MMDB_s mmdb_{}; // MaxMind 数据库句柄
+    std::atomic<Database*> db_{nullptr}; // 当前数据库, 为空表示不可用
+    mutable std::atomic<std::uint64_t> epoch_{0}; // 读者进入时按其奇偶选择计数槽
+    mutable ReaderSlot readers_[2];
+    std::atomic<std::uint64_t> generation_{0};
+    std::unique_ptr<GeoLookupCache> cache_; // 查询缓存, 容量为 0 时为空
+
+    std::mutex reload_mutex_; // 串行化 Reload
+    std::mutex watch_mutex_;
+    std::condition_variable watch_cv_;
+    bool watch_stop_ = false;
+    std::thread watch_thread_; // 文件检查线程
 };
 
-} // namespace geo    
-} // namespace meeting
\ No newline at end of file
+} // namespace geo
+} // namespace meeting
@@ -0,0 +1,343 @@
+#include "geo/mmdb_decoder.hpp"
+
+#include <cstring>
+#include <string_view>
+
+namespace meeting{
+namespace geo{
+
+namespace {
+
+constexpr std::uint32_t kTypePointer = 1;
+constexpr std::uint32_t kTypeUtf8String = 2;
+constexpr std::uint32_t kTypeDouble = 3;
+constexpr std::uint32_t kTypeMap = 7;
+constexpr std::uint32_t kTypeArray = 11;
+constexpr std::uint32_t kTypeBoolean = 14;
+constexpr std::uint32_t kTypeFloat = 15;
+constexpr int kMaxDepth = 32; // 防止损坏数据导致无限递归
+// 元数据段起始标记; 部分 libmaxminddb 版本的 data_section_size 包含元数据段
+constexpr std::string_view kMetadataMarker("\xAB\xCD\xEFMaxMind.com", 14);
+
+// 数据区中的一个值: 类型、长度 (字符串/字节数或容器元素数) 与负载起始偏移
+struct Field {
+    std::uint32_t type = 0;
+    std::uint32_t size = 0;
+    std::uint32_t payload = 0;
+    bool via_pointer = false;
+};
+
+// 遍历回调的返回值
+enum class Visit {
+    kContinue, // 继续下一个键值对
+    kStop,     // 已取得所需字段, 提前结束
+    kError,    // 数据非法
+};
+
+class DataReader {
+public:
+    DataReader(const std::uint8_t* base, std::uint32_t size) : base_(base), size_(size) {}
+
+    // 解析 offset 处的值头部; 若为指针则解析其目标 (规范不允许指针指向指针)
+    // end 为该值在原位置之后的偏移: 指针为指针字节之后, 其余为负载起始
+    bool Header(std::uint32_t offset, Field* field, std::uint32_t* end) const {
+        std::uint32_t pos = offset;
+        if (!Raw(pos, field, &pos)) {
+            return false;
+        }
+        if (field->type != kTypePointer) {
+            *end = pos;
+            return true;
+        }
+        const std::uint32_t after_pointer = pos;
+        std::uint32_t unused = 0;
+        if (!Raw(field->payload, field, &unused) || field->type == kTypePointer) {
+            return false;
+        }
+        field->via_pointer = true;
+        *end = after_pointer;
+        return true;
+    }
+
+    // 跳过 offset 处的完整值, 返回其后的偏移
+    bool Skip(std::uint32_t offset, std::uint32_t* end, int depth = 0) const {
+        Field field;
+        std::uint32_t pos = 0;
+        if (depth > kMaxDepth || !Header(offset, &field, &pos)) {
+            return false;
+        }
+        if (field.via_pointer) {
+            *end = pos;
+            return true;
+        }
+        if (field.type == kTypeMap || field.type == kTypeArray) {
+            const std::uint64_t children = field.type == kTypeMap ? 2ULL * field.size : field.size;
+            for (std::uint64_t i = 0; i < children; ++i) {
+                if (!Skip(pos, &pos, depth + 1)) {
+                    return false;
+                }
+            }
+            *end = pos;
+            return true;
+        }
+        if (field.type == kTypeBoolean) {
+            *end = pos; // 布尔值存放在长度位中, 无负载
+            return true;
+        }
+        if (!InBounds(pos, field.size)) {
+            return false;
+        }
+        *end = pos + field.size;
+        return true;
+    }
+
+    // 遍历 map 中的键值对, visitor(key, value_offset, depth) 返回 Visit; 仅数据非法时返回 false
+    template <typename Visitor>
+    bool ForEachPair(std::uint32_t offset, int depth, Visitor&& visitor) const {
+        Field field;
+        std::uint32_t pos = 0;
+        if (depth > kMaxDepth || !Header(offset, &field, &pos) || field.type != kTypeMap) {
+            return false;
+        }
+        pos = field.payload;
+        for (std::uint32_t i = 0; i < field.size; ++i) {
+            std::string_view key;
+            if (!String(pos, &key, &pos)) {
+                return false;
+            }
+            const std::uint32_t value = pos;
+            const Visit visit = visitor(key, value, depth + 1);
+            if (visit == Visit::kStop) {
+                return true;
+            }
+            if (visit == Visit::kError || !Skip(value, &pos, depth + 1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 取数组第 index 个元素的偏移
+    bool ArrayElement(std::uint32_t offset, std::uint32_t index, std::uint32_t* element) const {
+        Field field;
+        std::uint32_t pos = 0;
+        if (!Header(offset, &field, &pos) || field.type != kTypeArray || index >= field.size) {
+            return false;
+        }
+        pos = field.payload;
+        for (std::uint32_t i = 0; i < index; ++i) {
+            if (!Skip(pos, &pos)) {
+                return false;
+            }
+        }
+        *element = pos;
+        return true;
+    }
+
+    bool String(std::uint32_t offset, std::string_view* value, std::uint32_t* end) const {
+        Field field;
+        if (!Header(offset, &field, end) || field.type != kTypeUtf8String || !InBounds(field.payload, field.size)) {
+            return false;
+        }
+        if (!field.via_pointer) {
+            *end = field.payload + field.size;
+        }
+        *value = std::string_view(reinterpret_cast<const char*>(base_ + field.payload), field.size);
+        return true;
+    }
+
+    bool Number(std::uint32_t offset, double* value) const {
+        Field field;
+        std::uint32_t end = 0;
+        if (!Header(offset, &field, &end) || !InBounds(field.payload, field.size)) {
+            return false;
+        }
+        if (field.type == kTypeDouble && field.size == 8) {
+            std::uint64_t bits = BigEndian(field.payload, 8);
+            std::memcpy(value, &bits, sizeof(bits));
+            return true;
+        }
+        if (field.type == kTypeFloat && field.size == 4) {
+            auto bits = static_cast<std::uint32_t>(BigEndian(field.payload, 4));
+            float f = 0.0f;
+            std::memcpy(&f, &bits, sizeof(bits));
+            *value = f;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    bool InBounds(std::uint32_t offset, std::uint32_t length) const {
+        return static_cast<std::uint64_t>(offset) + length <= size_;
+    }
+
+    std::uint64_t BigEndian(std::uint32_t offset, std::uint32_t length) const {
+        std::uint64_t value = 0;
+        for (std::uint32_t i = 0; i < length; ++i) {
+            value = (value << 8) | base_[offset + i];
+        }
+        return value;
+    }
+
+    // 解析控制字节 (不跟随指针); 对指针, field->payload 为目标偏移
+    bool Raw(std::uint32_t offset, Field* field, std::uint32_t* end) const {
+        if (!InBounds(offset, 1)) {
+            return false;
+        }
+        const std::uint8_t ctrl = base_[offset++];
+        std::uint32_t type = ctrl >> 5;
+        if (type == kTypePointer) {
+            const std::uint32_t extra = ((ctrl >> 3) & 0x3) + 1;
+            if (!InBounds(offset, extra)) {
+                return false;
+            }
+            const std::uint32_t high = ctrl & 0x7;
+            const auto bytes = static_cast<std::uint32_t>(BigEndian(offset, extra));
+            static constexpr std::uint32_t kBias[] = {0, 2048, 526336, 0};
+            std::uint32_t target = 0;
+            if (extra == 4) {
+                target = bytes;
+            } else {
+                target = ((high << (8 * extra)) | bytes) + kBias[extra - 1];
+            }
+            field->type = kTypePointer;
+            field->size = 0;
+            field->payload = target;
+            field->via_pointer = false;
+            *end = offset + extra;
+            return true;
+        }
+        if (type == 0) {
+            // 扩展类型: 实际类型为 7 + 下一字节
+            if (!InBounds(offset, 1)) {
+                return false;
+            }
+            type = 7 + base_[offset++];
+        }
+        std::uint32_t size = ctrl & 0x1f;
+        if (size >= 29) {
+            const std::uint32_t extra = size - 28;
+            if (!InBounds(offset, extra)) {
+                return false;
+            }
+            static constexpr std::uint32_t kSizeBias[] = {29, 285, 65821};
+            size = static_cast<std::uint32_t>(BigEndian(offset, extra)) + kSizeBias[extra - 1];
+            offset += extra;
+        }
+        field->type = type;
+        field->size = size;
+        field->payload = offset;
+        field->via_pointer = false;
+        *end = offset;
+        return true;
+    }
+
+private:
+    const std::uint8_t* base_;
+    std::uint32_t size_;
+};
+
+Visit Check(bool ok) {
+    return ok ? Visit::kContinue : Visit::kError;
+}
+
+// 读取 names.en
+bool EnglishName(const DataReader& reader, std::uint32_t names, int depth, std::string_view* out) {
+    return reader.ForEachPair(names, depth, [&](std::string_view key, std::uint32_t value, int) {
+        if (key != "en") {
+            return Visit::kContinue;
+        }
+        std::uint32_t end = 0;
+        return reader.String(value, out, &end) ? Visit::kStop : Visit::kError;
+    });
+}
+
+// 读取 {"iso_code": .., "names": {...}} 形式的子 map (country / city / subdivision)
+bool NamedPlace(const DataReader& reader, std::uint32_t offset, int depth
+                , std::string_view* name, std::string_view* iso_code) {
+    return reader.ForEachPair(offset, depth, [&](std::string_view key, std::uint32_t value, int child_depth) {
+        std::uint32_t end = 0;
+        if (key == "names") {
+            return Check(EnglishName(reader, value, child_depth, name));
+        }
+        if (iso_code != nullptr && key == "iso_code") {
+            return Check(reader.String(value, iso_code, &end));
+        }
+        return Visit::kContinue;
+    });
+}
+
+bool DecodeRecord(const DataReader& reader, std::uint32_t offset, GeoRecordView* out) {
+    return reader.ForEachPair(offset, 0, [&](std::string_view key, std::uint32_t value, int depth) {
+        if (key == "country") {
+            return Check(NamedPlace(reader, value, depth, &out->country, &out->iso_code));
+        }
+        if (key == "city") {
+            return Check(NamedPlace(reader, value, depth, &out->city, nullptr));
+        }
+        if (key == "subdivisions") {
+            std::uint32_t first = 0;
+            if (!reader.ArrayElement(value, 0, &first)) {
+                return Visit::kContinue; // 空数组: 无地区信息
+            }
+            return Check(NamedPlace(reader, first, depth + 1, &out->region, nullptr));
+        }
+        if (key == "location") {
+            return Check(reader.ForEachPair(value, depth, [&](std::string_view field, std::uint32_t field_value, int) {
+                double number = 0.0;
+                std::uint32_t end = 0;
+                if (field == "time_zone") {
+                    return Check(reader.String(field_value, &out->timezone, &end));
+                }
+                if (field == "latitude" && reader.Number(field_value, &number)) {
+                    out->latitude = number;
+                } else if (field == "longitude" && reader.Number(field_value, &number)) {
+                    out->longitude = number;
+                }
+                return Visit::kContinue;
+            }));
+        }
+        return Visit::kContinue;
+    });
+}
+
+} // namespace
+
+bool DecodeGeoRecord(const MMDB_entry_s& entry, GeoRecordView* out) {
+    if (entry.mmdb == nullptr || entry.mmdb->data_section == nullptr) {
+        return false;
+    }
+    DataReader reader(entry.mmdb->data_section, entry.mmdb->data_section_size);
+    return DecodeRecord(reader, entry.offset, out);
+}
+
+bool ForEachGeoRecord(const MMDB_s& mmdb, const std::function<void(const GeoRecordView&)>& visit) {
+    if (mmdb.data_section == nullptr) {
+        return false;
+    }
+    DataReader reader(mmdb.data_section, mmdb.data_section_size);
+    const std::string_view data(reinterpret_cast<const char*>(mmdb.data_section), mmdb.data_section_size);
+    std::uint32_t offset = 0;
+    while (offset < mmdb.data_section_size) {
+        if (data.compare(offset, kMetadataMarker.size(), kMetadataMarker) == 0) {
+            break;
+        }
+        Field field;
+        std::uint32_t end = 0;
+        if (!reader.Header(offset, &field, &end)) {
+            return false;
+        }
+        GeoRecordView record;
+        if (field.type == kTypeMap && !field.via_pointer && DecodeRecord(reader, offset, &record)) {
+            visit(record);
+        }
+        if (!reader.Skip(offset, &offset)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace geo
+} // namespace meeting
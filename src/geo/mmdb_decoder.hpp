@@ -0,0 +1,34 @@
+#pragma once
+
+#include <maxminddb.h>
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string_view>
+
+namespace meeting{
+namespace geo{
+
+// 一条 GeoLite2-City 记录中需要的字段, 字符串直接引用数据库映射区, 仅在数据库打开期间有效
+struct GeoRecordView {
+    std::string_view iso_code; // country.iso_code
+    std::string_view country;  // country.names.en
+    std::string_view region;   // subdivisions[0].names.en
+    std::string_view city;     // city.names.en
+    std::string_view timezone; // location.time_zone
+    std::optional<double> latitude;  // location.latitude
+    std::optional<double> longitude; // location.longitude
+};
+
+// 单趟解码 MMDB 数据区中的记录: 从记录根部顺序遍历一次, 只进入需要的子 map,
+// 其余值按编码长度跳过 (指针值 O(1) 跳过), 不分配内存
+// 数据格式参见 MaxMind DB File Format Specification 2.0; 数据损坏时返回 false
+bool DecodeGeoRecord(const MMDB_entry_s& entry, GeoRecordView* out);
+
+// 按顺序遍历数据区中的全部顶层值, 对其中的 map 按 DecodeGeoRecord 解码后回调 visit
+// 查询结果指向的记录都是数据区的顶层值, 用于在加载数据库时预先处理所有记录; 数据损坏时提前结束并返回 false
+bool ForEachGeoRecord(const MMDB_s& mmdb, const std::function<void(const GeoRecordView&)>& visit);
+
+} // namespace geo
+} // namespace meeting
@@ -0,0 +1,41 @@
+#include "geo/string_table.hpp"
+
+#include <mutex>
+
+namespace meeting{
+namespace geo{
+
+StringTable& StringTable::Shared() {
+    static StringTable* table = new StringTable(); // 不析构, 避免退出阶段的悬空引用
+    return *table;
+}
+
+std::string_view StringTable::Intern(std::string_view value) {
+    if (value.empty()) {
+        return {};
+    }
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = index_.find(value);
+        if (it != index_.end()) {
+            return *it;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = index_.find(value);
+    if (it != index_.end()) {
+        return *it;
+    }
+    const auto& stored = storage_.emplace_back(value);
+    std::string_view view(stored);
+    index_.insert(view);
+    return view;
+}
+
+std::size_t StringTable::Size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return index_.size();
+}
+
+} // namespace geo
+} // namespace meeting
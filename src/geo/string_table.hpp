@@ -0,0 +1,35 @@
+#pragma once
+
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+namespace meeting{
+namespace geo{
+
+// 进程级字符串驻留表 (只增不删)
+// 国家/地区/时区等取值有限, 驻留后 GeoInfo 只保存 string_view, 查询与缓存拷贝均不分配内存;
+// 字符串在进程生命周期内有效, 数据库重新加载后旧结果仍可安全引用
+// 只在打开数据库时批量驻留 (GeoLocationService 按数据区位置缓存结果), 查询路径不访问本表
+class StringTable {
+public:
+    static StringTable& Shared();
+
+    // 返回与 value 内容相同的驻留字符串
+    std::string_view Intern(std::string_view value);
+
+    std::size_t Size() const;
+
+private:
+    StringTable() = default;
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::deque<std::string> storage_; // deque 追加时不移动已有元素, 保证 string_view 稳定
+    std::unordered_set<std::string_view> index_;
+};
+
+} // namespace geo
+} // namespace meeting
@@ -1,283 +1,858 @@
 #include "registry/server_registry.hpp"
 #include "common/logger.hpp"
 
+#include <nlohmann/json.hpp>
+
 #include <algorithm>
 #include <chrono>
+#include <cstdlib>
 #include <thread>
-#include <sys/select.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 namespace meeting {
 namespace registry {
 
 namespace {
-// Zookeeper 操作的回调函数，用于设置 promise 的值
-void VoidCompletion(int rc, const void* data) {
-    auto* promise = static_cast<std::promise<int>*>(const_cast<void*>(data));
-    if (promise) {
-        promise->set_value(rc);
-    }
+
+constexpr const char* kMeetingRoot = "/meeting";
+constexpr const char* kServersRoot = "/meeting/servers";
+constexpr int kSessionTimeoutMs = 30000; // zookeeper 会话超时
+constexpr auto kConnectTimeout = std::chrono::seconds(5); // 首次连接超时, 超时后禁用注册
+constexpr auto kOperationTimeout = std::chrono::seconds(10); // 同步接口等待操作完成的上限
+constexpr auto kListTimeout = std::chrono::seconds(2); // region 首次拉取的等待上限
+constexpr int kMaxPollMs = 1000; // 单次 poll 的最长等待
+constexpr int kReconnectBackoffMs = 1000; // 创建句柄失败后的重试间隔
+
+std::string RegionKey(const std::string& region) {
+    return region.empty() ? std::string("default") : region;
 }
 
-// 用于获取 Stat 结构体的回调函数
-void StatCompletion(int rc, const struct Stat*, const void* data) {
-    VoidCompletion(rc, data);
+std::string RegionPath(const std::string& region) {
+    return std::string(kServersRoot) + "/" + region;
 }
 
-// 用于创建节点的回调函数
-void CreateCompletion(int rc, const char*, const void* data) {
-    VoidCompletion(rc, data);
+std::string NodePath(const NodeInfo& node) {
+    return RegionPath(node.region) + "/" + node.host + ":" + std::to_string(node.port);
 }
 
-// 用于获取字符串列表的回调函数
-void StringsCompletion(int rc, const struct String_vector* strings, const void* data) {
-    auto* promise = static_cast<std::promise<std::pair<int, String_vector>>*>(const_cast<void*>(data));
-    if (!promise) return;
-    String_vector copy{};
-    if (rc == ZOK && strings) {
-        copy.count = strings->count;
-        copy.data = (char**)calloc(strings->count, sizeof(char*));
-        for (int i = 0; i < strings->count; ++i) {
-            copy.data[i] = strdup(strings->data[i]);
-        }
+// 从 zookeeper 路径中解析 region, 例如 /meeting/servers/default -> default
+std::optional<std::string> RegionFromPath(const char* path) {
+    if (path == nullptr) {
+        return std::nullopt;
     }
-    promise->set_value({rc, copy});
+    std::string prefix = std::string(kServersRoot) + "/";
+    std::string full(path);
+    if (full.compare(0, prefix.size(), prefix) != 0 || full.size() == prefix.size()) {
+        return std::nullopt;
+    }
+    auto region = full.substr(prefix.size());
+    if (region.find('/') != std::string::npos) {
+        return std::nullopt;
+    }
+    return region;
 }
 
-template<typename T>
-T Wait(std::future<T>& f, zhandle_t* zk) {
-    while (f.wait_for(std::chrono::milliseconds(0)) != std::future_status::ready) {
-        int fd = -1;
-        int interest = 0;
-        struct timeval tv = {0, 10000}; // 10ms
-        if (zookeeper_interest(zk, &fd, &interest, &tv) != ZOK) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+// 解析子节点列表 (名称格式为 host:port)
+std::vector<NodeInfo> ParseChildren(const String_vector* strings, const std::string& region) {
+    std::vector<NodeInfo> result;
+    if (strings == nullptr) {
+        return result;
+    }
+    result.reserve(static_cast<std::size_t>(strings->count));
+    for (int i = 0; i < strings->count; ++i) {
+        std::string name(strings->data[i]);
+        auto pos = name.find(':');
+        if (pos == std::string::npos) {
             continue;
         }
-        
-        fd_set rfds, wfds;
-        FD_ZERO(&rfds);
-        FD_ZERO(&wfds);
-        if (interest & ZOOKEEPER_READ) FD_SET(fd, &rfds);
-        if (interest & ZOOKEEPER_WRITE) FD_SET(fd, &wfds);
-
-        struct timeval select_tv = {0, 10000}; // 10ms
-        select(fd + 1, &rfds, &wfds, nullptr, &select_tv);
-        
-        int events = 0;
-        if (FD_ISSET(fd, &rfds)) events |= ZOOKEEPER_READ;
-        if (FD_ISSET(fd, &wfds)) events |= ZOOKEEPER_WRITE;
-        zookeeper_process(zk, events);
+        NodeInfo n;
+        n.host = name.substr(0, pos);
+        n.port = std::atoi(name.substr(pos + 1).c_str());
+        n.region = region;
+        result.push_back(std::move(n));
+    }
+    return result;
+}
+
+bool SameNode(const NodeInfo& a, const NodeInfo& b) {
+    return a.host == b.host && a.port == b.port && a.region == b.region;
+}
+
+void SetResult(const std::shared_ptr<std::promise<int>>& done, int rc) {
+    if (done) {
+        done->set_value(rc);
+    }
+}
+
+// 等待 I/O 线程返回结果, 超时或线程退出时返回错误码
+int AwaitResult(std::future<int>& f, std::chrono::milliseconds timeout) {
+    if (f.wait_for(timeout) != std::future_status::ready) {
+        return ZOPERATIONTIMEOUT;
+    }
+    try {
+        return f.get();
+    } catch (const std::future_error&) {
+        return ZCLOSING;
+    }
+}
+
+// 父路径创建的回调: 已存在属于正常情况, 忽略结果
+void IgnoreCreateCompletion(int, const char*, const void*) {}
+
+// 异步请求的上下文, 在回调中释放
+struct RegionRequest {
+    ServerRegistry* self;
+    std::string region;
+    std::shared_ptr<std::promise<int>> done;
+};
+
+struct NodeRequest {
+    ServerRegistry* self;
+    NodeInfo node;
+    std::shared_ptr<std::promise<int>> done;
+};
+
+struct NodeDataRequest {
+    ServerRegistry* self;
+    std::string region;
+    std::string name; // host:port
+};
+
+std::string NodeName(const NodeInfo& node) {
+    return node.host + ":" + std::to_string(node.port);
+}
+
+// 解析节点路径 /meeting/servers/<region>/<host:port>
+bool SplitNodePath(const char* path, std::string* region, std::string* name) {
+    if (path == nullptr) {
+        return false;
+    }
+    std::string prefix = std::string(kServersRoot) + "/";
+    std::string full(path);
+    if (full.compare(0, prefix.size(), prefix) != 0) {
+        return false;
+    }
+    auto rest = full.substr(prefix.size());
+    auto slash = rest.find('/');
+    if (slash == std::string::npos || slash == 0 || slash + 1 >= rest.size()) {
+        return false;
     }
-    return f.get();
+    *region = rest.substr(0, slash);
+    *name = rest.substr(slash + 1);
+    return name->find('/') == std::string::npos;
+}
+
+void IgnoreStatCompletion(int, const struct Stat*, const void*) {}
+
+// 两个节点列表的成员, 顺序与 meta_json 是否一致 (不比较负载与权重)
+bool SameLayout(const std::vector<NodeInfo>& a, const std::vector<NodeInfo>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (a[i].port != b[i].port || a[i].host != b[i].host || a[i].meta_json != b[i].meta_json) {
+            return false;
+        }
+    }
+    return true;
 }
 
 } // namespace
 
-ServerRegistry::ServerRegistry(std::string zk_hosts) : zk_hosts_(std::move(zk_hosts)) {
+std::string EncodeNodeData(const NodeInfo& node) {
+    nlohmann::json j = nlohmann::json::object();
+    if (!node.meta_json.empty()) {
+        auto meta = nlohmann::json::parse(node.meta_json, nullptr, false);
+        if (meta.is_object()) {
+            j = std::move(meta);
+        }
+    }
+    j["weight"] = node.weight;
+    j["load"] = {
+        {"active_meetings", node.load.active_meetings},
+        {"participants", node.load.participants},
+        {"busy_ratio", node.load.busy_ratio},
+    };
+    return j.dump();
+}
+
+void DecodeNodeData(const std::string& data, NodeInfo* node) {
+    if (node == nullptr) {
+        return;
+    }
+    auto j = nlohmann::json::parse(data, nullptr, false);
+    if (!j.is_object()) {
+        node->meta_json = data;
+        return;
+    }
+    node->weight = std::max(j.value("weight", node->weight), 0);
+    if (j.contains("load") && j["load"].is_object()) {
+        const auto& load = j["load"];
+        node->load.active_meetings = load.value("active_meetings", node->load.active_meetings);
+        node->load.participants = load.value("participants", node->load.participants);
+        node->load.busy_ratio = load.value("busy_ratio", node->load.busy_ratio);
+    }
+    // weight 与 load 已单独解析, meta_json 只保留节点自身的元数据 (如坐标)
+    j.erase("weight");
+    j.erase("load");
+    node->meta_json = j.dump();
+}
+
+ServerRegistry::ServerRegistry(std::string zk_hosts)
+    : zk_hosts_(std::move(zk_hosts))
+    , snapshot_(std::make_shared<const RegionSnapshot>())
+    , local_nodes_(std::make_shared<const std::vector<NodeInfo>>())
+    , all_nodes_(std::make_shared<const NodeSnapshot>()) {
     enabled_ = !zk_hosts_.empty(); // 是否启用注册功能, 取决于是否配置了zk地址
     if (!enabled_) {
         MEETING_LOG_WARN("[ServerRegistry] zk hosts empty, registry disabled");
+        return;
+    }
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        MEETING_LOG_ERROR("[ServerRegistry] eventfd failed, registry disabled");
+        enabled_ = false;
+        return;
     }
+    io_thread_ = std::thread([this]() { IoLoop(); });
 }
 
 ServerRegistry::~ServerRegistry() {
-    // 关闭zookeeper连接
-    if (zk_) {
-        zookeeper_close(zk_);
-        zk_ = nullptr;
+    // 通知 I/O 线程退出, 由其关闭 zookeeper 连接 (临时节点随会话一起删除)
+    stopping_.store(true, std::memory_order_release);
+    Wakeup();
+    if (io_thread_.joinable()) {
+        io_thread_.join();
+    }
+    if (wake_fd_ >= 0) {
+        close(wake_fd_);
+        wake_fd_ = -1;
     }
 }
 
 // 注册本节点
 void ServerRegistry::Register(const NodeInfo& node) {
-    if (!enabled_) {
+    if (!Enabled()) {
         return;
     }
+    auto f = RegisterAsync(node);
+    int rc = AwaitResult(f, kOperationTimeout);
+    if (rc != ZOK) {
+        MEETING_LOG_ERROR("[ServerRegistry] register failed rc={} node={}:{}", rc, node.host, node.port);
+    }
+}
 
-    std::lock_guard<std::mutex> lock(mutex_); // 保护 nodes_
-    if (!EnsureConnected()) {
-        MEETING_LOG_ERROR("[ServerRegistry] failed to connect to zookeeper");
+// 注销本节点
+void ServerRegistry::Unregister(const NodeInfo& node) {
+    if (!Enabled()) {
         return;
     }
-
-    // 确保父路径存在
-    EnsurePath("/meeting", false, "");
-    EnsurePath("/meeting/servers", false, "");
-
-    std::string base = "/meeting/servers/" + node.region; // 节点基础路径
-    // 确保基础路径存在
-    EnsurePath(base, false, "");
-
-    std::string path = base + "/" + node.host + ":" + std::to_string(node.port); // 节点完整路径
-    std::string data = node.meta_json; // 节点数据
-    // 创建临时节点
-    int rc = EnsurePath(path, true, data);
-    if (rc != ZOK && rc != ZNODEEXISTS) {
-        MEETING_LOG_ERROR("[ServerRegistry] register failed rc={} path={}", rc, path);
-    } else {
-        nodes_.push_back(node);
-        MEETING_LOG_INFO("[ServerRegistry] register node {}:{} region={}", node.host, node.port, node.region);
+    auto f = UnregisterAsync(node);
+    int rc = AwaitResult(f, kOperationTimeout);
+    if (rc != ZOK && rc != ZNONODE) {
+        MEETING_LOG_WARN("[ServerRegistry] unregister failed rc={} node={}:{}", rc, node.host, node.port);
     }
 }
 
-// 注销本节点
-void ServerRegistry::Unregister(const NodeInfo& node) {
-    if (!enabled_) {
+void ServerRegistry::SetLoadReporter(LoadReporter reporter, std::chrono::milliseconds interval) {
+    if (!Enabled()) {
         return;
     }
+    Post([this, reporter = std::move(reporter), interval]() mutable {
+        load_reporter_ = std::move(reporter);
+        report_interval_ = interval;
+        next_report_ = std::chrono::steady_clock::now();
+        last_load_.reset();
+    });
+}
+
+std::future<int> ServerRegistry::RegisterAsync(const NodeInfo& node) {
+    auto done = std::make_shared<std::promise<int>>();
+    auto f = done->get_future();
+    if (!Enabled()) {
+        done->set_value(ZINVALIDSTATE);
+        return f;
+    }
+    Post([this, node, done]() { DoRegister(node, done); });
+    return f;
+}
 
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (zk_) {
-        // 删除节点
-        std::promise<int> p;
-        auto f = p.get_future();
-        std::string path = "/meeting/servers/" + node.region + "/" + node.host + ":" + std::to_string(node.port);
-        int rc = zoo_adelete(zk_, path.c_str(), -1, VoidCompletion, &p);
-        if (rc != ZOK) {
-            p.set_value(rc);
-        }
-        Wait(f, zk_);
+std::future<int> ServerRegistry::UnregisterAsync(const NodeInfo& node) {
+    auto done = std::make_shared<std::promise<int>>();
+    auto f = done->get_future();
+    if (!Enabled()) {
+        done->set_value(ZINVALIDSTATE);
+        return f;
     }
-    // 从缓存中移除节点
-    nodes_.erase(std::remove_if(nodes_.begin(), nodes_.end(), [&](const NodeInfo& n) {
-        return n.host == node.host && n.port == node.port && n.region == node.region;
-    }), nodes_.end());
-    MEETING_LOG_INFO("[ServerRegistry] unregister node {}:{} region={}", node.host, node.port, node.region);
+    Post([this, node, done]() { DoUnregister(node, done); });
+    return f;
 }
 
 // 列出指定 region 的节点，region 为空则返回全部
 std::vector<NodeInfo> ServerRegistry::List(const std::string& region) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (!enabled_ || !zk_) {
-        // 如果未启用或未连接，直接返回缓存的节点列表
+    auto local = std::atomic_load(&local_nodes_);
+    if (!Enabled()) {
+        // 如果未启用，直接返回本地注册的节点列表
         if (region.empty()) {
-            return nodes_;
+            return *local;
         }
         std::vector<NodeInfo> filtered; // 过滤指定 region 的节点
-        for (const auto& n : nodes_) {
+        for (const auto& n : *local) {
             if (n.region == region) {
                 filtered.push_back(n);
             }
         }
         if (filtered.empty()) {
-            return nodes_; // 如果没有匹配的，返回全部
+            return *local; // 如果没有匹配的，返回全部
         }
         return filtered;
     }
 
-    // 获取指定 region 的节点列表
-    std::string base = "/meeting/servers/" + (region.empty() ? std::string("default") : region);
-    // 异步获取子节点列表
-    std::promise<std::pair<int, String_vector>> p; // 用于接收回调结果
-    auto f = p.get_future();
-    int rc = zoo_aget_children(zk_, base.c_str(), 0, StringsCompletion, &p); // 异步获取子节点
-    if (rc != ZOK) {
-        p.set_value({rc, {}});
+    const std::string key = RegionKey(region);
+    auto snapshot = std::atomic_load(&snapshot_);
+    auto it = snapshot->find(key);
+    if (it == snapshot->end() && connected_.load(std::memory_order_acquire)) {
+        // 首次访问该 region: 由 I/O 线程拉取并设置 watch, 之后只读快照
+        auto done = std::make_shared<std::promise<int>>();
+        auto f = done->get_future();
+        auto* self = const_cast<ServerRegistry*>(this);
+        Post([self, key, done]() { self->WatchRegion(key, done); });
+        AwaitResult(f, std::chrono::duration_cast<std::chrono::milliseconds>(kListTimeout));
+        snapshot = std::atomic_load(&snapshot_);
+        it = snapshot->find(key);
+    }
+    if (it == snapshot->end() || it->second.empty()) {
+        return *local;
     }
-    auto res = Wait(f, zk_); // 等待结果
+    return it->second;
+}
 
-    // 解析结果
-    std::vector<NodeInfo> result;
-    if (res.first == ZOK) {
-        for (int i = 0; i < res.second.count; ++i) {
-            std::string name(res.second.data[i]);
-            auto pos = name.find(':');
-            if (pos == std::string::npos) {
-                continue;
-            }
-            NodeInfo n;
-            n.host = name.substr(0, pos);
-            n.port = std::atoi(name.substr(pos + 1).c_str());
-            n.region = region.empty() ? "default" : region;
-            result.push_back(n);
-        }
+std::vector<NodeInfo> ServerRegistry::ListAll() const {
+    return SnapshotAll()->nodes;
+}
+
+std::shared_ptr<const NodeSnapshot> ServerRegistry::SnapshotAll() const {
+    if (Enabled() && !all_regions_watched_.load(std::memory_order_acquire) && connected_.load(std::memory_order_acquire)) {
+        auto done = std::make_shared<std::promise<int>>();
+        auto f = done->get_future();
+        auto* self = const_cast<ServerRegistry*>(this);
+        Post([self, done]() { self->WatchAllRegions(done); });
+        AwaitResult(f, std::chrono::duration_cast<std::chrono::milliseconds>(kListTimeout));
     }
-    deallocate_String_vector(&res.second);
-    if (result.empty()) {
-        return nodes_;
+    // 未启用时 I/O 线程不存在, 快照保持为空 (与本进程注册的节点一致)
+    return std::atomic_load(&all_nodes_);
+}
+
+void ServerRegistry::Post(Command command) const {
+    {
+        std::lock_guard<std::mutex> lock(command_mutex_);
+        commands_.push_back(std::move(command));
     }
-    return result;
+    Wakeup();
 }
 
-bool ServerRegistry::EnsureConnected() {
-    if (!enabled_) {
-        return false;
+void ServerRegistry::Wakeup() const {
+    if (wake_fd_ >= 0) {
+        std::uint64_t one = 1;
+        [[maybe_unused]] auto n = write(wake_fd_, &one, sizeof(one));
     }
+}
+
+void ServerRegistry::IoLoop() {
+    connect_started_ = std::chrono::steady_clock::now();
+    Connect();
+    while (!stopping_.load(std::memory_order_acquire)) {
+        if (!ever_connected_ && !connected_.load(std::memory_order_acquire)
+            && std::chrono::steady_clock::now() - connect_started_ > kConnectTimeout) {
+            // 与原有行为一致: 启动时连不上 zookeeper 则禁用注册
+            MEETING_LOG_WARN("[ServerRegistry] zookeeper connection timeout ({}), disable registry", zk_hosts_);
+            enabled_.store(false, std::memory_order_release);
+            break;
+        }
+
+        if (zk_ == nullptr) {
+            // 句柄创建失败: 退避后重试
+            struct pollfd wake{wake_fd_, POLLIN, 0};
+            poll(&wake, 1, kReconnectBackoffMs);
+            std::uint64_t drained = 0;
+            [[maybe_unused]] auto n = read(wake_fd_, &drained, sizeof(drained));
+            Connect();
+            continue;
+        }
+
+        if (connected_.load(std::memory_order_acquire)) {
+            RunCommands();
+            if (load_reporter_ && std::chrono::steady_clock::now() >= next_report_) {
+                ReportLoad();
+            }
+        }
+
+        int fd = -1;
+        int interest = 0;
+        struct timeval tv {};
+        int rc = zookeeper_interest(zk_, &fd, &interest, &tv);
+        if (rc != ZOK && rc != ZCONNECTIONLOSS) {
+            // 句柄已不可用 (例如会话过期), 重建会话
+            MEETING_LOG_WARN("[ServerRegistry] zookeeper_interest rc={}, resetting session", rc);
+            ResetSession();
+            continue;
+        }
+
+        struct pollfd fds[2];
+        fds[0] = {wake_fd_, POLLIN, 0};
+        nfds_t nfds = 1;
+        if (fd >= 0) {
+            short events = 0;
+            if (interest & ZOOKEEPER_READ) events |= POLLIN;
+            if (interest & ZOOKEEPER_WRITE) events |= POLLOUT;
+            fds[1] = {fd, events, 0};
+            nfds = 2;
+        }
+        long timeout_ms = tv.tv_sec * 1000L + tv.tv_usec / 1000L;
+        if (load_reporter_ && connected_.load(std::memory_order_acquire)) {
+            auto until_report = std::chrono::duration_cast<std::chrono::milliseconds>(
+                next_report_ - std::chrono::steady_clock::now()).count();
+            timeout_ms = std::min(timeout_ms, static_cast<long>(until_report));
+        }
+        timeout_ms = std::clamp(timeout_ms, 0L, static_cast<long>(kMaxPollMs));
+        if (poll(fds, nfds, static_cast<int>(timeout_ms)) < 0) {
+            continue; // EINTR
+        }
+        if (fds[0].revents & POLLIN) {
+            std::uint64_t drained = 0;
+            [[maybe_unused]] auto n = read(wake_fd_, &drained, sizeof(drained));
+        }
+        int events = 0;
+        if (nfds == 2) {
+            if (fds[1].revents & (POLLIN | POLLERR | POLLHUP)) events |= ZOOKEEPER_READ;
+            if (fds[1].revents & POLLOUT) events |= ZOOKEEPER_WRITE;
+        }
+        zookeeper_process(zk_, events); // 派发回调与 watch
+        if (session_expired_) {
+            ResetSession();
+        }
+    }
+
     if (zk_) {
-        return true;
+        zookeeper_close(zk_);
+        zk_ = nullptr;
     }
+    connected_.store(false, std::memory_order_release);
+    FailCommands();
+}
 
-    zk_ = zookeeper_init(zk_hosts_.c_str(), nullptr, 30000, 0, nullptr, 0);
+void ServerRegistry::Connect() {
+    zk_ = zookeeper_init(zk_hosts_.c_str(), SessionWatcher, kSessionTimeoutMs, nullptr, this, 0);
     if (!zk_) {
         MEETING_LOG_ERROR("[ServerRegistry] connect zookeeper failed: {}", zk_hosts_);
-        return false;
     }
+}
 
-    // 等待连接建立（最多等待5秒），显式驱动非线程化客户端
-    int max_retries = 50;  // 50 * 100ms = 5秒
-    for (int i = 0; i < max_retries; ++i) {
-        int fd = -1;
-        int interest = 0;
-        struct timeval tv {};
-        if (zookeeper_interest(zk_, &fd, &interest, &tv) != ZOK) {
-            break;
+void ServerRegistry::ResetSession() {
+    if (zk_) {
+        zookeeper_close(zk_);
+        zk_ = nullptr;
+    }
+    connected_.store(false, std::memory_order_release);
+    session_expired_ = false;
+    needs_recovery_ = ever_connected_;
+    data_watched_.clear(); // 数据 watch 随旧会话失效
+    last_load_.reset();
+    Connect();
+}
+
+void ServerRegistry::Recover() {
+    needs_recovery_ = false;
+    MEETING_LOG_INFO("[ServerRegistry] session re-established, re-registering {} node(s)", nodes_.size());
+    for (const auto& node : nodes_) {
+        DoRegister(node, nullptr);
+    }
+    auto snapshot = std::atomic_load(&snapshot_);
+    for (const auto& [region, nodes] : *snapshot) {
+        (void)nodes;
+        WatchRegion(region, nullptr);
+    }
+    if (all_regions_watched_.load(std::memory_order_acquire)) {
+        WatchAllRegions(nullptr);
+    }
+}
+
+void ServerRegistry::RunCommands() {
+    std::deque<Command> pending;
+    {
+        std::lock_guard<std::mutex> lock(command_mutex_);
+        pending.swap(commands_);
+    }
+    for (auto& command : pending) {
+        command();
+    }
+}
+
+void ServerRegistry::FailCommands() {
+    // 丢弃命令即销毁其中的 promise, 等待方得到 broken_promise 并按 ZCLOSING 处理
+    std::lock_guard<std::mutex> lock(command_mutex_);
+    commands_.clear();
+}
+
+void ServerRegistry::DoRegister(const NodeInfo& node, ResultPromise done) {
+    // 同一会话内的请求按序执行, 父路径创建无需等待结果
+    zoo_acreate(zk_, kMeetingRoot, "", 0, &ZOO_OPEN_ACL_UNSAFE, 0, IgnoreCreateCompletion, nullptr);
+    zoo_acreate(zk_, kServersRoot, "", 0, &ZOO_OPEN_ACL_UNSAFE, 0, IgnoreCreateCompletion, nullptr);
+    const std::string base = RegionPath(node.region);
+    zoo_acreate(zk_, base.c_str(), "", 0, &ZOO_OPEN_ACL_UNSAFE, 0, IgnoreCreateCompletion, nullptr);
+
+    const std::string path = NodePath(node);
+    const std::string data = EncodeNodeData(node);
+    auto* req = new NodeRequest{this, node, std::move(done)};
+    int rc = zoo_acreate(zk_, path.c_str(), data.data(), static_cast<int>(data.size()),
+                         &ZOO_OPEN_ACL_UNSAFE, ZOO_EPHEMERAL, CreateNodeCompletion, req);
+    if (rc != ZOK) {
+        SetResult(req->done, rc);
+        delete req;
+    }
+}
+
+void ServerRegistry::DoUnregister(const NodeInfo& node, ResultPromise done) {
+    // 先从本地移除, 避免重连恢复时再次注册
+    nodes_.erase(std::remove_if(nodes_.begin(), nodes_.end(), [&](const NodeInfo& n) {
+        return SameNode(n, node);
+    }), nodes_.end());
+    PublishLocalNodes();
+    UpdateLocalNode(node, false);
+
+    const std::string path = NodePath(node);
+    auto* req = new NodeRequest{this, node, std::move(done)};
+    int rc = zoo_adelete(zk_, path.c_str(), -1, DeleteNodeCompletion, req);
+    if (rc != ZOK) {
+        SetResult(req->done, rc);
+        delete req;
+    }
+}
+
+void ServerRegistry::WatchRegion(const std::string& region, ResultPromise done) {
+    auto* req = new RegionRequest{this, region, std::move(done)};
+    const std::string path = RegionPath(region);
+    int rc = zoo_awget_children(zk_, path.c_str(), ChildWatcher, this, ChildrenCompletion, req);
+    if (rc != ZOK) {
+        MEETING_LOG_WARN("[ServerRegistry] watch region {} failed rc={}", region, rc);
+        SetResult(req->done, rc);
+        delete req;
+    }
+}
+
+void ServerRegistry::WatchAllRegions(ResultPromise done) {
+    auto* req = new RegionRequest{this, std::string(), std::move(done)};
+    int rc = zoo_awget_children(zk_, kServersRoot, RootWatcher, this, RootChildrenCompletion, req);
+    if (rc != ZOK) {
+        MEETING_LOG_WARN("[ServerRegistry] watch regions failed rc={}", rc);
+        SetResult(req->done, rc);
+        delete req;
+    }
+}
+
+void ServerRegistry::PublishRegion(const std::string& region, std::vector<NodeInfo> nodes) {
+    auto next = std::make_shared<RegionSnapshot>(*snapshot_);
+    (*next)[region] = std::move(nodes);
+    StoreSnapshot(std::move(next));
+}
+
+void ServerRegistry::StoreSnapshot(std::shared_ptr<const RegionSnapshot> next) {
+    std::atomic_store(&snapshot_, std::move(next));
+    PublishAll();
+}
+
+void ServerRegistry::PublishAll() {
+    auto next = std::make_shared<NodeSnapshot>();
+    // region 按名称排序拼接, 节点顺序不随哈希表内部顺序变化
+    std::vector<const RegionSnapshot::value_type*> regions;
+    regions.reserve(snapshot_->size());
+    for (const auto& entry : *snapshot_) {
+        regions.push_back(&entry);
+    }
+    std::sort(regions.begin(), regions.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+    for (const auto* entry : regions) {
+        next->nodes.insert(next->nodes.end(), entry->second.begin(), entry->second.end());
+    }
+    if (next->nodes.empty()) {
+        next->nodes = nodes_;
+    }
+    const auto& previous = *all_nodes_;
+    next->layout_version = SameLayout(previous.nodes, next->nodes) ? previous.layout_version : previous.layout_version + 1;
+    std::atomic_store(&all_nodes_, std::shared_ptr<const NodeSnapshot>(std::move(next)));
+}
+
+void ServerRegistry::UpdateLocalNode(const NodeInfo& node, bool add) {
+    auto it = snapshot_->find(node.region);
+    if (it == snapshot_->end()) {
+        return; // 未订阅的 region 无需维护
+    }
+    auto next = std::make_shared<RegionSnapshot>(*snapshot_);
+    auto& nodes = (*next)[node.region];
+    auto pos = std::find_if(nodes.begin(), nodes.end(), [&](const NodeInfo& n) { return SameNode(n, node); });
+    if (add && pos == nodes.end()) {
+        nodes.push_back(node);
+    } else if (!add && pos != nodes.end()) {
+        nodes.erase(pos);
+    }
+    StoreSnapshot(std::move(next));
+}
+
+void ServerRegistry::PublishLocalNodes() {
+    std::atomic_store(&local_nodes_, std::make_shared<const std::vector<NodeInfo>>(nodes_));
+    PublishAll();
+}
+
+void ServerRegistry::ReportLoad() {
+    next_report_ = std::chrono::steady_clock::now() + report_interval_;
+    NodeLoad load = load_reporter_();
+    if (last_load_.has_value() && *last_load_ == load) {
+        return; // 负载未变化, 不产生写入
+    }
+    last_load_ = load;
+    for (auto& node : nodes_) {
+        node.load = load;
+        const std::string path = NodePath(node);
+        const std::string data = EncodeNodeData(node);
+        int rc = zoo_aset(zk_, path.c_str(), data.data(), static_cast<int>(data.size()), -1,
+                          IgnoreStatCompletion, nullptr);
+        if (rc != ZOK) {
+            MEETING_LOG_WARN("[ServerRegistry] publish load failed rc={} path={}", rc, path);
         }
+        UpdateNodeData(node.region, NodeName(node), data);
+    }
+    PublishLocalNodes();
+}
 
-        int state = zoo_state(zk_);
-        if (state == ZOO_CONNECTED_STATE) {
-            MEETING_LOG_INFO("[ServerRegistry] connected to zookeeper: {}", zk_hosts_);
-            return true;
+void ServerRegistry::WatchNodeData(const std::string& region, const std::string& name) {
+    const std::string path = RegionPath(region) + "/" + name;
+    if (!data_watched_.insert(path).second) {
+        return; // 数据 watch 已存在
+    }
+    auto* req = new NodeDataRequest{this, region, name};
+    int rc = zoo_awget(zk_, path.c_str(), DataWatcher, this, DataCompletion, req);
+    if (rc != ZOK) {
+        data_watched_.erase(path);
+        delete req;
+    }
+}
+
+void ServerRegistry::UpdateNodeData(const std::string& region, const std::string& name, const std::string& data) {
+    auto it = snapshot_->find(region);
+    if (it == snapshot_->end()) {
+        return;
+    }
+    auto next = std::make_shared<RegionSnapshot>(*snapshot_);
+    for (auto& n : (*next)[region]) {
+        if (NodeName(n) == name) {
+            DecodeNodeData(data, &n);
+            StoreSnapshot(std::move(next));
+            return;
         }
+    }
+}
+
+// 会话事件: 维护连接状态, 过期后由主循环重建会话
+void ServerRegistry::SessionWatcher(zhandle_t*, int type, int state, const char*, void* ctx) {
+    auto* self = static_cast<ServerRegistry*>(ctx);
+    if (self == nullptr || type != ZOO_SESSION_EVENT) {
+        return;
+    }
+    if (state == ZOO_CONNECTED_STATE) {
+        self->connected_.store(true, std::memory_order_release);
+        if (!self->ever_connected_) {
+            self->ever_connected_ = true;
+            MEETING_LOG_INFO("[ServerRegistry] connected to zookeeper: {}", self->zk_hosts_);
+        }
+        if (self->needs_recovery_) {
+            self->Recover();
+        }
+    } else if (state == ZOO_EXPIRED_SESSION_STATE) {
+        MEETING_LOG_WARN("[ServerRegistry] zookeeper session expired, reconnecting");
+        self->connected_.store(false, std::memory_order_release);
+        self->session_expired_ = true;
+    } else if (state == ZOO_CONNECTING_STATE || state == ZOO_ASSOCIATING_STATE) {
+        // 暂时断开: 客户端会自动重连, 会话与 watch 在恢复后保持有效
+        self->connected_.store(false, std::memory_order_release);
+    }
+}
 
-        fd_set rfds, wfds;
-        FD_ZERO(&rfds);
-        FD_ZERO(&wfds);
-        if (interest & ZOOKEEPER_READ) FD_SET(fd, &rfds);
-        if (interest & ZOOKEEPER_WRITE) FD_SET(fd, &wfds);
+// 子节点 / 存在性 watch: region 发生变化时重新拉取并再次设置 watch
+void ServerRegistry::ChildWatcher(zhandle_t*, int type, int, const char* path, void* ctx) {
+    auto* self = static_cast<ServerRegistry*>(ctx);
+    if (self == nullptr) {
+        return;
+    }
+    if (type != ZOO_CHILD_EVENT && type != ZOO_CREATED_EVENT && type != ZOO_DELETED_EVENT) {
+        return;
+    }
+    auto region = RegionFromPath(path);
+    if (region.has_value()) {
+        self->WatchRegion(*region, nullptr);
+    }
+}
 
-        int rc = select(fd + 1, &rfds, &wfds, nullptr, &tv);
-        if (rc < 0) {
-            break;
+// region 列表 watch: 新增 region 时重新拉取 (已订阅的 region 由各自的 watch 维护)
+void ServerRegistry::RootWatcher(zhandle_t*, int type, int, const char*, void* ctx) {
+    auto* self = static_cast<ServerRegistry*>(ctx);
+    if (self == nullptr) {
+        return;
+    }
+    if (type == ZOO_CHILD_EVENT || type == ZOO_CREATED_EVENT) {
+        self->WatchAllRegions(nullptr);
+    }
+}
+
+void ServerRegistry::RootChildrenCompletion(int rc, const struct String_vector* strings, const void* data) {
+    std::unique_ptr<RegionRequest> req(static_cast<RegionRequest*>(const_cast<void*>(data)));
+    if (!req) {
+        return;
+    }
+    auto* self = req->self;
+    if (rc == ZOK) {
+        self->all_regions_watched_.store(true, std::memory_order_release);
+        std::vector<std::string> fresh;
+        for (int i = 0; strings != nullptr && i < strings->count; ++i) {
+            std::string region(strings->data[i]);
+            if (self->snapshot_->find(region) == self->snapshot_->end()) {
+                fresh.push_back(std::move(region));
+            }
+        }
+        if (!fresh.empty()) {
+            // 会话内请求按序完成, 最后一个 region 拉取完成时之前的也已发布
+            for (std::size_t i = 0; i + 1 < fresh.size(); ++i) {
+                self->WatchRegion(fresh[i], nullptr);
+            }
+            self->WatchRegion(fresh.back(), std::move(req->done));
+            return;
+        }
+    } else if (rc == ZNONODE) {
+        self->all_regions_watched_.store(true, std::memory_order_release);
+        auto* exists_req = new RegionRequest{self, std::string(), nullptr};
+        if (zoo_awexists(self->zk_, kServersRoot, RootWatcher, self, ExistsCompletion, exists_req) != ZOK) {
+            delete exists_req;
+        }
+    }
+    SetResult(req->done, rc);
+}
+
+void ServerRegistry::ChildrenCompletion(int rc, const struct String_vector* strings, const void* data) {
+    std::unique_ptr<RegionRequest> req(static_cast<RegionRequest*>(const_cast<void*>(data)));
+    if (!req) {
+        return;
+    }
+    auto* self = req->self;
+    if (rc == ZOK) {
+        auto nodes = ParseChildren(strings, req->region);
+        // 保留已知节点的数据 (负载/权重), 新节点的数据由数据 watch 填充
+        auto known = self->snapshot_->find(req->region);
+        if (known != self->snapshot_->end()) {
+            for (auto& n : nodes) {
+                for (const auto& old : known->second) {
+                    if (SameNode(old, n)) {
+                        n = old;
+                        break;
+                    }
+                }
+            }
+        }
+        self->PublishRegion(req->region, nodes);
+        for (const auto& n : nodes) {
+            self->WatchNodeData(req->region, NodeName(n));
+        }
+    } else if (rc == ZNONODE) {
+        // region 尚不存在: 发布空列表, 并监听其创建
+        self->PublishRegion(req->region, {});
+        const std::string path = RegionPath(req->region);
+        auto* exists_req = new RegionRequest{self, req->region, nullptr};
+        if (zoo_awexists(self->zk_, path.c_str(), ChildWatcher, self, ExistsCompletion, exists_req) != ZOK) {
+            delete exists_req;
         }
-        int events = 0;
-        if (FD_ISSET(fd, &rfds)) events |= ZOOKEEPER_READ;
-        if (FD_ISSET(fd, &wfds)) events |= ZOOKEEPER_WRITE;
-        zookeeper_process(zk_, events);
     }
+    SetResult(req->done, rc);
+}
 
-    int state = zoo_state(zk_);
-    MEETING_LOG_WARN("[ServerRegistry] zookeeper connection timeout (state={}), disable registry", state);
-    zookeeper_close(zk_);
-    zk_ = nullptr;
-    enabled_ = false;
-    return false;
+void ServerRegistry::ExistsCompletion(int rc, const struct Stat*, const void* data) {
+    std::unique_ptr<RegionRequest> req(static_cast<RegionRequest*>(const_cast<void*>(data)));
+    if (req && rc == ZOK) {
+        // 监听注册期间节点已被创建, 直接拉取子节点 (region 为空表示 region 列表根节点)
+        if (req->region.empty()) {
+            req->self->WatchAllRegions(nullptr);
+        } else {
+            req->self->WatchRegion(req->region, nullptr);
+        }
+    }
 }
 
-// 确保指定路径存在
-int ServerRegistry::EnsurePath(const std::string& path, bool ephemeral, const std::string& data) {
-    int flags = ephemeral ? ZOO_EPHEMERAL : 0; // 节点类型标志
+void ServerRegistry::CreateNodeCompletion(int rc, const char*, const void* data) {
+    std::unique_ptr<NodeRequest> req(static_cast<NodeRequest*>(const_cast<void*>(data)));
+    if (!req) {
+        return;
+    }
+    auto* self = req->self;
+    const auto& node = req->node;
+    if (rc == ZOK || rc == ZNODEEXISTS) {
+        auto pos = std::find_if(self->nodes_.begin(), self->nodes_.end(),
+                                [&](const NodeInfo& n) { return SameNode(n, node); });
+        if (pos == self->nodes_.end()) {
+            self->nodes_.push_back(node);
+            self->PublishLocalNodes();
+        }
+        if (self->snapshot_->find(node.region) == self->snapshot_->end()) {
+            // 订阅本 region: 先发布本节点保证立即可见, 完整列表与后续变化由 watch 推送
+            self->PublishRegion(node.region, {node});
+            self->WatchRegion(node.region, nullptr);
+        } else {
+            self->UpdateLocalNode(node, true);
+        }
+        MEETING_LOG_INFO("[ServerRegistry] register node {}:{} region={}", node.host, node.port, node.region);
+        rc = ZOK;
+    } else {
+        MEETING_LOG_ERROR("[ServerRegistry] register failed rc={} path={}", rc, NodePath(node));
+    }
+    SetResult(req->done, rc);
+}
+
+// 数据 watch: 节点数据变化时重新拉取
+void ServerRegistry::DataWatcher(zhandle_t*, int type, int, const char* path, void* ctx) {
+    auto* self = static_cast<ServerRegistry*>(ctx);
+    if (self == nullptr || (type != ZOO_CHANGED_EVENT && type != ZOO_DELETED_EVENT)) {
+        return;
+    }
+    std::string region;
+    std::string name;
+    if (!SplitNodePath(path, &region, &name)) {
+        return;
+    }
+    self->data_watched_.erase(path);
+    if (type == ZOO_CHANGED_EVENT) {
+        self->WatchNodeData(region, name);
+    }
+}
 
-    // 检查节点是否存在
-    std::promise<int> p;
-    auto f = p.get_future();
-    int rc = zoo_aexists(zk_, path.c_str(), 0, StatCompletion, &p); // 异步检查节点是否存在
+void ServerRegistry::DataCompletion(int rc, const char* value, int value_len, const struct Stat*, const void* data) {
+    std::unique_ptr<NodeDataRequest> req(static_cast<NodeDataRequest*>(const_cast<void*>(data)));
+    if (!req) {
+        return;
+    }
     if (rc != ZOK) {
-        p.set_value(rc);
+        req->self->data_watched_.erase(RegionPath(req->region) + "/" + req->name);
+        return;
     }
-    rc = Wait(f, zk_);
+    std::string payload = (value != nullptr && value_len > 0) ? std::string(value, static_cast<std::size_t>(value_len))
+                                                              : std::string();
+    req->self->UpdateNodeData(req->region, req->name, payload);
+}
 
-    // 如果节点不存在，则创建节点
-    if (rc == ZNONODE) {
-        std::promise<int> c;
-        auto cf = c.get_future();
-        rc = zoo_acreate(zk_, path.c_str(), data.data(), static_cast<int>(data.size()),
-                         &ZOO_OPEN_ACL_UNSAFE, flags, CreateCompletion, &c);
-        if (rc != ZOK) {
-            c.set_value(rc);
-        }
-        rc = Wait(cf, zk_);
+void ServerRegistry::DeleteNodeCompletion(int rc, const void* data) {
+    std::unique_ptr<NodeRequest> req(static_cast<NodeRequest*>(const_cast<void*>(data)));
+    if (!req) {
+        return;
     }
-    return rc;
+    const auto& node = req->node;
+    MEETING_LOG_INFO("[ServerRegistry] unregister node {}:{} region={} rc={}", node.host, node.port, node.region, rc);
+    SetResult(req->done, rc);
 }
 
 } // namespace registry
@@ -3,49 +3,176 @@
 // 接入zookeeper头文件
 #include <zookeeper/zookeeper.h>
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <string>
+#include <thread>
 #include <vector>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <future>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace meeting{
 namespace registry {
 
+// 节点实时负载, 随 znode 数据发布
+struct NodeLoad {
+    std::uint64_t active_meetings = 0; // 进行中的会议数
+    std::uint64_t participants = 0;    // 在线参与者数
+    double busy_ratio = 0.0;           // 线程池繁忙比例 [0, 1]
+
+    bool operator==(const NodeLoad& other) const {
+        return active_meetings == other.active_meetings && participants == other.participants
+            && busy_ratio == other.busy_ratio;
+    }
+    bool operator!=(const NodeLoad& other) const { return !(*this == other); }
+};
+
 struct NodeInfo {
     std::string host;
     int port = 0;
     std::string region = "default";
     int weight = 1;
     std::string meta_json;
+    NodeLoad load; // 最近一次发布的负载
+};
+
+// znode 数据编解码: 在 meta_json 对象基础上附加 weight 与 load 字段
+std::string EncodeNodeData(const NodeInfo& node);
+// 解析 znode 数据并填充 meta_json / weight / load, 数据非法时保持默认值;
+// meta_json 不含 weight 与 load, 只发布负载时保持不变
+void DecodeNodeData(const std::string& data, NodeInfo* node);
+
+// 全部 region 节点的只读快照, 注册信息变化时由 I/O 线程整体替换
+struct NodeSnapshot {
+    std::vector<NodeInfo> nodes;
+    // 节点集合, 顺序或 meta_json 变化时加 1; 只有负载或权重变化时不变, 同一版本内节点下标稳定
+    std::uint64_t layout_version = 0;
 };
 
 // 服务器注册中心
+// 独立的 I/O 线程独占 zhandle_t: 负责驱动事件循环、执行提交的操作、派发 watch,
+// 并在会话过期后自动重连、重新注册临时节点和重新订阅 region
 class ServerRegistry {
 public:
     // 构造函数，传入zookeeper的连接地址
     explicit ServerRegistry(std::string zk_hosts);
     ~ServerRegistry();
 
-    // 注册本节点
+    ServerRegistry(const ServerRegistry&) = delete;
+    ServerRegistry& operator=(const ServerRegistry&) = delete;
+
+    // 注册本节点 (阻塞直到完成或超时)
     void Register(const NodeInfo& node);
-    // 注销本节点
+    // 注销本节点 (阻塞直到完成或超时)
     void Unregister(const NodeInfo& node);
+    // 异步注册/注销, future 中为 zookeeper 返回码 (ZOK 表示成功)
+    std::future<int> RegisterAsync(const NodeInfo& node);
+    std::future<int> UnregisterAsync(const NodeInfo& node);
 
-    bool Enabled() const {return enabled_;}
+    // 负载采集函数, 由 I/O 线程周期性调用并将结果写入本进程注册的 znode
+    using LoadReporter = std::function<NodeLoad()>;
+    void SetLoadReporter(LoadReporter reporter, std::chrono::milliseconds interval);
+
+    bool Enabled() const {return enabled_.load(std::memory_order_acquire);}
     // 列出指定 region 的节点，region 为空则返回全部
+    // 读取 watch 维护的本地快照, 不加锁也不访问网络; 仅 region 首次出现时同步拉取一次并设置 watch
     std::vector<NodeInfo> List(const std::string& region) const;
+    // 列出所有 region 的节点 (跨 region 选择时使用), 首次调用时订阅 region 列表
+    std::vector<NodeInfo> ListAll() const;
+    // 与 ListAll 相同的节点, 直接返回当前快照而不复制节点列表
+    std::shared_ptr<const NodeSnapshot> SnapshotAll() const;
 private:
-    // 确保与zookeeper的连接
-    bool EnsureConnected();
-    // 确保指定路径存在
-    int EnsurePath(const std::string& path, bool ephemeral, const std::string& data);
+    // region -> 节点列表 的只读快照, 通过原子替换 shared_ptr 发布
+    using RegionSnapshot = std::unordered_map<std::string, std::vector<NodeInfo>>;
+    using Command = std::function<void()>;
+    using ResultPromise = std::shared_ptr<std::promise<int>>;
+
+    // 提交操作到 I/O 线程并唤醒
+    void Post(Command command) const;
+    void Wakeup() const;
+    // I/O 线程主循环
+    void IoLoop();
+    // 创建新的 zookeeper 会话
+    void Connect();
+    // 会话过期: 关闭旧句柄并重建会话
+    void ResetSession();
+    // 重连成功后重新注册临时节点并重新订阅 region
+    void Recover();
+    // 执行已排队的操作 (仅在已连接时)
+    void RunCommands();
+    // 放弃所有排队的操作
+    void FailCommands();
+
+    // 以下函数仅在 I/O 线程中调用
+    void DoRegister(const NodeInfo& node, ResultPromise done);
+    void DoUnregister(const NodeInfo& node, ResultPromise done);
+    // 拉取子节点并设置 watch, 结果在回调中发布
+    void WatchRegion(const std::string& region, ResultPromise done);
+    // 拉取 region 列表并设置 watch, 对新出现的 region 逐个订阅
+    void WatchAllRegions(ResultPromise done);
+    // 发布 region 的最新节点列表 (写时复制)
+    void PublishRegion(const std::string& region, std::vector<NodeInfo> nodes);
+    // 替换 region 快照并重建全部节点快照
+    void StoreSnapshot(std::shared_ptr<const RegionSnapshot> next);
+    // 按 region 快照 (为空时按本进程注册的节点) 重建全部节点快照
+    void PublishAll();
+    // 在快照中增删本节点, 保证本地写入立即可见
+    void UpdateLocalNode(const NodeInfo& node, bool add);
+    void PublishLocalNodes();
+    // 采集并发布本节点负载 (负载变化时才写入 zookeeper)
+    void ReportLoad();
+    // 拉取节点数据并设置数据 watch
+    void WatchNodeData(const std::string& region, const std::string& name);
+    // 用最新的节点数据更新快照
+    void UpdateNodeData(const std::string& region, const std::string& name, const std::string& data);
+
+    // zookeeper watch / 回调
+    static void SessionWatcher(zhandle_t* zh, int type, int state, const char* path, void* ctx);
+    static void ChildWatcher(zhandle_t* zh, int type, int state, const char* path, void* ctx);
+    static void RootWatcher(zhandle_t* zh, int type, int state, const char* path, void* ctx);
+    static void RootChildrenCompletion(int rc, const struct String_vector* strings, const void* data);
+    static void ChildrenCompletion(int rc, const struct String_vector* strings, const void* data);
+    static void ExistsCompletion(int rc, const struct Stat* stat, const void* data);
+    static void CreateNodeCompletion(int rc, const char* value, const void* data);
+    static void DeleteNodeCompletion(int rc, const void* data);
+    static void DataWatcher(zhandle_t* zh, int type, int state, const char* path, void* ctx);
+    static void DataCompletion(int rc, const char* value, int value_len, const struct Stat* stat, const void* data);
 private:
     std::string zk_hosts_; // zookeeper 连接地址
-    bool enabled_ = false; // 是否启用注册功能
-    mutable std::mutex mutex_; // 保护 nodes_
-    std::vector<NodeInfo> nodes_; // 缓存的节点列表
+    std::atomic<bool> enabled_{false}; // 是否启用注册功能
+    std::atomic<bool> connected_{false}; // 当前会话是否已连接
+    std::atomic<bool> stopping_{false}; // I/O 线程退出标志
+    std::atomic<bool> all_regions_watched_{false}; // 是否已订阅 region 列表
+
+    mutable std::mutex command_mutex_; // 保护 commands_
+    mutable std::deque<Command> commands_; // 待 I/O 线程执行的操作
+    int wake_fd_ = -1; // eventfd, 用于唤醒 I/O 线程
+    std::thread io_thread_; // I/O 线程
+
+    // 以下成员仅由 I/O 线程访问
     zhandle_t* zk_ = nullptr; // zookeeper 句柄
+    std::vector<NodeInfo> nodes_; // 本进程注册的节点列表, 重连后据此重新注册
+    bool ever_connected_ = false; // 是否曾经连接成功 (首次连接失败则禁用注册)
+    bool session_expired_ = false; // 会话已过期, 需要重建
+    bool needs_recovery_ = false; // 新会话建立后需要恢复注册与订阅
+    std::chrono::steady_clock::time_point connect_started_{}; // 首次连接开始时间
+    std::unordered_set<std::string> data_watched_; // 已设置数据 watch 的节点路径
+    LoadReporter load_reporter_; // 负载采集函数
+    std::chrono::milliseconds report_interval_{0}; // 负载发布周期
+    std::chrono::steady_clock::time_point next_report_{}; // 下次发布时间
+    std::optional<NodeLoad> last_load_; // 上次发布的负载
+
+    // 快照仅由 I/O 线程写入, 读取方通过 std::atomic_load 获取
+    std::shared_ptr<const RegionSnapshot> snapshot_;
+    std::shared_ptr<const std::vector<NodeInfo>> local_nodes_; // nodes_ 的只读副本, 供 List 兜底
+    std::shared_ptr<const NodeSnapshot> all_nodes_; // 全部节点, 随 snapshot_ / nodes_ 一起更新
 };
 
 } // namespace registry
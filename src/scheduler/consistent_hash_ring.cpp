@@ -0,0 +1,71 @@
+#include "scheduler/consistent_hash_ring.hpp"
+
+#include <algorithm>
+
+namespace meeting {
+namespace scheduler {
+
+ConsistentHashRing::ConsistentHashRing(std::vector<meeting::registry::NodeInfo> nodes, std::size_t virtual_nodes)
+    : members_(std::move(nodes)) {
+    std::sort(members_.begin(), members_.end(), [](const auto& a, const auto& b) {
+        return NodeKey(a) < NodeKey(b);
+    });
+    members_.erase(std::unique(members_.begin(), members_.end(), [](const auto& a, const auto& b) {
+        return NodeKey(a) == NodeKey(b);
+    }), members_.end());
+
+    virtual_nodes = std::max<std::size_t>(virtual_nodes, 1);
+    points_.reserve(members_.size() * virtual_nodes);
+    for (std::size_t i = 0; i < members_.size(); ++i) {
+        const auto key = NodeKey(members_[i]) + "#";
+        for (std::size_t v = 0; v < virtual_nodes; ++v) {
+            points_.emplace_back(Hash(key + std::to_string(v)), static_cast<std::uint32_t>(i));
+        }
+    }
+    std::sort(points_.begin(), points_.end());
+}
+
+bool ConsistentHashRing::SameMembers(const std::vector<meeting::registry::NodeInfo>& sorted_nodes) const {
+    if (sorted_nodes.size() != members_.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < members_.size(); ++i) {
+        if (sorted_nodes[i].host != members_[i].host || sorted_nodes[i].port != members_[i].port) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::optional<std::size_t> ConsistentHashRing::Locate(std::string_view key) const {
+    if (points_.empty()) {
+        return std::nullopt;
+    }
+    auto it = std::lower_bound(points_.begin(), points_.end(), std::make_pair(Hash(key), std::uint32_t{0}));
+    if (it == points_.end()) {
+        it = points_.begin(); // 环回绕
+    }
+    return it->second;
+}
+
+std::string ConsistentHashRing::NodeKey(const meeting::registry::NodeInfo& node) {
+    return node.host + ":" + std::to_string(node.port);
+}
+
+std::uint64_t ConsistentHashRing::Hash(std::string_view data) {
+    std::uint64_t hash = 1469598103934665603ULL; // FNV offset basis
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ULL; // FNV prime
+    }
+    // splitmix64 末端混淆, 让相近的虚拟节点名在环上分散
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebULL;
+    hash ^= hash >> 31;
+    return hash;
+}
+
+} // namespace scheduler
+} // namespace meeting
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "registry/server_registry.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace meeting {
+namespace scheduler {
+
+// 带虚拟节点的一致性哈希环 (不可变, 成员变化时整体重建)
+// 以 meeting_id 为键定位会议的归属节点; 成员增删只影响相邻区间, 大部分会议归属保持不变
+class ConsistentHashRing {
+public:
+    static constexpr std::size_t kDefaultVirtualNodes = 160;
+
+    explicit ConsistentHashRing(std::vector<meeting::registry::NodeInfo> nodes
+                                , std::size_t virtual_nodes = kDefaultVirtualNodes);
+
+    bool Empty() const { return members_.empty(); }
+    // 成员节点, 按 NodeKey 排序
+    const std::vector<meeting::registry::NodeInfo>& Members() const { return members_; }
+    // 成员集合是否与给定节点列表 (已按 NodeKey 排序) 一致
+    bool SameMembers(const std::vector<meeting::registry::NodeInfo>& sorted_nodes) const;
+
+    // 返回 key 的归属节点在 Members() 中的下标
+    std::optional<std::size_t> Locate(std::string_view key) const;
+
+    // 节点在环上的标识 "host:port"
+    static std::string NodeKey(const meeting::registry::NodeInfo& node);
+    // 64 位哈希 (FNV-1a + 末端混淆), 跨进程/跨节点稳定
+    static std::uint64_t Hash(std::string_view data);
+
+private:
+    std::vector<meeting::registry::NodeInfo> members_;
+    // (哈希值, 成员下标), 按哈希值升序
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> points_;
+};
+
+} // namespace scheduler
+} // namespace meeting
@@ -0,0 +1,160 @@
+#include "scheduler/geo_index.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace meeting {
+namespace scheduler {
+
+namespace {
+
+constexpr double kEarthRadiusKm = 6371.0;
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kKmPerDegree = kEarthRadiusKm * kPi / 180.0;
+
+double ToRadians(double degrees) {
+    return degrees * kPi / 180.0;
+}
+
+// 将坐标量化为 kMaxLevel 位的网格下标
+std::uint32_t Quantize(double value, double min, double max) {
+    const double scale = static_cast<double>(1ULL << GeoIndex::kMaxLevel);
+    auto cell = static_cast<std::int64_t>((value - min) / (max - min) * scale);
+    return static_cast<std::uint32_t>(std::clamp<std::int64_t>(cell, 0, (1LL << GeoIndex::kMaxLevel) - 1));
+}
+
+// 交错两个 bits 位的整数: 纬度占奇数位, 经度占偶数位
+std::uint64_t Interleave(std::uint32_t lat, std::uint32_t lon, int bits) {
+    std::uint64_t result = 0;
+    for (int i = bits - 1; i >= 0; --i) {
+        result = (result << 1) | ((lon >> i) & 1U);
+        result = (result << 1) | ((lat >> i) & 1U);
+    }
+    return result;
+}
+
+} // namespace
+
+std::optional<GeoPoint> NodeLocation(const meeting::registry::NodeInfo& node) {
+    if (node.meta_json.empty()) {
+        return std::nullopt;
+    }
+    auto meta = nlohmann::json::parse(node.meta_json, nullptr, false);
+    if (meta.is_discarded() || !meta.is_object()) {
+        return std::nullopt;
+    }
+    auto lat = meta.find("latitude");
+    auto lon = meta.find("longitude");
+    if (lat == meta.end() || lon == meta.end() || !lat->is_number() || !lon->is_number()) {
+        return std::nullopt;
+    }
+    GeoPoint point{lat->get<double>(), lon->get<double>()};
+    if (point.latitude < -90.0 || point.latitude > 90.0 || point.longitude < -180.0 || point.longitude > 180.0) {
+        return std::nullopt;
+    }
+    return point;
+}
+
+double DistanceKm(const GeoPoint& a, const GeoPoint& b) {
+    const double dlat = ToRadians(b.latitude - a.latitude);
+    const double dlon = ToRadians(b.longitude - a.longitude);
+    const double h = std::sin(dlat / 2) * std::sin(dlat / 2)
+                   + std::cos(ToRadians(a.latitude)) * std::cos(ToRadians(b.latitude))
+                   * std::sin(dlon / 2) * std::sin(dlon / 2);
+    return 2.0 * kEarthRadiusKm * std::asin(std::min(1.0, std::sqrt(h)));
+}
+
+GeoIndex::GeoIndex(const std::vector<meeting::registry::NodeInfo>& nodes) {
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        auto point = NodeLocation(nodes[i]);
+        if (point.has_value()) {
+            entries_.push_back(Entry{Encode(*point), static_cast<std::uint32_t>(i), *point});
+        }
+    }
+    std::sort(entries_.begin(), entries_.end(), [](const Entry& a, const Entry& b) { return a.hash < b.hash; });
+}
+
+std::uint64_t GeoIndex::Encode(const GeoPoint& point) {
+    return Interleave(Quantize(point.latitude, -90.0, 90.0), Quantize(point.longitude, -180.0, 180.0), kMaxLevel);
+}
+
+void GeoIndex::CollectCell(int level, std::int64_t lat_cell, std::int64_t lon_cell,
+                           const std::function<bool(std::size_t)>& accept, std::vector<const Entry*>* out) const {
+    const int shift = 2 * (kMaxLevel - level);
+    const std::uint64_t prefix = Interleave(static_cast<std::uint32_t>(lat_cell), static_cast<std::uint32_t>(lon_cell), level);
+    const std::uint64_t lo = prefix << shift;
+    const std::uint64_t hi = lo + (1ULL << shift);
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), lo,
+                               [](const Entry& e, std::uint64_t value) { return e.hash < value; });
+    for (; it != entries_.end() && it->hash < hi; ++it) {
+        if (!accept || accept(it->index)) {
+            out->push_back(&*it);
+        }
+    }
+}
+
+std::vector<std::size_t> GeoIndex::Nearest(const GeoPoint& point, std::size_t n,
+                                           const std::function<bool(std::size_t)>& accept) const {
+    std::vector<std::size_t> result;
+    if (entries_.empty() || n == 0) {
+        return result;
+    }
+    n = std::min(n, entries_.size());
+    const std::uint32_t lat_full = Quantize(point.latitude, -90.0, 90.0);
+    const std::uint32_t lon_full = Quantize(point.longitude, -180.0, 180.0);
+
+    std::vector<const Entry*> candidates;
+    std::vector<std::pair<double, const Entry*>> ranked;
+    for (int level = kStartLevel; level >= 0; --level) {
+        const std::int64_t cells = 1LL << level;
+        const std::int64_t lat_cell = lat_full >> (kMaxLevel - level);
+        const std::int64_t lon_cell = lon_full >> (kMaxLevel - level);
+
+        // 目标网格及 8 个邻格: 经度方向环绕, 纬度方向截断, 重复网格只查一次
+        candidates.clear();
+        std::vector<std::pair<std::int64_t, std::int64_t>> visited;
+        for (std::int64_t dlat = -1; dlat <= 1; ++dlat) {
+            const std::int64_t lat = lat_cell + dlat;
+            if (lat < 0 || lat >= cells) {
+                continue;
+            }
+            for (std::int64_t dlon = -1; dlon <= 1; ++dlon) {
+                const std::int64_t lon = (lon_cell + dlon + cells) % cells;
+                if (std::find(visited.begin(), visited.end(), std::make_pair(lat, lon)) != visited.end()) {
+                    continue;
+                }
+                visited.emplace_back(lat, lon);
+                CollectCell(level, lat, lon, accept, &candidates);
+            }
+        }
+        if (candidates.size() < n && level > 0) {
+            continue;
+        }
+
+        ranked.clear();
+        for (const auto* e : candidates) {
+            ranked.emplace_back(DistanceKm(point, e->point), e);
+        }
+        std::sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        // 邻域保证覆盖的半径: 距离不超过一个网格宽度的节点必然落在 3x3 邻域内
+        const double cell_lat_deg = 180.0 / static_cast<double>(cells);
+        const double cell_lon_deg = 360.0 / static_cast<double>(cells);
+        const double worst_lat = std::min(90.0, std::fabs(point.latitude) + cell_lat_deg);
+        const double covered_km = std::min(cell_lat_deg * kKmPerDegree,
+                                           cell_lon_deg * kKmPerDegree * std::cos(ToRadians(worst_lat)));
+        if (level == 0 || ranked[n - 1].first <= covered_km) {
+            result.reserve(n);
+            for (std::size_t i = 0; i < n && i < ranked.size(); ++i) {
+                result.push_back(ranked[i].second->index);
+            }
+            return result;
+        }
+    }
+    return result;
+}
+
+} // namespace scheduler
+} // namespace meeting
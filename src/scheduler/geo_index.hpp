@@ -0,0 +1,63 @@
+#pragma once
+
+#include "registry/server_registry.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace meeting {
+namespace scheduler {
+
+struct GeoPoint {
+    double latitude = 0.0;
+    double longitude = 0.0;
+};
+
+// 从 NodeInfo::meta_json 中读取节点坐标 {"latitude": .., "longitude": ..}, 缺失或非法时返回空
+std::optional<GeoPoint> NodeLocation(const meeting::registry::NodeInfo& node);
+// 球面距离 (haversine), 单位千米
+double DistanceKm(const GeoPoint& a, const GeoPoint& b);
+
+// 基于 geohash 网格的节点空间索引 (不可变, 节点或坐标变化时整体重建; 权重与负载不参与索引)
+// 节点按 52 位 geohash 排序, 同一网格的节点在数组中连续;
+// 查询时从细到粗逐级检查目标所在网格及其 8 个邻格, 每个网格一次二分查找
+class GeoIndex {
+public:
+    static constexpr int kMaxLevel = 26;   // 每个维度的最大位数
+    static constexpr int kStartLevel = 12; // 查询起始精度 (约 5km 网格)
+
+    // nodes 中带坐标的节点进入索引
+    explicit GeoIndex(const std::vector<meeting::registry::NodeInfo>& nodes);
+
+    // 已索引的节点数
+    std::size_t Size() const { return entries_.size(); }
+
+    // 返回距离 point 最近的至多 n 个节点在构建列表中的下标, 按距离升序;
+    // accept 非空时只考虑 accept(下标) 为 true 的节点 (如按当前权重过滤摘除的节点)
+    std::vector<std::size_t> Nearest(const GeoPoint& point, std::size_t n,
+                                     const std::function<bool(std::size_t)>& accept = nullptr) const;
+
+    // 完整精度的 geohash (纬度/经度各 kMaxLevel 位交错)
+    static std::uint64_t Encode(const GeoPoint& point);
+
+private:
+    struct Entry {
+        std::uint64_t hash;
+        std::uint32_t index; // 构建列表中的下标
+        GeoPoint point;
+    };
+
+    // 收集 level 精度下 (lat_cell, lon_cell) 网格内被 accept 接受的节点
+    void CollectCell(int level, std::int64_t lat_cell, std::int64_t lon_cell,
+                     const std::function<bool(std::size_t)>& accept, std::vector<const Entry*>* out) const;
+
+private:
+    std::vector<Entry> entries_; // 按 hash 升序
+};
+
+} // namespace scheduler
+} // namespace meeting
@@ -1,22 +1,221 @@
 #include "scheduler/load_balancer.hpp"
 
+#include <algorithm>
+#include <random>
+
 namespace meeting {
 namespace scheduler {
 
-LoadBalancer::LoadBalancer(std::shared_ptr<meeting::registry::ServerRegistry> registry)
-    : registry_(std::move(registry)) {}
+namespace {
+
+std::uint64_t RandomIndex(std::uint64_t bound) {
+    static thread_local std::mt19937_64 rng(std::random_device{}());
+    return std::uniform_int_distribution<std::uint64_t>(0, bound - 1)(rng);
+}
+
+} // namespace
+
+std::optional<SelectionStrategy> ParseSelectionStrategy(const std::string& name) {
+    if (name == "weighted_round_robin") {
+        return SelectionStrategy::kWeightedRoundRobin;
+    }
+    if (name == "power_of_two") {
+        return SelectionStrategy::kPowerOfTwoChoices;
+    }
+    if (name == "least_loaded") {
+        return SelectionStrategy::kLeastLoaded;
+    }
+    return std::nullopt;
+}
+
+LoadBalancer::LoadBalancer(std::shared_ptr<meeting::registry::ServerRegistry> registry
+                           , SelectionStrategy strategy
+                           , AffinityOptions affinity
+                           , std::size_t nearest_n)
+    : registry_(std::move(registry))
+    , strategy_(strategy)
+    , affinity_(affinity)
+    , nearest_n_(nearest_n) {}
 
 std::optional<meeting::registry::NodeInfo> LoadBalancer::Select(const meeting::geo::GeoInfo& geo) const {
     if (!registry_) {
         return std::nullopt;
     }
-    auto nodes = registry_->List(geo.region.empty() ? "default" : geo.region); // 先尝试同 region
+    // GeoInfo 未携带坐标时经纬度均为 0, 私有地址同样没有位置信息
+    const bool has_location = !geo.is_private && (geo.latitude != 0.0 || geo.longitude != 0.0);
+    if (nearest_n_ > 0 && has_location) {
+        auto snapshot = registry_->SnapshotAll();
+        auto nearest = PickNearestIn(GeoPoint{geo.latitude, geo.longitude}, snapshot->nodes, *GeoIndexFor(*snapshot));
+        if (nearest.has_value()) {
+            return nearest;
+        }
+    }
+    auto nodes = registry_->List(geo.region.empty() ? std::string("default") : std::string(geo.region)); // 先尝试同 region
+    return Pick(nodes);
+}
+
+std::optional<meeting::registry::NodeInfo> LoadBalancer::Pick(const std::vector<meeting::registry::NodeInfo>& nodes) const {
     if (nodes.empty()) {
         return std::nullopt;
     }
-    // 简单策略：取首个
-    return nodes.front();
+    // 过滤权重为 0 的节点; 若全部为 0 则退化为全部候选
+    std::vector<const meeting::registry::NodeInfo*> candidates;
+    candidates.reserve(nodes.size());
+    for (const auto& n : nodes) {
+        if (n.weight > 0) {
+            candidates.push_back(&n);
+        }
+    }
+    if (candidates.empty()) {
+        for (const auto& n : nodes) {
+            candidates.push_back(&n);
+        }
+    }
+
+    std::size_t index = 0;
+    switch (strategy_) {
+        case SelectionStrategy::kWeightedRoundRobin:
+            index = PickWeightedRoundRobin(candidates);
+            break;
+        case SelectionStrategy::kPowerOfTwoChoices:
+            index = PickPowerOfTwo(candidates);
+            break;
+        case SelectionStrategy::kLeastLoaded:
+            index = PickLeastLoaded(candidates);
+            break;
+    }
+    return *candidates[index];
+}
+
+std::optional<meeting::registry::NodeInfo> LoadBalancer::SelectForMeeting(const std::string& meeting_id) const {
+    if (!registry_) {
+        return std::nullopt;
+    }
+    // 归属节点与客户端位置无关, 不同 region 的参与者必须落在同一节点
+    auto snapshot = registry_->SnapshotAll();
+    return PickForMeeting(meeting_id, snapshot->nodes);
+}
+
+std::optional<meeting::registry::NodeInfo> LoadBalancer::PickForMeeting(
+    const std::string& meeting_id, const std::vector<meeting::registry::NodeInfo>& nodes) const {
+    std::vector<meeting::registry::NodeInfo> members;
+    members.reserve(nodes.size());
+    for (const auto& n : nodes) {
+        if (n.weight > 0) {
+            members.push_back(n);
+        }
+    }
+    if (members.empty()) {
+        members = nodes; // 全部被摘除时退化为全部节点, 仍按哈希环确定归属
+    }
+    if (members.empty()) {
+        return std::nullopt;
+    }
+    std::sort(members.begin(), members.end(), [](const auto& a, const auto& b) {
+        return ConsistentHashRing::NodeKey(a) < ConsistentHashRing::NodeKey(b);
+    });
+    members.erase(std::unique(members.begin(), members.end(), [](const auto& a, const auto& b) {
+        return a.host == b.host && a.port == b.port;
+    }), members.end());
+
+    // 只用各节点一致的输入 (成员集合与 meeting_id) 定位, 不看负载也不记录归属,
+    // 因此任一节点对同一会议算出的归属相同, 无需跨节点同步
+    auto index = RingFor(members)->Locate(meeting_id);
+    if (!index.has_value()) {
+        return std::nullopt;
+    }
+    return members[*index];
+}
+
+std::optional<meeting::registry::NodeInfo> LoadBalancer::PickNearest(
+    const GeoPoint& point, const std::vector<meeting::registry::NodeInfo>& nodes) const {
+    // 显式给定的候选列表不缓存索引
+    return PickNearestIn(point, nodes, GeoIndex(nodes));
+}
+
+std::optional<meeting::registry::NodeInfo> LoadBalancer::PickNearestIn(
+    const GeoPoint& point, const std::vector<meeting::registry::NodeInfo>& nodes, const GeoIndex& index) const {
+    // 索引包含权重为 0 的节点, 查询时按当前权重过滤
+    auto nearest = index.Nearest(point, std::max<std::size_t>(nearest_n_, 1),
+                                 [&nodes](std::size_t i) { return nodes[i].weight > 0; });
+    if (nearest.empty()) {
+        return std::nullopt;
+    }
+    std::vector<meeting::registry::NodeInfo> candidates;
+    candidates.reserve(nearest.size());
+    for (auto i : nearest) {
+        candidates.push_back(nodes[i]);
+    }
+    return Pick(candidates);
+}
+
+std::shared_ptr<const GeoIndex> LoadBalancer::GeoIndexFor(const meeting::registry::NodeSnapshot& snapshot) const {
+    auto cached = std::atomic_load(&geo_index_);
+    if (cached && cached->layout_version == snapshot.layout_version) {
+        return cached->index;
+    }
+    // 版本变化后并发请求可能各自重建一次, 结果相同, 以最后写入者为准
+    auto next = std::make_shared<const CachedGeoIndex>(
+        CachedGeoIndex{snapshot.layout_version, std::make_shared<const GeoIndex>(snapshot.nodes)});
+    std::atomic_store(&geo_index_, next);
+    return next->index;
+}
+
+std::shared_ptr<const ConsistentHashRing> LoadBalancer::RingFor(
+    const std::vector<meeting::registry::NodeInfo>& sorted_nodes) const {
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    if (!ring_ || !ring_->SameMembers(sorted_nodes)) {
+        ring_ = std::make_shared<const ConsistentHashRing>(sorted_nodes, affinity_.virtual_nodes);
+    }
+    return ring_;
+}
+
+double LoadBalancer::LoadScore(const meeting::registry::NodeInfo& node) {
+    const double weight = static_cast<double>(std::max(node.weight, 1));
+    const double work = 1.0 + static_cast<double>(node.load.participants) + static_cast<double>(node.load.active_meetings);
+    return work * (1.0 + std::clamp(node.load.busy_ratio, 0.0, 1.0)) / weight;
+}
+
+std::size_t LoadBalancer::PickWeightedRoundRobin(const std::vector<const meeting::registry::NodeInfo*>& nodes) const {
+    std::uint64_t total = 0;
+    for (const auto* n : nodes) {
+        total += static_cast<std::uint64_t>(std::max(n->weight, 1));
+    }
+    std::uint64_t slot = rr_cursor_.fetch_add(1, std::memory_order_relaxed) % total;
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        const auto w = static_cast<std::uint64_t>(std::max(nodes[i]->weight, 1));
+        if (slot < w) {
+            return i;
+        }
+        slot -= w;
+    }
+    return nodes.size() - 1;
+}
+
+std::size_t LoadBalancer::PickPowerOfTwo(const std::vector<const meeting::registry::NodeInfo*>& nodes) const {
+    if (nodes.size() == 1) {
+        return 0;
+    }
+    const auto first = static_cast<std::size_t>(RandomIndex(nodes.size()));
+    auto second = static_cast<std::size_t>(RandomIndex(nodes.size() - 1));
+    if (second >= first) {
+        ++second;
+    }
+    return LoadScore(*nodes[second]) < LoadScore(*nodes[first]) ? second : first;
+}
+
+std::size_t LoadBalancer::PickLeastLoaded(const std::vector<const meeting::registry::NodeInfo*>& nodes) const {
+    std::size_t best = 0;
+    double best_score = LoadScore(*nodes[0]);
+    for (std::size_t i = 1; i < nodes.size(); ++i) {
+        const double score = LoadScore(*nodes[i]);
+        if (score < best_score) {
+            best = i;
+            best_score = score;
+        }
+    }
+    return best;
 }
 
 } // namespace scheduler
-} // namespace meeting
\ No newline at end of file
+} // namespace meeting
@@ -2,8 +2,13 @@
 
 #include "registry/server_registry.hpp"
 #include "geo/geo_location_service.hpp"
+#include "scheduler/consistent_hash_ring.hpp"
+#include "scheduler/geo_index.hpp"
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <vector>
 #include <string>
@@ -11,19 +16,94 @@
 namespace meeting{
 namespace scheduler {
 
-// 负载均衡器，根据地理位置选择合适的服务器节点
+// 节点选择策略
+enum class SelectionStrategy {
+    kWeightedRoundRobin, // 按权重轮询
+    kPowerOfTwoChoices,  // 随机取两个节点, 选负载较低者
+    kLeastLoaded,        // 选择负载评分最低的节点
+};
+
+// 解析策略名称 ("weighted_round_robin" | "power_of_two" | "least_loaded")
+std::optional<SelectionStrategy> ParseSelectionStrategy(const std::string& name);
+
+// 会议亲和 (一致性哈希) 参数
+struct AffinityOptions {
+    std::size_t virtual_nodes = ConsistentHashRing::kDefaultVirtualNodes; // 每个节点的虚拟节点数
+};
+
+// 负载均衡器，根据地理位置与节点负载选择合适的服务器节点
 class LoadBalancer {
 public:
-    // 构造函数，传入服务器注册中心的共享指针
-    explicit LoadBalancer(std::shared_ptr<meeting::registry::ServerRegistry> registry);
+    // 构造函数，传入服务器注册中心的共享指针与选择策略
+    // nearest_n > 0 时开启就近选择: 跨 region 取距客户端最近的 nearest_n 个节点, 再按策略选择
+    explicit LoadBalancer(std::shared_ptr<meeting::registry::ServerRegistry> registry
+                          , SelectionStrategy strategy = SelectionStrategy::kWeightedRoundRobin
+                          , AffinityOptions affinity = {}
+                          , std::size_t nearest_n = 0);
 
     // 根据地理位置选择合适的服务器节点
+    // 客户端坐标已知且存在带坐标的节点时就近选择, 否则按 region 匹配
     std::optional<meeting::registry::NodeInfo> Select(const meeting::geo::GeoInfo& geo) const;
 
+    // 在候选节点中取距 point 最近的 nearest_n 个节点, 再按策略选择; 无带坐标节点时返回空
+    std::optional<meeting::registry::NodeInfo> PickNearest(const GeoPoint& point
+                                                           , const std::vector<meeting::registry::NodeInfo>& nodes) const;
+
+    // 按会议选择归属节点: 全部节点组成一个哈希环, 与客户端所在 region 无关,
+    // 同一会议的参与者落在同一节点, 成员变化时仅少量会议迁移
+    std::optional<meeting::registry::NodeInfo> SelectForMeeting(const std::string& meeting_id) const;
+
+    // 在候选节点中选择会议归属节点, 权重为 0 的节点不参与
+    // 结果只取决于成员集合与 meeting_id, 与负载及本进程历史无关: 看到相同成员的节点总是选出同一归属
+    std::optional<meeting::registry::NodeInfo> PickForMeeting(const std::string& meeting_id
+                                                              , const std::vector<meeting::registry::NodeInfo>& nodes) const;
+
+    // 在候选节点中按策略选择一个节点, 权重为 0 的节点视为摘除流量
+    std::optional<meeting::registry::NodeInfo> Pick(const std::vector<meeting::registry::NodeInfo>& nodes) const;
+
+    SelectionStrategy Strategy() const { return strategy_; }
+
+    // 节点负载评分 (越小越空闲), 按权重归一化
+    static double LoadScore(const meeting::registry::NodeInfo& node);
+
+private:
+    std::size_t PickWeightedRoundRobin(const std::vector<const meeting::registry::NodeInfo*>& nodes) const;
+    std::size_t PickPowerOfTwo(const std::vector<const meeting::registry::NodeInfo*>& nodes) const;
+    std::size_t PickLeastLoaded(const std::vector<const meeting::registry::NodeInfo*>& nodes) const;
+    // 在 index 给出的最近节点中按策略选择, 权重为 0 的节点不参与
+    std::optional<meeting::registry::NodeInfo> PickNearestIn(const GeoPoint& point
+                                                             , const std::vector<meeting::registry::NodeInfo>& nodes
+                                                             , const GeoIndex& index) const;
+    // 按注册中心快照的 layout_version 缓存空间索引:
+    // 只有节点集合或坐标变化时重建一次, 负载与权重上报不触发重建, 读取路径不加锁
+    std::shared_ptr<const GeoIndex> GeoIndexFor(const meeting::registry::NodeSnapshot& snapshot) const;
+    // 获取与当前成员一致的哈希环, 成员变化时重建
+    std::shared_ptr<const ConsistentHashRing> RingFor(const std::vector<meeting::registry::NodeInfo>& sorted_nodes) const;
+
 private:
     // 服务器注册中心
     std::shared_ptr<meeting::registry::ServerRegistry> registry_;
+    // 选择策略
+    SelectionStrategy strategy_;
+    // 轮询游标
+    mutable std::atomic<std::uint64_t> rr_cursor_{0};
+    // 会议亲和参数
+    AffinityOptions affinity_;
+    // 就近选择的候选数 (0 表示关闭)
+    std::size_t nearest_n_;
+    // 保护哈希环
+    mutable std::mutex index_mutex_;
+    // 全部节点的哈希环
+    mutable std::shared_ptr<const ConsistentHashRing> ring_;
+
+    // 某一 layout_version 下全部节点的空间索引
+    struct CachedGeoIndex {
+        std::uint64_t layout_version = 0;
+        std::shared_ptr<const GeoIndex> index;
+    };
+    // 通过 std::atomic_load / std::atomic_store 读写
+    mutable std::shared_ptr<const CachedGeoIndex> geo_index_;
 };
 
 } // namespace scheduler
-} // namespace meeting
\ No newline at end of file
+} // namespace meeting
@@ -1,13 +1,18 @@
 #include "common/config_loader.hpp"
 #include "common/logger.hpp"
 #include "core/meeting/meeting_manager.hpp"
+#include "server/meeting_callback_service.hpp"
 #include "server/meeting_service_impl.hpp"
+#include "server/user_callback_service.hpp"
 #include "server/user_service_impl.hpp"
+#include "thread_pool/config.hpp"
+#include "thread_pool/thread_pool.hpp"
 
 #include <cstdlib>
 #include <csignal>
 #include <chrono>
 #include <grpcpp/grpcpp.h>
+#include <memory>
 #include <thread>
 
 namespace {
@@ -41,14 +46,40 @@ int main(int argc, char** argv) {
     meeting::common::InitLogger(config.logging);
     MEETING_LOG_INFO("Meeting server starting with config {}", config_path);
 
-    meeting::server::UserServiceImpl user_service(config.thread_pool.config_path);
-    meeting::server::MeetingServiceImpl meeting_service(config.thread_pool.config_path);
+    // 两个服务共享一个线程池, 由 lanes 配置划分通道 (权重 + 预留工作线程), 互不挤占
+    auto pool_config = thread_pool::ThreadPoolConfigLoader::FromFile(config.thread_pool.config_path);
+    thread_pool::ThreadPool thread_pool(pool_config ? pool_config->GetConfig() : thread_pool::ThreadPoolConfig{});
+    thread_pool.Start();
+
+    std::unique_ptr<meeting::server::UserServiceImpl> user_service;
+    std::unique_ptr<meeting::server::MeetingServiceImpl> meeting_service;
+    try {
+        user_service = std::make_unique<meeting::server::UserServiceImpl>(thread_pool);
+        meeting_service = std::make_unique<meeting::server::MeetingServiceImpl>(thread_pool);
+    } catch (const std::exception& ex) {
+        MEETING_LOG_ERROR("Failed to start services: {}", ex.what());
+        user_service.reset();
+        thread_pool.Stop();
+        meeting::common::ShutdownLogger();
+        return EXIT_FAILURE;
+    }
 
     grpc::ServerBuilder builder;
     std::string address = config.server.host + ":" + std::to_string(config.server.port);
     builder.AddListeningPort(address, grpc::InsecureServerCredentials());
-    builder.RegisterService(&user_service);
-    builder.RegisterService(&meeting_service);
+    // 回调模式: gRPC 线程只投递请求, 由线程池工作线程完成 RPC
+    std::unique_ptr<meeting::server::UserCallbackService> user_callback_service;
+    std::unique_ptr<meeting::server::MeetingCallbackService> meeting_callback_service;
+    if (config.server.rpc_mode == "callback") {
+        user_callback_service = std::make_unique<meeting::server::UserCallbackService>(*user_service);
+        meeting_callback_service = std::make_unique<meeting::server::MeetingCallbackService>(*meeting_service);
+        builder.RegisterService(user_callback_service.get());
+        builder.RegisterService(meeting_callback_service.get());
+    } else {
+        builder.RegisterService(user_service.get());
+        builder.RegisterService(meeting_service.get());
+    }
+    MEETING_LOG_INFO("RPC mode: {}", config.server.rpc_mode);
 
     std::unique_ptr<grpc::Server> server(builder.BuildAndStart());
     if (!server) {
@@ -71,6 +102,14 @@ int main(int argc, char** argv) {
 
     server->Wait();
     shutdown_thread.join();
+    // 先销毁 gRPC 服务器与服务对象, 再停止共享线程池: 请求已全部完成, 而会议管理器析构时
+    // 要借助仍在运行的线程池写完邮箱中未落库的变更; 日志最后关闭, 析构过程中仍可记录
+    server.reset();
+    meeting_callback_service.reset();
+    user_callback_service.reset();
+    meeting_service.reset();
+    user_service.reset();
+    thread_pool.Stop();
     meeting::common::ShutdownLogger();
     return EXIT_SUCCESS;
 }
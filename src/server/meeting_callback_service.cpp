@@ -0,0 +1,50 @@
+#include "server/meeting_callback_service.hpp"
+#include "server/rpc_dispatch.hpp"
+
+namespace meeting {
+namespace server {
+
+MeetingCallbackService::MeetingCallbackService(MeetingServiceImpl& impl) : impl_(impl) {}
+
+grpc::ServerUnaryReactor* MeetingCallbackService::CreateMeeting(grpc::CallbackServerContext* context
+                                                                , const proto::meeting::CreateMeetingRequest* request
+                                                                , proto::meeting::CreateMeetingResponse* response) {
+    return DispatchToPool(impl_.thread_pool_, impl_.lane_, context, [this, context, request, response]() {
+        return impl_.HandleCreateMeeting(context, request, response);
+    });
+}
+
+grpc::ServerUnaryReactor* MeetingCallbackService::JoinMeeting(grpc::CallbackServerContext* context
+                                                              , const proto::meeting::JoinMeetingRequest* request
+                                                              , proto::meeting::JoinMeetingResponse* response) {
+    return DispatchToPool(impl_.thread_pool_, impl_.lane_, context, [this, context, request, response]() {
+        return impl_.HandleJoinMeeting(context, request, response);
+    });
+}
+
+grpc::ServerUnaryReactor* MeetingCallbackService::LeaveMeeting(grpc::CallbackServerContext* context
+                                                               , const proto::meeting::LeaveMeetingRequest* request
+                                                               , proto::meeting::LeaveMeetingResponse* response) {
+    return DispatchToPool(impl_.thread_pool_, impl_.lane_, context, [this, context, request, response]() {
+        return impl_.HandleLeaveMeeting(context, request, response);
+    });
+}
+
+grpc::ServerUnaryReactor* MeetingCallbackService::EndMeeting(grpc::CallbackServerContext* context
+                                                             , const proto::meeting::EndMeetingRequest* request
+                                                             , proto::meeting::EndMeetingResponse* response) {
+    return DispatchToPool(impl_.thread_pool_, impl_.lane_, context, [this, context, request, response]() {
+        return impl_.HandleEndMeeting(context, request, response);
+    });
+}
+
+grpc::ServerUnaryReactor* MeetingCallbackService::GetMeeting(grpc::CallbackServerContext* context
+                                                             , const proto::meeting::GetMeetingRequest* request
+                                                             , proto::meeting::GetMeetingResponse* response) {
+    return DispatchToPool(impl_.thread_pool_, impl_.lane_, context, [this, context, request, response]() {
+        return impl_.HandleGetMeeting(context, request, response);
+    });
+}
+
+} // namespace server
+} // namespace meeting
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "server/meeting_service_impl.hpp"
+
+#include "meeting_service.grpc.pb.h"
+
+#include <grpcpp/grpcpp.h>
+
+namespace meeting {
+namespace server {
+
+// 回调(异步)模式的会议服务
+// gRPC 回调线程只负责把请求投递到线程池, 由工作线程执行业务并 Finish, 不占用 gRPC 线程等待
+class MeetingCallbackService final : public proto::meeting::MeetingService::CallbackService {
+public:
+    explicit MeetingCallbackService(MeetingServiceImpl& impl);
+
+    grpc::ServerUnaryReactor* CreateMeeting(grpc::CallbackServerContext* context
+                                            , const proto::meeting::CreateMeetingRequest* request
+                                            , proto::meeting::CreateMeetingResponse* response) override;
+
+    grpc::ServerUnaryReactor* JoinMeeting(grpc::CallbackServerContext* context
+                                          , const proto::meeting::JoinMeetingRequest* request
+                                          , proto::meeting::JoinMeetingResponse* response) override;
+
+    grpc::ServerUnaryReactor* LeaveMeeting(grpc::CallbackServerContext* context
+                                           , const proto::meeting::LeaveMeetingRequest* request
+                                           , proto::meeting::LeaveMeetingResponse* response) override;
+
+    grpc::ServerUnaryReactor* EndMeeting(grpc::CallbackServerContext* context
+                                         , const proto::meeting::EndMeetingRequest* request
+                                         , proto::meeting::EndMeetingResponse* response) override;
+
+    grpc::ServerUnaryReactor* GetMeeting(grpc::CallbackServerContext* context
+                                         , const proto::meeting::GetMeetingRequest* request
+                                         , proto::meeting::GetMeetingResponse* response) override;
+
+private:
+    MeetingServiceImpl& impl_; // 业务实现 (持有线程池与管理器)
+};
+
+} // namespace server
+} // namespace meeting
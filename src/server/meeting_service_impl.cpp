@@ -16,8 +16,11 @@
 #include "scheduler/load_balancer.hpp"
 #include "geo/geo_location_service.hpp"
 
+#include <nlohmann/json.hpp>
+
 #include <charconv>
 #include <chrono>
+#include <stdexcept>
 #include <system_error>
 #include <optional>
 #include <string_view>
@@ -26,12 +29,15 @@ namespace server {
 
 namespace {
 
-thread_pool::ThreadPool CreateThreadPool(const std::string& config_path) {
+// 会议请求所在的线程池通道 (thread_pool.json 的 lanes)
+constexpr std::string_view kMeetingLane = "meeting";
+
+std::unique_ptr<thread_pool::ThreadPool> CreateThreadPool(const std::string& config_path) {
     auto loader = thread_pool::ThreadPoolConfigLoader::FromFile(config_path);
     if (loader.has_value()) {
-        return thread_pool::ThreadPool(loader->GetConfig());
+        return std::make_unique<thread_pool::ThreadPool>(loader->GetConfig());
     }
-    return thread_pool::ThreadPool(4, 1024);
+    return std::make_unique<thread_pool::ThreadPool>(4, 1024);
 }
 
 // 根据配置创建Redis客户端
@@ -49,6 +55,16 @@ std::shared_ptr<meeting::cache::RedisClient> CreateRedisClient() {
     return client;
 }
 
+// 根据配置选择会议命令的执行方式
+meeting::core::MeetingConfig CreateMeetingConfig() {
+    const auto& config = meeting::common::GlobalConfig();
+    meeting::core::MeetingConfig meeting_config;
+    meeting_config.serialize_per_meeting = config.meeting.execution == "mailbox";
+    meeting_config.mailbox_count = static_cast<std::size_t>(config.meeting.mailboxes);
+    meeting_config.mailbox_idle_ttl = std::chrono::milliseconds(config.meeting.idle_ttl_ms);
+    return meeting_config;
+}
+
 // 根据配置创建会议存储库
 std::shared_ptr<meeting::core::MeetingRepository> CreateMeetingRepository(
     const std::shared_ptr<meeting::cache::RedisClient>& redis) {
@@ -201,7 +217,7 @@ std::string ExtractIpFromPeer(const std::string& peer) {
     return StripBrackets(sv.substr(0, pos_port));
 }
 
-std::string ExtractClientIp(const grpc::ServerContext* context, const proto::meeting::JoinMeetingRequest* request) {
+std::string ExtractClientIp(const grpc::ServerContextBase* context, const proto::meeting::JoinMeetingRequest* request) {
     auto decode_brackets = [](std::string ip) {
         auto replace_all = [](std::string& target, std::string_view from, std::string_view to) {
             std::size_t pos = 0;
@@ -225,22 +241,55 @@ std::string ExtractClientIp(const grpc::ServerContext* context, const proto::mee
     return {};
 }
 
-// 选择合适的会议服务节点
+// 根据配置创建 GeoIP 服务 (含查询缓存)
+std::shared_ptr<meeting::geo::GeoLocationService> CreateGeoService() {
+    const auto& geoip = meeting::common::GlobalConfig().geoip;
+    meeting::geo::GeoCacheOptions cache;
+    cache.capacity = geoip.cache_capacity;
+    cache.shards = geoip.cache_shards;
+    cache.ttl = std::chrono::seconds(geoip.cache_ttl_seconds);
+    auto service = std::make_shared<meeting::geo::GeoLocationService>(geoip.db_path, cache);
+    // 周期检查数据库文件, 更新后在后台热替换
+    service->StartWatching(std::chrono::seconds(geoip.reload_interval_seconds));
+    return service;
+}
+
+// 根据配置创建负载均衡器
+std::shared_ptr<meeting::scheduler::LoadBalancer> CreateLoadBalancer(
+    const std::shared_ptr<meeting::registry::ServerRegistry>& registry) {
+    const auto& config = meeting::common::GlobalConfig();
+    auto strategy = meeting::scheduler::ParseSelectionStrategy(config.scheduler.strategy);
+    if (!strategy.has_value()) {
+        MEETING_LOG_WARN("[MeetingService] Unknown scheduler strategy {}, fallback to weighted_round_robin",
+                         config.scheduler.strategy);
+    }
+    meeting::scheduler::AffinityOptions affinity;
+    affinity.virtual_nodes = static_cast<std::size_t>(config.scheduler.virtual_nodes);
+    return std::make_shared<meeting::scheduler::LoadBalancer>(
+        registry, strategy.value_or(meeting::scheduler::SelectionStrategy::kWeightedRoundRobin), affinity,
+        static_cast<std::size_t>(config.scheduler.nearest_n));
+}
+
+// 选择合适的会议服务节点; meeting_id 非空且开启会议亲和时返回会议的归属节点
 meeting::registry::NodeInfo PickEndpoint(const meeting::scheduler::LoadBalancer* lb,
                                          const meeting::registry::NodeInfo& self_node,
                                          const meeting::geo::GeoLocationService* geo_service,
-                                         const std::string& client_ip) {
-    meeting::geo::GeoInfo geo; // 默认地理信息
-    if (geo_service && !client_ip.empty()) {
-        auto geo_res = geo_service->Lookup(client_ip);
-        if (geo_res.IsOk()) {
-            geo = geo_res.Value();
-        } else {
-            MEETING_LOG_WARN("[MeetingService] Geo lookup failed for {}: {}", client_ip, geo_res.GetStatus().Message());
-        }
-    }
+                                         const std::string& client_ip,
+                                         const std::string& meeting_id = {}) {
     std::optional<meeting::registry::NodeInfo> selected; // 选择的节点
-    if (lb) {
+    if (lb && !meeting_id.empty() && meeting::common::GlobalConfig().scheduler.meeting_affinity) {
+        // 会议归属与客户端位置无关, 无需 GeoIP 查询
+        selected = lb->SelectForMeeting(meeting_id);
+    } else if (lb) {
+        meeting::geo::GeoInfo geo; // 默认地理信息
+        if (geo_service && !client_ip.empty()) {
+            auto geo_res = geo_service->Lookup(client_ip);
+            if (geo_res.IsOk()) {
+                geo = geo_res.Value();
+            } else {
+                MEETING_LOG_WARN("[MeetingService] Geo lookup failed for {}: {}", client_ip, geo_res.GetStatus().Message());
+            }
+        }
         selected = lb->Select(geo);
     }
     if (selected.has_value()) {
@@ -254,21 +303,59 @@ meeting::registry::NodeInfo PickEndpoint(const meeting::scheduler::LoadBalancer*
 MeetingServiceImpl::MeetingServiceImpl(): MeetingServiceImpl(meeting::common::GetThreadPoolConfigPath()) {}
 
 MeetingServiceImpl::MeetingServiceImpl(const std::string& thread_pool_config_path)
+    : MeetingServiceImpl(CreateThreadPool(thread_pool_config_path), nullptr) {}
+
+MeetingServiceImpl::MeetingServiceImpl(thread_pool::ThreadPool& shared_pool)
+    : MeetingServiceImpl(nullptr, &shared_pool) {}
+
+MeetingServiceImpl::MeetingServiceImpl(std::unique_ptr<thread_pool::ThreadPool> owned_pool
+                                       , thread_pool::ThreadPool* shared_pool)
     : redis_client_(CreateRedisClient())
-    , meeting_manager_(std::make_unique<meeting::core::MeetingManager>(meeting::core::MeetingConfig{}, CreateMeetingRepository(redis_client_)))
+    , meeting_manager_(std::make_unique<meeting::core::MeetingManager>(CreateMeetingConfig(), CreateMeetingRepository(redis_client_)
+                                                                       , owned_pool ? owned_pool.get() : shared_pool))
     , session_repository_(CreateSessionRepository(redis_client_))
     , registry_(std::make_shared<meeting::registry::ServerRegistry>(meeting::common::GlobalConfig().zookeeper.hosts))
-    , load_balancer_(std::make_shared<meeting::scheduler::LoadBalancer>(registry_))
-    , geo_service_(std::make_shared<meeting::geo::GeoLocationService>(meeting::common::GlobalConfig().geoip.db_path))
+    , load_balancer_(CreateLoadBalancer(registry_))
+    , geo_service_(CreateGeoService())
     , self_node_()
-    , thread_pool_(CreateThreadPool(thread_pool_config_path)) {
+    , owned_thread_pool_(std::move(owned_pool))
+    , thread_pool_(owned_thread_pool_ ? *owned_thread_pool_ : *shared_pool)
+    , lane_(thread_pool_.FindLane(kMeetingLane)) {
 
-    thread_pool_.Start();
+    if (owned_thread_pool_) {
+        owned_thread_pool_->Start();
+    }
     self_node_.host = meeting::common::GlobalConfig().server.host;
     self_node_.port = meeting::common::GlobalConfig().server.port;
     self_node_.region = "default";
+    if (meeting::common::GlobalConfig().server.has_location) {
+        // 发布节点坐标, 供其他节点就近选择
+        nlohmann::json meta;
+        meta["latitude"] = meeting::common::GlobalConfig().server.latitude;
+        meta["longitude"] = meeting::common::GlobalConfig().server.longitude;
+        self_node_.meta_json = meta.dump();
+    }
+    if (meeting::common::GlobalConfig().meeting.execution == "mailbox") {
+        // 邮箱中的会议状态只在本进程内权威, 其他节点的写入不可见: 邮箱模式只支持单节点部署
+        for (const auto& node : registry_->ListAll()) {
+            if (node.host != self_node_.host || node.port != self_node_.port) {
+                MEETING_LOG_ERROR("[MeetingService] meeting.execution=mailbox is single-node only, but {}:{} is registered",
+                                  node.host, node.port);
+                throw std::runtime_error("meeting.execution=mailbox requires a single-node deployment");
+            }
+        }
+    }
     // 自注册当前节点
     registry_->Register(self_node_);
+    // 周期性发布本节点负载, 供其他节点的负载均衡器使用
+    registry_->SetLoadReporter([this]() {
+        auto meeting_load = meeting_manager_->GetLoad();
+        meeting::registry::NodeLoad load;
+        load.active_meetings = meeting_load.active_meetings;
+        load.participants = meeting_load.participants;
+        load.busy_ratio = thread_pool_.GetStatistics().statistic_busy_ratio;
+        return load;
+    }, std::chrono::milliseconds(meeting::common::GlobalConfig().scheduler.load_report_interval_ms));
 }
 
 
@@ -277,12 +364,61 @@ MeetingServiceImpl::~MeetingServiceImpl() {
         // 注销当前节点
         registry_->Unregister(self_node_);
     }
-    thread_pool_.Stop();
+    // 先停止注册中心 I/O 线程, 负载采集回调引用了本对象的成员
+    load_balancer_.reset();
+    registry_.reset();
+    // 会议管理器在线程池停止前销毁, 邮箱中未落库的变更在此写完: 自有线程池在下面停止,
+    // 共享线程池由调用方在本对象销毁后停止 (见 main)
+    meeting_manager_.reset();
+    if (owned_thread_pool_) {
+        owned_thread_pool_->Stop();
+    }
+}
+
+// 同步模式: 在线程池中执行处理函数并阻塞等待结果 (Completion 基于 futex 等待, 无 future 的锁与条件变量开销)
+template <typename Handler>
+grpc::Status MeetingServiceImpl::RunOnPool(Handler&& handler) {
+    try {
+        return thread_pool_.SubmitCompletionTo(lane_, std::forward<Handler>(handler)).Get();
+    } catch (const std::exception& ex) {
+        MEETING_LOG_ERROR("[MeetingService] Handler dispatch failed: {}", ex.what());
+        return {grpc::StatusCode::UNAVAILABLE, ex.what()};
+    }
 }
 
 grpc::Status MeetingServiceImpl::CreateMeeting(grpc::ServerContext* context
                                                 , const proto::meeting::CreateMeetingRequest* request
                                                 , proto::meeting::CreateMeetingResponse* response) {
+    return RunOnPool([&]() { return HandleCreateMeeting(context, request, response); });
+}
+
+grpc::Status MeetingServiceImpl::JoinMeeting(grpc::ServerContext* context
+                                              , const proto::meeting::JoinMeetingRequest* request
+                                              , proto::meeting::JoinMeetingResponse* response) {
+    return RunOnPool([&]() { return HandleJoinMeeting(context, request, response); });
+}
+
+grpc::Status MeetingServiceImpl::LeaveMeeting(grpc::ServerContext* context
+                                              , const proto::meeting::LeaveMeetingRequest* request
+                                              , proto::meeting::LeaveMeetingResponse* response) {
+    return RunOnPool([&]() { return HandleLeaveMeeting(context, request, response); });
+}
+
+grpc::Status MeetingServiceImpl::EndMeeting(grpc::ServerContext* context
+                                             , const proto::meeting::EndMeetingRequest* request
+                                             , proto::meeting::EndMeetingResponse* response) {
+    return RunOnPool([&]() { return HandleEndMeeting(context, request, response); });
+}
+
+grpc::Status MeetingServiceImpl::GetMeeting(grpc::ServerContext* context
+                                             , const proto::meeting::GetMeetingRequest* request
+                                             , proto::meeting::GetMeetingResponse* response) {
+    return RunOnPool([&]() { return HandleGetMeeting(context, request, response); });
+}
+
+grpc::Status MeetingServiceImpl::HandleCreateMeeting(grpc::ServerContextBase* context
+                                                      , const proto::meeting::CreateMeetingRequest* request
+                                                      , proto::meeting::CreateMeetingResponse* response) {
     (void)context; // 未使用
     auto organizer_id_or = ResolveUserId(request->session_token(), session_repository_.get(),
                                          !meeting::common::GlobalConfig().storage.mysql.enabled);
@@ -294,10 +430,7 @@ grpc::Status MeetingServiceImpl::CreateMeeting(grpc::ServerContext* context
     meeting::core::CreateMeetingCommand command{organizer_id_or.Value(), request->topic()};
     MEETING_LOG_INFO("[MeetingService] CreateMeeting topic={} organizer={}",
                      command.topic, command.organizer_id);
-    auto create_future = thread_pool_.Submit([this, command]() {
-        return meeting_manager_->CreateMeeting(command);
-    });
-    auto status_or_meeting = create_future.get();
+    auto status_or_meeting = meeting_manager_->CreateMeeting(command);
     if (!status_or_meeting.IsOk()) {
         auto code = MapStatus(status_or_meeting.GetStatus());
         meeting::core::ErrorToProto(code, status_or_meeting.GetStatus(), response->mutable_error());
@@ -311,9 +444,9 @@ grpc::Status MeetingServiceImpl::CreateMeeting(grpc::ServerContext* context
     return grpc::Status::OK;
 }
 
-grpc::Status MeetingServiceImpl::JoinMeeting(grpc::ServerContext* context
-                                              , const proto::meeting::JoinMeetingRequest* request
-                                              , proto::meeting::JoinMeetingResponse* response) {
+grpc::Status MeetingServiceImpl::HandleJoinMeeting(grpc::ServerContextBase* context
+                                                    , const proto::meeting::JoinMeetingRequest* request
+                                                    , proto::meeting::JoinMeetingResponse* response) {
     auto participant_or = ResolveUserId(request->session_token(), session_repository_.get(),
                                         !meeting::common::GlobalConfig().storage.mysql.enabled);
     if (!participant_or.IsOk()) {
@@ -324,10 +457,7 @@ grpc::Status MeetingServiceImpl::JoinMeeting(grpc::ServerContext* context
     meeting::core::JoinMeetingCommand command{request->meeting_id(), participant_or.Value()};
     MEETING_LOG_INFO("[MeetingService] JoinMeeting meeting={} participant={}",
                      command.meeting_id, command.participant_id);
-    auto join_future = thread_pool_.Submit([this, command]() {
-        return meeting_manager_->JoinMeeting(command);
-    });
-    auto status_or_meeting = join_future.get();
+    auto status_or_meeting = meeting_manager_->JoinMeeting(command);
     if (!status_or_meeting.IsOk()) {
         auto code = MapStatus(status_or_meeting.GetStatus());
         meeting::core::ErrorToProto(code, status_or_meeting.GetStatus(), response->mutable_error());
@@ -340,7 +470,8 @@ grpc::Status MeetingServiceImpl::JoinMeeting(grpc::ServerContext* context
                                 , response->mutable_error());
     // 选择合适的会议服务节点
     const auto client_ip = ExtractClientIp(context, request);
-    auto endpoint_node = PickEndpoint(load_balancer_.get(), self_node_, geo_service_.get(), client_ip);
+    auto endpoint_node = PickEndpoint(load_balancer_.get(), self_node_, geo_service_.get(), client_ip,
+                                      command.meeting_id);
     auto* endpoint = response->mutable_endpoint();
     endpoint->set_ip(endpoint_node.host);
     endpoint->set_port(endpoint_node.port);
@@ -348,9 +479,9 @@ grpc::Status MeetingServiceImpl::JoinMeeting(grpc::ServerContext* context
     return grpc::Status::OK;
 }
 
-grpc::Status MeetingServiceImpl::LeaveMeeting(grpc::ServerContext* context
-                                              , const proto::meeting::LeaveMeetingRequest* request
-                                              , proto::meeting::LeaveMeetingResponse* response) {
+grpc::Status MeetingServiceImpl::HandleLeaveMeeting(grpc::ServerContextBase* context
+                                                     , const proto::meeting::LeaveMeetingRequest* request
+                                                     , proto::meeting::LeaveMeetingResponse* response) {
     (void)context; // 未使用
     auto participant_or = ResolveUserId(request->session_token(), session_repository_.get(),
                                         !meeting::common::GlobalConfig().storage.mysql.enabled);
@@ -362,10 +493,7 @@ grpc::Status MeetingServiceImpl::LeaveMeeting(grpc::ServerContext* context
     meeting::core::LeaveMeetingCommand command{request->meeting_id(), participant_or.Value()};
     MEETING_LOG_INFO("[MeetingService] LeaveMeeting meeting={} participant={}",
                      command.meeting_id, command.participant_id);
-    auto leave_future = thread_pool_.Submit([this, command]() {
-        return meeting_manager_->LeaveMeeting(command);
-    });
-    auto status = leave_future.get();
+    auto status = meeting_manager_->LeaveMeeting(command);
     if (!status.IsOk()) {
         auto code = MapStatus(status);
         meeting::core::ErrorToProto(code, status, response->mutable_error());
@@ -377,9 +505,9 @@ grpc::Status MeetingServiceImpl::LeaveMeeting(grpc::ServerContext* context
     return grpc::Status::OK;
 }
 
-grpc::Status MeetingServiceImpl::EndMeeting(grpc::ServerContext* context
-                                             , const proto::meeting::EndMeetingRequest* request
-                                             , proto::meeting::EndMeetingResponse* response) {
+grpc::Status MeetingServiceImpl::HandleEndMeeting(grpc::ServerContextBase* context
+                                                   , const proto::meeting::EndMeetingRequest* request
+                                                   , proto::meeting::EndMeetingResponse* response) {
     (void)context; // 未使用
     auto requester_or = ResolveUserId(request->session_token(), session_repository_.get(),
                                       !meeting::common::GlobalConfig().storage.mysql.enabled);
@@ -391,10 +519,7 @@ grpc::Status MeetingServiceImpl::EndMeeting(grpc::ServerContext* context
     meeting::core::EndMeetingCommand command{request->meeting_id(), requester_or.Value()};
     MEETING_LOG_INFO("[MeetingService] EndMeeting meeting={} requester={}",
                      command.meeting_id, command.requester_id);
-    auto end_future = thread_pool_.Submit([this, command]() {
-        return meeting_manager_->EndMeeting(command);
-    });
-    auto status = end_future.get();
+    auto status = meeting_manager_->EndMeeting(command);
     if (!status.IsOk()) {
         auto code = MapStatus(status);
         meeting::core::ErrorToProto(code, status, response->mutable_error());
@@ -406,21 +531,37 @@ grpc::Status MeetingServiceImpl::EndMeeting(grpc::ServerContext* context
     return grpc::Status::OK;
 }
 
-grpc::Status MeetingServiceImpl::GetMeeting(grpc::ServerContext* context
-                                             , const proto::meeting::GetMeetingRequest* request
-                                             , proto::meeting::GetMeetingResponse* response) {
+grpc::Status MeetingServiceImpl::HandleGetMeeting(grpc::ServerContextBase* context
+                                                   , const proto::meeting::GetMeetingRequest* request
+                                                   , proto::meeting::GetMeetingResponse* response) {
     (void)context; // 未使用
-    auto get_future = thread_pool_.Submit([this, id = request->meeting_id()]() {
-        return meeting_manager_->GetMeeting(id);
-    });
-    MEETING_LOG_INFO("[MeetingService] GetMeeting meeting={}", request->meeting_id());
-    auto status_or_meeting = get_future.get();
-    if (!status_or_meeting.IsOk()) {
-        auto code = MapStatus(status_or_meeting.GetStatus());
-        meeting::core::ErrorToProto(code, status_or_meeting.GetStatus(), response->mutable_error());
-        return ToGrpcStatus(status_or_meeting.GetStatus());
+    MEETING_LOG_INFO("[MeetingService] GetMeeting meeting={} since_revision={}", request->meeting_id(),
+                     request->since_revision());
+    if (request->since_revision() == 0) {
+        auto status_or_meeting = meeting_manager_->GetMeeting(request->meeting_id());
+        if (!status_or_meeting.IsOk()) {
+            auto code = MapStatus(status_or_meeting.GetStatus());
+            meeting::core::ErrorToProto(code, status_or_meeting.GetStatus(), response->mutable_error());
+            return ToGrpcStatus(status_or_meeting.GetStatus());
+        }
+        FillMeetingInfo(status_or_meeting.Value(), response->mutable_meeting());
+    } else {
+        // 带版本号的请求: 参与者用 packed uint64 返回, 能给出增量时只返回增删
+        auto status_or_delta = meeting_manager_->GetMeetingSince(request->meeting_id(), request->since_revision());
+        if (!status_or_delta.IsOk()) {
+            auto code = MapStatus(status_or_delta.GetStatus());
+            meeting::core::ErrorToProto(code, status_or_delta.GetStatus(), response->mutable_error());
+            return ToGrpcStatus(status_or_delta.GetStatus());
+        }
+        const auto& delta = status_or_delta.Value();
+        FillMeetingInfo(delta.meeting, response->mutable_meeting(), true);
+        if (delta.incremental) {
+            auto* participant_delta = response->mutable_participant_delta();
+            participant_delta->set_since_revision(delta.since_revision);
+            participant_delta->mutable_added_user_ids()->Add(delta.added.begin(), delta.added.end());
+            participant_delta->mutable_removed_user_ids()->Add(delta.removed.begin(), delta.removed.end());
+        }
     }
-    FillMeetingInfo(status_or_meeting.Value(), response->mutable_meeting());
     meeting::core::ErrorToProto(meeting::core::MeetingErrorCode::kOk
                                 , meeting::common::Status::OK()
                                 , response->mutable_error());
@@ -463,7 +604,8 @@ std::string MeetingServiceImpl::StateToString(meeting::core::MeetingState state)
 
 // 填写会议信息
 void MeetingServiceImpl::FillMeetingInfo(const meeting::core::MeetingData& data
-                                         , proto::common::MeetingInfo* info) {
+                                         , proto::common::MeetingInfo* info
+                                         , bool compact_participants) {
     if (info  == nullptr) {
         return;
     }
@@ -475,7 +617,15 @@ void MeetingServiceImpl::FillMeetingInfo(const meeting::core::MeetingData& data
     info->mutable_start_time()->set_nanos(0);
     info->mutable_end_time()->set_seconds(data.updated_at);
     info->mutable_end_time()->set_nanos(0);
+    info->set_revision(data.revision);
     info->clear_participant_ids();
+    info->clear_participant_user_ids();
+    if (compact_participants) {
+        const auto& ids = data.participants.Ids();
+        info->mutable_participant_user_ids()->Add(ids.begin(), ids.end());
+        return;
+    }
+    info->mutable_participant_ids()->Reserve(static_cast<int>(data.participants.size()));
     for (const auto participant : data.participants) {
         info->add_participant_ids(std::to_string(participant));
     }
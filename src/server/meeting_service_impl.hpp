@@ -22,10 +22,14 @@
 namespace meeting {
 namespace server {
 
+class MeetingCallbackService;
+
 class MeetingServiceImpl final : public proto::meeting::MeetingService::Service {
 public:
     MeetingServiceImpl();
     explicit MeetingServiceImpl(const std::string& thread_pool_config_path);
+    // 使用外部共享线程池 (由调用方启动, 并在本对象销毁后停止), 请求投递到 "meeting" 通道
+    explicit MeetingServiceImpl(thread_pool::ThreadPool& shared_pool);
     ~MeetingServiceImpl();
 
     grpc::Status CreateMeeting(grpc::ServerContext* context
@@ -48,10 +52,36 @@ public:
                              , const proto::meeting::GetMeetingRequest* request
                              , proto::meeting::GetMeetingResponse* response) override;
 private:
+    friend class MeetingCallbackService;
+
+    // 业务处理函数: 在调用线程上直接执行, 同步与回调两种服务模式共用
+    grpc::Status HandleCreateMeeting(grpc::ServerContextBase* context
+                                     , const proto::meeting::CreateMeetingRequest* request
+                                     , proto::meeting::CreateMeetingResponse* response);
+    grpc::Status HandleJoinMeeting(grpc::ServerContextBase* context
+                                   , const proto::meeting::JoinMeetingRequest* request
+                                   , proto::meeting::JoinMeetingResponse* response);
+    grpc::Status HandleLeaveMeeting(grpc::ServerContextBase* context
+                                    , const proto::meeting::LeaveMeetingRequest* request
+                                    , proto::meeting::LeaveMeetingResponse* response);
+    grpc::Status HandleEndMeeting(grpc::ServerContextBase* context
+                                  , const proto::meeting::EndMeetingRequest* request
+                                  , proto::meeting::EndMeetingResponse* response);
+    grpc::Status HandleGetMeeting(grpc::ServerContextBase* context
+                                  , const proto::meeting::GetMeetingRequest* request
+                                  , proto::meeting::GetMeetingResponse* response);
+
+    MeetingServiceImpl(std::unique_ptr<thread_pool::ThreadPool> owned_pool, thread_pool::ThreadPool* shared_pool);
+
+    template <typename Handler>
+    grpc::Status RunOnPool(Handler&& handler);
+
     static grpc::Status ToGrpcStatus(const meeting::common::Status& status);
     static std::string StateToString(meeting::core::MeetingState state);
+    // compact_participants 时参与者写入 packed 的 participant_user_ids, 不逐个格式化为字符串
     void FillMeetingInfo(const meeting::core::MeetingData& data
-                         , proto::common::MeetingInfo* info);
+                         , proto::common::MeetingInfo* info
+                         , bool compact_participants = false);
 
 private:
     std::shared_ptr<meeting::cache::RedisClient> redis_client_; // Redis客户端
@@ -63,7 +93,9 @@ private:
     std::shared_ptr<meeting::geo::GeoLocationService> geo_service_; // 地理位置服务
     meeting::registry::NodeInfo self_node_; // 本节点信息
 
-    thread_pool::ThreadPool thread_pool_;
+    std::unique_ptr<thread_pool::ThreadPool> owned_thread_pool_; // 独立模式下自有的线程池
+    thread_pool::ThreadPool& thread_pool_; // 实际使用的线程池 (自有或共享)
+    thread_pool::LaneId lane_; // 请求所在的线程池通道
 
 };
 
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "common/logger.hpp"
+#include "thread_pool/thread_pool.hpp"
+
+#include <grpcpp/grpcpp.h>
+#include <grpcpp/support/server_callback.h>
+
+#include <exception>
+#include <utility>
+
+namespace meeting {
+namespace server {
+
+// 将处理函数提交到线程池的指定通道, 由工作线程在完成回调中直接结束 RPC, gRPC 线程立即返回
+// 完成回调恰好执行一次: 任务被线程池拒绝/丢弃/取消时以异常结果执行, 据此返回 UNAVAILABLE, 避免请求悬挂
+template <typename Handler>
+grpc::ServerUnaryReactor* DispatchToPool(thread_pool::ThreadPool& pool
+                                         , thread_pool::LaneId lane
+                                         , grpc::CallbackServerContext* context
+                                         , Handler handler) {
+    auto* reactor = context->DefaultReactor();
+    auto run = [handler = std::move(handler)]() mutable -> grpc::Status {
+        try {
+            return handler();
+        } catch (const std::exception& ex) {
+            MEETING_LOG_ERROR("[RpcDispatch] Handler threw: {}", ex.what());
+            return grpc::Status(grpc::StatusCode::INTERNAL, ex.what());
+        } catch (...) {
+            return grpc::Status(grpc::StatusCode::INTERNAL, "unknown error");
+        }
+    };
+    try {
+        pool.SubmitWithCallbackTo(lane, std::move(run), [reactor](thread_pool::Completion<grpc::Status> done) {
+            try {
+                reactor->Finish(done.Get());
+            } catch (const std::exception& ex) {
+                // 处理函数的异常已在 run 中转换, 这里只会是未被调度的任务
+                MEETING_LOG_WARN("[RpcDispatch] Request not scheduled: {}", ex.what());
+                reactor->Finish(grpc::Status(grpc::StatusCode::UNAVAILABLE, "server busy: request was not scheduled"));
+            }
+        });
+    } catch (const std::exception& ex) {
+        // 抛出时回调尚未注册, 由这里结束 RPC
+        MEETING_LOG_ERROR("[RpcDispatch] Submit failed: {}", ex.what());
+        reactor->Finish(grpc::Status(grpc::StatusCode::UNAVAILABLE, "server busy: request was not scheduled"));
+    }
+    return reactor;
+}
+
+} // namespace server
+} // namespace meeting
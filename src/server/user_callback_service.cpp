@@ -0,0 +1,42 @@
+#include "server/user_callback_service.hpp"
+#include "server/rpc_dispatch.hpp"
+
+namespace meeting {
+namespace server {
+
+UserCallbackService::UserCallbackService(UserServiceImpl& impl) : impl_(impl) {}
+
+grpc::ServerUnaryReactor* UserCallbackService::Register(grpc::CallbackServerContext* context
+                                                        , const proto::user::RegisterRequest* request
+                                                        , proto::user::RegisterResponse* response) {
+    return DispatchToPool(impl_.thread_pool_, impl_.auth_lane_, context, [this, context, request, response]() {
+        return impl_.HandleRegister(context, request, response);
+    });
+}
+
+grpc::ServerUnaryReactor* UserCallbackService::Login(grpc::CallbackServerContext* context
+                                                     , const proto::user::LoginRequest* request
+                                                     , proto::user::LoginResponse* response) {
+    return DispatchToPool(impl_.thread_pool_, impl_.auth_lane_, context, [this, context, request, response]() {
+        return impl_.HandleLogin(context, request, response);
+    });
+}
+
+grpc::ServerUnaryReactor* UserCallbackService::Logout(grpc::CallbackServerContext* context
+                                                      , const proto::user::LogoutRequest* request
+                                                      , proto::user::LogoutResponse* response) {
+    return DispatchToPool(impl_.thread_pool_, impl_.lane_, context, [this, context, request, response]() {
+        return impl_.HandleLogout(context, request, response);
+    });
+}
+
+grpc::ServerUnaryReactor* UserCallbackService::GetProfile(grpc::CallbackServerContext* context
+                                                          , const proto::user::GetProfileRequest* request
+                                                          , proto::user::GetProfileResponse* response) {
+    return DispatchToPool(impl_.thread_pool_, impl_.lane_, context, [this, context, request, response]() {
+        return impl_.HandleGetProfile(context, request, response);
+    });
+}
+
+} // namespace server
+} // namespace meeting
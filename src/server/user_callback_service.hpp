@@ -0,0 +1,38 @@
+#pragma once
+
+#include "server/user_service_impl.hpp"
+
+#include "user_service.grpc.pb.h"
+
+#include <grpcpp/grpcpp.h>
+
+namespace meeting {
+namespace server {
+
+// 回调(异步)模式的用户服务, 业务逻辑复用 UserServiceImpl, 由线程池工作线程完成 RPC
+class UserCallbackService final : public proto::user::UserService::CallbackService {
+public:
+    explicit UserCallbackService(UserServiceImpl& impl);
+
+    grpc::ServerUnaryReactor* Register(grpc::CallbackServerContext* context
+                                       , const proto::user::RegisterRequest* request
+                                       , proto::user::RegisterResponse* response) override;
+
+    grpc::ServerUnaryReactor* Login(grpc::CallbackServerContext* context
+                                    , const proto::user::LoginRequest* request
+                                    , proto::user::LoginResponse* response) override;
+
+    grpc::ServerUnaryReactor* Logout(grpc::CallbackServerContext* context
+                                     , const proto::user::LogoutRequest* request
+                                     , proto::user::LogoutResponse* response) override;
+
+    grpc::ServerUnaryReactor* GetProfile(grpc::CallbackServerContext* context
+                                         , const proto::user::GetProfileRequest* request
+                                         , proto::user::GetProfileResponse* response) override;
+
+private:
+    UserServiceImpl& impl_; // 业务实现 (持有线程池与管理器)
+};
+
+} // namespace server
+} // namespace meeting
@@ -15,17 +15,22 @@
 
 #include <chrono>
 #include <random>
+#include <string_view>
 namespace meeting {
 namespace server {
 
 namespace {
+// 线程池通道 (thread_pool.json 的 lanes)
+constexpr std::string_view kUserLane = "user";
+constexpr std::string_view kAuthLane = "auth";
+
 // 创建用户相关的线程池
-thread_pool::ThreadPool CreateUserThreadPool(const std::string& path) {
+std::unique_ptr<thread_pool::ThreadPool> CreateUserThreadPool(const std::string& path) {
     auto config_loader = thread_pool::ThreadPoolConfigLoader::FromFile(path);
     if (config_loader.has_value()) {
-        return thread_pool::ThreadPool(config_loader->GetConfig());
+        return std::make_unique<thread_pool::ThreadPool>(config_loader->GetConfig());
     }
-    return thread_pool::ThreadPool(4, 5000);
+    return std::make_unique<thread_pool::ThreadPool>(4, 5000);
 }
 // 创建Redis客户端
 std::shared_ptr<meeting::cache::RedisClient> CreateRedisClient() {
@@ -151,32 +156,78 @@ std::int64_t NowSeconds() {
 UserServiceImpl::UserServiceImpl(): UserServiceImpl(meeting::common::GetThreadPoolConfigPath()) {}
 
 UserServiceImpl::UserServiceImpl(const std::string& thread_pool_config_path)
+    : UserServiceImpl(CreateUserThreadPool(thread_pool_config_path), nullptr) {}
+
+UserServiceImpl::UserServiceImpl(thread_pool::ThreadPool& shared_pool)
+    : UserServiceImpl(nullptr, &shared_pool) {}
+
+UserServiceImpl::UserServiceImpl(std::unique_ptr<thread_pool::ThreadPool> owned_pool
+                                 , thread_pool::ThreadPool* shared_pool)
     : redis_client_(CreateRedisClient()) // 创建Redis客户端
     , user_manager_(std::make_unique<meeting::core::UserManager>(CreateUserRepository(redis_client_))) // 创建用户管理器
     , session_repository_(CreateSessionRepository(redis_client_)) // 创建会话存储库
-    , thread_pool_(CreateUserThreadPool(thread_pool_config_path)) {
-    // 启动线程池
-    thread_pool_.Start();
+    , owned_thread_pool_(std::move(owned_pool))
+    , thread_pool_(owned_thread_pool_ ? *owned_thread_pool_ : *shared_pool)
+    , lane_(thread_pool_.FindLane(kUserLane))
+    , auth_lane_(thread_pool_.FindLane(kAuthLane)) {
+    // 启动自有线程池; 共享线程池由调用方管理
+    if (owned_thread_pool_) {
+        owned_thread_pool_->Start();
+    }
 }
 
 UserServiceImpl::~UserServiceImpl() {
-    // 停止线程池
-    thread_pool_.Stop();
+    // 停止自有线程池
+    if (owned_thread_pool_) {
+        owned_thread_pool_->Stop();
+    }
 }
 
-grpc::Status UserServiceImpl::Register(grpc::ServerContext*
-                                        , const proto::user::RegisterRequest* request           
+// 同步模式: 在线程池中执行处理函数并阻塞等待结果 (Completion 基于 futex 等待, 无 future 的锁与条件变量开销)
+template <typename Handler>
+grpc::Status UserServiceImpl::RunOnPool(thread_pool::LaneId lane, Handler&& handler) {
+    try {
+        return thread_pool_.SubmitCompletionTo(lane, std::forward<Handler>(handler)).Get();
+    } catch (const std::exception& ex) {
+        MEETING_LOG_ERROR("[UserService] Handler dispatch failed: {}", ex.what());
+        return {grpc::StatusCode::UNAVAILABLE, ex.what()};
+    }
+}
+
+grpc::Status UserServiceImpl::Register(grpc::ServerContext* context
+                                        , const proto::user::RegisterRequest* request
                                         , proto::user::RegisterResponse* response) {
+    return RunOnPool(auth_lane_, [&]() { return HandleRegister(context, request, response); });
+}
+
+grpc::Status UserServiceImpl::Login(grpc::ServerContext* context
+                                    , const proto::user::LoginRequest* request
+                                    , proto::user::LoginResponse* response) {
+    return RunOnPool(auth_lane_, [&]() { return HandleLogin(context, request, response); });
+}
+
+grpc::Status UserServiceImpl::Logout(grpc::ServerContext* context,
+                                      const proto::user::LogoutRequest* request,
+                                      proto::user::LogoutResponse* response) {
+    return RunOnPool(lane_, [&]() { return HandleLogout(context, request, response); });
+}
+
+grpc::Status UserServiceImpl::GetProfile(grpc::ServerContext* context,
+                                          const proto::user::GetProfileRequest* request,
+                                          proto::user::GetProfileResponse* response) {
+    return RunOnPool(lane_, [&]() { return HandleGetProfile(context, request, response); });
+}
+
+grpc::Status UserServiceImpl::HandleRegister(grpc::ServerContextBase*
+                                              , const proto::user::RegisterRequest* request
+                                              , proto::user::RegisterResponse* response) {
     meeting::core::RegisterCommand command{request->user_name()
                                          , request->password()
                                          , request->email()
                                          , request->display_name()};
-    MEETING_LOG_INFO("[UserService] Register user={}", command.user_name);                                     
-    auto future = thread_pool_.Submit([this, command]() {
-        return user_manager_->RegisterUser(command);
-    });
-    meeting::common::Status status = future.get();
-    
+    MEETING_LOG_INFO("[UserService] Register user={}", command.user_name);
+    meeting::common::Status status = user_manager_->RegisterUser(command);
+
     if (!status.IsOk()) {
         meeting::core::UserErrorCode error_code = meeting::core::UserErrorCode::kOk;
         switch (status.Code()) {
@@ -193,27 +244,24 @@ grpc::Status UserServiceImpl::Register(grpc::ServerContext*
         meeting::core::ErrorToProto(error_code, status, response->mutable_error());
         return ToGrpcStatus(status);
     }
-    
+
     auto user_data = user_manager_->GetUserByUserName(command.user_name);
     if (user_data.IsOk()) {
         FillUserInfo(user_data.Value(), response->mutable_user());
     }
-    
+
     return grpc::Status::OK;
 }
 
-grpc::Status UserServiceImpl::Login(grpc::ServerContext*
-                                    , const proto::user::LoginRequest* request
-                                    , proto::user::LoginResponse* response) {
+grpc::Status UserServiceImpl::HandleLogin(grpc::ServerContextBase*
+                                          , const proto::user::LoginRequest* request
+                                          , proto::user::LoginResponse* response) {
     meeting::core::LoginCommand command{request->user_name()
                                          , request->password()
                                          , ""
                                          , ""};
-    MEETING_LOG_INFO("[UserService] Login user={}", command.user_name);                                     
-    auto login_future = thread_pool_.Submit([this, command]() {
-        return user_manager_->LoginUser(command);
-    });
-    meeting::common::StatusOr status_or_user = login_future.get();
+    MEETING_LOG_INFO("[UserService] Login user={}", command.user_name);
+    meeting::common::StatusOr status_or_user = user_manager_->LoginUser(command);
 
     meeting::core::UserErrorCode error_code = meeting::core::UserErrorCode::kOk;
     if (!status_or_user.IsOk()) {
@@ -230,18 +278,14 @@ grpc::Status UserServiceImpl::Login(grpc::ServerContext*
         return ToGrpcStatus(status);
     }
 
-    auto user_data = status_or_user.Value();
+    const auto& user_data = status_or_user.Value();
     FillUserInfo(user_data, response->mutable_user());
 
-    auto session_future = thread_pool_.Submit([this, user_data]() {
-        meeting::core::SessionRecord rec;
-        rec.token = GenerateToken();
-        rec.user_id = user_data.numeric_id;
-        rec.user_uuid = user_data.user_id;
-        rec.expires_at = NowSeconds() + 3600;
-        return rec;
-    });
-    auto rec = session_future.get();
+    meeting::core::SessionRecord rec;
+    rec.token = GenerateToken();
+    rec.user_id = user_data.numeric_id;
+    rec.user_uuid = user_data.user_id;
+    rec.expires_at = NowSeconds() + 3600;
     auto session_status = session_repository_->CreateSession(rec);
     if (!session_status.IsOk()) {
         meeting::core::UserErrorCode session_error = meeting::core::UserErrorCode::kSessionExpired;
@@ -256,15 +300,11 @@ grpc::Status UserServiceImpl::Login(grpc::ServerContext*
     return grpc::Status::OK;
 }
 
-grpc::Status UserServiceImpl::Logout(grpc::ServerContext* /*context*/,
-                                      const proto::user::LogoutRequest* request,
-                                      proto::user::LogoutResponse* response) {
-    MEETING_LOG_INFO("[UserService] Logout session_token={}...", request->session_token().substr(0, 6));                                    
-    auto logout_future = thread_pool_.Submit([this, token = request->session_token()]() {
-        return session_repository_->DeleteSession(token);
-    });
-
-    auto logout_status = logout_future.get();
+grpc::Status UserServiceImpl::HandleLogout(grpc::ServerContextBase* /*context*/,
+                                            const proto::user::LogoutRequest* request,
+                                            proto::user::LogoutResponse* response) {
+    MEETING_LOG_INFO("[UserService] Logout session_token={}...", request->session_token().substr(0, 6));
+    auto logout_status = session_repository_->DeleteSession(request->session_token());
     meeting::core::UserErrorCode error_code = logout_status.IsOk() ? meeting::core::UserErrorCode::kOk
                                                           : meeting::core::UserErrorCode::kSessionExpired;
 
@@ -273,23 +313,17 @@ grpc::Status UserServiceImpl::Logout(grpc::ServerContext* /*context*/,
     return ToGrpcStatus(logout_status);
 }
 
-grpc::Status UserServiceImpl::GetProfile(grpc::ServerContext* /*context*/,
-                                          const proto::user::GetProfileRequest* request,
-                                          proto::user::GetProfileResponse* response) {
-    auto session_future = thread_pool_.Submit([this, token = request->session_token()]() {
-        return session_repository_->ValidateSession(token);
-    });
-    auto session_status = session_future.get();
+grpc::Status UserServiceImpl::HandleGetProfile(grpc::ServerContextBase* /*context*/,
+                                                const proto::user::GetProfileRequest* request,
+                                                proto::user::GetProfileResponse* response) {
+    auto session_status = session_repository_->ValidateSession(request->session_token());
     if (!session_status.IsOk()) {
         meeting::core::UserErrorCode error_code = meeting::core::UserErrorCode::kSessionExpired;
         meeting::core::ErrorToProto(error_code, session_status.GetStatus(), response->mutable_error());
         return ToGrpcStatus(session_status.GetStatus());
     }
 
-    auto user_future = thread_pool_.Submit([this, user_id = session_status.Value().user_uuid]() {
-        return user_manager_->GetUserById(user_id);
-    });
-    auto user_status_or = user_future.get();
+    auto user_status_or = user_manager_->GetUserById(session_status.Value().user_uuid);
     if (!user_status_or.IsOk()) {
         meeting::core::UserErrorCode error_code = meeting::core::UserErrorCode::kUserNotFound;
         meeting::core::ErrorToProto(error_code, user_status_or.GetStatus(), response->mutable_error());
@@ -22,10 +22,14 @@
 namespace meeting {
 namespace server {
 
+class UserCallbackService;
+
 class UserServiceImpl final : public proto::user::UserService::Service {
 public:
     UserServiceImpl();
     explicit UserServiceImpl(const std::string& thread_pool_config_path);
+    // 使用外部共享线程池 (由调用方启动和停止), 注册/登录投递到 "auth" 通道, 其余请求投递到 "user" 通道
+    explicit UserServiceImpl(thread_pool::ThreadPool& shared_pool);
     ~UserServiceImpl();
     
     grpc::Status Register(grpc::ServerContext* context
@@ -45,6 +49,27 @@ public:
                            , proto::user::GetProfileResponse* response) override;
 
 private:
+    friend class UserCallbackService;
+
+    // 业务处理函数: 在调用线程上直接执行, 同步与回调两种服务模式共用
+    grpc::Status HandleRegister(grpc::ServerContextBase* context
+                                , const proto::user::RegisterRequest* request
+                                , proto::user::RegisterResponse* response);
+    grpc::Status HandleLogin(grpc::ServerContextBase* context
+                             , const proto::user::LoginRequest* request
+                             , proto::user::LoginResponse* response);
+    grpc::Status HandleLogout(grpc::ServerContextBase* context
+                              , const proto::user::LogoutRequest* request
+                              , proto::user::LogoutResponse* response);
+    grpc::Status HandleGetProfile(grpc::ServerContextBase* context
+                                  , const proto::user::GetProfileRequest* request
+                                  , proto::user::GetProfileResponse* response);
+
+    UserServiceImpl(std::unique_ptr<thread_pool::ThreadPool> owned_pool, thread_pool::ThreadPool* shared_pool);
+
+    // 辅助函数: 同步模式下投递到线程池指定通道并等待结果
+    template <typename Handler>
+    grpc::Status RunOnPool(thread_pool::LaneId lane, Handler&& handler);
     // 辅助函数: 转换状态码 
     static grpc::Status ToGrpcStatus(const meeting::common::Status& status);
     // 辅助函数: 填充用户信息
@@ -57,7 +82,14 @@ private:
     std::unique_ptr<meeting::core::UserManager> user_manager_;
     // 会话存储库
     std::shared_ptr<meeting::core::SessionRepository> session_repository_;
-    thread_pool::ThreadPool thread_pool_;
+    // 独立模式下自有的线程池
+    std::unique_ptr<thread_pool::ThreadPool> owned_thread_pool_;
+    // 实际使用的线程池 (自有或共享)
+    thread_pool::ThreadPool& thread_pool_;
+    // 普通请求通道
+    thread_pool::LaneId lane_;
+    // 注册/登录通道: PBKDF2 计算耗时, 与其余请求隔离
+    thread_pool::LaneId auth_lane_;
 };
 
 } // namespace server
@@ -4,6 +4,10 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
 
 namespace meeting {
 namespace storage {
@@ -41,6 +45,68 @@ std::int64_t ParseInt64(const char* field) {
     if (!field) return 0;
     return std::strtoll(field, nullptr, 10);
 }
+
+using ResultPtr = std::unique_ptr<MYSQL_RES, decltype(&mysql_free_result)>;
+
+// 解析会议行 (列顺序与 LoadMeeting / LockMeeting 的查询一致)
+meeting::core::MeetingData ParseMeetingRow(MYSQL_ROW row) {
+    meeting::core::MeetingData data;
+    data.meeting_id = row[0] ? row[0] : "";
+    data.meeting_code = row[1] ? row[1] : "";
+    data.organizer_id = ParseUInt64(row[2]);
+    data.topic = row[3] ? row[3] : "";
+    data.state = static_cast<meeting::core::MeetingState>(row[4] ? std::atoi(row[4]) : 0);
+    data.created_at = ParseInt64(row[5]);
+    data.updated_at = ParseInt64(row[6]);
+    data.revision = ParseUInt64(row[7]);
+    return data;
+}
+
+// 执行多条以分号分隔的语句 (连接启用了 CLIENT_MULTI_STATEMENTS), 一次往返; 返回各 SELECT 的结果集.
+// 某条语句失败时其后的语句不会执行, 返回该语句的错误
+meeting::common::Status RunBatch(MYSQL* conn, const std::string& sql, std::vector<ResultPtr>* results) {
+    if (mysql_real_query(conn, sql.c_str(), sql.size()) != 0) {
+        return MapMySqlError(conn);
+    }
+    for (;;) {
+        MYSQL_RES* res = mysql_store_result(conn);
+        if (res) {
+            ResultPtr owned(res, mysql_free_result);
+            if (results) {
+                results->push_back(std::move(owned));
+            }
+        } else if (mysql_field_count(conn) != 0) {
+            return MapMySqlError(conn);
+        }
+        const int next = mysql_next_result(conn);
+        if (next < 0) {
+            return meeting::common::Status::OK();
+        }
+        if (next > 0) {
+            return MapMySqlError(conn);
+        }
+    }
+}
+
+// 单条写入的版本号表达式: 写后落库给出绝对版本号时直接覆盖, 否则在当前值上加 1
+std::string RevisionExpr(std::uint64_t revision) {
+    return revision == meeting::core::kNextRevision ? std::string("revision + 1") : std::to_string(revision);
+}
+
+// UPDATE 匹配到的行数; 未启用 CLIENT_FOUND_ROWS 时 affected_rows 不含值未变化的行
+std::uint64_t RowsMatched(MYSQL* conn) {
+    const char* info = mysql_info(conn);
+    if (!info) {
+        return mysql_affected_rows(conn);
+    }
+    const char* matched = std::strstr(info, "Rows matched:");
+    return matched ? std::strtoull(matched + std::strlen("Rows matched:"), nullptr, 10) : mysql_affected_rows(conn);
+}
+
+// 放弃事务, 释放会议行锁 (连接随后归还连接池)
+void RollbackBatch(MYSQL* conn) {
+    RunBatch(conn, "ROLLBACK", nullptr);
+}
 } // namespace
 
 // 构造函数
@@ -67,13 +133,14 @@ meeting::common::StatusOr<meeting::core::MeetingData> MySqlMeetingRepository::Cr
     auto created_at = std::max<std::int64_t>(data.created_at, 1);
     auto updated_at = std::max<std::int64_t>(data.updated_at, created_at);
     auto sql_meeting = fmt::format(
-        "INSERT INTO meetings (meeting_id, meeting_code, organizer_id, topic, state, created_at, updated_at) "
-        "VALUES ({}, {}, {}, {}, {}, FROM_UNIXTIME({}), FROM_UNIXTIME({}))",
+        "INSERT INTO meetings (meeting_id, meeting_code, organizer_id, topic, state, revision, created_at, updated_at) "
+        "VALUES ({}, {}, {}, {}, {}, {}, FROM_UNIXTIME({}), FROM_UNIXTIME({}))",
         EscapeAndQuote(conn, data.meeting_id),
         EscapeAndQuote(conn, data.meeting_code),
         data.organizer_id,
         EscapeAndQuote(conn, data.topic),
         static_cast<int>(data.state),
+        std::max<std::uint64_t>(data.revision, 1),
         created_at,
         updated_at);
     // 执行SQL语句
@@ -109,7 +176,7 @@ meeting::common::StatusOr<meeting::core::MeetingData> MySqlMeetingRepository::Lo
     // 查询会议数据
     auto sql = fmt::format(
         "SELECT meeting_id, meeting_code, organizer_id, topic, state, "
-        "UNIX_TIMESTAMP(created_at), UNIX_TIMESTAMP(updated_at) "
+        "UNIX_TIMESTAMP(created_at), UNIX_TIMESTAMP(updated_at), revision "
         "FROM meetings WHERE meeting_id = {} LIMIT 1",
         EscapeAndQuote(conn, meeting_id));
     if (mysql_real_query(conn, sql.c_str(), sql.size()) != 0) {
@@ -130,14 +197,7 @@ meeting::common::StatusOr<meeting::core::MeetingData> MySqlMeetingRepository::Lo
     }
 
     // 解析会议数据
-    meeting::core::MeetingData data;
-    data.meeting_id = row[0] ? row[0] : "";
-    data.meeting_code = row[1] ? row[1] : "";
-    data.organizer_id = ParseUInt64(row[2]);
-    data.topic = row[3] ? row[3] : "";
-    data.state = static_cast<meeting::core::MeetingState>(row[4] ? std::atoi(row[4]) : 0);
-    data.created_at = ParseInt64(row[5]);
-    data.updated_at = ParseInt64(row[6]);
+    meeting::core::MeetingData data = ParseMeetingRow(row);
 
     // 查询参与者列表
     auto participants_sql = fmt::format(
@@ -150,9 +210,10 @@ meeting::common::StatusOr<meeting::core::MeetingData> MySqlMeetingRepository::Lo
     if (pres) {
         // 确保结果集释放
         auto cleanup_p = std::unique_ptr<MYSQL_RES, decltype(&mysql_free_result)>(pres, mysql_free_result);
+        data.participants.Reserve(static_cast<std::size_t>(mysql_num_rows(pres)));
         MYSQL_ROW prow;
         while ((prow = mysql_fetch_row(pres)) != nullptr) {
-            data.participants.push_back(ParseUInt64(prow[0]));
+            data.participants.Insert(ParseUInt64(prow[0]));
         }
     }
     return meeting::common::StatusOr<meeting::core::MeetingData>(data);
@@ -171,7 +232,8 @@ meeting::common::StatusOr<meeting::core::MeetingData> MySqlMeetingRepository::Ge
 }
 
 // 更新会议信息
-meeting::common::Status MySqlMeetingRepository::UpdateMeetingState(const std::string& meeting_id, meeting::core::MeetingState state, std::int64_t updated_at) {
+meeting::common::Status MySqlMeetingRepository::UpdateMeetingState(const std::string& meeting_id, meeting::core::MeetingState state, std::int64_t updated_at,
+                                                           std::uint64_t revision) {
     // 获取连接租赁对象
     auto lease_or = pool_->Acquire();
     if (!lease_or.IsOk()) {
@@ -182,21 +244,24 @@ meeting::common::Status MySqlMeetingRepository::UpdateMeetingState(const std::st
 
     // 更新会议状态
     auto sql = fmt::format(
-        "UPDATE meetings SET state = {}, updated_at = FROM_UNIXTIME({}) WHERE meeting_id = {}",
+        "UPDATE meetings SET state = {}, updated_at = FROM_UNIXTIME({}), revision = {} WHERE meeting_id = {}",
         static_cast<int>(state),
         std::max<std::int64_t>(updated_at, 1),
+        RevisionExpr(revision),
         EscapeAndQuote(conn, meeting_id));
     if (mysql_real_query(conn, sql.c_str(), sql.size()) != 0) {
         return MapMySqlError(conn);
     }
-    if (mysql_affected_rows(conn) == 0) {
+    // 绝对版本号可能与已落库的值相同 (同一命令的参与者写入已写过), 按匹配行数判断会议是否存在
+    if (RowsMatched(conn) == 0) {
         return meeting::common::Status::NotFound("meeting not found");
     }
     return meeting::common::Status::OK();
 }
 
 // 添加会议参与者
-meeting::common::Status MySqlMeetingRepository::AddParticipant(const std::string& meeting_id, std::uint64_t participant_id, bool is_organizer) {
+meeting::common::Status MySqlMeetingRepository::AddParticipant(const std::string& meeting_id, std::uint64_t participant_id, bool is_organizer,
+                                                       std::uint64_t revision) {
     // 获取连接租赁对象
     auto lease_or = pool_->Acquire();
     if (!lease_or.IsOk()) {
@@ -205,20 +270,28 @@ meeting::common::Status MySqlMeetingRepository::AddParticipant(const std::string
     auto lease = std::move(lease_or.Value());
     MYSQL* conn = lease.Raw();
     
+    // 插入参与者并写入会议版本号, 同一事务一次往返
+    const auto quoted = EscapeAndQuote(conn, meeting_id);
     auto sql = fmt::format(
+        "START TRANSACTION; "
         "INSERT INTO meeting_participants (meeting_id, user_id, role, joined_at) "
-        "VALUES ((SELECT id FROM meetings WHERE meeting_id = {}), {}, {}, NOW())",
-        EscapeAndQuote(conn, meeting_id),
+        "VALUES ((SELECT id FROM meetings WHERE meeting_id = {0}), {1}, {2}, NOW()); "
+        "UPDATE meetings SET revision = {3} WHERE meeting_id = {0}; "
+        "COMMIT",
+        quoted,
         participant_id,
-        is_organizer ? 1 : 0);
-    if (mysql_real_query(conn, sql.c_str(), sql.size()) != 0) {
-        return MapMySqlError(conn);
+        is_organizer ? 1 : 0,
+        RevisionExpr(revision));
+    auto status = RunBatch(conn, sql, nullptr);
+    if (!status.IsOk()) {
+        RollbackBatch(conn);
     }
-    return meeting::common::Status::OK();
+    return status;
 }
 
 // 移除会议参与者
-meeting::common::Status MySqlMeetingRepository::RemoveParticipant(const std::string& meeting_id, std::uint64_t participant_id) {
+meeting::common::Status MySqlMeetingRepository::RemoveParticipant(const std::string& meeting_id, std::uint64_t participant_id,
+                                                          std::uint64_t revision) {
     // 获取连接租赁对象
     auto lease_or = pool_->Acquire();
     if (!lease_or.IsOk()) {
@@ -227,17 +300,31 @@ meeting::common::Status MySqlMeetingRepository::RemoveParticipant(const std::str
     auto lease = std::move(lease_or.Value());
     MYSQL* conn = lease.Raw();
 
+    // 删除参与者, 确有删除时写入会议版本号后提交; 两次往返
+    const auto quoted = EscapeAndQuote(conn, meeting_id);
     auto sql = fmt::format(
-        "DELETE FROM meeting_participants WHERE meeting_id = (SELECT id FROM meetings WHERE meeting_id = {}) AND user_id = {}",
-        EscapeAndQuote(conn, meeting_id),
+        "START TRANSACTION; "
+        "DELETE FROM meeting_participants WHERE meeting_id = (SELECT id FROM meetings WHERE meeting_id = {}) AND user_id = {}; "
+        "SELECT ROW_COUNT()",
+        quoted,
         participant_id);
-    if (mysql_real_query(conn, sql.c_str(), sql.size()) != 0) {
-        return meeting::common::Status::Internal(mysql_error(conn));
+    std::vector<ResultPtr> results;
+    auto status = RunBatch(conn, sql, &results);
+    if (!status.IsOk()) {
+        RollbackBatch(conn);
+        return meeting::common::Status::Internal(status.Message());
     }
-    if (mysql_affected_rows(conn) == 0) {
+    MYSQL_ROW row = results.size() == 1 ? mysql_fetch_row(results[0].get()) : nullptr;
+    if (!row || ParseInt64(row[0]) <= 0) {
+        RollbackBatch(conn);
         return meeting::common::Status::NotFound("participant not found");
     }
-    return meeting::common::Status::OK();
+    status = RunBatch(conn, fmt::format("UPDATE meetings SET revision = {} WHERE meeting_id = {}; COMMIT",
+                                        RevisionExpr(revision), quoted), nullptr);
+    if (!status.IsOk()) {
+        RollbackBatch(conn);
+    }
+    return status;
 }
 
 // 列出会议参与者
@@ -269,5 +356,137 @@ meeting::common::StatusOr<std::vector<std::uint64_t>> MySqlMeetingRepository::Li
     return meeting::common::StatusOr<std::vector<std::uint64_t>>(users);
 }
 
+// 会议增量
+meeting::common::StatusOr<meeting::core::MeetingDelta> MySqlMeetingRepository::DiffSince(const std::string& meeting_id,
+                                                                                       std::uint64_t since_revision) const {
+    auto meeting = GetMeeting(meeting_id);
+    if (!meeting.IsOk()) {
+        return meeting.GetStatus();
+    }
+    return meeting::common::StatusOr<meeting::core::MeetingDelta>(
+        meeting::core::DiffMeeting(std::move(meeting).Value(), nullptr, since_revision));
+}
+
+// 开启事务并锁定会议行 (SELECT ... FOR UPDATE), 同时读出参与者; 一次往返.
+// 成功时事务保持打开, 由调用方提交; 失败时已回滚
+meeting::common::StatusOr<meeting::core::MeetingData> MySqlMeetingRepository::LockMeeting(MYSQL* conn, const std::string& meeting_id) {
+    const auto quoted = EscapeAndQuote(conn, meeting_id);
+    auto sql = fmt::format(
+        "START TRANSACTION; "
+        "SELECT meeting_id, meeting_code, organizer_id, topic, state, "
+        "UNIX_TIMESTAMP(created_at), UNIX_TIMESTAMP(updated_at), revision "
+        "FROM meetings WHERE meeting_id = {0} LIMIT 1 FOR UPDATE; "
+        "SELECT user_id FROM meeting_participants WHERE meeting_id = (SELECT id FROM meetings WHERE meeting_id = {0})",
+        quoted);
+    std::vector<ResultPtr> results;
+    auto status = RunBatch(conn, sql, &results);
+    if (!status.IsOk()) {
+        RollbackBatch(conn);
+        return status;
+    }
+    MYSQL_ROW row = results.size() == 2 ? mysql_fetch_row(results[0].get()) : nullptr;
+    if (!row) {
+        RollbackBatch(conn);
+        return meeting::common::Status::NotFound("meeting not found");
+    }
+    meeting::core::MeetingData data = ParseMeetingRow(row);
+    data.participants.Reserve(static_cast<std::size_t>(mysql_num_rows(results[1].get())));
+    MYSQL_ROW prow;
+    while ((prow = mysql_fetch_row(results[1].get())) != nullptr) {
+        data.participants.Insert(ParseUInt64(prow[0]));
+    }
+    return meeting::common::StatusOr<meeting::core::MeetingData>(std::move(data));
+}
+
+// 加入会议: 锁定会议行后按 ApplyJoin 校验, 写入参与者, 版本号与状态并提交; 共两次往返
+meeting::common::StatusOr<meeting::core::MeetingData> MySqlMeetingRepository::JoinAndLoad(const meeting::core::JoinRequest& request) {
+    auto lease_or = pool_->Acquire();
+    if (!lease_or.IsOk()) {
+        return lease_or.GetStatus();
+    }
+    auto lease = std::move(lease_or.Value());
+    MYSQL* conn = lease.Raw();
+
+    auto meeting_or = LockMeeting(conn, request.meeting_id);
+    if (!meeting_or.IsOk()) {
+        return meeting_or.GetStatus();
+    }
+    auto meeting = std::move(meeting_or).Value();
+    const auto previous = meeting.state;
+    auto status = meeting::core::ApplyJoin(meeting, request);
+    if (!status.IsOk()) {
+        RollbackBatch(conn);
+        return status;
+    }
+
+    const auto quoted = EscapeAndQuote(conn, request.meeting_id);
+    auto sql = fmt::format(
+        "INSERT INTO meeting_participants (meeting_id, user_id, role, joined_at) "
+        "VALUES ((SELECT id FROM meetings WHERE meeting_id = {}), {}, 0, NOW()); ",
+        quoted,
+        request.participant_id);
+    if (meeting.state != previous) {
+        sql += fmt::format("UPDATE meetings SET state = {}, updated_at = FROM_UNIXTIME({}), revision = {} WHERE meeting_id = {}; ",
+                           static_cast<int>(meeting.state),
+                           std::max<std::int64_t>(meeting.updated_at, 1),
+                           meeting.revision,
+                           quoted);
+    } else {
+        sql += fmt::format("UPDATE meetings SET revision = {} WHERE meeting_id = {}; ", meeting.revision, quoted);
+    }
+    sql += "COMMIT";
+    status = RunBatch(conn, sql, nullptr);
+    if (!status.IsOk()) {
+        RollbackBatch(conn);
+        return status;
+    }
+    return meeting::common::StatusOr<meeting::core::MeetingData>(std::move(meeting));
+}
+
+// 离开会议: 锁定会议行后按 ApplyLeave 校验, 删除参与者并推进版本号, 需要时结束会议并提交; 共两次往返
+meeting::common::StatusOr<meeting::core::LeaveResult> MySqlMeetingRepository::LeaveAndLoad(const meeting::core::LeaveRequest& request) {
+    auto lease_or = pool_->Acquire();
+    if (!lease_or.IsOk()) {
+        return lease_or.GetStatus();
+    }
+    auto lease = std::move(lease_or.Value());
+    MYSQL* conn = lease.Raw();
+
+    auto meeting_or = LockMeeting(conn, request.meeting_id);
+    if (!meeting_or.IsOk()) {
+        return meeting_or.GetStatus();
+    }
+    meeting::core::LeaveResult result;
+    result.meeting = std::move(meeting_or).Value();
+    auto ended = meeting::core::ApplyLeave(result.meeting, request);
+    if (!ended.IsOk()) {
+        RollbackBatch(conn);
+        return ended.GetStatus();
+    }
+    result.ended = ended.Value();
+
+    const auto quoted = EscapeAndQuote(conn, request.meeting_id);
+    auto sql = fmt::format(
+        "DELETE FROM meeting_participants WHERE meeting_id = (SELECT id FROM meetings WHERE meeting_id = {}) AND user_id = {}; ",
+        quoted,
+        request.participant_id);
+    if (result.ended) {
+        sql += fmt::format("UPDATE meetings SET state = {}, updated_at = FROM_UNIXTIME({}), revision = {} WHERE meeting_id = {}; ",
+                           static_cast<int>(result.meeting.state),
+                           std::max<std::int64_t>(result.meeting.updated_at, 1),
+                           result.meeting.revision,
+                           quoted);
+    } else {
+        sql += fmt::format("UPDATE meetings SET revision = {} WHERE meeting_id = {}; ", result.meeting.revision, quoted);
+    }
+    sql += "COMMIT";
+    auto status = RunBatch(conn, sql, nullptr);
+    if (!status.IsOk()) {
+        RollbackBatch(conn);
+        return status;
+    }
+    return meeting::common::StatusOr<meeting::core::LeaveResult>(std::move(result));
+}
+
 } // namespace storage
 } // namespace meeting
@@ -21,22 +21,36 @@ public:
     meeting::common::StatusOr<meeting::core::MeetingData> GetMeeting(const std::string& meeting_id) const override;
 
     // 更新会议信息
-    meeting::common::Status UpdateMeetingState(const std::string& meeting_id, meeting::core::MeetingState state, std::int64_t updated_at) override;
+    meeting::common::Status UpdateMeetingState(const std::string& meeting_id, meeting::core::MeetingState state, std::int64_t updated_at,
+                                               std::uint64_t revision) override;
 
     // 添加会议参与者
-    meeting::common::Status AddParticipant(const std::string& meeting_id, std::uint64_t participant_id, bool is_organizer) override;
+    meeting::common::Status AddParticipant(const std::string& meeting_id, std::uint64_t participant_id, bool is_organizer,
+                                           std::uint64_t revision) override;
 
     // 移除会议参与者
-    meeting::common::Status RemoveParticipant(const std::string& meeting_id, std::uint64_t participant_id) override;
+    meeting::common::Status RemoveParticipant(const std::string& meeting_id, std::uint64_t participant_id,
+                                              std::uint64_t revision) override;
 
     // 列出会议参与者
     meeting::common::StatusOr<std::vector<std::uint64_t>> ListParticipants(const std::string& meeting_id) const override;
 
+    // 会议增量 (不保存变更记录, 版本变化时返回完整会议数据)
+    meeting::common::StatusOr<meeting::core::MeetingDelta> DiffSince(const std::string& meeting_id, std::uint64_t since_revision) const override;
+
+    // 加入会议 (单个事务, 锁定会议行)
+    meeting::common::StatusOr<meeting::core::MeetingData> JoinAndLoad(const meeting::core::JoinRequest& request) override;
+
+    // 离开会议 (单个事务, 锁定会议行)
+    meeting::common::StatusOr<meeting::core::LeaveResult> LeaveAndLoad(const meeting::core::LeaveRequest& request) override;
+
 private:
     // 转义并加引号字符串值
     static std::string EscapeAndQuote(MYSQL* conn, const std::string& value);
     // 加载会议数据
     meeting::common::StatusOr<meeting::core::MeetingData> LoadMeeting(MYSQL* conn, const std::string& meeting_id) const;
+    // 开启事务并锁定会议行, 读出会议数据
+    static meeting::common::StatusOr<meeting::core::MeetingData> LockMeeting(MYSQL* conn, const std::string& meeting_id);
     
 private:
     std::shared_ptr<ConnectionPool> pool_;
@@ -1,12 +1,16 @@
 #pragma once
 
 #include "mpmc/bounded_circular_queue.hpp"
+#include "mpmc/event_count.hpp"
 
-#include <condition_variable>
+#include <algorithm>
+#include <atomic>
 #include <mutex>
 #include <chrono>
+#include <cstdint>
 #include <optional>
 #include <functional>
+#include <thread>
 #include <tuple>
 #include <iterator>
 #include <type_traits>
@@ -26,11 +30,7 @@ public:
         }
         // Lock-free fast path: try enqueue directly
         if (queue_.TryPush(item)) {
-            const auto prev = pending_count_.fetch_add(1, std::memory_order_release);
-            // Notify only when queue transitions from empty to non-empty
-            if (prev == 0) {
-                not_empty_.notify_one();
-            }
+            OnPushed();
             return true;
         }
         discard_counter_.fetch_add(1, std::memory_order_relaxed);
@@ -45,11 +45,7 @@ public:
             ::new (slot) T(std::move(item));
         };
         if (queue_.TryPushWith(try_push_item)) {
-            const auto prev = pending_count_.fetch_add(1, std::memory_order_release);
-            // Notify only when queue transitions from empty to non-empty
-            if (prev == 0) {
-                not_empty_.notify_one();
-            }
+            OnPushed();
             return true;
         }
         discard_counter_.fetch_add(1, std::memory_order_relaxed);
@@ -62,11 +58,7 @@ public:
         }
         // Lock-free fast path: try enqueue directly
         if (queue_.TryEmplace(std::forward<Args>(args)...)) {
-            const auto prev = pending_count_.fetch_add(1, std::memory_order_release);
-            // Notify only when queue transitions from empty to non-empty
-            if (prev == 0) {
-                not_empty_.notify_one();
-            }
+            OnPushed();
             return true;
         }
         discard_counter_.fetch_add(1, std::memory_order_relaxed);
@@ -76,11 +68,7 @@ public:
     bool TryPop(T& out) {
         // Lock-free fast path: try dequeue directly
         if (queue_.TryPop(out)) {
-            const auto prev = pending_count_.fetch_sub(1, std::memory_order_release);
-            // Notify only when queue transitions from full to non-full
-            if (prev == Capacity()) {
-                not_full_.notify_one();
-            }
+            OnPopped();
             return true;
         }
         return false;
@@ -88,36 +76,7 @@ public:
 
     // Blocking APIs
     bool WaitPush(const T& item) {
-        if (Closed()) {
-            return false;
-        }
-        
-        // Fast path: attempt lock-free enqueue first
-        if (queue_.TryPush(item)) {
-            const auto prev = pending_count_.fetch_add(1, std::memory_order_release);
-            if (prev == 0) {
-                not_empty_.notify_one();
-            }
-            return true;
-        }
-        
-        // Slow path: need to wait, then acquire lock
-        std::unique_lock<std::mutex> lk(push_mutex_);
-        for (;;) {
-            if (Closed()) {
-                return false;
-            }
-            if (queue_.TryPush(item)) {
-                break;
-            }
-            not_full_.wait(lk);
-        }
-        const auto prev = pending_count_.fetch_add(1, std::memory_order_release);
-        lk.unlock();
-        if (prev == 0) {
-            not_empty_.notify_one();
-        }
-        return true;
+        return AwaitPush([&]() { return queue_.TryPush(item); }, nullptr) == Outcome::kDone;
     }
     bool WaitPush(T&& item) {
         if (Closed()) {
@@ -125,35 +84,11 @@ public:
         }
 
         T value(std::move(item));
-        auto try_push_value = [&]() {
+        return AwaitPush([&]() {
             return queue_.TryPushWith([&](void* slot) {
                 ::new (slot) T(std::move(value));
             });
-        };
-
-        if (try_push_value()) {
-            const auto prev = pending_count_.fetch_add(1, std::memory_order_release);
-            if (prev == 0) {
-                not_empty_.notify_one();
-            }
-            return true;
-        }
-
-        std::unique_lock<std::mutex> lk(push_mutex_);
-        for (;;) {
-            if (Closed()) {
-                return false;
-            }
-            if (try_push_value()) {
-                const auto prev = pending_count_.fetch_add(1, std::memory_order_release);
-                lk.unlock();
-                if (prev == 0) {
-                    not_empty_.notify_one();
-                }
-                return true;
-            }
-            not_full_.wait(lk);
-        }
+        }, nullptr) == Outcome::kDone;
     }
     template <class... Args>
     bool WaitEmplace(Args&&... args) {
@@ -162,99 +97,28 @@ public:
         }
 
         std::tuple<std::decay_t<Args>...> stored(std::forward<Args>(args)...);
-        auto try_emplace = [&]() {
+        return AwaitPush([&]() {
             return queue_.TryPushWith([&](void* slot) {
                 std::apply([&](auto&... vals) {
                     ::new (slot) T(std::move(vals)...);
                 }, stored);
             });
-        };
-
-        if (try_emplace()) {
-            const auto prev = pending_count_.fetch_add(1, std::memory_order_release);
-            if (prev == 0) {
-                not_empty_.notify_one();
-            }
-            return true;
-        }
-
-        std::unique_lock<std::mutex> lk(push_mutex_);
-        for (;;) {
-            if (Closed()) {
-                return false;
-            }
-            if (try_emplace()) {
-                const auto prev = pending_count_.fetch_add(1, std::memory_order_release);
-                lk.unlock();
-                if (prev == 0) {
-                    not_empty_.notify_one();
-                }
-                return true;
-            }
-            not_full_.wait(lk);
-        }
+        }, nullptr) == Outcome::kDone;
     }
 
     bool WaitPop(T& out) {
-        // Fast path: attempt lock-free dequeue first
-        if (queue_.TryPop(out)) {
-            pending_count_.fetch_sub(1, std::memory_order_release);
-            not_full_.notify_one();
-            return true;
-        }
-        
-        // Slow path: need to wait, then acquire lock
-        std::unique_lock<std::mutex> lk(pop_mutex_);
-        while (!queue_.TryPop(out)) {
-            if (Closed()) {
-                return false;
-            }
-            not_empty_.wait(lk);
-        }
-        pending_count_.fetch_sub(1, std::memory_order_release);
-        lk.unlock();
-        not_full_.notify_one();
-        return true;
+        return AwaitPop(out, nullptr) == Outcome::kDone;
     }
 
     // Timeout variants
     template <typename Rep, typename Period>
     bool WaitPushFor(const T& item, const std::chrono::duration<Rep, Period>& timeout) {
-        if (Closed()) {
-            return false;
-        }
-        
-        // Fast path: attempt lock-free enqueue first
-        if (queue_.TryPush(item)) {
-            const auto prev = pending_count_.fetch_add(1, std::memory_order_release);
-            if (prev == 0) {
-                not_empty_.notify_one();
-            }
-            return true;
-        }
-        
-        // Slow path: need to wait
-        std::unique_lock<std::mutex> lk(push_mutex_);
-        auto deadline = std::chrono::steady_clock::now() + timeout;
-
-        for (;;) {
-            if (Closed()) {
-                return false;
-            }
-            if (queue_.TryPush(item)) {
-                break;
-            }
-            if (not_full_.wait_until(lk, deadline) == std::cv_status::timeout) {
-                discard_counter_.fetch_add(1, std::memory_order_relaxed);
-                return false;
-            }
-        }
-        const auto prev = pending_count_.fetch_add(1, std::memory_order_release);
-        lk.unlock();
-        if (prev == 0) {
-            not_empty_.notify_one();
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        const Outcome outcome = AwaitPush([&]() { return queue_.TryPush(item); }, &deadline);
+        if (outcome == Outcome::kTimeout) {
+            discard_counter_.fetch_add(1, std::memory_order_relaxed);
         }
-        return true;
+        return outcome == Outcome::kDone;
     }
     template <typename Rep, typename Period>
     bool WaitPushFor(T&& item, const std::chrono::duration<Rep, Period>& timeout) {
@@ -263,67 +127,22 @@ public:
         }
 
         T value(std::move(item));
-        auto try_push_value = [&]() {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        const Outcome outcome = AwaitPush([&]() {
             return queue_.TryPushWith([&](void* slot) {
                 ::new (slot) T(std::move(value));
             });
-        };
-
-        if (try_push_value()) {
-            const auto prev = pending_count_.fetch_add(1, std::memory_order_release);
-            if (prev == 0) {
-                not_empty_.notify_one();
-            }
-            return true;
-        }
-
-        std::unique_lock<std::mutex> lk(push_mutex_);
-        auto deadline = std::chrono::steady_clock::now() + timeout;
-
-        for (;;) {
-            if (Closed()) {
-                return false;
-            }
-            if (try_push_value()) {
-                const auto prev = pending_count_.fetch_add(1, std::memory_order_release);
-                lk.unlock();
-                if (prev == 0) {
-                    not_empty_.notify_one();
-                }
-                return true;
-            }
-            if (not_full_.wait_until(lk, deadline) == std::cv_status::timeout) {
-                discard_counter_.fetch_add(1, std::memory_order_relaxed);
-                return false;
-            }
+        }, &deadline);
+        if (outcome == Outcome::kTimeout) {
+            discard_counter_.fetch_add(1, std::memory_order_relaxed);
         }
+        return outcome == Outcome::kDone;
     }
 
     template <typename Rep, typename Period>
     bool WaitPopFor(T& out, const std::chrono::duration<Rep, Period>& timeout) {
-        // Fast path: attempt lock-free dequeue first
-        if (queue_.TryPop(out)) {
-            pending_count_.fetch_sub(1, std::memory_order_release);
-            not_full_.notify_one();
-            return true;
-        }
-        
-        // Slow path: need to wait
-        std::unique_lock<std::mutex> lk(pop_mutex_);
-        auto deadline = std::chrono::steady_clock::now() + timeout;
-        
-        while (!queue_.TryPop(out)) {
-            if (Closed()) {
-                return false;
-            }
-            if (not_empty_.wait_until(lk, deadline) == std::cv_status::timeout) {
-                return false;
-            }
-        }
-        pending_count_.fetch_sub(1, std::memory_order_release);
-        lk.unlock();
-        not_full_.notify_one();
-        return true;
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        return AwaitPop(out, &deadline) == Outcome::kDone;
     }
 
     // Overwrite an old task
@@ -340,8 +159,7 @@ public:
             });
         };
         if (try_push_hold()) {
-            pending_count_.fetch_add(1, std::memory_order_release);
-            not_empty_.notify_one();
+            OnPushed();
             return true;
         }
 
@@ -364,12 +182,10 @@ public:
             *overwritten = std::move(*tmp);
         }
         const bool ok = try_push_hold();
+        lk.unlock();
         if (ok) {
-            pending_count_.fetch_add(1, std::memory_order_release);
+            OnPushed();
         }
-
-        lk.unlock(); 
-        not_empty_.notify_one();
         return ok;
     }
 
@@ -390,8 +206,8 @@ public:
     void Close() noexcept {
         close_.store(true, std::memory_order_release);
         // Wake all waiting threads
-        not_empty_.notify_all();
-        not_full_.notify_all();
+        not_empty_.NotifyAll();
+        not_full_.NotifyAll();
     }
 
     bool Closed() const noexcept {
@@ -403,7 +219,7 @@ public:
         T tmp;
         while (queue_.TryPop(tmp)) {}
         pending_count_.store(0, std::memory_order_release);
-        not_full_.notify_all();
+        not_full_.NotifyAll();
     }
 
     template <class Visitor>
@@ -417,28 +233,29 @@ public:
             }
         }
         pending_count_.store(0, std::memory_order_release);
-        not_full_.notify_all();
+        not_full_.NotifyAll();
     }
 
     // Number of pending items
     size_type Size() const noexcept {
         return pending_count_.load(std::memory_order_acquire);
     }
-    
+
+    // Threads currently parked (or about to park) waiting for an item
+    bool HasWaitingConsumers() const noexcept {
+        return not_empty_.HasWaiters();
+    }
+
     // Batch non-blocking enqueue
     template <typename Iterator>
     size_type TryPushBatch(Iterator begin, Iterator end) {
         if (Closed()) {
             return 0;
         }
-        
+
         const size_type count = queue_.TryPushBatch(begin, end);
         if (count > 0) {
-            const auto prev = pending_count_.fetch_add(count, std::memory_order_release);
-            // Batch: notify only when the first element is enqueued
-            if (prev == 0) {
-                not_empty_.notify_all();  // For batch, use notify_all to wake multiple consumers
-            }
+            OnPushed(count);
         }
         return count;
     }
@@ -448,11 +265,7 @@ public:
     size_type TryPopBatch(OutputIterator out, size_type max_count) {
         const size_type count = queue_.TryPopBatch(out, max_count);
         if (count > 0) {
-            const auto prev = pending_count_.fetch_sub(count, std::memory_order_release);
-            // Batch: notify when releasing space
-            if (prev >= Capacity() - count && prev <= Capacity()) {
-                not_full_.notify_all();  // For batch, use notify_all to wake multiple producers
-            }
+            OnPopped(count);
         }
         return count;
     }
@@ -474,37 +287,15 @@ public:
         std::advance(it, pushed);
 
         for (; it != end; ++it) {
-            auto try_push_elem = [&]() {
+            const Outcome outcome = AwaitPush([&]() {
                 return queue_.TryPushWith([&](void* slot) {
                     ::new (slot) T(std::move(*it));
                 });
-            };
-
-            if (try_push_elem()) {
-                const auto prev = pending_count_.fetch_add(1, std::memory_order_release);
-                if (prev == 0) {
-                    not_empty_.notify_one();
-                }
-                ++pushed;
-                continue;
-            }
-
-            std::unique_lock<std::mutex> lk(push_mutex_);
-            for (;;) {
-                if (Closed()) {
-                    return pushed;
-                }
-                if (try_push_elem()) {
-                    const auto prev = pending_count_.fetch_add(1, std::memory_order_release);
-                    lk.unlock();
-                    if (prev == 0) {
-                        not_empty_.notify_one();
-                    }
-                    ++pushed;
-                    break;
-                }
-                not_full_.wait(lk);
+            }, nullptr);
+            if (outcome != Outcome::kDone) {
+                return pushed;
             }
+            ++pushed;
         }
 
         return pushed;
@@ -540,23 +331,124 @@ public:
     size_type TryConsumeBatch(Func&& func, size_type max_count) {
         const size_type count = queue_.TryConsumeBatch(std::forward<Func>(func), max_count);
         if (count > 0) {
-            const auto prev = pending_count_.fetch_sub(count, std::memory_order_release);
-            if (prev >= Capacity() - count && prev <= Capacity()) {
-                not_full_.notify_all();
-            }
+            OnPopped(count);
         }
         return count;
     }
 
 private:
-    // Optimization: use multiple fine-grained mutexes to reduce contention
-    mutable std::mutex push_mutex_;       // Used only for waiting on push
-    mutable std::mutex pop_mutex_;        // Used only for waiting on pop
-    mutable std::mutex overwrite_mutex_;  // Used only for overwrite operation
-    std::condition_variable not_full_;
-    std::condition_variable not_empty_;
-    BoundedCircularQueue<T> queue_;       // Lock-free queue
-    std::atomic<size_type> discard_counter_{0};
-    std::atomic<size_type> pending_count_{0};
+    using Deadline = std::chrono::steady_clock::time_point;
+
+    enum class Outcome { kDone, kClosed, kTimeout, kRetry };
+
+    // Adaptive spin budget (attempts before yielding): doubled when spinning pays off, halved when the
+    // waiter had to park anyway. Single-core machines skip the spin phase entirely.
+    static constexpr std::uint32_t kMinSpin = 8;
+    static constexpr std::uint32_t kInitialSpin = 64;
+    static constexpr std::uint32_t kMaxSpin = 2048;
+    static constexpr int kYieldRounds = 2;
+
+    // Counters only; notifications are skipped inside EventCount when nobody is parked
+    void OnPushed(size_type count = 1) noexcept {
+        pending_count_.fetch_add(count, std::memory_order_release);
+        if (count == 1) {
+            not_empty_.NotifyOne();
+        } else {
+            not_empty_.NotifyAll();
+        }
+    }
+    void OnPopped(size_type count = 1) noexcept {
+        pending_count_.fetch_sub(count, std::memory_order_release);
+        if (count == 1) {
+            not_full_.NotifyOne();
+        } else {
+            not_full_.NotifyAll();
+        }
+    }
+
+    template <typename Attempt>
+    Outcome AwaitPush(Attempt&& attempt, const Deadline* deadline) {
+        const Outcome outcome = Await(not_full_, push_spin_, [&]() {
+            if (Closed()) {
+                return Outcome::kClosed;
+            }
+            return attempt() ? Outcome::kDone : Outcome::kRetry;
+        }, deadline);
+        if (outcome == Outcome::kDone) {
+            OnPushed();
+        }
+        return outcome;
+    }
+
+    Outcome AwaitPop(T& out, const Deadline* deadline) {
+        // Drain before honouring close so queued items are still delivered
+        const Outcome outcome = Await(not_empty_, pop_spin_, [&]() {
+            if (queue_.TryPop(out)) {
+                return Outcome::kDone;
+            }
+            return Closed() ? Outcome::kClosed : Outcome::kRetry;
+        }, deadline);
+        if (outcome == Outcome::kDone) {
+            OnPopped();
+        }
+        return outcome;
+    }
+
+    // Spin (pause) -> yield -> park on the event count until step() stops asking for a retry
+    template <typename Step>
+    static Outcome Await(EventCount& event, std::atomic<std::uint32_t>& spin_budget, Step&& step,
+                         const Deadline* deadline) {
+        Outcome outcome = step();
+        if (outcome != Outcome::kRetry) {
+            return outcome;
+        }
+
+        static const bool multi_core = std::thread::hardware_concurrency() > 1;
+        const std::uint32_t budget = multi_core ? spin_budget.load(std::memory_order_relaxed) : 0;
+        for (std::uint32_t i = 0; i < budget; ++i) {
+            EventCount::CpuRelax();
+            outcome = step();
+            if (outcome != Outcome::kRetry) {
+                spin_budget.store(std::min(kMaxSpin, budget * 2), std::memory_order_relaxed);
+                return outcome;
+            }
+        }
+        for (int i = 0; i < kYieldRounds; ++i) {
+            std::this_thread::yield();
+            outcome = step();
+            if (outcome != Outcome::kRetry) {
+                return outcome;
+            }
+        }
+        if (multi_core) {
+            spin_budget.store(std::max(kMinSpin, budget / 2), std::memory_order_relaxed);
+        }
+
+        for (;;) {
+            const EventCount::Key key = event.PrepareWait();
+            outcome = step();
+            if (outcome != Outcome::kRetry) {
+                event.CancelWait();
+                return outcome;
+            }
+            if (deadline == nullptr) {
+                event.Wait(key);
+            } else if (!event.WaitUntil(key, *deadline)) {
+                // A wakeup may have raced with the timeout: take one last look before giving up
+                outcome = step();
+                return outcome == Outcome::kRetry ? Outcome::kTimeout : outcome;
+            }
+        }
+    }
+
+    // Read on every operation, written rarely: kept apart from pending_count_, which every push/pop writes
     std::atomic<bool> close_{false};
+    EventCount not_full_;                 // Producers parked on a full queue
+    EventCount not_empty_;                // Consumers parked on an empty queue
+    std::atomic<std::uint32_t> push_spin_{kInitialSpin};
+    std::atomic<std::uint32_t> pop_spin_{kInitialSpin};
+    BoundedCircularQueue<T> queue_;       // Lock-free queue (cursors padded internally)
+    alignas(64) std::atomic<size_type> pending_count_{0};
+    std::atomic<size_type> discard_counter_{0};
+    mutable std::mutex overwrite_mutex_;  // Used only for overwrite operation
 };
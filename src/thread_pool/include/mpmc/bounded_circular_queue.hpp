@@ -169,33 +169,32 @@ public:
         return count;
     }
 
-    // Batch dequeue
+    // Batch dequeue: claims up to max_count consecutive ready cells with a single CAS on consumer_pos_
     template <typename OutputIterator>
     size_type TryPopBatch(OutputIterator out, size_type max_count) {
-        size_type count = 0;
-        T item;
-        for (size_type i = 0; i < max_count; ++i) {
-            if (!TryPop(item)) {
-                break;
-            }
-            *out++ = std::move(item);
-            ++count;
+        size_type pos = 0;
+        const size_type count = ClaimBatch(max_count, pos);
+        for (size_type i = 0; i < count; ++i) {
+            Cell& cell = buffer_[(pos + i) & mask_];
+            T* elem = std::launder(reinterpret_cast<T*>(static_cast<void*>(cell.storage_)));
+            *out++ = std::move(*elem);
+            elem->~T();
+            cell.seq_.store(pos + i + capacity_, std::memory_order_release);
         }
         return count;
     }
 
-    // Batch consume (with callback)
+    // Batch consume (with callback); the range is claimed with a single CAS like TryPopBatch
     template <typename Func>
     size_type TryConsumeBatch(Func&& func, size_type max_count) {
-        size_type count = 0;
-        for (size_type i = 0; i < max_count; ++i) {
-            bool consumed = TryPopConsume([&](T&& item) {
-                func(std::move(item));
-            });
-            if (!consumed) {
-                break;
-            }
-            ++count;
+        size_type pos = 0;
+        const size_type count = ClaimBatch(max_count, pos);
+        for (size_type i = 0; i < count; ++i) {
+            Cell& cell = buffer_[(pos + i) & mask_];
+            T* elem = std::launder(reinterpret_cast<T*>(static_cast<void*>(cell.storage_)));
+            func(std::move(*elem));
+            elem->~T();
+            cell.seq_.store(pos + i + capacity_, std::memory_order_release);
         }
         return count;
     }
@@ -236,6 +235,44 @@ private:
         return RoundUpToPow2(n);
     }
 
+    // Dequeue helper: count the published cells from consumer_pos_ (up to max_count) and claim them all
+    // with one CAS. Cells seen as published stay so until consumed, and consumer_pos_ only grows, so a
+    // successful CAS hands the whole range [start, start + count) to this consumer.
+    // The caller must move out and release every claimed cell (element moves must not throw).
+    size_type ClaimBatch(size_type max_count, size_type& start) {
+        if (max_count == 0) {
+            return 0;
+        }
+        size_type pos = consumer_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            const size_type seq = buffer_[pos & mask_].seq_.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff < 0) {
+                // Queue empty
+                return 0;
+            }
+            if (diff > 0) {
+                // Another consumer claimed the cell; reload consumer_pos_ and retry
+                pos = consumer_pos_.load(std::memory_order_relaxed);
+                continue;
+            }
+            size_type count = 1;
+            while (count < max_count
+                   && buffer_[(pos + count) & mask_].seq_.load(std::memory_order_acquire) == pos + count + 1) {
+                ++count;
+            }
+            if (consumer_pos_.compare_exchange_weak(
+                    pos, pos + count
+                    , std::memory_order_relaxed
+                    , std::memory_order_relaxed
+            )) {
+                start = pos;
+                return count;
+            }
+            // CAS failure reloaded pos; rescan from there
+        }
+    }
+
     // Enqueue helper: claim cell storage and construct in-place
     template <typename Func>
     bool DoPush(Func&& f) {
@@ -280,6 +317,8 @@ private:
     const size_type mask_; // equals capacity_ - 1
     std::vector<Cell> buffer_;
 
-    alignas(64) std::atomic<size_type> producer_pos_{0};
-    alignas(64) std::atomic<size_type> consumer_pos_{0};
+    // Producer and consumer cursors each own a 128-byte block: x86 adjacent-line prefetch pulls cache lines in
+    // pairs, so 64-byte padding alone still lets the two cursors (and the read-only fields above) interfere
+    alignas(128) std::atomic<size_type> producer_pos_{0};
+    alignas(128) std::atomic<size_type> consumer_pos_{0};
 };
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Event count (Vyukov / folly style): lets a thread sleep until a lock-free condition may have changed
+// without a mutex on the fast path. Waiters announce themselves before re-checking the condition; notifiers
+// only pay for a fence and a load when nobody is parked, and bump the epoch + futex-wake otherwise.
+//
+//   auto key = ec.PrepareWait();
+//   if (condition()) { ec.CancelWait(); return; }
+//   ec.Wait(key);
+class EventCount {
+public:
+    using Key = std::uint32_t;
+
+    EventCount() = default;
+    EventCount(const EventCount&) = delete;
+    EventCount& operator=(const EventCount&) = delete;
+
+    // Register as a waiter and snapshot the epoch; must be followed by CancelWait or Wait*
+    Key PrepareWait() noexcept {
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        // Pairs with the fence in Notify: either the notifier sees us or we see its state change
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return epoch_.load(std::memory_order_acquire);
+    }
+
+    void CancelWait() noexcept {
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // Block until a notification newer than key arrives (may also return spuriously)
+    void Wait(Key key) noexcept {
+        if (epoch_.load(std::memory_order_acquire) == key) {
+            Park(key, nullptr);
+        }
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // Like Wait but gives up at deadline; returns false on timeout
+    template <typename Clock, typename Duration>
+    bool WaitUntil(Key key, const std::chrono::time_point<Clock, Duration>& deadline) noexcept {
+        bool notified = true;
+        if (epoch_.load(std::memory_order_acquire) == key) {
+            const auto remaining = deadline - Clock::now();
+            if (remaining.count() <= 0) {
+                notified = false;
+            } else {
+                const auto timeout = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining);
+                Park(key, &timeout);
+                notified = epoch_.load(std::memory_order_acquire) != key || Clock::now() < deadline;
+            }
+        }
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+        return notified;
+    }
+
+    void NotifyOne() noexcept {
+        Notify(1);
+    }
+
+    void NotifyAll() noexcept {
+        Notify(INT_MAX);
+    }
+
+    bool HasWaiters() const noexcept {
+        return waiters_.load(std::memory_order_relaxed) != 0;
+    }
+
+    // Spin-loop hint (x86 pause / arm yield)
+    static void CpuRelax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        asm volatile("yield" ::: "memory");
+#else
+        std::this_thread::yield();
+#endif
+    }
+
+private:
+    void Notify(int count) noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+        epoch_.fetch_add(1, std::memory_order_release);
+        Wake(count);
+    }
+
+#if defined(__linux__)
+    static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "futex word must be a plain 32-bit int");
+
+    void Park(Key key, const std::chrono::nanoseconds* timeout) noexcept {
+        timespec ts{};
+        if (timeout != nullptr) {
+            ts.tv_sec = static_cast<time_t>(timeout->count() / 1000000000LL);
+            ts.tv_nsec = static_cast<long>(timeout->count() % 1000000000LL);
+        }
+        // EAGAIN when the epoch already moved, EINTR/ETIMEDOUT are reported as spurious returns
+        ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&epoch_), FUTEX_WAIT_PRIVATE, key,
+                  timeout != nullptr ? &ts : nullptr, nullptr, 0);
+    }
+
+    void Wake(int count) noexcept {
+        ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&epoch_), FUTEX_WAKE_PRIVATE, count, nullptr,
+                  nullptr, 0);
+    }
+#else
+    void Park(Key key, const std::chrono::nanoseconds* timeout) noexcept {
+        std::unique_lock<std::mutex> lk(mutex_);
+        auto pred = [&]() { return epoch_.load(std::memory_order_acquire) != key; };
+        if (timeout != nullptr) {
+            cv_.wait_for(lk, *timeout, pred);
+        } else {
+            cv_.wait(lk, pred);
+        }
+    }
+
+    void Wake(int count) noexcept {
+        // Lock so a waiter between its epoch check and cv wait cannot miss the bump
+        { std::lock_guard<std::mutex> lk(mutex_); }
+        if (count == 1) {
+            cv_.notify_one();
+        } else {
+            cv_.notify_all();
+        }
+    }
+
+    std::mutex              mutex_;
+    std::condition_variable cv_;
+#endif
+
+    std::atomic<std::uint32_t> epoch_{0};    // Futex word, bumped on every delivered notification
+    std::atomic<std::uint32_t> waiters_{0};  // Threads between PrepareWait and the end of Wait
+};
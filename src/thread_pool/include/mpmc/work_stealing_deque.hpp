@@ -0,0 +1,134 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Chase-Lev work-stealing deque (Le et al., "Correct and Efficient Work-Stealing for Weak Memory Models").
+// The owner thread pushes/pops at the bottom (LIFO); any other thread steals from the top (FIFO).
+// The buffer grows on demand; retired buffers are kept until destruction because a concurrent
+// stealer may still be reading from them.
+template <typename T>
+class WorkStealingDeque {
+    static_assert(std::is_trivially_copyable_v<T>, "WorkStealingDeque stores elements in std::atomic<T>");
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    explicit WorkStealingDeque(size_type initial_capacity = 256)
+        : array_(new Array(RoundUpPow2(initial_capacity))) {}
+    ~WorkStealingDeque() {
+        delete array_.load(std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+    WorkStealingDeque(WorkStealingDeque&&) = delete;
+    WorkStealingDeque& operator=(WorkStealingDeque&&) = delete;
+
+    // Owner only
+    void Push(T item) {
+        const std::int64_t b = bottom_.load(std::memory_order_relaxed);
+        const std::int64_t t = top_.load(std::memory_order_acquire);
+        Array* a = array_.load(std::memory_order_relaxed);
+        if (b - t > a->capacity - 1) {
+            Array* grown = a->Grow(b, t);
+            retired_.emplace_back(a);
+            array_.store(grown, std::memory_order_release);
+            a = grown;
+        }
+        a->Store(b, item);
+        // Publish the element together with the new bottom
+        bottom_.store(b + 1, std::memory_order_release);
+    }
+
+    // Owner only
+    bool Pop(T& out) {
+        const std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Array* a = array_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top_.load(std::memory_order_relaxed);
+        if (t > b) {
+            // Empty
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        out = a->Load(b);
+        if (t == b) {
+            // Last element: race against stealers for it
+            const bool won = top_.compare_exchange_strong(
+                t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // Any thread; false when empty or when another thief won the race
+    bool Steal(T& out) {
+        std::int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) {
+            return false;
+        }
+        Array* a = array_.load(std::memory_order_acquire);
+        T item = a->Load(t);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return false;
+        }
+        out = item;
+        return true;
+    }
+
+    // Approximate number of queued elements
+    size_type Size() const noexcept {
+        const std::int64_t b = bottom_.load(std::memory_order_relaxed);
+        const std::int64_t t = top_.load(std::memory_order_relaxed);
+        return b > t ? static_cast<size_type>(b - t) : 0;
+    }
+
+    bool Empty() const noexcept {
+        return Size() == 0;
+    }
+
+private:
+    struct Array {
+        explicit Array(std::int64_t cap)
+            : capacity(cap), mask(cap - 1), slots(new std::atomic<T>[static_cast<size_type>(cap)]) {}
+
+        T Load(std::int64_t i) const noexcept {
+            return slots[static_cast<size_type>(i & mask)].load(std::memory_order_relaxed);
+        }
+        void Store(std::int64_t i, T item) noexcept {
+            slots[static_cast<size_type>(i & mask)].store(item, std::memory_order_relaxed);
+        }
+        Array* Grow(std::int64_t bottom, std::int64_t top) const {
+            auto* grown = new Array(capacity * 2);
+            for (std::int64_t i = top; i < bottom; ++i) {
+                grown->Store(i, Load(i));
+            }
+            return grown;
+        }
+
+        std::int64_t capacity;
+        std::int64_t mask;
+        std::unique_ptr<std::atomic<T>[]> slots;
+    };
+
+    static std::int64_t RoundUpPow2(size_type n) noexcept {
+        std::int64_t cap = 2;
+        while (static_cast<size_type>(cap) < n) {
+            cap <<= 1;
+        }
+        return cap;
+    }
+
+    alignas(64) std::atomic<std::int64_t> top_{0};     // Steal end (shared by thieves)
+    alignas(64) std::atomic<std::int64_t> bottom_{0};  // Owner end
+    std::atomic<Array*> array_;                        // Current buffer
+    std::vector<std::unique_ptr<Array>> retired_;      // Outgrown buffers (owner only)
+};
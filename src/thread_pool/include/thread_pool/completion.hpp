@@ -0,0 +1,326 @@
+#pragma once
+
+#include "thread_pool/move_only_function.hpp"
+#include "thread_pool/task_allocator.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace thread_pool {
+
+template <typename T>
+class Completion;
+template <typename T>
+class CompletionPromise;
+
+namespace detail {
+
+// Block while word == expected (futex on Linux, yield polling elsewhere); may return spuriously
+void WaitOnWord(const std::atomic<std::uint32_t>& word, std::uint32_t expected) noexcept;
+void WakeAllOnWord(std::atomic<std::uint32_t>& word) noexcept;
+
+struct VoidResult {};
+
+template <typename Fn, typename T>
+struct ThenResult {
+    using type = std::invoke_result_t<Fn, T>;
+};
+template <typename Fn>
+struct ThenResult<Fn, void> {
+    using type = std::invoke_result_t<Fn>;
+};
+
+// Shared state of a one-shot completion: one producer (CompletionPromise) and one consumer (Completion).
+// The consumer either blocks in Wait/Get or attaches a callback that runs on the thread that completes it.
+template <typename T>
+class CompletionState {
+public:
+    using Value = std::conditional_t<std::is_void_v<T>, VoidResult, T>;
+    using Callback = MoveOnlyFunction<void(Completion<T>)>;
+
+    static void* operator new(std::size_t size) {
+        return TaskAllocator::Allocate(size);
+    }
+    static void operator delete(void* ptr, std::size_t size) noexcept {
+        TaskAllocator::Deallocate(ptr, size);
+    }
+
+    void Release() noexcept {
+        if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    bool Ready() const noexcept {
+        return ready_.load(std::memory_order_acquire) != 0;
+    }
+
+    void Wait() noexcept {
+        for (int spin = 0; spin < kSpin; ++spin) {
+            if (Ready()) {
+                return;
+            }
+        }
+        // seq_cst pairs with Publish: either the producer sees a waiter or we see the result
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        while (ready_.load(std::memory_order_seq_cst) == 0) {
+            WaitOnWord(ready_, 0);
+        }
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    template <typename... V>
+    void SetValue(V&&... v) {
+        value_.emplace(std::forward<V>(v)...);
+        Publish();
+    }
+
+    void SetException(std::exception_ptr eptr) noexcept {
+        error_ = std::move(eptr);
+        Publish();
+    }
+
+    // Takes over the consumer reference; returns false (callback not stored) when already completed
+    bool Attach(Callback& cb) noexcept {
+        callback_ = std::move(cb);
+        std::uint32_t expected = kEmpty;
+        if (phase_.compare_exchange_strong(expected, kCallback, std::memory_order_acq_rel,
+                                           std::memory_order_acquire)) {
+            return true;
+        }
+        cb = std::move(callback_);
+        return false;
+    }
+
+    Value TakeValue() {
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+        return std::move(*value_);
+    }
+
+private:
+    static constexpr int kSpin = 64;
+    static constexpr std::uint32_t kEmpty = 0;     // neither result nor callback yet
+    static constexpr std::uint32_t kCallback = 1;  // callback attached, waiting for the result
+    static constexpr std::uint32_t kResult = 2;    // result published
+
+    void Publish() noexcept;
+
+    std::atomic<std::uint32_t> refs_{2};  // producer + consumer
+    std::atomic<std::uint32_t> phase_{kEmpty};
+    std::atomic<std::uint32_t> ready_{0};
+    std::atomic<std::uint32_t> waiters_{0};
+    std::optional<Value>       value_;
+    std::exception_ptr         error_;
+    Callback                   callback_;
+};
+
+} // namespace detail
+
+// Consumer side of a one-shot result: a lighter alternative to std::future
+// (no mutex/condvar; waiting parks on a futex, continuations run inline on the completing thread).
+// Move-only; Get, Then and OnComplete consume the handle.
+template <typename T>
+class Completion {
+public:
+    using State = detail::CompletionState<T>;
+
+    Completion() noexcept = default;
+    explicit Completion(State* state) noexcept : state_(state) {}  // adopts one reference
+    Completion(Completion&& other) noexcept : state_(std::exchange(other.state_, nullptr)) {}
+    Completion& operator=(Completion&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            state_ = std::exchange(other.state_, nullptr);
+        }
+        return *this;
+    }
+    Completion(const Completion&) = delete;
+    Completion& operator=(const Completion&) = delete;
+    ~Completion() {
+        Reset();
+    }
+
+    bool Valid() const noexcept {
+        return state_ != nullptr;
+    }
+
+    bool Ready() const noexcept {
+        return state_ != nullptr && state_->Ready();
+    }
+
+    void Wait() const {
+        CheckValid();
+        state_->Wait();
+    }
+
+    // Blocks until completed, then returns the value or rethrows the stored exception
+    T Get() {
+        CheckValid();
+        state_->Wait();
+        Completion hold(std::exchange(state_, nullptr));
+        if constexpr (std::is_void_v<T>) {
+            hold.state_->TakeValue();
+        } else {
+            return hold.state_->TakeValue();
+        }
+    }
+
+    // Runs callback(Completion<T>) exactly once with a ready handle: inline when already completed,
+    // otherwise on the thread that completes the promise. The callback must not throw.
+    template <typename Callback>
+    void OnComplete(Callback&& callback) {
+        CheckValid();
+        typename State::Callback cb(std::forward<Callback>(callback));
+        State* state = std::exchange(state_, nullptr);
+        if (!state->Attach(cb)) {
+            cb(Completion(state));
+        }
+    }
+
+    // Chains fn(value) (fn() for void) after this completion; exceptions skip fn and propagate
+    template <typename Fn>
+    auto Then(Fn&& fn) {
+        using Next = typename detail::ThenResult<std::decay_t<Fn>&, T>::type;
+        CompletionPromise<Next> next;
+        Completion<Next> result = next.GetCompletion();
+        OnComplete([next = std::move(next), fn = std::decay_t<Fn>(std::forward<Fn>(fn))](Completion<T> done) mutable {
+            try {
+                if constexpr (std::is_void_v<T>) {
+                    done.Get();
+                    if constexpr (std::is_void_v<Next>) {
+                        fn();
+                        next.SetValue();
+                    } else {
+                        next.SetValue(fn());
+                    }
+                } else if constexpr (std::is_void_v<Next>) {
+                    fn(done.Get());
+                    next.SetValue();
+                } else {
+                    next.SetValue(fn(done.Get()));
+                }
+            } catch (...) {
+                next.SetException(std::current_exception());
+            }
+        });
+        return result;
+    }
+
+private:
+    void CheckValid() const {
+        if (state_ == nullptr) {
+            throw std::logic_error("Completion: no shared state");
+        }
+    }
+
+    void Reset() noexcept {
+        if (state_ != nullptr) {
+            std::exchange(state_, nullptr)->Release();
+        }
+    }
+
+    State* state_{nullptr};
+};
+
+// Producer side. Destroying an unsatisfied promise completes it with an exception (like std::broken_promise).
+template <typename T>
+class CompletionPromise {
+public:
+    using State = detail::CompletionState<T>;
+
+    CompletionPromise() : state_(new State()) {}
+    CompletionPromise(CompletionPromise&& other) noexcept
+        : state_(std::exchange(other.state_, nullptr)), retrieved_(other.retrieved_) {}
+    CompletionPromise& operator=(CompletionPromise&& other) noexcept {
+        if (this != &other) {
+            Abandon();
+            state_ = std::exchange(other.state_, nullptr);
+            retrieved_ = other.retrieved_;
+        }
+        return *this;
+    }
+    CompletionPromise(const CompletionPromise&) = delete;
+    CompletionPromise& operator=(const CompletionPromise&) = delete;
+    ~CompletionPromise() {
+        Abandon();
+    }
+
+    // True until the result has been set (or the promise moved from)
+    bool Valid() const noexcept {
+        return state_ != nullptr;
+    }
+
+    Completion<T> GetCompletion() {
+        if (state_ == nullptr || retrieved_) {
+            throw std::logic_error("CompletionPromise: completion already retrieved");
+        }
+        retrieved_ = true;
+        return Completion<T>(state_);
+    }
+
+    // A throwing value constructor completes the promise with that exception instead
+    template <typename... V>
+    void SetValue(V&&... v) {
+        State* state = Take();
+        try {
+            state->SetValue(std::forward<V>(v)...);
+        } catch (...) {
+            state->SetException(std::current_exception());
+        }
+        state->Release();
+    }
+
+    void SetException(std::exception_ptr eptr) {
+        State* state = Take();
+        state->SetException(std::move(eptr));
+        state->Release();
+    }
+
+private:
+    State* Take() {
+        if (state_ == nullptr) {
+            throw std::logic_error("CompletionPromise: already satisfied");
+        }
+        if (!retrieved_) {
+            // Nobody will consume the result: drop the consumer reference up front
+            retrieved_ = true;
+            state_->Release();
+        }
+        return std::exchange(state_, nullptr);
+    }
+
+    void Abandon() noexcept {
+        if (state_ != nullptr) {
+            SetException(std::make_exception_ptr(std::runtime_error("CompletionPromise: broken promise")));
+        }
+    }
+
+    State* state_{nullptr};
+    bool   retrieved_{false};
+};
+
+namespace detail {
+
+template <typename T>
+void CompletionState<T>::Publish() noexcept {
+    ready_.store(1, std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_seq_cst) != 0) {
+        WakeAllOnWord(ready_);
+    }
+    // The consumer reference moves into the callback's handle
+    if (phase_.exchange(kResult, std::memory_order_acq_rel) == kCallback) {
+        Callback cb = std::move(callback_);
+        cb(Completion<T>(this));
+    }
+}
+
+} // namespace detail
+
+}
@@ -5,6 +5,7 @@
 #include <string>
 #include <optional>
 #include <mutex>
+#include <vector>
 
 namespace thread_pool {
 
@@ -47,10 +48,19 @@ private:
         std::optional<std::size_t> debounce_hits;           // debounce hit count
         std::optional<std::size_t> cooldown_ms;             // cooldown after capacity change (ms)
         std::optional<std::string> queue_policy;            // backpressure policy
+        std::optional<std::string> scheduler;               // scheduler mode
+        std::optional<std::vector<LaneConfig>> lanes;       // priority lanes
+        std::optional<std::string> affinity;                // worker CPU pinning
+        std::optional<std::vector<int>> cpus;               // CPUs for the List affinity
+        std::optional<bool>        honor_cpu_quota;         // cap threads at the cgroup CPU quota
+        std::optional<int>         timer_tick_ms;           // timer wheel resolution (ms)
     };
     // Parsing layer
     static RawConfig ParseRaw(const nlohmann::json& jcfg);
     static QueueFullPolicy ParsePolicy(const std::string& policy);
+    static SchedulerMode ParseScheduler(const std::string& scheduler);
+    static LaneConfig ParseLane(const nlohmann::json& jlane);
+    static AffinityMode ParseAffinity(const std::string& affinity);
 
     // Validation/Normalization layer
     static ThreadPoolConfig Normalize(const RawConfig& raw);
@@ -0,0 +1,274 @@
+#pragma once
+
+// C++20 coroutine support for ThreadPool. Compiles to nothing below C++20; THREAD_POOL_HAS_COROUTINES tells
+// callers whether Task<T> is available (configure with -DENABLE_COROUTINES=ON to build the project as C++20).
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#define THREAD_POOL_HAS_COROUTINES 1
+
+#include "thread_pool/completion.hpp"
+#include "thread_pool/task_allocator.hpp"
+#include "thread_pool/thread_pool.hpp"
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace thread_pool {
+
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+// Frames come from TaskAllocator like task nodes; continuation and exception are shared by all result types
+class TaskPromiseBase {
+public:
+    static void* operator new(std::size_t size) {
+        return TaskAllocator::Allocate(size);
+    }
+    static void operator delete(void* ptr, std::size_t size) noexcept {
+        TaskAllocator::Deallocate(ptr, size);
+    }
+
+    // Symmetric transfer back to the awaiting coroutine, so deep co_await chains do not grow the stack
+    struct FinalAwaiter {
+        bool await_ready() const noexcept {
+            return false;
+        }
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> self) noexcept {
+            const auto next = self.promise().continuation_;
+            return next ? next : std::noop_coroutine();
+        }
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept {
+        return {};
+    }
+    FinalAwaiter final_suspend() const noexcept {
+        return {};
+    }
+    void unhandled_exception() noexcept {
+        exception_ = std::current_exception();
+    }
+    void SetContinuation(std::coroutine_handle<> continuation) noexcept {
+        continuation_ = continuation;
+    }
+
+protected:
+    void RethrowIfFailed() const {
+        if (exception_) {
+            std::rethrow_exception(exception_);
+        }
+    }
+
+private:
+    std::coroutine_handle<> continuation_;
+    std::exception_ptr      exception_;
+};
+
+template <typename T>
+class TaskPromise : public TaskPromiseBase {
+public:
+    Task<T> get_return_object() noexcept;
+
+    template <typename V, typename = std::enable_if_t<std::is_convertible_v<V&&, T>>>
+    void return_value(V&& value) {
+        value_.emplace(std::forward<V>(value));
+    }
+
+    T Result() {
+        RethrowIfFailed();
+        return std::move(*value_);
+    }
+
+private:
+    std::optional<T> value_;
+};
+
+template <>
+class TaskPromise<void> : public TaskPromiseBase {
+public:
+    Task<void> get_return_object() noexcept;
+
+    void return_void() noexcept {}
+
+    void Result() {
+        RethrowIfFailed();
+    }
+};
+
+} // namespace detail
+
+// Lazily started coroutine producing T: the body runs when the task is awaited (or handed to Spawn) and
+// finishes on whatever thread its last co_await resumed on. Move-only; destroying it destroys the frame.
+template <typename T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Task() noexcept = default;
+    explicit Task(Handle handle) noexcept : handle_(handle) {}
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() {
+        Reset();
+    }
+
+    bool Valid() const noexcept {
+        return static_cast<bool>(handle_);
+    }
+
+    // co_await std::move(task): starts the body and resumes the awaiter with its result (or exception)
+    auto operator co_await() && noexcept {
+        struct Awaiter {
+            Handle handle;
+
+            bool await_ready() const noexcept {
+                return !handle || handle.done();
+            }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().SetContinuation(awaiting);
+                return handle;
+            }
+            T await_resume() {
+                if (!handle) {
+                    throw std::logic_error("Task: no coroutine");
+                }
+                return handle.promise().Result();
+            }
+        };
+        return Awaiter{handle_};
+    }
+
+private:
+    void Reset() noexcept {
+        if (handle_) {
+            std::exchange(handle_, {}).destroy();
+        }
+    }
+
+    Handle handle_;
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() noexcept {
+    return Task<T>(Task<T>::Handle::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+    return Task<void>(Task<void>::Handle::from_promise(*this));
+}
+
+// Awaits a Completion without blocking: the coroutine resumes on the thread that completes it, or inline
+// when the result arrives before await_suspend returns (whichever of the two comes second resumes).
+template <typename T>
+class CompletionAwaiter {
+public:
+    explicit CompletionAwaiter(Completion<T> pending) noexcept : pending_(std::move(pending)) {}
+
+    bool await_ready() const noexcept {
+        return pending_.Ready();
+    }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+        handle_ = handle;
+        pending_.OnComplete([this](Completion<T> done) {
+            done_ = std::move(done);
+            if (second_.exchange(true, std::memory_order_acq_rel)) {
+                handle_.resume();
+            }
+        });
+        return !second_.exchange(true, std::memory_order_acq_rel);
+    }
+
+    T await_resume() {
+        return (done_.Valid() ? done_ : pending_).Get();
+    }
+
+private:
+    Completion<T>           pending_;
+    Completion<T>           done_;
+    std::coroutine_handle<> handle_;
+    std::atomic<bool>       second_{false};
+};
+
+// Fire-and-forget frame used by Spawn: starts eagerly and frees itself when the body ends
+struct Detached {
+    struct promise_type {
+        static void* operator new(std::size_t size) {
+            return TaskAllocator::Allocate(size);
+        }
+        static void operator delete(void* ptr, std::size_t size) noexcept {
+            TaskAllocator::Deallocate(ptr, size);
+        }
+
+        Detached get_return_object() const noexcept {
+            return {};
+        }
+        std::suspend_never initial_suspend() const noexcept {
+            return {};
+        }
+        std::suspend_never final_suspend() const noexcept {
+            return {};
+        }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept {
+            std::terminate();  // RunSpawned catches everything
+        }
+    };
+};
+
+template <typename T>
+Detached RunSpawned(ThreadPool& pool, LaneId lane, Task<T> task, CompletionPromise<T> promise) {
+    try {
+        co_await pool.Schedule(lane);
+        if constexpr (std::is_void_v<T>) {
+            co_await std::move(task);
+            promise.SetValue();
+        } else {
+            promise.SetValue(co_await std::move(task));
+        }
+    } catch (...) {
+        promise.SetException(std::current_exception());
+    }
+}
+
+} // namespace detail
+
+// co_await pool.SubmitCompletion(...): suspends instead of parking the thread in Completion::Get
+template <typename T>
+detail::CompletionAwaiter<T> operator co_await(Completion<T>&& pending) noexcept {
+    return detail::CompletionAwaiter<T>(std::move(pending));
+}
+
+// Runs task on a worker of the lane; the Completion carries its result, or the exception it threw
+// (including a rejected Schedule when the pool is not running). The pool must outlive the task.
+template <typename T>
+Completion<T> Spawn(ThreadPool& pool, Task<T> task, LaneId lane = kDefaultLane) {
+    CompletionPromise<T> promise;
+    Completion<T> completion = promise.GetCompletion();
+    detail::RunSpawned(pool, lane, std::move(task), std::move(promise));
+    return completion;
+}
+
+}
+
+#endif
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "thread_pool/fwd.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace thread_pool {
+
+// CPUs this process may run on, grouped by NUMA node.
+// Detect() reads sysfs and the scheduler affinity mask; without NUMA information every allowed CPU lands in node 0.
+class CpuTopology {
+public:
+    CpuTopology() = default;
+    explicit CpuTopology(std::vector<std::vector<int>> nodes);
+
+    static CpuTopology Detect();
+
+    const std::vector<std::vector<int>>& Nodes() const noexcept;
+    std::size_t NodeCount() const noexcept;
+    std::size_t CpuCount() const noexcept;
+    std::size_t NodeOf(int cpu) const noexcept;  // 0 for CPUs outside the topology
+
+    // CPU order for workers: Compact fills one node before the next, Scatter alternates between nodes,
+    // List keeps the given CPUs that are allowed. Empty for AffinityMode::None (or nothing allowed).
+    std::vector<int> Placement(AffinityMode mode, const std::vector<int>& cpus) const;
+
+    // "0-3,8,10-11" -> {0,1,2,3,8,10,11}; malformed entries are skipped
+    static std::vector<int> ParseCpuList(std::string_view list);
+
+    // CPUs granted by the cgroup CPU quota (v2 cpu.max, v1 cfs_quota_us / cfs_period_us), nullopt when unlimited
+    static std::optional<double> CgroupCpuLimit(const std::string& cgroup_root = "/sys/fs/cgroup");
+
+    // Bind the calling thread to one CPU; false when unsupported or refused
+    static bool PinCurrentThread(int cpu) noexcept;
+
+private:
+    std::vector<std::vector<int>> nodes_;
+};
+
+}
@@ -1,5 +1,9 @@
 #pragma once
 
+#include "thread_pool/completion.hpp"
+#include "thread_pool/move_only_function.hpp"
+#include "thread_pool/task_allocator.hpp"
+
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -7,7 +11,9 @@
 #include <atomic>
 #include <chrono>
 #include <fmt/format.h>
+#include <string>
 #include <string_view>
+#include <vector>
 
 
 namespace spdlog {
@@ -41,8 +47,33 @@ enum class QueueFullPolicy {
     Overwrite,  // Overwrite an existing (old) task
 };
 
+enum class SchedulerMode {
+    Mpmc,          // All workers pop from one shared bounded MPMC queue
+    WorkStealing,  // Per-worker Chase-Lev deques + random-victim stealing; shared queue only for external submitters
+};
+
+enum class AffinityMode {
+    None,     // Threads float freely
+    Compact,  // Pin workers CPU by CPU, filling one NUMA node before the next
+    Scatter,  // Pin workers round-robin across NUMA nodes
+    List,     // Pin workers to ThreadPoolConfig::cpus in order
+};
+
 using LoggerPtr = std::shared_ptr<spdlog::logger>;
 
+// Priority lane: a separate injection queue inside one pool (bulkhead between task classes)
+struct LaneConfig {
+    std::string name;            // Lane name used by callers to look the lane up
+    std::size_t weight{1};       // Relative share of dequeues by shared workers (weighted round-robin)
+    std::size_t min_workers{0};  // Workers reserved to this lane; they never run other lanes' tasks
+};
+
+using LaneId = std::size_t;
+inline constexpr LaneId kDefaultLane = 0;  // Lane used by Post/Submit; the first configured lane
+
+using TimerId = std::uint64_t;              // ScheduleAfter/ScheduleAt/ScheduleEvery handle
+inline constexpr TimerId kInvalidTimer = 0;  // Returned when a timer was not scheduled
+
 struct ThreadPoolConfig {
     std::size_t               queue_cap{1024};                       // Task queue capacity
     std::size_t               core_threads{4};                       // Core thread count
@@ -56,6 +87,12 @@ struct ThreadPoolConfig {
     std::size_t               debounce_hits{3};                      // Debounce hit count
     std::chrono::milliseconds cooldown{500};                         // Cooldown after capacity change
     QueueFullPolicy           queue_policy{QueueFullPolicy::Block};  // Backpressure policy
+    SchedulerMode             scheduler{SchedulerMode::Mpmc};        // Task distribution between workers
+    std::vector<LaneConfig>   lanes;                                 // Priority lanes (empty: one default lane)
+    AffinityMode              affinity{AffinityMode::None};          // Worker CPU pinning
+    std::vector<int>          cpus;                                  // CPUs for AffinityMode::List
+    bool                      honor_cpu_quota{false};                // Cap max_threads at the cgroup CPU quota on construction
+    std::chrono::milliseconds timer_tick{1};                         // Timer wheel resolution
 };
 
 struct Statistics {
@@ -90,13 +127,22 @@ public:
         return true;
     }
     virtual void Cancel(std::exception_ptr eptr) noexcept = 0;
+
+    // Task nodes are recycled through TaskAllocator instead of the global heap
+    // (the virtual destructor passes the dynamic type's size to the sized delete)
+    static void* operator new(std::size_t size) {
+        return TaskAllocator::Allocate(size);
+    }
+    static void operator delete(void* ptr, std::size_t size) noexcept {
+        TaskAllocator::Deallocate(ptr, size);
+    }
 };
 
 // Task with return value
 template <typename T>
 class FutureTask : public TaskBase  {
 public:
-    using Func = std::function<T()>;
+    using Func = MoveOnlyFunction<T()>;
 
     explicit FutureTask(Func f) : f_(std::move(f)) {}
 
@@ -147,7 +193,7 @@ public:
     }
 private:
     Func f_;
-    std::promise<T> promise_;
+    std::promise<T> promise_{std::allocator_arg, PooledAllocator<char>{}};  // shared state from TaskAllocator
     std::atomic<bool> ok_{false};
     std::atomic<bool> fut_taken_{false};
     std::atomic<bool> done_{false};
@@ -157,7 +203,7 @@ private:
 template <>
 class FutureTask<void> : public TaskBase  {
 public:
-    using Func = std::function<void()>;
+    using Func = MoveOnlyFunction<void()>;
 
     explicit FutureTask(Func f) : f_(std::move(f)) {}
 
@@ -202,16 +248,66 @@ public:
     }
 private:
     Func f_;
-    std::promise<void> promise_;
+    std::promise<void> promise_{std::allocator_arg, PooledAllocator<char>{}};  // shared state from TaskAllocator
     std::atomic<bool> ok_{false};
     std::atomic<bool> fut_taken_{false};
     std::atomic<bool> done_{false};
 };
 
+// Task completing a CompletionPromise (SubmitCompletion / SubmitWithCallback).
+// A task destroyed without running (rejected, dropped) completes with the promise's broken-promise error.
+template <typename T>
+class CompletionTask : public TaskBase {
+public:
+    using Func = MoveOnlyFunction<T()>;
+
+    CompletionTask(Func f, CompletionPromise<T> promise) : f_(std::move(f)), promise_(std::move(promise)) {}
+
+    void Execute() noexcept override {
+        if (done_.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+        try {
+            if constexpr (std::is_void_v<T>) {
+                f_();
+                ok_.store(true, std::memory_order_release);
+                promise_.SetValue();
+            } else {
+                T result = f_();
+                ok_.store(true, std::memory_order_release);
+                promise_.SetValue(std::move(result));
+            }
+        } catch (...) {
+            ok_.store(false, std::memory_order_release);
+            promise_.SetException(std::current_exception());
+        }
+    }
+
+    bool Success() const noexcept override {
+        return ok_.load(std::memory_order_acquire);
+    }
+
+    void Cancel(std::exception_ptr eptr) noexcept override {
+        if (!done_.exchange(true, std::memory_order_acq_rel)) {
+            if (!eptr) {
+                eptr = std::make_exception_ptr(std::runtime_error("task cancelled"));
+            }
+            promise_.SetException(std::move(eptr));
+            ok_.store(false, std::memory_order_release);
+        }
+    }
+
+private:
+    Func f_;
+    CompletionPromise<T> promise_;
+    std::atomic<bool> ok_{false};
+    std::atomic<bool> done_{false};
+};
+
 // Lightweight task (no future overhead; used by Post)
 class SimpleTask : public TaskBase {
 public:
-    using Func = std::function<void()>;
+    using Func = MoveOnlyFunction<void()>;
     
     explicit SimpleTask(Func f) : f_(std::move(f)) {}
 
@@ -308,6 +404,48 @@ struct formatter<thread_pool::QueueFullPolicy> : formatter<std::string_view> {
     }
 };
 
+// SchedulerMode formatter
+template <>
+struct formatter<thread_pool::SchedulerMode> : formatter<std::string_view> {
+    auto format(thread_pool::SchedulerMode mode, format_context& ctx) const {
+        using M = thread_pool::SchedulerMode;
+        std::string_view name = "Unknown";
+        switch (mode) {
+            case M::Mpmc: 
+                name = "Mpmc"; 
+                break;
+            case M::WorkStealing: 
+                name = "WorkStealing"; 
+                break;
+        }
+        return formatter<std::string_view>::format(name, ctx);
+    }
+};
+
+// AffinityMode formatter
+template <>
+struct formatter<thread_pool::AffinityMode> : formatter<std::string_view> {
+    auto format(thread_pool::AffinityMode mode, format_context& ctx) const {
+        using M = thread_pool::AffinityMode;
+        std::string_view name = "Unknown";
+        switch (mode) {
+            case M::None: 
+                name = "None"; 
+                break;
+            case M::Compact: 
+                name = "Compact"; 
+                break;
+            case M::Scatter: 
+                name = "Scatter"; 
+                break;
+            case M::List: 
+                name = "List"; 
+                break;
+        }
+        return formatter<std::string_view>::format(name, ctx);
+    }
+};
+
 // StopMode formatter
 template <>
 struct formatter<thread_pool::StopMode> : formatter<std::string_view> {
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace thread_pool {
+
+template <typename Signature, std::size_t Capacity = 48>
+class MoveOnlyFunction;
+
+// Move-only type-erased callable with small-buffer optimization.
+// Callables up to Capacity bytes (and nothrow-movable) are stored inline; larger ones fall back to the heap.
+// Unlike std::function it accepts move-only captures (promises, unique_ptr, ...).
+template <typename R, typename... Args, std::size_t Capacity>
+class MoveOnlyFunction<R(Args...), Capacity> {
+public:
+    MoveOnlyFunction() noexcept = default;
+    MoveOnlyFunction(std::nullptr_t) noexcept {}
+
+    template <typename F,
+              typename D = std::decay_t<F>,
+              typename = std::enable_if_t<!std::is_same_v<D, MoveOnlyFunction> && std::is_invocable_r_v<R, D&, Args...>>>
+    MoveOnlyFunction(F&& f) {
+        if constexpr (std::is_pointer_v<D> || std::is_member_pointer_v<D> || IsStdFunction<D>::value) {
+            if (!f) {
+                return;
+            }
+        }
+        if constexpr (FitsInline<D>()) {
+            ::new (static_cast<void*>(&storage_)) D(std::forward<F>(f));
+            ops_ = &InlineOps<D>::kOps;
+        } else {
+            *reinterpret_cast<D**>(&storage_) = new D(std::forward<F>(f));
+            ops_ = &HeapOps<D>::kOps;
+        }
+    }
+
+    MoveOnlyFunction(MoveOnlyFunction&& other) noexcept {
+        MoveFrom(other);
+    }
+
+    MoveOnlyFunction& operator=(MoveOnlyFunction&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            MoveFrom(other);
+        }
+        return *this;
+    }
+
+    MoveOnlyFunction& operator=(std::nullptr_t) noexcept {
+        Reset();
+        return *this;
+    }
+
+    MoveOnlyFunction(const MoveOnlyFunction&) = delete;
+    MoveOnlyFunction& operator=(const MoveOnlyFunction&) = delete;
+
+    ~MoveOnlyFunction() {
+        Reset();
+    }
+
+    explicit operator bool() const noexcept {
+        return ops_ != nullptr;
+    }
+
+    R operator()(Args... args) {
+        if (ops_ == nullptr) {
+            throw std::bad_function_call();
+        }
+        return ops_->invoke(&storage_, std::forward<Args>(args)...);
+    }
+
+    // True when the callable lives in the inline buffer (no heap allocation)
+    bool IsInline() const noexcept {
+        return ops_ != nullptr && ops_->is_inline;
+    }
+
+    template <typename F>
+    static constexpr bool FitsInline() noexcept {
+        return sizeof(F) <= Capacity && alignof(F) <= alignof(Storage)
+            && std::is_nothrow_move_constructible_v<F>;
+    }
+
+private:
+    using Storage = std::aligned_storage_t<Capacity, alignof(std::max_align_t)>;
+
+    struct Ops {
+        R (*invoke)(void* storage, Args&&... args);
+        void (*relocate)(void* dst, void* src) noexcept;  // move-construct into dst and destroy src
+        void (*destroy)(void* storage) noexcept;
+        bool is_inline;
+    };
+
+    template <typename T>
+    struct IsStdFunction : std::false_type {};
+    template <typename Sig>
+    struct IsStdFunction<std::function<Sig>> : std::true_type {};
+
+    template <typename D>
+    struct InlineOps {
+        static R Invoke(void* storage, Args&&... args) {
+            return std::invoke(*static_cast<D*>(storage), std::forward<Args>(args)...);
+        }
+        static void Relocate(void* dst, void* src) noexcept {
+            D* from = static_cast<D*>(src);
+            ::new (dst) D(std::move(*from));
+            from->~D();
+        }
+        static void Destroy(void* storage) noexcept {
+            static_cast<D*>(storage)->~D();
+        }
+        static constexpr Ops kOps{&Invoke, &Relocate, &Destroy, true};
+    };
+
+    template <typename D>
+    struct HeapOps {
+        static D* Get(void* storage) noexcept {
+            return *static_cast<D**>(storage);
+        }
+        static R Invoke(void* storage, Args&&... args) {
+            return std::invoke(*Get(storage), std::forward<Args>(args)...);
+        }
+        static void Relocate(void* dst, void* src) noexcept {
+            *static_cast<D**>(dst) = Get(src);
+        }
+        static void Destroy(void* storage) noexcept {
+            delete Get(storage);
+        }
+        static constexpr Ops kOps{&Invoke, &Relocate, &Destroy, false};
+    };
+
+    void MoveFrom(MoveOnlyFunction& other) noexcept {
+        if (other.ops_ != nullptr) {
+            other.ops_->relocate(&storage_, &other.storage_);
+            ops_ = std::exchange(other.ops_, nullptr);
+        }
+    }
+
+    void Reset() noexcept {
+        if (ops_ != nullptr) {
+            ops_->destroy(&storage_);
+            ops_ = nullptr;
+        }
+    }
+
+    Storage storage_;
+    const Ops* ops_{nullptr};
+};
+
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+namespace thread_pool {
+
+// Fixed-size block recycler for task nodes and promise shared states.
+// Requests are rounded up to 64-byte size classes (up to 256 bytes); each thread keeps a free list per
+// class and exchanges whole batches with a global depot, so the usual producer-allocates /
+// worker-frees pattern costs one depot lock per batch instead of a malloc/free per task.
+// Blocks are carved from slabs that are kept for reuse and never returned to the heap.
+class TaskAllocator {
+public:
+    static constexpr std::size_t kGranularity = 64;                       // size class step (bytes)
+    static constexpr std::size_t kClasses = 4;                            // 64 / 128 / 192 / 256
+    static constexpr std::size_t kMaxBlock = kGranularity * kClasses;     // larger requests use operator new
+
+    static void* Allocate(std::size_t size);
+    static void Deallocate(void* ptr, std::size_t size) noexcept;
+
+    struct Stats {
+        std::size_t slabs{0};     // slabs carved from the heap
+        std::size_t oversize{0};  // requests above kMaxBlock forwarded to operator new
+    };
+    static Stats GetStats() noexcept;
+};
+
+// std-compatible allocator over TaskAllocator (used for std::promise shared state)
+template <typename T>
+struct PooledAllocator {
+    using value_type = T;
+
+    PooledAllocator() noexcept = default;
+    template <typename U>
+    PooledAllocator(const PooledAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{alignof(T)}));
+        } else {
+            return static_cast<T*>(TaskAllocator::Allocate(n * sizeof(T)));
+        }
+    }
+    void deallocate(T* ptr, std::size_t n) noexcept {
+        if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            ::operator delete(ptr, std::align_val_t{alignof(T)});
+        } else {
+            TaskAllocator::Deallocate(ptr, n * sizeof(T));
+        }
+    }
+
+    template <typename U>
+    bool operator==(const PooledAllocator<U>&) const noexcept {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const PooledAllocator<U>&) const noexcept {
+        return false;
+    }
+};
+
+}
@@ -2,9 +2,13 @@
 
 #include "thread_pool/fwd.hpp"
 #include "mpmc/blocking_queue_adapter.hpp"
+#include "mpmc/work_stealing_deque.hpp"
 #include "thread_pool/config.hpp"
+#include "thread_pool/cpu_topology.hpp"
+#include "thread_pool/timer_wheel.hpp"
 #include "logger.hpp"
 
+#include <array>
 #include <thread>
 #include <future>
 #include <vector>
@@ -14,6 +18,8 @@
 #include <future>
 #include <functional>
 #include <exception>
+#include <stdexcept>
+#include <utility>
 
 namespace thread_pool {
 class ThreadPool {
@@ -32,10 +38,52 @@ public:
     void ShutDown(ShutDownOption opt = ShutDownOption::Graceful, 
         std::chrono::milliseconds timeout = std::chrono::seconds(30));
 
-    void Post(std::function<void()> f);
+    template <typename Func>
+    void Post(Func&& f);
     template <typename Func, typename... Args>
     auto Submit(Func&& f, Args&&... args) -> std::future<std::invoke_result_t<Func, Args...>>;
 
+    // std::future-free submission: the result is delivered through a Completion (futex wait or continuation).
+    // Like Post these never reject by throwing; a rejected or dropped task completes with an exception.
+    template <typename Func, typename... Args>
+    auto SubmitCompletion(Func&& f, Args&&... args) -> Completion<std::invoke_result_t<Func, Args...>>;
+    // callback(Completion<R>) runs exactly once, normally on the worker right after f; if this call throws,
+    // the callback was never registered
+    template <typename Func, typename Callback>
+    void SubmitWithCallback(Func&& f, Callback&& callback);
+
+    // Priority lanes (ThreadPoolConfig::lanes): the calls above use kDefaultLane, the *To variants pick a lane.
+    // Shared workers dequeue across lanes by weight; reserved workers only serve their own lane.
+    template <typename Func>
+    void PostTo(LaneId lane, Func&& f);
+    template <typename Func, typename... Args>
+    auto SubmitTo(LaneId lane, Func&& f, Args&&... args) -> std::future<std::invoke_result_t<Func, Args...>>;
+    template <typename Func, typename... Args>
+    auto SubmitCompletionTo(LaneId lane, Func&& f, Args&&... args) -> Completion<std::invoke_result_t<Func, Args...>>;
+    template <typename Func, typename Callback>
+    void SubmitWithCallbackTo(LaneId lane, Func&& f, Callback&& callback);
+
+    // Timers: f is posted to the default lane once due (resolution ThreadPoolConfig::timer_tick).
+    // Pending timers are dropped when the pool stops; kInvalidTimer is returned once it is stopping.
+    template <typename Rep, typename Period, typename Func>
+    TimerId ScheduleAfter(std::chrono::duration<Rep, Period> delay, Func&& f);
+    template <typename Func>
+    TimerId ScheduleAt(std::chrono::steady_clock::time_point when, Func&& f);
+    // Fixed-rate repetition, first run one period from now; runs may overlap when f outlasts the period
+    template <typename Rep, typename Period, typename Func>
+    TimerId ScheduleEvery(std::chrono::duration<Rep, Period> period, Func&& f);
+    bool        CancelTimer(TimerId id) noexcept;  // false when already fired (one-shot) or cancelled
+    std::size_t PendingTimers() const noexcept;
+
+    // C++20 coroutines: `co_await pool.Schedule()` resumes the caller on a worker (via the given lane); the co_await
+    // throws std::runtime_error when the pool rejects or drops the resumption. Task<T> is in thread_pool/coroutine.hpp.
+    class ScheduleAwaitable;
+    ScheduleAwaitable Schedule(LaneId lane = kDefaultLane) noexcept;
+
+    std::size_t LaneCount() const noexcept;
+    LaneId      FindLane(std::string_view name) const noexcept;  // kDefaultLane when no lane has this name
+    std::size_t LanePending(LaneId lane) const noexcept;         // tasks waiting in the lane's queue
+
     // Batch submission APIs
     template <typename Iterator>
     std::size_t PostBatch(Iterator begin, Iterator end);
@@ -46,6 +94,7 @@ public:
     // Policy
     QueueFullPolicy GetQueueFullPolicy() const noexcept;
     void SetQueueFullPolicy(QueueFullPolicy policy) noexcept;
+    SchedulerMode Scheduler() const noexcept;
 
     void Pause() noexcept;
     void Resume() noexcept;
@@ -56,6 +105,8 @@ public:
     std::size_t Pending() const noexcept;
     std::size_t ActiveTasks() const noexcept;
     PoolState State() const noexcept;
+    // Calling thread is a worker of this pool (any scheduler); such callers must not block on tasks they submit
+    bool InWorkerThread() const noexcept;
 
     std::size_t DiscardedTasks() const noexcept;
     std::size_t OverwrittedTasks() const noexcept;
@@ -71,12 +122,51 @@ public:
     Statistics GetStatistics() const noexcept;
     void ResetStatistics() noexcept;
 private:
+    static constexpr std::size_t kSharedWorker = static_cast<std::size_t>(-1);  // WorkerSlot::home_lane of shared workers
+    static constexpr std::size_t kUnpinned = static_cast<std::size_t>(-1);      // WorkerSlot::placement of floating workers
+    static constexpr std::size_t kCacheLine = 64;
+    static constexpr std::size_t kMaxCounterShards = 256;
+    static constexpr std::chrono::milliseconds kDrainRecheck{10};  // graceful stop re-checks drain conditions this often
+    static constexpr std::size_t kWorkerBatch = 8;  // max tasks an Mpmc worker claims from the queue at once
+
+    // Per-task counters, sharded so concurrent workers and producers do not bounce one cache line.
+    // Each thread updates the shard picked by LocalShard(); readers sum all shards.
+    struct alignas(kCacheLine) CounterShard {
+        std::atomic<std::size_t> submitted{0};     // tasks submitted successfully
+        std::atomic<std::size_t> completed{0};     // tasks executed successfully
+        std::atomic<std::size_t> failed{0};        // tasks failed during execution
+        std::atomic<std::size_t> exec_time_ns{0};  // execution time (ns)
+        std::atomic<std::size_t> active{0};        // tasks executing (incremented and decremented by the same worker)
+        std::atomic<std::size_t> submitting{0};    // submissions in progress (entered and left on the same thread)
+        std::atomic<std::size_t> buffered{0};      // tasks claimed into a worker's TaskBatch, not yet started
+    };
+
     struct WorkerSlot {
         std::thread                           thread;              // worker object
         std::atomic<bool>                     should_exit{false};  // shrink/shutdown indicator
         std::atomic<bool>                     idle{true};          // worker idle state
         std::atomic<std::uint64_t>            idle_nums{0};        // consecutive idle count
         std::chrono::steady_clock::time_point last_active{};       // last time a task executed
+        std::size_t                           deque{0};            // local deque index (WorkStealing)
+        std::size_t                           home_lane{kSharedWorker};  // lane this worker is reserved to
+        std::vector<std::int64_t>             lane_credit;         // smooth weighted round-robin state (shared workers)
+        std::size_t                           placement{kUnpinned};  // index into placement_ of the CPU this worker is pinned to
+    };
+
+    // Tasks an Mpmc worker claimed with one queue CAS and runs before touching the queue again
+    struct TaskBatch {
+        std::array<TaskPtr, kWorkerBatch> items;
+        std::size_t                       head{0};
+        std::size_t                       size{0};
+        bool Empty() const noexcept { return head == size; }
+    };
+
+    struct Lane {
+        Lane(LaneConfig config, std::size_t queue_cap) : cfg(std::move(config)), queue(queue_cap) {}
+        LaneConfig                    cfg;
+        BlockingQueueAdapter<TaskPtr> queue;
+        std::size_t                   reserved{0};  // live workers reserved to this lane, protected by workers_mu_
+        std::condition_variable       park_cv;      // reserved workers of this lane park here (with park_mtx_)
     };
 
     struct ExitTask final : TaskBase {
@@ -104,16 +194,67 @@ private:
     void SubmitOn() noexcept;
     void SubmitOff() noexcept;
 
+    // Sharded counters
+    void          InitCounterShards();
+    CounterShard& LocalShard() noexcept;
+    std::size_t   SumShards(std::atomic<std::size_t> CounterShard::*counter) const noexcept;
+
     void WorkerLoop(WorkerSlot* slot);
+    bool NextBatchedTask(TaskBatch& batch, TaskPtr& task);  // Mpmc: buffered task, else claim a fair share, else wait
+    void CancelBatch(TaskBatch& batch) noexcept;            // cancel buffered tasks of an exiting worker
     void SetState(PoolState new_state) noexcept;
+    void PostTask(TaskPtr task_ptr, LaneId lane);
+    TimerId ScheduleTimer(std::chrono::steady_clock::time_point when, std::chrono::steady_clock::duration period,
+                          TimerWheel::Callback cb);
+    template <typename Return, typename Func, typename... Args>
+    void PostCompletion(LaneId lane, CompletionPromise<Return>& promise, Func&& f, Args&&... args) noexcept;
+
+    // Priority lanes
+    BlockingQueueAdapter<TaskPtr>& LaneQueue(LaneId lane) noexcept;  // unknown ids map to the default lane
+    bool        PopFromLanes(WorkerSlot* slot, TaskPtr& task);      // home lane, or weighted round-robin for shared workers
+    bool        QueuesClosed() const noexcept;
+    std::size_t QueueCapacity() const noexcept;                      // sum of all lane capacities
+
+    // Work-stealing scheduler
+    bool        OnWorkerThread(LaneId lane) const noexcept;    // calling thread is a WorkStealing worker of this pool serving lane
+    void        PushLocal(TaskBase* task);                     // push to the calling worker's deque (takes ownership)
+    void        NotifyWork(std::size_t count = 1, LaneId lane = kDefaultLane) noexcept;  // wake workers that can run lane's new tasks
+    void        WakeAllWorkers() noexcept;                     // wake every parked worker (close/exit)
+    bool        FindTask(WorkerSlot* slot, TaskPtr& task);     // local pop -> injection queue -> steal
+    bool        WaitNextTask(WorkerSlot* slot, TaskPtr& task); // FindTask, parking when nothing is runnable
+    std::size_t LocalPending() const noexcept;                 // tasks queued in worker deques
+    void        CancelLocalTasks();                            // drain and cancel all worker deques
+
+    // CPU placement (ThreadPoolConfig::affinity)
+    void        InitPlacement(const ThreadPoolConfig& cfg);    // worker CPU order and NUMA nodes
+    void        ApplyCpuQuota(std::size_t reserved);           // cap max_threads_ at the cgroup CPU quota
+    void        AssignCpuUnlocked(WorkerSlot& slot);           // least-loaded CPU in placement order
+    void        ReleaseCpuUnlocked(const WorkerSlot& slot) noexcept;  // once per slot, when it leaves workers_
 
     template <class R>
     static std::future<R> BrokenFuture(std::exception_ptr eptr);
 private:
     std::atomic<PoolState> state_;
-    BlockingQueueAdapter<TaskPtr> queue_;
+    std::vector<std::unique_ptr<Lane>> lanes_;  // injection queues; lanes_[kDefaultLane] always exists
     std::vector<std::unique_ptr<WorkerSlot>> workers_;
     std::atomic<QueueFullPolicy> policy_;
+    const SchedulerMode scheduler_;
+    const bool parking_;  // idle workers park on park_cv_ (WorkStealing or several lanes) instead of the queue
+
+    // Parking and work-stealing state (deques_ is empty in Mpmc mode)
+    std::vector<std::unique_ptr<WorkStealingDeque<TaskBase*>>> deques_;  // one per worker slot, lives as long as the pool
+    std::vector<std::size_t>   free_deques_;      // unused deques, protected by workers_mu_
+    alignas(kCacheLine) std::atomic<std::size_t> sleepers_{0};  // workers parked or about to park
+    std::atomic<std::uint64_t> park_epoch_{0};    // bumped on every wake-up
+    std::mutex                 park_mtx_;
+    std::condition_variable    park_cv_;          // shared workers park here, reserved ones on their Lane::park_cv
+
+    // CPU placement (empty placement_: workers float freely)
+    std::vector<int>         placement_;       // CPUs in the order workers are pinned to them
+    std::vector<std::size_t> placement_node_;  // NUMA node of each placement_ entry
+    std::vector<std::size_t> placement_load_;  // live workers per placement_ entry, protected by workers_mu_
+    bool                     multi_node_{false};  // pinned across several NUMA nodes: steal node-locally first
+    std::unique_ptr<std::atomic<std::size_t>[]> deque_node_;  // NUMA node of each deque's current owner (WorkStealing)
 
     // Dynamic thread management
     mutable                 std::mutex workers_mu_;  // protects workers_ container
@@ -152,25 +293,19 @@ private:
     void                     EnqueueExitSignals(const std::vector<WorkerSlot*>& targets);  // enqueue directed exit tasks
     void                     RetireWorkerUnlocked(WorkerSlot& slot);                       // retire worker
 private:
-    // Task state
-    std::atomic<size_t>      active_tasks_{0};  // active tasks
-    std::atomic<std::size_t> submit_ing_{0};    // submissions in progress
-
-    // Statistics
-    std::atomic<std::size_t> total_submitted_{0};  // total tasks submitted successfully
-    std::atomic<std::size_t> total_completed_{0};  // total tasks executed successfully
-    std::atomic<std::size_t> total_failed_{0};     // total tasks failed during execution
-    std::atomic<std::size_t> total_cancelled_{0};  // total tasks cancelled
-    std::atomic<std::size_t> total_rejected_{0};   // total tasks rejected on submit
+    // Hot counters (submitted/completed/failed/exec time/active tasks/in-flight submissions)
+    std::unique_ptr<CounterShard[]> shards_;
+    std::size_t                     shard_mask_{0};  // shard count - 1 (power of two)
 
-    std::atomic<std::size_t> total_exec_time_ns_{0};  // total execution time (ns)
+    // Statistics (rare events; kept off the cache lines of the fields above)
+    alignas(kCacheLine) std::atomic<std::size_t> total_cancelled_{0};  // total tasks cancelled
+    std::atomic<std::size_t> total_rejected_{0};   // total tasks rejected on submit
 
-    // pending is maintained by queue_
+    // pending is maintained by the lane queues
     std::atomic<double> busy_ratio_{0.0};     // busy thread ratio
     std::atomic<double> pending_ratio_{0.0};  // queue utilization ratio
 
     std::atomic<std::size_t> current_threads_{0};          // current running worker count
-    std::atomic<std::size_t> active_threads_{0};           // workers currently executing tasks
     std::atomic<std::size_t> peak_threads_{0};             // peak worker count
     std::atomic<std::size_t> total_threads_created_{0};    // total workers created
     std::atomic<std::size_t> total_threads_destroyed_{0};  // total workers destroyed
@@ -182,8 +317,129 @@ private:
     void RecordTaskComplete(const TaskBase& task, std::chrono::steady_clock::duration duration) noexcept;
     void RecordTaskCancel() noexcept;
     void RecordTaskRejected() noexcept;
+
+    // Declared last: the timer thread posts into the pool and must be joined before anything else is destroyed
+    std::unique_ptr<TimerWheel> timers_;
 };
 
+// Awaiter returned by Schedule. await_suspend is a template over the coroutine handle, so this header stays
+// C++17 and does not need <coroutine>. The coroutine always resumes on the thread that runs (or drops) the
+// posted task; only a task rejected inside PostTo itself lets await_suspend resume inline with the error.
+class ThreadPool::ScheduleAwaitable {
+public:
+    ScheduleAwaitable(ThreadPool& pool, LaneId lane) noexcept : pool_(&pool), lane_(lane) {}
+
+    ScheduleAwaitable(const ScheduleAwaitable&) = delete;
+    ScheduleAwaitable& operator=(const ScheduleAwaitable&) = delete;
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    template <typename Handle>
+    bool await_suspend(Handle handle) {
+        poster_ = std::this_thread::get_id();
+        pool_->PostTo(lane_, Resumer<Handle>(this, handle));
+        std::uint32_t expected = kPosting;
+        return state_.compare_exchange_strong(expected, kSuspended, std::memory_order_acq_rel);
+    }
+
+    void await_resume() const {
+        if (state_.load(std::memory_order_acquire) == kDropped) {
+            throw std::runtime_error("ThreadPool::Schedule: resumption rejected or dropped by the pool");
+        }
+    }
+
+private:
+    static constexpr std::uint32_t kPosting = 0;    // await_suspend has not returned yet
+    static constexpr std::uint32_t kSuspended = 1;  // coroutine suspended, resumption queued
+    static constexpr std::uint32_t kResumed = 2;    // resumption task ran
+    static constexpr std::uint32_t kDropped = 3;    // resumption task destroyed without running
+
+    // Task body: resumes the coroutine when run; a rejected or cancelled task resumes it from its destructor
+    // so the coroutine observes the failure instead of leaking its frame
+    template <typename Handle>
+    class Resumer {
+    public:
+        Resumer(ScheduleAwaitable* owner, Handle handle) noexcept : owner_(owner), handle_(handle) {}
+        Resumer(Resumer&& other) noexcept : owner_(std::exchange(other.owner_, nullptr)), handle_(other.handle_) {}
+        Resumer& operator=(Resumer&&) = delete;
+        ~Resumer() {
+            Finish(kDropped);
+        }
+
+        void operator()() noexcept {
+            Finish(kResumed);
+        }
+
+    private:
+        void Finish(std::uint32_t outcome) noexcept {
+            ScheduleAwaitable* owner = std::exchange(owner_, nullptr);
+            if (owner == nullptr) {
+                return;
+            }
+            if (outcome == kDropped && owner->poster_ == std::this_thread::get_id()) {
+                // Rejected inside PostTo: await_suspend sees kDropped and resumes inline
+                std::uint32_t expected = kPosting;
+                if (owner->state_.compare_exchange_strong(expected, kDropped, std::memory_order_acq_rel)) {
+                    return;
+                }
+            }
+            // Picked up before await_suspend returned: wait until it no longer touches the frame
+            while (owner->state_.load(std::memory_order_acquire) == kPosting) {
+                std::this_thread::yield();
+            }
+            owner->state_.store(outcome, std::memory_order_relaxed);
+            handle_.resume();
+        }
+
+        ScheduleAwaitable* owner_;
+        Handle             handle_;
+    };
+
+    ThreadPool*                pool_;
+    LaneId                     lane_;
+    std::thread::id            poster_;
+    std::atomic<std::uint32_t> state_{kPosting};
+};
+
+inline ThreadPool::ScheduleAwaitable ThreadPool::Schedule(LaneId lane) noexcept {
+    return ScheduleAwaitable(*this, lane);
+}
+
+// Fire-and-forget submission (lightweight SimpleTask, no future); small closures are stored
+// inline in the pooled task node, so the common path does not touch the global heap
+template <typename Func>
+inline void ThreadPool::Post(Func&& f) {
+    PostTo(kDefaultLane, std::forward<Func>(f));
+}
+
+template <typename Func>
+inline void ThreadPool::PostTo(LaneId lane, Func&& f) {
+    PostTask(std::make_unique<SimpleTask>(typename SimpleTask::Func(std::forward<Func>(f))), lane);
+}
+
+template <typename Rep, typename Period, typename Func>
+inline TimerId ThreadPool::ScheduleAfter(std::chrono::duration<Rep, Period> delay, Func&& f) {
+    return ScheduleTimer(std::chrono::steady_clock::now()
+                             + std::chrono::duration_cast<std::chrono::steady_clock::duration>(delay),
+                         std::chrono::steady_clock::duration::zero(), TimerWheel::Callback(std::forward<Func>(f)));
+}
+
+template <typename Func>
+inline TimerId ThreadPool::ScheduleAt(std::chrono::steady_clock::time_point when, Func&& f) {
+    return ScheduleTimer(when, std::chrono::steady_clock::duration::zero(), TimerWheel::Callback(std::forward<Func>(f)));
+}
+
+template <typename Rep, typename Period, typename Func>
+inline TimerId ThreadPool::ScheduleEvery(std::chrono::duration<Rep, Period> period, Func&& f) {
+    const auto step = std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+    if (step <= std::chrono::steady_clock::duration::zero()) {
+        throw std::invalid_argument("ThreadPool::ScheduleEvery: period must be positive");
+    }
+    return ScheduleTimer(std::chrono::steady_clock::now() + step, step, TimerWheel::Callback(std::forward<Func>(f)));
+}
+
 // Batch submission from an iterator range (uses lightweight SimpleTask)
 template <typename Iterator>
 inline std::size_t ThreadPool::PostBatch(Iterator begin, Iterator end) {
@@ -202,8 +458,9 @@ inline std::size_t ThreadPool::PostBatch(Iterator begin, Iterator end) {
         tasks.push_back(std::move(task));
     }
 
-    const auto count = queue_.TryPushBatch(tasks.begin(), tasks.end());
-    total_submitted_.fetch_add(count, std::memory_order_relaxed);
+    const auto count = LaneQueue(kDefaultLane).TryPushBatch(tasks.begin(), tasks.end());
+    LocalShard().submitted.fetch_add(count, std::memory_order_relaxed);
+    NotifyWork(count);
     
     return count;
 }
@@ -227,12 +484,59 @@ inline std::size_t ThreadPool::PostBatch(Func generator, std::size_t count) {
         tasks.push_back(std::move(task));
     }
 
-    const auto pushed = queue_.TryPushBatch(tasks.begin(), tasks.end());
-    total_submitted_.fetch_add(pushed, std::memory_order_relaxed);
+    const auto pushed = LaneQueue(kDefaultLane).TryPushBatch(tasks.begin(), tasks.end());
+    LocalShard().submitted.fetch_add(pushed, std::memory_order_relaxed);
+    NotifyWork(pushed);
     
     return pushed;
 }
 
+template <typename Func, typename... Args>
+auto ThreadPool::SubmitCompletion(Func&& f, Args&&... args) -> Completion<std::invoke_result_t<Func, Args...>> {
+    return SubmitCompletionTo(kDefaultLane, std::forward<Func>(f), std::forward<Args>(args)...);
+}
+
+template <typename Func, typename... Args>
+auto ThreadPool::SubmitCompletionTo(LaneId lane, Func&& f, Args&&... args)
+    -> Completion<std::invoke_result_t<Func, Args...>> {
+    using Return = std::invoke_result_t<Func, Args...>;
+    CompletionPromise<Return> promise;
+    auto completion = promise.GetCompletion();
+    PostCompletion(lane, promise, std::forward<Func>(f), std::forward<Args>(args)...);
+    return completion;
+}
+
+template <typename Func, typename Callback>
+void ThreadPool::SubmitWithCallback(Func&& f, Callback&& callback) {
+    SubmitWithCallbackTo(kDefaultLane, std::forward<Func>(f), std::forward<Callback>(callback));
+}
+
+template <typename Func, typename Callback>
+void ThreadPool::SubmitWithCallbackTo(LaneId lane, Func&& f, Callback&& callback) {
+    using Return = std::invoke_result_t<Func>;
+    CompletionPromise<Return> promise;
+    // Register before enqueueing so the callback runs where the task finishes
+    promise.GetCompletion().OnComplete(std::forward<Callback>(callback));
+    PostCompletion(lane, promise, std::forward<Func>(f));
+}
+
+// Hands the promise to a CompletionTask; any failure before that completes the promise with the exception
+template <typename Return, typename Func, typename... Args>
+void ThreadPool::PostCompletion(LaneId lane, CompletionPromise<Return>& promise, Func&& f, Args&&... args) noexcept {
+    try {
+        auto bound = [ff = std::forward<Func>(f),
+                      tup = std::make_tuple(std::forward<Args>(args)...)]() mutable -> Return {
+            return std::apply(std::move(ff), std::move(tup));
+        };
+        typename CompletionTask<Return>::Func fn(std::move(bound));
+        PostTask(std::make_unique<CompletionTask<Return>>(std::move(fn), std::move(promise)), lane);
+    } catch (...) {
+        if (promise.Valid()) {
+            promise.SetException(std::current_exception());
+        }
+    }
+}
+
 template <class R>
 inline std::future<R> ThreadPool::BrokenFuture(std::exception_ptr eptr) {
     std::promise<R> promise; 
@@ -242,6 +546,11 @@ inline std::future<R> ThreadPool::BrokenFuture(std::exception_ptr eptr) {
 
 template <typename Func, typename... Args>
 auto ThreadPool::Submit(Func&& f, Args&&... args) -> std::future<std::invoke_result_t<Func, Args...>> {
+    return SubmitTo(kDefaultLane, std::forward<Func>(f), std::forward<Args>(args)...);
+}
+
+template <typename Func, typename... Args>
+auto ThreadPool::SubmitTo(LaneId lane, Func&& f, Args&&... args) -> std::future<std::invoke_result_t<Func, Args...>> {
     using Return = std::invoke_result_t<Func, Args...>;
 
     // Package into a closure
@@ -253,7 +562,7 @@ auto ThreadPool::Submit(Func&& f, Args&&... args) -> std::future<std::invoke_res
 
     auto task_ptr = std::make_unique<FutureTask<Return>>(
         typename FutureTask<Return>::Func(std::move(bound)) 
-        // typename FutureTask<Return>::Func = std::function<Return()> (type erasure)
+        // typename FutureTask<Return>::Func = MoveOnlyFunction<Return()> (type erasure, inline for small closures)
     );
     std::future<Return> fut;
     try {
@@ -323,11 +632,20 @@ auto ThreadPool::Submit(Func&& f, Args&&... args) -> std::future<std::invoke_res
         throw std::runtime_error("ThreadPool::Submit: pool is not RUNNING");
     }
 
+    // Work-stealing: tasks a worker spawns for its own lane stay on its deque (no queue policy applies);
+    // other lanes go through their queue so weights, reservations and the queue-full policy hold
+    if (OnWorkerThread(lane)) {
+        PushLocal(task_ptr.release());
+        LocalShard().submitted.fetch_add(1, std::memory_order_relaxed);
+        return fut;
+    }
+
     // Dispatch by queue policy
+    auto& queue = LaneQueue(lane);
     const auto policy = policy_.load(std::memory_order_relaxed);
     switch (policy) {
         case QueueFullPolicy::Block: {
-            if (!queue_.WaitPush(std::move(task_ptr))) {
+            if (!queue.WaitPush(std::move(task_ptr))) {
                 RecordTaskRejected(); // task rejected
                 auto eptr = std::make_exception_ptr(
                     std::runtime_error("ThreadPool::Submit: queue closed")
@@ -336,14 +654,15 @@ auto ThreadPool::Submit(Func&& f, Args&&... args) -> std::future<std::invoke_res
                             Pending(), State());
                 return BrokenFuture<Return>(eptr);
             }
-            total_submitted_.fetch_add(1, std::memory_order_relaxed); // successfully enqueued
+            LocalShard().submitted.fetch_add(1, std::memory_order_relaxed); // successfully enqueued
+            NotifyWork(1, lane);
             TP_LOG_TRACE("Submit succeeded (policy=Block): pending={} queue_cap={}",
-                         Pending(), queue_.Capacity());
+                         Pending(), queue.Capacity());
             return fut;
         }
 
         case QueueFullPolicy::Discard: {
-             if (!queue_.TryPush(std::move(task_ptr))) {
+             if (!queue.TryPush(std::move(task_ptr))) {
                 RecordTaskRejected(); // task rejected
                 discard_cnt_.fetch_add(1, std::memory_order_relaxed);
                 auto eptr = std::make_exception_ptr(
@@ -353,7 +672,8 @@ auto ThreadPool::Submit(Func&& f, Args&&... args) -> std::future<std::invoke_res
                             Pending(), discard_cnt_.load(std::memory_order_relaxed));
                 return BrokenFuture<Return>(eptr);
             }
-            total_submitted_.fetch_add(1, std::memory_order_relaxed); // successfully enqueued
+            LocalShard().submitted.fetch_add(1, std::memory_order_relaxed); // successfully enqueued
+            NotifyWork(1, lane);
             TP_LOG_DEBUG("Submit accepted (policy=Discard): pending={} discard_cnt={}",
                          Pending(), discard_cnt_.load(std::memory_order_relaxed));
             return fut;
@@ -361,7 +681,7 @@ auto ThreadPool::Submit(Func&& f, Args&&... args) -> std::future<std::invoke_res
         
         case QueueFullPolicy::Overwrite: {
             TaskPtr overwritten;
-            bool pushed = queue_.OverwritePush(std::move(task_ptr), &overwritten);
+            bool pushed = queue.OverwritePush(std::move(task_ptr), &overwritten);
             if (overwritten) {
                 overwritten->Cancel(std::make_exception_ptr(
                     std::runtime_error("ThreadPool::Submit: overwritten")
@@ -380,7 +700,8 @@ auto ThreadPool::Submit(Func&& f, Args&&... args) -> std::future<std::invoke_res
                             Pending(), discard_cnt_.load(std::memory_order_relaxed));
                 return BrokenFuture<Return>(eptr);
             }
-            total_submitted_.fetch_add(1, std::memory_order_relaxed); // successfully enqueued
+            LocalShard().submitted.fetch_add(1, std::memory_order_relaxed); // successfully enqueued
+            NotifyWork(1, lane);
             TP_LOG_TRACE("Submit enqueued (policy=Overwrite): pending={} overwrite_cnt={}",
                          Pending(), overwrite_cnt_.load(std::memory_order_relaxed));
             return fut;
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "thread_pool/fwd.hpp"
+#include "thread_pool/move_only_function.hpp"
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace thread_pool {
+
+// Hierarchical timing wheel: 4 levels x 256 slots of intrusive lists, O(1) insert and cancel.
+// Level 0 holds timers due within 256 ticks; higher levels cover 256x more each and are cascaded down
+// when the lower level wraps (2^32 ticks in total; longer delays are re-filed when they cascade).
+// Due callbacks are handed to the dispatch function outside the wheel lock; one background thread
+// sleeps until the next occupied level-0 slot or cascade point, so idle timers cost no wake-ups.
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = MoveOnlyFunction<void()>;
+    using Dispatch = MoveOnlyFunction<void(Callback)>;
+
+    static constexpr std::size_t kLevels = 4;
+    static constexpr std::size_t kSlotBits = 8;
+    static constexpr std::size_t kSlots = std::size_t{1} << kSlotBits;
+
+    TimerWheel(Clock::duration tick, Dispatch dispatch);
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    void Start();  // launch the timer thread (idempotent)
+    void Stop();   // join the timer thread and drop every pending timer
+
+    // Fires cb at when (rounded up to the next tick), then every period if period > 0
+    TimerId     Add(Clock::time_point when, Clock::duration period, Callback cb);
+    bool        Cancel(TimerId id) noexcept;  // false when unknown, already fired (one-shot) or cancelled
+    std::size_t Size() const noexcept;        // pending timers
+
+    // Dispatch everything due by now; the timer thread calls this, tests may drive it directly
+    std::size_t Poll(Clock::time_point now);
+
+private:
+    struct Node;
+    struct Handle {
+        Node*         node{nullptr};
+        std::uint32_t generation{1};
+    };
+
+    std::uint64_t TickAt(Clock::time_point t) const noexcept;  // first tick not before t
+    void          Link(Node* node) noexcept;                    // file by expiry relative to current_
+    void          Unlink(Node* node) noexcept;
+    void          Cascade(std::size_t level) noexcept;          // re-file the level's current slot
+    void          Release(Node* node) noexcept;                 // free node and its handle
+    void          ClearUnlocked() noexcept;
+    std::uint64_t NextWakeTickUnlocked() const noexcept;
+    void          Run();
+
+    const Clock::time_point origin_;
+    const Clock::duration   tick_;
+    Dispatch                dispatch_;
+
+    mutable std::mutex      mu_;
+    std::condition_variable cv_;
+    std::uint64_t           current_{0};                          // last processed tick
+    std::uint64_t           wake_tick_{UINT64_MAX};               // tick the timer thread sleeps until
+    std::size_t             size_{0};
+    std::array<std::array<Node*, kSlots>, kLevels>              slots_{};
+    std::array<std::array<std::uint64_t, kSlots / 64>, kLevels> occupied_{};  // non-empty slot bitmap
+    std::vector<Handle>        handles_;                          // TimerId = generation << 32 | index
+    std::vector<std::uint32_t> free_handles_;
+
+    std::thread thread_;
+    bool        running_{false};
+};
+
+}
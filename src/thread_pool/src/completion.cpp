@@ -0,0 +1,38 @@
+#include "thread_pool/completion.hpp"
+
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace thread_pool {
+namespace detail {
+
+#if defined(__linux__)
+static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "futex word must be a plain 32-bit int");
+
+void WaitOnWord(const std::atomic<std::uint32_t>& word, std::uint32_t expected) noexcept {
+    // Returns immediately (EAGAIN) when the word no longer holds expected; EINTR is a spurious wakeup
+    ::syscall(SYS_futex, reinterpret_cast<const std::uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected,
+              nullptr, nullptr, 0);
+}
+
+void WakeAllOnWord(std::atomic<std::uint32_t>& word) noexcept {
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr,
+              nullptr, 0);
+}
+#else
+void WaitOnWord(const std::atomic<std::uint32_t>& word, std::uint32_t expected) noexcept {
+    if (word.load(std::memory_order_acquire) == expected) {
+        std::this_thread::yield();
+    }
+}
+
+void WakeAllOnWord(std::atomic<std::uint32_t>&) noexcept {}
+#endif
+
+} // namespace detail
+}
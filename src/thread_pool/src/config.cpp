@@ -4,6 +4,7 @@
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
+#include <unordered_set>
 #include <utility>
 
 namespace thread_pool {
@@ -84,14 +85,17 @@ namespace thread_pool {
             RawConfig raw = ParseRaw(jcfg);
             ThreadPoolConfig cfg = Normalize(raw);
             TP_LOG_INFO(
-                "ThreadPool config loaded from {} (queue_cap={} core_threads={} max_threads={} pending_hi={} pending_low={} policy={})",
+                "ThreadPool config loaded from {} (queue_cap={} core_threads={} max_threads={} pending_hi={} pending_low={} policy={} scheduler={} lanes={} affinity={})",
                 source_desc,
                 cfg.queue_cap,
                 cfg.core_threads,
                 cfg.max_threads,
                 cfg.pending_hi,
                 cfg.pending_low,
-                cfg.queue_policy);
+                cfg.queue_policy,
+                cfg.scheduler,
+                cfg.lanes.size(),
+                cfg.affinity);
             {
                 std::lock_guard<std::mutex> lk(cfg_mtx_);
                 config_ = std::move(cfg);
@@ -143,6 +147,28 @@ namespace thread_pool {
         if (jcfg.contains("queue_policy")) {
             raw.queue_policy = jcfg.at("queue_policy").get<std::string>();
         }
+        if (jcfg.contains("scheduler")) {
+            raw.scheduler = jcfg.at("scheduler").get<std::string>();
+        }
+        if (jcfg.contains("lanes")) {
+            std::vector<LaneConfig> lanes;
+            for (const auto& jlane : jcfg.at("lanes")) {
+                lanes.push_back(ParseLane(jlane));
+            }
+            raw.lanes = std::move(lanes);
+        }
+        if (jcfg.contains("affinity")) {
+            raw.affinity = jcfg.at("affinity").get<std::string>();
+        }
+        if (jcfg.contains("cpus")) {
+            raw.cpus = jcfg.at("cpus").get<std::vector<int>>();
+        }
+        if (jcfg.contains("honor_cpu_quota")) {
+            raw.honor_cpu_quota = jcfg.at("honor_cpu_quota").get<bool>();
+        }
+        if (jcfg.contains("timer_tick_ms")) {
+            raw.timer_tick_ms = jcfg.at("timer_tick_ms").get<int>();
+        }
 
         return raw;
     }
@@ -159,6 +185,42 @@ namespace thread_pool {
         }
     }
 
+    SchedulerMode ThreadPoolConfigLoader::ParseScheduler(const std::string& scheduler) {
+        if (scheduler == "Mpmc") {
+            return SchedulerMode::Mpmc;
+        } else if (scheduler == "WorkStealing") {
+            return SchedulerMode::WorkStealing;
+        } else {
+            throw std::invalid_argument("Invalid scheduler: " + scheduler);
+        }
+    }
+
+    AffinityMode ThreadPoolConfigLoader::ParseAffinity(const std::string& affinity) {
+        if (affinity == "None") {
+            return AffinityMode::None;
+        } else if (affinity == "Compact") {
+            return AffinityMode::Compact;
+        } else if (affinity == "Scatter") {
+            return AffinityMode::Scatter;
+        } else if (affinity == "List") {
+            return AffinityMode::List;
+        } else {
+            throw std::invalid_argument("Invalid affinity: " + affinity);
+        }
+    }
+
+    LaneConfig ThreadPoolConfigLoader::ParseLane(const nlohmann::json& jlane) {
+        LaneConfig lane;
+        lane.name = jlane.at("name").get<std::string>();
+        if (jlane.contains("weight")) {
+            lane.weight = jlane.at("weight").get<std::size_t>();
+        }
+        if (jlane.contains("min_workers")) {
+            lane.min_workers = jlane.at("min_workers").get<std::size_t>();
+        }
+        return lane;
+    }
+
     // Validation/Normalization layer
     ThreadPoolConfig ThreadPoolConfigLoader::Normalize(const RawConfig& raw) {
         ThreadPoolConfig cfg;
@@ -200,12 +262,49 @@ namespace thread_pool {
         if (raw.queue_policy.has_value()) {
             cfg.queue_policy = ParsePolicy(raw.queue_policy.value());
         }
+        if (raw.scheduler.has_value()) {
+            cfg.scheduler = ParseScheduler(raw.scheduler.value());
+        }
+        if (raw.lanes.has_value()) {
+            cfg.lanes = raw.lanes.value();
+        }
+        if (raw.affinity.has_value()) {
+            cfg.affinity = ParseAffinity(raw.affinity.value());
+        }
+        if (raw.cpus.has_value()) {
+            cfg.cpus = raw.cpus.value();
+        }
+        if (raw.honor_cpu_quota.has_value()) {
+            cfg.honor_cpu_quota = raw.honor_cpu_quota.value();
+        }
+        if (raw.timer_tick_ms.has_value()) {
+            cfg.timer_tick = std::chrono::milliseconds{raw.timer_tick_ms.value()};
+        }
+        if (cfg.affinity == AffinityMode::List && cfg.cpus.empty()) {
+            throw std::invalid_argument("Invalid cpus: affinity List needs at least one CPU");
+        }
+
+        // Lane validation
+        std::unordered_set<std::string> lane_names;
+        std::size_t reserved = 0;
+        for (auto& lane : cfg.lanes) {
+            if (lane.name.empty() || !lane_names.insert(lane.name).second) {
+                throw std::invalid_argument("Invalid lane name: '" + lane.name + "' (empty or duplicated)");
+            }
+            lane.weight = std::max<std::size_t>(1, lane.weight);
+            reserved += lane.min_workers;
+        }
 
         // Sanity adjustments
         cfg.core_threads = std::max<std::size_t>(1, cfg.core_threads);
+        if (reserved > 0) {
+            // Keep at least one shared worker besides the reserved ones
+            cfg.core_threads = std::max(cfg.core_threads, reserved + 1);
+        }
         cfg.max_threads = std::max(cfg.core_threads, cfg.max_threads);
         cfg.pending_low = std::min(cfg.pending_hi, cfg.pending_low);
         cfg.debounce_hits = std::max<std::size_t>(1, cfg.debounce_hits);
+        cfg.timer_tick = std::max(std::chrono::milliseconds{1}, cfg.timer_tick);
         return cfg;
     }
 
@@ -256,6 +355,40 @@ namespace thread_pool {
                 jcfg["queue_policy"] = "Overwrite";
                 break;
         }
+        switch (cfg.scheduler) {
+            case SchedulerMode::Mpmc:
+                jcfg["scheduler"] = "Mpmc";
+                break;
+            case SchedulerMode::WorkStealing:
+                jcfg["scheduler"] = "WorkStealing";
+                break;
+        }
+        switch (cfg.affinity) {
+            case AffinityMode::None:
+                jcfg["affinity"] = "None";
+                break;
+            case AffinityMode::Compact:
+                jcfg["affinity"] = "Compact";
+                break;
+            case AffinityMode::Scatter:
+                jcfg["affinity"] = "Scatter";
+                break;
+            case AffinityMode::List:
+                jcfg["affinity"] = "List";
+                break;
+        }
+        if (!cfg.cpus.empty()) {
+            jcfg["cpus"] = cfg.cpus;
+        }
+        jcfg["honor_cpu_quota"] = cfg.honor_cpu_quota;
+        jcfg["timer_tick_ms"] = cfg.timer_tick.count();
+        if (!cfg.lanes.empty()) {
+            auto& jlanes = jcfg["lanes"];
+            jlanes = nlohmann::json::array();
+            for (const auto& lane : cfg.lanes) {
+                jlanes.push_back({{"name", lane.name}, {"weight", lane.weight}, {"min_workers", lane.min_workers}});
+            }
+        }
         return jcfg;
     }
 
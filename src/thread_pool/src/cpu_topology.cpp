@@ -0,0 +1,282 @@
+#include "thread_pool/cpu_topology.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace thread_pool {
+namespace {
+
+bool ReadFirstLine(const std::string& path, std::string& line) {
+    std::ifstream in(path);
+    return in && std::getline(in, line);
+}
+
+bool ParseLong(std::string_view text, long& value) {
+    if (text.empty()) {
+        return false;
+    }
+    const std::string buf(text);
+    char* end = nullptr;
+    errno = 0;
+    value = std::strtol(buf.c_str(), &end, 10);
+    return errno == 0 && end == buf.c_str() + buf.size();
+}
+
+std::vector<int> AllowedCpus() {
+    std::vector<int> cpus;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+    if (cpus.empty()) {
+        const unsigned n = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned cpu = 0; cpu < n; ++cpu) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+    }
+    return cpus;
+}
+
+// node index -> CPUs from /sys/devices/system/node/node*/cpulist
+std::vector<std::pair<int, std::vector<int>>> SysfsNodes() {
+    std::vector<std::pair<int, std::vector<int>>> nodes;
+#if defined(__linux__)
+    const std::string base = "/sys/devices/system/node";
+    DIR* dir = ::opendir(base.c_str());
+    if (dir == nullptr) {
+        return nodes;
+    }
+    while (const dirent* entry = ::readdir(dir)) {
+        const std::string_view name(entry->d_name);
+        long id = 0;
+        if (name.size() <= 4 || name.substr(0, 4) != "node" || !ParseLong(name.substr(4), id)) {
+            continue;
+        }
+        std::string line;
+        if (ReadFirstLine(base + "/" + std::string(name) + "/cpulist", line)) {
+            nodes.emplace_back(static_cast<int>(id), CpuTopology::ParseCpuList(line));
+        }
+    }
+    ::closedir(dir);
+    std::sort(nodes.begin(), nodes.end());
+#endif
+    return nodes;
+}
+
+// Path of this process in the unified (v2) hierarchy, "" when unknown
+std::string SelfCgroupPath() {
+    std::ifstream in("/proc/self/cgroup");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.rfind("0::", 0) == 0) {
+            return line.substr(3);
+        }
+    }
+    return {};
+}
+
+std::optional<double> ReadCpuMax(const std::string& path) {
+    std::string line;
+    if (!ReadFirstLine(path, line)) {
+        return std::nullopt;
+    }
+    // "<quota> <period>" or "max <period>"
+    std::istringstream in(line);
+    std::string quota;
+    long period = 0;
+    in >> quota >> period;
+    long q = 0;
+    if (quota == "max" || !ParseLong(quota, q) || q <= 0 || period <= 0) {
+        return std::nullopt;
+    }
+    return static_cast<double>(q) / static_cast<double>(period);
+}
+
+std::optional<double> ReadCfsQuota(const std::string& dir) {
+    std::string quota_line;
+    std::string period_line;
+    long quota = 0;
+    long period = 0;
+    if (!ReadFirstLine(dir + "/cpu.cfs_quota_us", quota_line) || !ReadFirstLine(dir + "/cpu.cfs_period_us", period_line)
+        || !ParseLong(quota_line, quota) || !ParseLong(period_line, period) || quota <= 0 || period <= 0) {
+        return std::nullopt;  // -1 means unlimited
+    }
+    return static_cast<double>(quota) / static_cast<double>(period);
+}
+
+}  // namespace
+
+CpuTopology::CpuTopology(std::vector<std::vector<int>> nodes) : nodes_(std::move(nodes)) {}
+
+CpuTopology CpuTopology::Detect() {
+    const std::vector<int> allowed = AllowedCpus();
+    const std::unordered_set<int> allowed_set(allowed.begin(), allowed.end());
+    std::vector<std::vector<int>> nodes;
+    std::unordered_set<int> placed;
+    for (auto& [id, cpus] : SysfsNodes()) {
+        std::vector<int> usable;
+        for (int cpu : cpus) {
+            if (allowed_set.count(cpu) != 0 && placed.insert(cpu).second) {
+                usable.push_back(cpu);
+            }
+        }
+        if (!usable.empty()) {
+            nodes.push_back(std::move(usable));
+        }
+    }
+    // Allowed CPUs missing from sysfs (or no NUMA info at all) go to the first node
+    std::vector<int> rest;
+    for (int cpu : allowed) {
+        if (placed.count(cpu) == 0) {
+            rest.push_back(cpu);
+        }
+    }
+    if (!rest.empty()) {
+        if (nodes.empty()) {
+            nodes.push_back(std::move(rest));
+        } else {
+            nodes.front().insert(nodes.front().end(), rest.begin(), rest.end());
+        }
+    }
+    return CpuTopology(std::move(nodes));
+}
+
+const std::vector<std::vector<int>>& CpuTopology::Nodes() const noexcept {
+    return nodes_;
+}
+
+std::size_t CpuTopology::NodeCount() const noexcept {
+    return nodes_.size();
+}
+
+std::size_t CpuTopology::CpuCount() const noexcept {
+    std::size_t total = 0;
+    for (const auto& node : nodes_) {
+        total += node.size();
+    }
+    return total;
+}
+
+std::size_t CpuTopology::NodeOf(int cpu) const noexcept {
+    for (std::size_t i = 0; i < nodes_.size(); ++i) {
+        if (std::find(nodes_[i].begin(), nodes_[i].end(), cpu) != nodes_[i].end()) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+std::vector<int> CpuTopology::Placement(AffinityMode mode, const std::vector<int>& cpus) const {
+    std::vector<int> order;
+    switch (mode) {
+        case AffinityMode::None:
+            break;
+        case AffinityMode::Compact:
+            for (const auto& node : nodes_) {
+                order.insert(order.end(), node.begin(), node.end());
+            }
+            break;
+        case AffinityMode::Scatter:
+            for (std::size_t i = 0; order.size() < CpuCount(); ++i) {
+                for (const auto& node : nodes_) {
+                    if (i < node.size()) {
+                        order.push_back(node[i]);
+                    }
+                }
+            }
+            break;
+        case AffinityMode::List:
+            for (int cpu : cpus) {
+                const bool known = std::any_of(nodes_.begin(), nodes_.end(), [cpu](const std::vector<int>& node) {
+                    return std::find(node.begin(), node.end(), cpu) != node.end();
+                });
+                if (known) {
+                    order.push_back(cpu);
+                }
+            }
+            break;
+    }
+    return order;
+}
+
+std::vector<int> CpuTopology::ParseCpuList(std::string_view list) {
+    std::vector<int> cpus;
+    while (!list.empty()) {
+        const auto comma = list.find(',');
+        std::string_view item = list.substr(0, comma);
+        list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+        while (!item.empty() && (item.back() == '\n' || item.back() == ' ')) {
+            item.remove_suffix(1);
+        }
+        const auto dash = item.find('-');
+        long lo = 0;
+        long hi = 0;
+        if (dash == std::string_view::npos) {
+            if (!ParseLong(item, lo)) {
+                continue;
+            }
+            hi = lo;
+        } else if (!ParseLong(item.substr(0, dash), lo) || !ParseLong(item.substr(dash + 1), hi)) {
+            continue;
+        }
+        for (long cpu = std::max(0L, lo); cpu <= hi; ++cpu) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+    }
+    return cpus;
+}
+
+std::optional<double> CpuTopology::CgroupCpuLimit(const std::string& cgroup_root) {
+    // cgroup v2: the process's own group first, then the namespace root
+    const std::string self = SelfCgroupPath();
+    if (!self.empty() && self != "/") {
+        if (auto limit = ReadCpuMax(cgroup_root + self + "/cpu.max")) {
+            return limit;
+        }
+    }
+    if (auto limit = ReadCpuMax(cgroup_root + "/cpu.max")) {
+        return limit;
+    }
+    // cgroup v1
+    for (const char* dir : {"/cpu", "/cpu,cpuacct", "/cpuacct,cpu"}) {
+        if (auto limit = ReadCfsQuota(cgroup_root + dir)) {
+            return limit;
+        }
+    }
+    return std::nullopt;
+}
+
+bool CpuTopology::PinCurrentThread(int cpu) noexcept {
+#if defined(__linux__)
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+}
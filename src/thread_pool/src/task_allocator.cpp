@@ -0,0 +1,196 @@
+#include "thread_pool/task_allocator.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace thread_pool {
+namespace {
+
+constexpr std::size_t kBatch = 32;       // blocks moved between a thread cache and the depot at once
+constexpr std::size_t kSlabBlocks = 64;  // blocks carved per slab
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+struct FreeList {
+    FreeBlock*  head{nullptr};
+    std::size_t count{0};
+};
+
+// Global per-class store of free batches; intentionally leaked so it outlives every thread cache
+struct Depot {
+    std::mutex            mu;
+    std::vector<FreeList> batches;
+};
+
+Depot* Depots() {
+    static Depot* depots = new Depot[TaskAllocator::kClasses];
+    return depots;
+}
+
+std::atomic<std::size_t> g_slabs{0};
+std::atomic<std::size_t> g_oversize{0};
+
+std::size_t ClassOf(std::size_t size) noexcept {
+    return size == 0 ? 0 : (size - 1) / TaskAllocator::kGranularity;
+}
+
+// Take one batch from the depot, carving a new slab when it is empty
+FreeList TakeBatch(std::size_t cls) {
+    Depot& depot = Depots()[cls];
+    {
+        std::lock_guard<std::mutex> lk(depot.mu);
+        if (!depot.batches.empty()) {
+            FreeList batch = depot.batches.back();
+            depot.batches.pop_back();
+            return batch;
+        }
+    }
+    const std::size_t block = (cls + 1) * TaskAllocator::kGranularity;
+    auto* slab = static_cast<char*>(::operator new(block * kSlabBlocks));
+    g_slabs.fetch_add(1, std::memory_order_relaxed);
+    FreeList batch;
+    for (std::size_t i = kSlabBlocks; i-- > 0;) {
+        auto* b = reinterpret_cast<FreeBlock*>(slab + i * block);
+        b->next = batch.head;
+        batch.head = b;
+    }
+    batch.count = kSlabBlocks;
+    return batch;
+}
+
+void GiveBatch(std::size_t cls, FreeList batch) {
+    if (batch.head == nullptr) {
+        return;
+    }
+    Depot& depot = Depots()[cls];
+    std::lock_guard<std::mutex> lk(depot.mu);
+    depot.batches.push_back(batch);
+}
+
+// Detach up to n blocks from the front of list
+FreeList Split(FreeList& list, std::size_t n) noexcept {
+    FreeList out;
+    while (out.count < n && list.head != nullptr) {
+        FreeBlock* b = list.head;
+        list.head = b->next;
+        --list.count;
+        b->next = out.head;
+        out.head = b;
+        ++out.count;
+    }
+    return out;
+}
+
+struct ThreadCache {
+    FreeList lists[TaskAllocator::kClasses];
+
+    ~ThreadCache();
+};
+
+// 0 = not yet used, 1 = alive, 2 = destroyed; trivially destructible so it stays valid during teardown
+thread_local int t_cache_state = 0;
+thread_local ThreadCache t_cache;
+
+ThreadCache::~ThreadCache() {
+    t_cache_state = 2;
+    for (std::size_t cls = 0; cls < TaskAllocator::kClasses; ++cls) {
+        try {
+            while (lists[cls].head != nullptr) {
+                GiveBatch(cls, Split(lists[cls], kBatch));
+            }
+        } catch (...) {
+            // Depot growth failed; remaining blocks of this thread are leaked
+        }
+    }
+}
+
+ThreadCache* LocalCache() noexcept {
+    if (t_cache_state == 2) {
+        return nullptr;
+    }
+    t_cache_state = 1;
+    return &t_cache;
+}
+
+}  // namespace
+
+void* TaskAllocator::Allocate(std::size_t size) {
+    if (size > kMaxBlock) {
+        g_oversize.fetch_add(1, std::memory_order_relaxed);
+        return ::operator new(size);
+    }
+    const std::size_t cls = ClassOf(size);
+    ThreadCache* cache = LocalCache();
+    if (cache == nullptr) {
+        // Thread is tearing down: go straight to the depot
+        FreeList batch = TakeBatch(cls);
+        FreeBlock* b = batch.head;
+        batch.head = b->next;
+        --batch.count;
+        GiveBatch(cls, batch);
+        return b;
+    }
+    FreeList& list = cache->lists[cls];
+    if (list.head == nullptr) {
+        list = TakeBatch(cls);
+    }
+    FreeBlock* b = list.head;
+    list.head = b->next;
+    --list.count;
+    return b;
+}
+
+void TaskAllocator::Deallocate(void* ptr, std::size_t size) noexcept {
+    if (ptr == nullptr) {
+        return;
+    }
+    if (size > kMaxBlock) {
+        ::operator delete(ptr);
+        return;
+    }
+    const std::size_t cls = ClassOf(size);
+    auto* b = static_cast<FreeBlock*>(ptr);
+    ThreadCache* cache = LocalCache();
+    if (cache == nullptr) {
+        b->next = nullptr;
+        try {
+            GiveBatch(cls, FreeList{b, 1});
+        } catch (...) {
+            // Depot growth failed during teardown; the block is leaked
+        }
+        return;
+    }
+    FreeList& list = cache->lists[cls];
+    b->next = list.head;
+    list.head = b;
+    ++list.count;
+    if (list.count >= 2 * kBatch) {
+        // Keep one batch locally, hand the rest back for producer threads
+        FreeList spill = Split(list, kBatch);
+        try {
+            GiveBatch(cls, spill);
+        } catch (...) {
+            // Depot growth failed; keep the blocks cached locally
+            while (spill.head != nullptr) {
+                FreeBlock* next = spill.head->next;
+                spill.head->next = list.head;
+                list.head = spill.head;
+                ++list.count;
+                spill.head = next;
+            }
+        }
+    }
+}
+
+TaskAllocator::Stats TaskAllocator::GetStats() noexcept {
+    Stats stats;
+    stats.slabs = g_slabs.load(std::memory_order_relaxed);
+    stats.oversize = g_oversize.load(std::memory_order_relaxed);
+    return stats;
+}
+
+}
@@ -3,11 +3,14 @@
 #include "mpmc/blocking_queue_adapter.hpp"
 #include "logger.hpp"
 
+#include <algorithm>
 #include <functional>
 #include <stdexcept>
 #include <cassert>
+#include <cmath>
 #include <utility>
 #include <chrono>
+#include <set>
 #include <string>
 
 namespace thread_pool {
@@ -18,14 +21,37 @@ long long ToMilliseconds(Duration duration) noexcept {
     return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
 }
 
+// Identifies the pool owning the current thread; deque, lane and rng are used by WorkStealing workers only
+struct WorkerContext {
+    const ThreadPool* pool{nullptr};
+    std::size_t       deque{0};
+    LaneId            lane{kDefaultLane};  // lane whose tasks may stay on the local deque: home lane, else default
+    std::uint64_t     rng{0};  // xorshift state for victim selection
+};
+thread_local WorkerContext t_worker;
+
+// Process-wide thread ordinal; pools map it onto their counter shards
+std::atomic<std::size_t> g_next_thread_ordinal{0};
+thread_local const std::size_t t_thread_ordinal = g_next_thread_ordinal.fetch_add(1, std::memory_order_relaxed);
+
+std::size_t NextVictim(std::size_t count) noexcept {
+    auto& x = t_worker.rng;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return static_cast<std::size_t>(x % count);
+}
+
 }
 
 ThreadPool::ThreadPool(std::size_t threads_count, std::size_t queue_cap) 
     : state_(PoolState::CREATED)
-    , queue_(queue_cap)
     , workers_()
     , policy_(QueueFullPolicy::Block)
+    , scheduler_(SchedulerMode::Mpmc)
+    , parking_(false)
 {
+    lanes_.push_back(std::make_unique<Lane>(LaneConfig{"default", 1, 0}, queue_cap));
     core_threads_         = std::max<std::size_t>(1, threads_count);  // Default core threads equals initial value
     max_threads_          = core_threads_;                            // If not configured, do not scale above core
     load_check_interval_  = std::chrono::milliseconds{100};           // Load balancer sampling interval
@@ -37,16 +63,21 @@ ThreadPool::ThreadPool(std::size_t threads_count, std::size_t queue_cap)
     debounce_hits_        = 3;                                        // Debounce hits for scale up/down
     cooldown_             = std::chrono::milliseconds{500};           // Cooldown after capacity change
     const auto policy = policy_.load(std::memory_order_relaxed);
+    InitCounterShards();
+    timers_ = std::make_unique<TimerWheel>(std::chrono::milliseconds{1}, [this](TimerWheel::Callback cb) {
+        PostTask(std::make_unique<SimpleTask>(std::move(cb)), kDefaultLane);
+    });
 
     TP_LOG_DEBUG("ThreadPool constructed (direct): core_threads={} max_threads={} queue_cap={} policy={}",
-                 core_threads_, max_threads_, queue_.Capacity(), policy);
+                 core_threads_, max_threads_, QueueCapacity(), policy);
 }
 
 ThreadPool::ThreadPool(const ThreadPoolConfig& cfg)
     : state_(PoolState::CREATED)
-    , queue_(cfg.queue_cap)
     , workers_()
     , policy_(cfg.queue_policy)
+    , scheduler_(cfg.scheduler)
+    , parking_(cfg.scheduler == SchedulerMode::WorkStealing || cfg.lanes.size() > 1)
 {
     core_threads_         = std::max<std::size_t>(1, cfg.core_threads);   // Default core threads equals configured value
     max_threads_          = std::max(core_threads_, cfg.max_threads);     // Ensure max >= core
@@ -59,9 +90,47 @@ ThreadPool::ThreadPool(const ThreadPoolConfig& cfg)
     debounce_hits_        = std::max<std::size_t>(1, cfg.debounce_hits);  // Debounce hits
     cooldown_             = cfg.cooldown;                                 // Cooldown after capacity change
     const auto policy = policy_.load(std::memory_order_relaxed);
+
+    // Each lane gets its own queue of queue_cap; without lanes there is a single default lane
+    std::size_t reserved = 0;
+    for (const auto& lane : cfg.lanes) {
+        lanes_.push_back(std::make_unique<Lane>(lane, cfg.queue_cap));
+        lanes_.back()->cfg.weight = std::max<std::size_t>(1, lane.weight);
+        reserved += lane.min_workers;
+    }
+    if (lanes_.empty()) {
+        lanes_.push_back(std::make_unique<Lane>(LaneConfig{"default", 1, 0}, cfg.queue_cap));
+    }
+    if (reserved > 0 && core_threads_ <= reserved) {
+        // Lanes without reservations still need a shared worker
+        TP_LOG_WARN("ThreadPool core_threads={} does not exceed reserved lane workers={}; raising to {}",
+                    core_threads_, reserved, reserved + 1);
+        core_threads_ = reserved + 1;
+        max_threads_ = std::max(max_threads_, core_threads_);
+    }
+    if (cfg.honor_cpu_quota) {
+        ApplyCpuQuota(reserved);
+    }
+
+    InitCounterShards();
+    InitPlacement(cfg);
+    timers_ = std::make_unique<TimerWheel>(cfg.timer_tick, [this](TimerWheel::Callback cb) {
+        PostTask(std::make_unique<SimpleTask>(std::move(cb)), kDefaultLane);
+    });
+
+    if (scheduler_ == SchedulerMode::WorkStealing) {
+        // One deque per possible worker; deques are recycled as workers come and go
+        deques_.reserve(max_threads_);
+        free_deques_.reserve(max_threads_);
+        deque_node_ = std::make_unique<std::atomic<std::size_t>[]>(max_threads_);
+        for (std::size_t i = 0; i < max_threads_; ++i) {
+            deques_.push_back(std::make_unique<WorkStealingDeque<TaskBase*>>());
+            free_deques_.push_back(max_threads_ - 1 - i);
+        }
+    }
     
-    TP_LOG_DEBUG("ThreadPool constructed (config): core_threads={} max_threads={} queue_cap={} policy={}",
-                 core_threads_, max_threads_, queue_.Capacity(), policy);
+    TP_LOG_DEBUG("ThreadPool constructed (config): core_threads={} max_threads={} queue_cap={} policy={} scheduler={} lanes={}",
+                 core_threads_, max_threads_, QueueCapacity(), policy, scheduler_, lanes_.size());
 }
 
 ThreadPool::~ThreadPool () {
@@ -85,13 +154,12 @@ void ThreadPool::Start() {
     }
     const auto policy = policy_.load(std::memory_order_relaxed);
     TP_LOG_INFO("ThreadPool starting: core_threads={} max_threads={} queue_cap={} policy={} load_interval={}ms keep_alive={}ms",
-                core_threads_, max_threads_, queue_.Capacity(), policy,
+                core_threads_, max_threads_, QueueCapacity(), policy,
                 ToMilliseconds(load_check_interval_), ToMilliseconds(keep_alive_));
     {
         std::lock_guard<std::mutex> lk(workers_mu_);
         workers_.reserve(max_threads_); // Reserve up to max threads to avoid frequent reallocation
         current_threads_.store(0, std::memory_order_relaxed);
-        active_threads_.store(0, std::memory_order_relaxed);
         for  (std::size_t i = 0; i < core_threads_; ++i) {
             CreateWorkerUnlocked();
         }
@@ -99,9 +167,9 @@ void ThreadPool::Start() {
     balancer_stop_.store(false, std::memory_order_release); // Enable dynamic load balancing
     LaunchLoadBalancer();
     const auto current_policy = policy_.load(std::memory_order_relaxed);
-    TP_LOG_INFO("ThreadPool started with {} workers (policy={}, pending_hi={}, pending_low={})",
+    TP_LOG_INFO("ThreadPool started with {} workers (policy={}, scheduler={}, pending_hi={}, pending_low={})",
                 current_threads_.load(std::memory_order_relaxed),
-                current_policy,
+                current_policy, scheduler_,
                 pending_hi_, pending_low_);
 }
 
@@ -153,41 +221,54 @@ void ThreadPool::Stop(StopMode mode) {
         pause_cv_.notify_all();
     }
 
+    // Drop pending timers; due ones would be rejected by the stopping pool anyway
+    timers_->Stop();
+
     // Shutdown: graceful / force
     PoolState cur = state_.load(std::memory_order_acquire);
     TP_LOG_DEBUG("ThreadPool stop entering phase {}", cur);
 
     if (cur == PoolState::SHUTTING_DOWN) {
-        TP_LOG_INFO("ThreadPool graceful shutdown: waiting for {} submissions in-flight", submit_ing_.load(std::memory_order_acquire));
-        // Drain in-flight submissions
+        TP_LOG_INFO("ThreadPool graceful shutdown: waiting for {} submissions in-flight", SumShards(&CounterShard::submitting));
+        // Drain in-flight submissions; the sharded counters are only summed here, so re-check periodically
+        // in case a notification raced with the state change
         {
             std::unique_lock<std::mutex> lk(submit_mtx_);
-            submit_cv_.wait(lk, [this] {
-                return submit_ing_.load(std::memory_order_acquire) == 0;
-            });
+            while (!submit_cv_.wait_for(lk, kDrainRecheck, [this] {
+                return SumShards(&CounterShard::submitting) == 0;
+            })) {}
         }
         TP_LOG_INFO("ThreadPool submissions drained, waiting for {} pending / {} active tasks",
                     Pending(), ActiveTasks());
         // All submissions done; wait for execution to complete
         {
             std::unique_lock<std::mutex> lk(drain_mtx_);
-            drain_cv_.wait(lk, [this] {
+            while (!drain_cv_.wait_for(lk, kDrainRecheck, [this] {
                 return Pending() == 0 && ActiveTasks() == 0;
-            });
+            })) {}
+        }
+        for (auto& lane : lanes_) {
+            lane->queue.Close();
         }
-        queue_.Close();
+        WakeAllWorkers();
         TP_LOG_INFO("ThreadPool queue closed after graceful drain");
     } else if (cur == PoolState::FORCE_STOPPING) {
         const auto pending = Pending();
         TP_LOG_WARN("ThreadPool force stop: cancelling {} pending tasks", pending);
         // Force clear the queue
-        queue_.Clear([&](TaskPtr& t) {
-            if (t) {
-                t->Cancel(std::make_exception_ptr(std::runtime_error("force stopped")));
-                RecordTaskCancel();
-            }
-        });
-        queue_.Close();
+        for (auto& lane : lanes_) {
+            lane->queue.Clear([&](TaskPtr& t) {
+                if (t) {
+                    t->Cancel(std::make_exception_ptr(std::runtime_error("force stopped")));
+                    RecordTaskCancel();
+                }
+            });
+        }
+        CancelLocalTasks();
+        for (auto& lane : lanes_) {
+            lane->queue.Close();
+        }
+        WakeAllWorkers();
         TP_LOG_WARN("ThreadPool queue cleared; {} tasks marked cancelled", pending);
     } else if (cur == PoolState::STOPPED) {
         TP_LOG_DEBUG("ThreadPool already stopped");
@@ -202,6 +283,9 @@ void ThreadPool::Stop(StopMode mode) {
     {
         std::lock_guard<std::mutex> lk(workers_mu_);
         to_join.swap(workers_); // Take ownership of all worker slots
+        for (auto& slot : to_join) {
+            ReleaseCpuUnlocked(*slot);
+        }
     }
     const auto self = std::this_thread::get_id(); // Avoid self-join deadlock
     for (auto& slot : to_join) {
@@ -209,6 +293,8 @@ void ThreadPool::Stop(StopMode mode) {
             slot->thread.join();
         }
     }
+    // Tasks spawned onto worker deques after the force-stop sweep
+    CancelLocalTasks();
 
     // Mark as stopped
     state_.store(PoolState::STOPPED, std::memory_order_release);
@@ -241,10 +327,7 @@ void ThreadPool::ShutDown(ShutDownOption opt, std::chrono::milliseconds timeout)
     }
 }
 
-void ThreadPool::Post(std::function<void()> f) {
-    // Use lightweight SimpleTask to avoid future overhead
-    auto task_ptr = std::make_unique<SimpleTask>(std::move(f));
-    
+void ThreadPool::PostTask(TaskPtr task_ptr, LaneId lane) {
     // Fast state check
     for (;;) {
         PoolState s = state_.load(std::memory_order_acquire);
@@ -262,26 +345,34 @@ void ThreadPool::Post(std::function<void()> f) {
         }
         // Other states: reject the submission
         RecordTaskRejected();
+        task_ptr->Cancel(std::make_exception_ptr(std::runtime_error("ThreadPool::Post: pool is not RUNNING")));
+        return;
+    }
+
+    if (OnWorkerThread(lane)) {
+        PushLocal(task_ptr.release());
+        LocalShard().submitted.fetch_add(1, std::memory_order_relaxed);
         return;
     }
 
     // Dispatch by queue policy
+    auto& queue = LaneQueue(lane);
     const auto policy = policy_.load(std::memory_order_relaxed);
     bool success = false;
     
     switch (policy) {
         case QueueFullPolicy::Block:
-            success = queue_.WaitPush(std::move(task_ptr));
+            success = queue.WaitPush(std::move(task_ptr));
             break;
         case QueueFullPolicy::Discard:
-            success = queue_.TryPush(std::move(task_ptr));
+            success = queue.TryPush(std::move(task_ptr));
             if (!success) {
                 discard_cnt_.fetch_add(1, std::memory_order_relaxed);
             }
             break;
         case QueueFullPolicy::Overwrite: {
             TaskPtr overwritten;
-            success = queue_.OverwritePush(std::move(task_ptr), &overwritten);
+            success = queue.OverwritePush(std::move(task_ptr), &overwritten);
             if (overwritten) {
                 overwritten->Cancel(std::make_exception_ptr(
                     std::runtime_error("ThreadPool::Post: overwritten")
@@ -297,9 +388,14 @@ void ThreadPool::Post(std::function<void()> f) {
     }
     
     if (success) {
-        total_submitted_.fetch_add(1, std::memory_order_relaxed);
+        LocalShard().submitted.fetch_add(1, std::memory_order_relaxed);
+        NotifyWork(1, lane);
     } else {
         RecordTaskRejected();
+        if (task_ptr) {
+            // Still owned here when the queue refused it without taking it (Discard/closed)
+            task_ptr->Cancel(std::make_exception_ptr(std::runtime_error("ThreadPool::Post: task rejected")));
+        }
     }
 }
 
@@ -329,9 +425,27 @@ void ThreadPool::WorkerLoop(WorkerSlot* slot) {
     const auto tid_hash = std::hash<std::thread::id>{}(std::this_thread::get_id());
     TP_LOG_DEBUG("Worker {} started (thread_id_hash={})",
                  static_cast<const void*>(slot), tid_hash);
+    if (slot->placement != kUnpinned && !CpuTopology::PinCurrentThread(placement_[slot->placement])) {
+        TP_LOG_WARN("Worker {} could not be pinned to cpu {}; running unpinned",
+                    static_cast<const void*>(slot), placement_[slot->placement]);
+    }
     WorkerCounterHelper counter(*this, *slot);
+    const bool work_stealing = scheduler_ == SchedulerMode::WorkStealing;
+    t_worker.pool = this;
+    if (work_stealing) {
+        t_worker.deque = slot->deque;
+        t_worker.lane = slot->home_lane == kSharedWorker ? kDefaultLane : slot->home_lane;
+        t_worker.rng = (tid_hash | 1) ^ (static_cast<std::uint64_t>(slot->deque) << 32);
+    }
+    TaskBatch batch;                // Mpmc only; parking mode pops one task at a time to keep lane weights exact
+    bool exit_after_batch = false;  // directed exit seen while batched tasks were still buffered
+    bool verbose = true;            // per-task debug logging, refreshed whenever the batch runs dry
     for (;;) {
-        {
+        if (exit_after_batch && batch.Empty()) {
+            TP_LOG_INFO("Worker {} leaving after its task batch", static_cast<const void*>(slot));
+            break;
+        }
+        if (state_.load(std::memory_order_acquire) == PoolState::PAUSED) {
             std::unique_lock<std::mutex> lk(pause_mtx_);
             while (state_.load(std::memory_order_acquire) == PoolState::PAUSED) {
                 paused_wait_cnt_.fetch_add(1, std::memory_order_relaxed);
@@ -350,14 +464,20 @@ void ThreadPool::WorkerLoop(WorkerSlot* slot) {
     slot->idle.store(true, std::memory_order_release); // Mark thread idle
     slot->idle_nums.fetch_add(1, std::memory_order_relaxed); // Increment idle counter
 
+        if (batch.Empty()) {
+            verbose = log::Level() <= spdlog::level::debug;
+        }
         TaskPtr task;
-        const bool ok = queue_.WaitPop(task);
+        const bool ok = parking_ ? WaitNextTask(slot, task) : NextBatchedTask(batch, task);
 
         if (!ok) {
-            if (queue_.Closed()) {
+            if (QueuesClosed()) {
                 TP_LOG_DEBUG("Worker {} exiting: task queue closed", static_cast<const void*>(slot));
                 break;
             }
+            if (parking_) {
+                continue; // Woken for pause/force stop; re-check state at loop head
+            }
             TP_LOG_WARN("Worker {} wait-pop failed but queue open; retrying", static_cast<const void*>(slot));
             continue; // No task obtained; remain idle
         }
@@ -370,15 +490,24 @@ void ThreadPool::WorkerLoop(WorkerSlot* slot) {
         if (auto* exit_task = dynamic_cast<ExitTask*>(task.get())) {
             if (exit_task->slot == slot) {
                 slot->should_exit.store(false, std::memory_order_release);
+                if (work_stealing && !deques_[slot->deque]->Empty()) {
+                    WakeAllWorkers(); // Leftover local tasks remain stealable by the others
+                }
                 TP_LOG_INFO("Worker {} received directed exit request", static_cast<const void*>(slot));
+                if (!batch.Empty()) {
+                    exit_after_batch = true; // Run what this worker already claimed, then leave
+                    continue;
+                }
                 break; // Directed exit
             }
             TP_LOG_DEBUG("Worker {} forwarding exit task to {}", static_cast<const void*>(slot),
                          static_cast<const void*>(exit_task->slot));
-            if (!queue_.WaitPush(std::move(task))) {
+            if (!LaneQueue(kDefaultLane).WaitPush(std::move(task))) {
                 TP_LOG_WARN("Worker {} failed to requeue exit task", static_cast<const void*>(slot));
-                break;
+                exit_after_batch = true;
+                continue;
             }
+            WakeAllWorkers();
             continue;
         }
 
@@ -389,13 +518,8 @@ void ThreadPool::WorkerLoop(WorkerSlot* slot) {
         bool unknown_exception = false;
         std::string exception_message;
         {
-            TP_PERF_SCOPE_HOOK_LEVEL(
-                "WorkerLoop::ExecuteTask",
-                ([this, &task, &exec_span](std::chrono::nanoseconds ns) {
-                    exec_span = ns;
-                    RecordTaskComplete(*task, ns);
-                }),
-                spdlog::level::trace);
+            // Timed inline rather than with ScopeTimer, whose name string and hook would allocate per task
+            const auto exec_start = std::chrono::steady_clock::now();
             try {
                 task->Execute();
             } catch (const std::exception& ex) {
@@ -404,6 +528,12 @@ void ThreadPool::WorkerLoop(WorkerSlot* slot) {
             } catch (...) {
                 unknown_exception = true;
             }
+            exec_span = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - exec_start);
+            RecordTaskComplete(*task, exec_span);
+            if (verbose) {
+                TP_LOG_TRACE("[perf] WorkerLoop::ExecuteTask took {} us",
+                             std::chrono::duration_cast<std::chrono::microseconds>(exec_span).count());
+            }
         }
         counter.TaskOff();
 
@@ -421,21 +551,68 @@ void ThreadPool::WorkerLoop(WorkerSlot* slot) {
             continue;
         }
 
-        TP_LOG_DEBUG("Worker {} completed task={} success={} duration={}us pending={} active={}",
-                     static_cast<const void*>(slot),
-                     static_cast<const void*>(task.get()),
-                     task->Success(),
-                     duration_us,
-                     Pending(), ActiveTasks());
+        if (verbose) {
+            // Arguments are evaluated even when the level is filtered out; Pending() sums every queue and shard
+            TP_LOG_DEBUG("Worker {} completed task={} success={} duration={}us pending={} active={}",
+                         static_cast<const void*>(slot),
+                         static_cast<const void*>(task.get()),
+                         task->Success(),
+                         duration_us,
+                         Pending(), ActiveTasks());
+        }
 
-        if (ActiveTasks() == 0 && Pending() == 0) {
+        // Pending() and ActiveTasks() read every deque / counter shard; only a graceful stop waits on them
+        if (State() == PoolState::SHUTTING_DOWN && ActiveTasks() == 0 && Pending() == 0) {
             std::lock_guard<std::mutex> lk(drain_mtx_);
             drain_cv_.notify_all();
         }
     }
+    CancelBatch(batch);
+    t_worker = WorkerContext{};
     TP_LOG_DEBUG("Worker {} exiting loop", static_cast<const void*>(slot));
 }
 
+bool ThreadPool::NextBatchedTask(TaskBatch& batch, TaskPtr& task) {
+    if (!batch.Empty()) {
+        task = std::move(batch.items[batch.head++]);
+        LocalShard().buffered.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    batch.head = batch.size = 0;
+    auto& queue = LaneQueue(kDefaultLane);
+    // Claim at most an even share of the backlog so one worker does not hoard tasks the others could run
+    const std::size_t workers = std::max<std::size_t>(1, current_threads_.load(std::memory_order_relaxed));
+    const std::size_t share = std::min(kWorkerBatch, queue.Size() / workers);
+    if (share > 1) {
+        // Count the claim as buffered before it leaves the queue so Pending() never misses it
+        auto& buffered = LocalShard().buffered;
+        buffered.fetch_add(share, std::memory_order_relaxed);
+        const std::size_t got = queue.TryPopBatch(batch.items.begin(), share);
+        if (got > 0) {
+            batch.size = got;
+            batch.head = 1;
+            task = std::move(batch.items[0]);
+            buffered.fetch_sub(share - got + 1, std::memory_order_relaxed);
+            return true;
+        }
+        buffered.fetch_sub(share, std::memory_order_relaxed);
+    }
+    return queue.WaitPop(task);
+}
+
+void ThreadPool::CancelBatch(TaskBatch& batch) noexcept {
+    auto& buffered = LocalShard().buffered;
+    while (!batch.Empty()) {
+        TaskPtr task = std::move(batch.items[batch.head++]);
+        buffered.fetch_sub(1, std::memory_order_relaxed);
+        if (task) {
+            task->Cancel(std::make_exception_ptr(std::runtime_error("force stopped")));
+            RecordTaskCancel();
+        }
+    }
+    batch.head = batch.size = 0;
+}
+
 bool ThreadPool::Running() const noexcept {
     return state_.load(std::memory_order_acquire) == PoolState::RUNNING;
 }
@@ -445,17 +622,25 @@ bool ThreadPool::Paused() const noexcept {
 }
 
 std::size_t ThreadPool::Pending() const noexcept {
-    return queue_.Size();
+    std::size_t total = LocalPending() + SumShards(&CounterShard::buffered);
+    for (const auto& lane : lanes_) {
+        total += lane->queue.Size();
+    }
+    return total;
 }
 
 std::size_t ThreadPool::ActiveTasks() const noexcept {
-    return active_tasks_.load(std::memory_order_acquire);
+    return SumShards(&CounterShard::active);
 }
 
 PoolState ThreadPool::State() const noexcept {
     return state_.load(std::memory_order_acquire);
 }
 
+bool ThreadPool::InWorkerThread() const noexcept {
+    return t_worker.pool == this;
+}
+
 void ThreadPool::SetState(PoolState new_state) noexcept {
     state_.store(new_state, std::memory_order_release);
 }
@@ -468,18 +653,283 @@ void ThreadPool::SetQueueFullPolicy(QueueFullPolicy policy) noexcept {
     policy_.store(policy, std::memory_order_release);
 }
 
+SchedulerMode ThreadPool::Scheduler() const noexcept {
+    return scheduler_;
+}
+
+// Priority lanes
+TimerId ThreadPool::ScheduleTimer(std::chrono::steady_clock::time_point when, std::chrono::steady_clock::duration period,
+                                  TimerWheel::Callback cb) {
+    const auto s = State();
+    if (s == PoolState::SHUTTING_DOWN || s == PoolState::FORCE_STOPPING || s == PoolState::STOPPED) {
+        TP_LOG_DEBUG("Timer rejected: pool state={}", s);
+        return kInvalidTimer;
+    }
+    timers_->Start();
+    return timers_->Add(when, period, std::move(cb));
+}
+
+bool ThreadPool::CancelTimer(TimerId id) noexcept {
+    return timers_->Cancel(id);
+}
+
+std::size_t ThreadPool::PendingTimers() const noexcept {
+    return timers_->Size();
+}
+
+std::size_t ThreadPool::LaneCount() const noexcept {
+    return lanes_.size();
+}
+
+LaneId ThreadPool::FindLane(std::string_view name) const noexcept {
+    for (std::size_t i = 0; i < lanes_.size(); ++i) {
+        if (lanes_[i]->cfg.name == name) {
+            return i;
+        }
+    }
+    return kDefaultLane;
+}
+
+std::size_t ThreadPool::LanePending(LaneId lane) const noexcept {
+    return lane < lanes_.size() ? lanes_[lane]->queue.Size() : 0;
+}
+
+BlockingQueueAdapter<TaskPtr>& ThreadPool::LaneQueue(LaneId lane) noexcept {
+    return lanes_[lane < lanes_.size() ? lane : kDefaultLane]->queue;
+}
+
+bool ThreadPool::QueuesClosed() const noexcept {
+    // All lanes are closed together by Stop
+    return lanes_[kDefaultLane]->queue.Closed();
+}
+
+std::size_t ThreadPool::QueueCapacity() const noexcept {
+    std::size_t total = 0;
+    for (const auto& lane : lanes_) {
+        total += lane->queue.Capacity();
+    }
+    return total;
+}
+
+bool ThreadPool::PopFromLanes(WorkerSlot* slot, TaskPtr& task) {
+    if (slot->home_lane != kSharedWorker) {
+        return lanes_[slot->home_lane]->queue.TryPop(task);
+    }
+    if (lanes_.size() == 1) {
+        return lanes_[kDefaultLane]->queue.TryPop(task);
+    }
+    // Smooth weighted round-robin over the non-empty lanes: every non-empty lane earns its weight,
+    // the richest one is served and pays back the total, so shares follow the weights without bursts
+    auto& credit = slot->lane_credit;
+    for (std::size_t attempt = 0; attempt <= lanes_.size(); ++attempt) {
+        std::int64_t total = 0;
+        std::size_t best = kSharedWorker;
+        for (std::size_t i = 0; i < lanes_.size(); ++i) {
+            if (lanes_[i]->queue.Size() == 0) {
+                continue;
+            }
+            const auto weight = static_cast<std::int64_t>(lanes_[i]->cfg.weight);
+            credit[i] += weight;
+            total += weight;
+            if (best == kSharedWorker || credit[i] > credit[best]) {
+                best = i;
+            }
+        }
+        if (best == kSharedWorker) {
+            return false;
+        }
+        credit[best] -= total;
+        if (lanes_[best]->queue.TryPop(task)) {
+            return true;
+        }
+        // Another worker took the last task of that lane; re-evaluate
+    }
+    return false;
+}
+
+// Work-stealing scheduler
+bool ThreadPool::OnWorkerThread(LaneId lane) const noexcept {
+    return scheduler_ == SchedulerMode::WorkStealing && InWorkerThread() && t_worker.lane == lane;
+}
+
+void ThreadPool::PushLocal(TaskBase* task) {
+    deques_[t_worker.deque]->Push(task);
+    NotifyWork(1, kSharedWorker);  // only shared workers steal
+}
+
+void ThreadPool::NotifyWork(std::size_t count, LaneId lane) noexcept {
+    if (!parking_ || count == 0) {
+        return;
+    }
+    // Pairs with the fence in WaitNextTask: either the parking worker sees the new task,
+    // or this thread sees the sleeper and bumps the epoch
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lk(park_mtx_);
+        park_epoch_.fetch_add(1, std::memory_order_release);
+    }
+    // Any shared worker can take the tasks; among reserved workers only those of the target lane can.
+    // lane == kSharedWorker: the tasks sit on a worker deque, which reserved workers never steal from
+    auto wake = [count](std::condition_variable& cv) {
+        if (count > 1) {
+            cv.notify_all();
+        } else {
+            cv.notify_one();
+        }
+    };
+    wake(park_cv_);
+    if (lane != kSharedWorker) {
+        wake(lanes_[lane < lanes_.size() ? lane : kDefaultLane]->park_cv);
+    }
+}
+
+void ThreadPool::WakeAllWorkers() noexcept {
+    if (!parking_) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lk(park_mtx_);
+        park_epoch_.fetch_add(1, std::memory_order_release);
+    }
+    park_cv_.notify_all();
+    for (auto& lane : lanes_) {
+        lane->park_cv.notify_all();
+    }
+}
+
+bool ThreadPool::FindTask(WorkerSlot* slot, TaskPtr& task) {
+    TaskBase* raw = nullptr;
+    const bool work_stealing = !deques_.empty();
+    // 1. Own deque (LIFO, cache-warm)
+    if (work_stealing && deques_[slot->deque]->Pop(raw)) {
+        task.reset(raw);
+        return true;
+    }
+    // 2. Lane injection queues filled by external submitters
+    if (PopFromLanes(slot, task)) {
+        return true;
+    }
+    // Reserved workers do not steal: they must stay available for their own lane
+    if (!work_stealing || slot->home_lane != kSharedWorker) {
+        return false;
+    }
+    // 3. Steal from a random victim, then sweep the remaining deques.
+    //    Pinned across NUMA nodes, the first sweep stays on this worker's node and remote deques are only
+    //    robbed once the local node has run dry.
+    const std::size_t count = deques_.size();
+    const std::size_t start = NextVictim(count);
+    const std::size_t home = deque_node_[slot->deque].load(std::memory_order_relaxed);
+    for (int pass = multi_node_ ? 0 : 1; pass < 2; ++pass) {
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::size_t victim = (start + i) % count;
+            if (victim == slot->deque) {
+                continue;
+            }
+            if (multi_node_ && (deque_node_[victim].load(std::memory_order_relaxed) == home) != (pass == 0)) {
+                continue;
+            }
+            auto& dq = *deques_[victim];
+            // Steal fails spuriously when another thief wins the race; retry while the victim has work
+            while (!dq.Empty()) {
+                if (dq.Steal(raw)) {
+                    task.reset(raw);
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::WaitNextTask(WorkerSlot* slot, TaskPtr& task) {
+    for (;;) {
+        if (FindTask(slot, task)) {
+            return true;
+        }
+        // Announce intent to park, then re-check so a concurrent push cannot be missed
+        const auto ticket = park_epoch_.load(std::memory_order_acquire);
+        sleepers_.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (FindTask(slot, task)) {
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        const auto s = state_.load(std::memory_order_acquire);
+        if (QueuesClosed() || s == PoolState::FORCE_STOPPING || s == PoolState::PAUSED) {
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+            return false;
+        }
+        {
+            auto& cv = slot->home_lane == kSharedWorker ? park_cv_ : lanes_[slot->home_lane]->park_cv;
+            std::unique_lock<std::mutex> lk(park_mtx_);
+            cv.wait(lk, [this, ticket] {
+                return park_epoch_.load(std::memory_order_relaxed) != ticket;
+            });
+        }
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+std::size_t ThreadPool::LocalPending() const noexcept {
+    std::size_t total = 0;
+    for (const auto& dq : deques_) {
+        total += dq->Size();
+    }
+    return total;
+}
+
+void ThreadPool::CancelLocalTasks() {
+    for (auto& dq : deques_) {
+        TaskBase* raw = nullptr;
+        while (!dq->Empty()) {
+            if (!dq->Steal(raw)) {
+                continue;
+            }
+            TaskPtr task(raw);
+            task->Cancel(std::make_exception_ptr(std::runtime_error("force stopped")));
+            RecordTaskCancel();
+        }
+    }
+}
+
 void ThreadPool::SubmitOn() noexcept {
-    submit_ing_.fetch_add(1, std::memory_order_acq_rel);
+    LocalShard().submitting.fetch_add(1, std::memory_order_acq_rel);
 }
 
 void ThreadPool::SubmitOff() noexcept {
-    const auto prev = submit_ing_.fetch_sub(1, std::memory_order_acq_rel);
-    if (prev == 1) {
+    LocalShard().submitting.fetch_sub(1, std::memory_order_acq_rel);
+    // Only a graceful stop waits for in-flight submissions to drain
+    if (State() == PoolState::SHUTTING_DOWN) {
         std::lock_guard<std::mutex> lk(submit_mtx_);
         submit_cv_.notify_all();
     }
 }
 
+void ThreadPool::InitCounterShards() {
+    // About two shards per possible worker so producers rarely share a line with a worker
+    std::size_t count = 8;
+    while (count < 2 * max_threads_ && count < kMaxCounterShards) {
+        count <<= 1;
+    }
+    shards_ = std::make_unique<CounterShard[]>(count);
+    shard_mask_ = count - 1;
+}
+
+ThreadPool::CounterShard& ThreadPool::LocalShard() noexcept {
+    return shards_[t_thread_ordinal & shard_mask_];
+}
+
+std::size_t ThreadPool::SumShards(std::atomic<std::size_t> CounterShard::*counter) const noexcept {
+    std::size_t total = 0;
+    for (std::size_t i = 0; i <= shard_mask_; ++i) {
+        total += (shards_[i].*counter).load(std::memory_order_acquire);
+    }
+    return total;
+}
+
 std::size_t ThreadPool::DiscardedTasks() const noexcept {
     return discard_cnt_.load(std::memory_order_relaxed);
 }
@@ -534,13 +984,13 @@ void ThreadPool::LoadBalancerLoop() {
             continue;
         }
 
-        const std::size_t pending = queue_.Size();
+        const std::size_t pending = Pending();
         const std::size_t current = current_threads_.load(std::memory_order_acquire);
-        const std::size_t active = active_threads_.load(std::memory_order_acquire);
+        const std::size_t active = ActiveThreads();
         const double busy_ratio = current == 0 ? 0.0 : static_cast<double>(active) / current;
 
         busy_ratio_.store(busy_ratio, std::memory_order_release); // Update busy ratio
-        pending_ratio_.store(static_cast<double>(pending) / queue_.Capacity(), std::memory_order_relaxed); // Update queue utilization
+        pending_ratio_.store(static_cast<double>(pending) / QueueCapacity(), std::memory_order_relaxed); // Update queue utilization
 
         // Scale-up conditions: too many pending tasks / workers too busy
         const bool to_grow = pending >= pending_hi_ || busy_ratio >= scale_up_threshold_;
@@ -607,6 +1057,24 @@ void ThreadPool::CreateWorkerUnlocked() {
     auto slot = std::make_unique<WorkerSlot>();
     slot->last_active = std::chrono::steady_clock::now();
     WorkerSlot* raw = slot.get();
+    if (scheduler_ == SchedulerMode::WorkStealing) {
+        if (free_deques_.empty()) {
+            TP_LOG_WARN("Worker creation skipped: no free work-stealing deque (max_threads={})", max_threads_);
+            return;
+        }
+        slot->deque = free_deques_.back();
+        free_deques_.pop_back();
+    }
+    AssignCpuUnlocked(*slot);
+    // Fill lane reservations first; everyone else serves all lanes by weight
+    for (std::size_t i = 0; i < lanes_.size(); ++i) {
+        if (lanes_[i]->reserved < lanes_[i]->cfg.min_workers) {
+            slot->home_lane = i;
+            ++lanes_[i]->reserved;
+            break;
+        }
+    }
+    slot->lane_credit.assign(lanes_.size(), 0);
 
     slot->thread = std::thread([this, raw] {
         WorkerLoop(raw);
@@ -638,8 +1106,8 @@ std::vector<ThreadPool::WorkerSlot*> ThreadPool::ScheduleShrinkUnlocked(std::siz
         if (targets.size() >= count) {
             break;
         }
-        // Skip busy workers
-        if (!slot->idle.load(std::memory_order_acquire)) {
+        // Skip busy workers and lane reservations
+        if (!slot->idle.load(std::memory_order_acquire) || slot->home_lane != kSharedWorker) {
             continue;
         }
         bool expected = false;
@@ -661,9 +1129,10 @@ void ThreadPool::EnqueueExitSignals(const std::vector<WorkerSlot*>& targets) {
         }
         // Create a directed exit task
         TaskPtr exit_task = std::make_unique<ExitTask>(slot);
-        if (!queue_.WaitPush(std::move(exit_task))) {
+        if (!LaneQueue(kDefaultLane).WaitPush(std::move(exit_task))) {
             break;
         }
+        NotifyWork();
         TP_LOG_DEBUG("Exit signal enqueued for worker {}", static_cast<const void*>(slot));
     }
 }
@@ -683,6 +1152,7 @@ void ThreadPool::RetireWorkerUnlocked(WorkerSlot& slot) {
         target_worker = std::move(*it);
         // Erase worker from pool
         workers_.erase(it);
+        ReleaseCpuUnlocked(*target_worker);
     }
 
     // Wait for worker thread to finish
@@ -692,11 +1162,83 @@ void ThreadPool::RetireWorkerUnlocked(WorkerSlot& slot) {
             target_worker->thread.join();
         }
     }
+    if (target_worker && scheduler_ == SchedulerMode::WorkStealing) {
+        // The owner has exited; the next worker may take over this deque
+        std::lock_guard<std::mutex> guard(workers_mu_);
+        free_deques_.push_back(target_worker->deque);
+    }
     TP_LOG_DEBUG("Worker {} retired; current_threads={}",
                  static_cast<const void*>(&slot),
                  current_threads_.load(std::memory_order_acquire));
 }
 
+void ThreadPool::InitPlacement(const ThreadPoolConfig& cfg) {
+    if (cfg.affinity == AffinityMode::None) {
+        return;
+    }
+    const CpuTopology topology = CpuTopology::Detect();
+    placement_ = topology.Placement(cfg.affinity, cfg.cpus);
+    if (placement_.empty()) {
+        TP_LOG_WARN("ThreadPool affinity={} matches no allowed CPU; workers stay unpinned", cfg.affinity);
+        return;
+    }
+    placement_node_.reserve(placement_.size());
+    for (int cpu : placement_) {
+        placement_node_.push_back(topology.NodeOf(cpu));
+    }
+    placement_load_.assign(placement_.size(), 0);
+    multi_node_ = std::any_of(placement_node_.begin(), placement_node_.end(),
+                              [this](std::size_t node) { return node != placement_node_.front(); });
+    TP_LOG_INFO("ThreadPool affinity={}: {} cpu(s) on {} NUMA node(s) of {}",
+                cfg.affinity, placement_.size(),
+                std::set<std::size_t>(placement_node_.begin(), placement_node_.end()).size(),
+                topology.NodeCount());
+}
+
+void ThreadPool::ApplyCpuQuota(std::size_t reserved) {
+    const auto limit = CpuTopology::CgroupCpuLimit();
+    if (!limit.has_value()) {
+        TP_LOG_DEBUG("ThreadPool: no cgroup CPU quota; max_threads={}", max_threads_);
+        return;
+    }
+    // A fractional quota still gets a thread for the remainder; lane reservations keep their shared worker
+    std::size_t cap = std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(*limit)));
+    if (reserved > 0) {
+        cap = std::max(cap, reserved + 1);
+    }
+    if (max_threads_ <= cap) {
+        return;
+    }
+    TP_LOG_INFO("ThreadPool capped by cgroup CPU quota {:.2f}: max_threads {} -> {}, core_threads {} -> {}",
+                *limit, max_threads_, cap, core_threads_, std::min(core_threads_, cap));
+    max_threads_ = cap;
+    core_threads_ = std::min(core_threads_, cap);
+}
+
+void ThreadPool::AssignCpuUnlocked(WorkerSlot& slot) {
+    if (placement_.empty()) {
+        return;
+    }
+    std::size_t best = 0;
+    for (std::size_t i = 1; i < placement_load_.size(); ++i) {
+        if (placement_load_[i] < placement_load_[best]) {
+            best = i;
+        }
+    }
+    ++placement_load_[best];
+    slot.placement = best;
+    if (deque_node_) {
+        deque_node_[slot.deque].store(placement_node_[best], std::memory_order_relaxed);
+    }
+}
+
+void ThreadPool::ReleaseCpuUnlocked(const WorkerSlot& slot) noexcept {
+    // slot.placement stays as is: a worker that has not started yet still reads it
+    if (slot.placement != kUnpinned) {
+        --placement_load_[slot.placement];
+    }
+}
+
 void ThreadPool::TriggerLoadCheck() {
     balancer_kick_.store(true, std::memory_order_release);
     load_cv_.notify_one();
@@ -708,7 +1250,8 @@ std::size_t ThreadPool::CurrentThreads() const noexcept {
 }
 
 std::size_t ThreadPool::ActiveThreads() const noexcept {
-    return active_threads_.load(std::memory_order_acquire);
+    // A worker executes one task at a time, so busy workers equal executing tasks
+    return SumShards(&CounterShard::active);
 }
 
 ThreadPool::WorkerCounterHelper::WorkerCounterHelper(ThreadPool& pool, WorkerSlot& slot) noexcept
@@ -720,8 +1263,7 @@ ThreadPool::WorkerCounterHelper::WorkerCounterHelper(ThreadPool& pool, WorkerSlo
 void ThreadPool::WorkerCounterHelper::TaskOn() {
     slot_.idle.store(false, std::memory_order_release); // Mark thread busy
     slot_.idle_nums.store(0, std::memory_order_relaxed); // Reset idle counter
-    pool_.active_threads_.fetch_add(1, std::memory_order_acq_rel);
-    pool_.active_tasks_.fetch_add(1, std::memory_order_acq_rel);
+    pool_.LocalShard().active.fetch_add(1, std::memory_order_acq_rel);
     normal_end_.store(true, std::memory_order_release);
 }
 
@@ -730,8 +1272,7 @@ void ThreadPool::WorkerCounterHelper::TaskOff() noexcept {
         return;
     }
     normal_end_.store(false, std::memory_order_release);
-    pool_.active_tasks_.fetch_sub(1, std::memory_order_acq_rel);
-    pool_.active_threads_.fetch_sub(1, std::memory_order_acq_rel);
+    pool_.LocalShard().active.fetch_sub(1, std::memory_order_acq_rel);
     slot_.idle.store(true, std::memory_order_release);
     slot_.idle_nums.fetch_add(1, std::memory_order_relaxed);
 }
@@ -750,13 +1291,13 @@ ThreadPool::WorkerCounterHelper::~WorkerCounterHelper() noexcept {
 Statistics ThreadPool::GetStatistics() const noexcept {
     Statistics stats;
     // Overview
-    stats.statistic_total_submitted = total_submitted_.load(std::memory_order_relaxed);
-    stats.statistic_total_completed = total_completed_.load(std::memory_order_relaxed);
-    stats.statistic_total_failed = total_failed_.load(std::memory_order_relaxed);
+    stats.statistic_total_submitted = SumShards(&CounterShard::submitted);
+    stats.statistic_total_completed = SumShards(&CounterShard::completed);
+    stats.statistic_total_failed = SumShards(&CounterShard::failed);
     stats.statistic_total_cancelled = total_cancelled_.load(std::memory_order_relaxed);
     stats.statistic_total_rejected = total_rejected_.load(std::memory_order_relaxed);
     // Execution time
-    const auto exec_ns = total_exec_time_ns_.load(std::memory_order_acquire);
+    const auto exec_ns = SumShards(&CounterShard::exec_time_ns);
     stats.statistic_total_exec_time = std::chrono::nanoseconds(exec_ns);           
     stats.statistic_avg_exec_time = (stats.statistic_total_completed == 0) 
                                     ? std::chrono::nanoseconds{0} 
@@ -765,7 +1306,7 @@ Statistics ThreadPool::GetStatistics() const noexcept {
     const auto pending = Pending();
     stats.statistic_pending_tasks = pending;
     stats.statistic_busy_ratio = busy_ratio_.load(std::memory_order_relaxed);
-    const auto cap = queue_.Capacity();
+    const auto cap = QueueCapacity();
     stats.statistic_pending_ratio = cap == 0
         ? 0.0
         : static_cast<double>(pending) / static_cast<double>(cap);
@@ -785,14 +1326,15 @@ Statistics ThreadPool::GetStatistics() const noexcept {
 }
 
 void ThreadPool::ResetStatistics() noexcept {
-    total_submitted_.store(0, std::memory_order_relaxed); 
-    total_completed_.store(0, std::memory_order_relaxed); 
-    total_failed_.store(0, std::memory_order_relaxed); 
+    for (std::size_t i = 0; i <= shard_mask_; ++i) {
+        shards_[i].submitted.store(0, std::memory_order_relaxed);
+        shards_[i].completed.store(0, std::memory_order_relaxed);
+        shards_[i].failed.store(0, std::memory_order_relaxed);
+        shards_[i].exec_time_ns.store(0, std::memory_order_relaxed);
+    }
     total_cancelled_.store(0, std::memory_order_relaxed); 
     total_rejected_.store(0, std::memory_order_relaxed);
 
-    total_exec_time_ns_.store(0, std::memory_order_relaxed);
-
     busy_ratio_.store(0.0, std::memory_order_relaxed);
     pending_ratio_.store(0.0, std::memory_order_relaxed);
 
@@ -807,11 +1349,12 @@ void ThreadPool::ResetStatistics() noexcept {
 
 void ThreadPool::RecordTaskComplete(const TaskBase& task, std::chrono::steady_clock::duration duration) noexcept {
     const auto elapsed_ns = static_cast<std::size_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
-    total_exec_time_ns_.fetch_add(elapsed_ns, std::memory_order_relaxed);  // Accumulate total execution time
+    auto& shard = LocalShard();
+    shard.exec_time_ns.fetch_add(elapsed_ns, std::memory_order_relaxed);  // Accumulate total execution time
     if (task.Success()) {
-        total_completed_.fetch_add(1, std::memory_order_relaxed);  // Success count +1
+        shard.completed.fetch_add(1, std::memory_order_relaxed);  // Success count +1
     } else {
-        total_failed_.fetch_add(1, std::memory_order_relaxed);  // Failure count +1
+        shard.failed.fetch_add(1, std::memory_order_relaxed);  // Failure count +1
     }
 }
 
@@ -0,0 +1,338 @@
+#include "thread_pool/timer_wheel.hpp"
+#include "thread_pool/task_allocator.hpp"
+#include "logger.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <exception>
+
+namespace thread_pool {
+
+struct TimerWheel::Node {
+    static void* operator new(std::size_t size) {
+        return TaskAllocator::Allocate(size);
+    }
+    static void operator delete(void* ptr, std::size_t size) noexcept {
+        TaskAllocator::Deallocate(ptr, size);
+    }
+
+    Node*                     prev{nullptr};
+    Node*                     next{nullptr};
+    std::uint64_t             expiry{0};  // tick
+    std::uint64_t             period{0};  // ticks between runs, 0 for one-shot timers
+    std::uint32_t             handle{0};
+    std::uint8_t              level{0};
+    std::uint8_t              slot{0};
+    Callback                  cb;         // one-shot callback
+    std::shared_ptr<Callback> repeat;     // periodic callback, shared by the runs already dispatched
+};
+
+namespace {
+
+constexpr std::uint64_t kSlotMask = TimerWheel::kSlots - 1;
+constexpr std::uint64_t kNoWake = UINT64_MAX;
+
+constexpr std::uint64_t LevelSpan(std::size_t level) noexcept {
+    return std::uint64_t{1} << (TimerWheel::kSlotBits * level);
+}
+
+}  // namespace
+
+TimerWheel::TimerWheel(Clock::duration tick, Dispatch dispatch)
+    : origin_(Clock::now())
+    , tick_(std::max<Clock::duration>(tick, Clock::duration{1}))
+    , dispatch_(std::move(dispatch)) {}
+
+TimerWheel::~TimerWheel() {
+    Stop();
+}
+
+void TimerWheel::Start() {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    thread_ = std::thread([this] { Run(); });
+}
+
+void TimerWheel::Stop() {
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) {
+        thread_.join();
+    }
+    std::vector<Node*> dropped;
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        for (auto& handle : handles_) {
+            if (handle.node != nullptr) {
+                dropped.push_back(handle.node);
+            }
+        }
+        ClearUnlocked();
+    }
+    // Callback destructors run outside the lock (they may cancel other timers)
+    for (Node* node : dropped) {
+        delete node;
+    }
+}
+
+TimerId TimerWheel::Add(Clock::time_point when, Clock::duration period, Callback cb) {
+    if (!cb) {
+        return kInvalidTimer;
+    }
+    auto node = std::make_unique<Node>();
+    if (period > Clock::duration::zero()) {
+        node->period = std::max<std::uint64_t>(1, static_cast<std::uint64_t>((period + tick_ - Clock::duration{1}) / tick_));
+        node->repeat = std::make_shared<Callback>(std::move(cb));
+    } else {
+        node->cb = std::move(cb);
+    }
+
+    bool wake = false;
+    TimerId id = kInvalidTimer;
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        std::uint32_t index = 0;
+        if (!free_handles_.empty()) {
+            index = free_handles_.back();
+            free_handles_.pop_back();
+        } else {
+            index = static_cast<std::uint32_t>(handles_.size());
+            handles_.emplace_back();
+        }
+        Handle& handle = handles_[index];
+        Node* raw = node.release();
+        handle.node = raw;
+        raw->handle = index;
+        raw->expiry = std::max(TickAt(when), current_ + 1);
+        Link(raw);
+        ++size_;
+        wake = raw->expiry < wake_tick_;
+        id = (static_cast<TimerId>(handle.generation) << 32) | index;
+    }
+    if (wake) {
+        cv_.notify_one();
+    }
+    return id;
+}
+
+bool TimerWheel::Cancel(TimerId id) noexcept {
+    const auto index = static_cast<std::uint32_t>(id & 0xffffffffu);
+    const auto generation = static_cast<std::uint32_t>(id >> 32);
+    Node* node = nullptr;
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        if (index >= handles_.size() || handles_[index].generation != generation || handles_[index].node == nullptr) {
+            return false;
+        }
+        node = handles_[index].node;
+        Unlink(node);
+        Release(node);
+    }
+    delete node;
+    return true;
+}
+
+std::size_t TimerWheel::Size() const noexcept {
+    std::lock_guard<std::mutex> lk(mu_);
+    return size_;
+}
+
+std::size_t TimerWheel::Poll(Clock::time_point now) {
+    std::vector<Callback> due;
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        const std::uint64_t target = now <= origin_ ? 0 : static_cast<std::uint64_t>((now - origin_) / tick_);
+        while (current_ < target) {
+            // Nothing below the first occupied level can fire or needs cascading: jump to its next boundary
+            std::size_t lowest = 0;
+            while (lowest < kLevels && std::all_of(occupied_[lowest].begin(), occupied_[lowest].end(),
+                                                   [](std::uint64_t word) { return word == 0; })) {
+                ++lowest;
+            }
+            if (lowest == kLevels) {
+                current_ = target;
+                break;
+            }
+            current_ = std::min(target - 1, current_ | (LevelSpan(lowest) - 1));
+            ++current_;
+
+            // Higher levels first, so timers re-filed into a lower level are cascaded again on this tick
+            for (std::size_t level = kLevels - 1; level > 0; --level) {
+                if ((current_ & (LevelSpan(level) - 1)) == 0) {
+                    Cascade(level);
+                }
+            }
+
+            const std::size_t slot = current_ & kSlotMask;
+            Node* node = slots_[0][slot];
+            slots_[0][slot] = nullptr;
+            occupied_[0][slot / 64] &= ~(std::uint64_t{1} << (slot % 64));
+            while (node != nullptr) {
+                Node* next = node->next;
+                if (node->period > 0) {
+                    due.emplace_back([repeat = node->repeat]() { (*repeat)(); });
+                    node->expiry += node->period;
+                    Link(node);
+                } else {
+                    due.push_back(std::move(node->cb));
+                    Release(node);
+                    delete node;  // callback already moved out
+                }
+                node = next;
+            }
+        }
+    }
+    for (auto& cb : due) {
+        try {
+            dispatch_(std::move(cb));
+        } catch (const std::exception& ex) {
+            TP_LOG_WARN("TimerWheel dropped a due timer: dispatch failed: {}", ex.what());
+        } catch (...) {
+            TP_LOG_WARN("TimerWheel dropped a due timer: dispatch failed");
+        }
+    }
+    return due.size();
+}
+
+std::uint64_t TimerWheel::TickAt(Clock::time_point t) const noexcept {
+    if (t <= origin_) {
+        return 0;
+    }
+    return static_cast<std::uint64_t>((t - origin_ + tick_ - Clock::duration{1}) / tick_);
+}
+
+void TimerWheel::Link(Node* node) noexcept {
+    const std::uint64_t delta = node->expiry > current_ ? node->expiry - current_ : 0;
+    std::size_t level = 0;
+    while (level + 1 < kLevels && delta >= LevelSpan(level + 1)) {
+        ++level;
+    }
+    // Beyond the top level: park in the farthest top slot and re-file when it cascades
+    const std::uint64_t place = delta >= LevelSpan(kLevels) ? current_ + LevelSpan(kLevels) - 1 : node->expiry;
+    const std::size_t slot = (place >> (kSlotBits * level)) & kSlotMask;
+    node->level = static_cast<std::uint8_t>(level);
+    node->slot = static_cast<std::uint8_t>(slot);
+    node->prev = nullptr;
+    node->next = slots_[level][slot];
+    if (node->next != nullptr) {
+        node->next->prev = node;
+    }
+    slots_[level][slot] = node;
+    occupied_[level][slot / 64] |= std::uint64_t{1} << (slot % 64);
+}
+
+void TimerWheel::Unlink(Node* node) noexcept {
+    if (node->prev != nullptr) {
+        node->prev->next = node->next;
+    } else {
+        slots_[node->level][node->slot] = node->next;
+    }
+    if (node->next != nullptr) {
+        node->next->prev = node->prev;
+    }
+    if (slots_[node->level][node->slot] == nullptr) {
+        occupied_[node->level][node->slot / 64] &= ~(std::uint64_t{1} << (node->slot % 64));
+    }
+    node->prev = node->next = nullptr;
+}
+
+void TimerWheel::Cascade(std::size_t level) noexcept {
+    const std::size_t slot = (current_ >> (kSlotBits * level)) & kSlotMask;
+    Node* node = slots_[level][slot];
+    slots_[level][slot] = nullptr;
+    occupied_[level][slot / 64] &= ~(std::uint64_t{1} << (slot % 64));
+    while (node != nullptr) {
+        Node* next = node->next;
+        Link(node);
+        node = next;
+    }
+}
+
+void TimerWheel::Release(Node* node) noexcept {
+    Handle& handle = handles_[node->handle];
+    handle.node = nullptr;
+    if (++handle.generation == 0) {
+        handle.generation = 1;  // 0 would make the next id equal kInvalidTimer
+    }
+    free_handles_.push_back(node->handle);
+    --size_;
+}
+
+void TimerWheel::ClearUnlocked() noexcept {
+    for (std::uint32_t i = 0; i < handles_.size(); ++i) {
+        Handle& handle = handles_[i];
+        if (handle.node != nullptr) {
+            handle.node = nullptr;
+            if (++handle.generation == 0) {
+                handle.generation = 1;
+            }
+            free_handles_.push_back(i);
+        }
+    }
+    for (auto& level : slots_) {
+        level.fill(nullptr);
+    }
+    for (auto& level : occupied_) {
+        level.fill(0);
+    }
+    size_ = 0;
+}
+
+std::uint64_t TimerWheel::NextWakeTickUnlocked() const noexcept {
+    if (size_ == 0) {
+        return kNoWake;
+    }
+    auto occupied = [this](std::size_t level, std::uint64_t slot) {
+        return (occupied_[level][slot / 64] >> (slot % 64)) & 1u;
+    };
+    // Next occupied level-0 slot before the cascade point
+    const std::uint64_t boundary = (current_ | kSlotMask) + 1;
+    for (std::uint64_t t = current_ + 1; t < boundary; ++t) {
+        if (occupied(0, t & kSlotMask)) {
+            return t;
+        }
+    }
+    // Level-0 timers left are due right after the boundary
+    for (std::uint64_t word : occupied_[0]) {
+        if (word != 0) {
+            return boundary;
+        }
+    }
+    // Otherwise wake at the next occupied level-1 slot, or where level 2+ must cascade
+    for (std::uint64_t b = boundary;; b += TimerWheel::kSlots) {
+        if ((b & (LevelSpan(2) - 1)) == 0 || occupied(1, (b >> kSlotBits) & kSlotMask)) {
+            return b;
+        }
+    }
+}
+
+void TimerWheel::Run() {
+    std::unique_lock<std::mutex> lk(mu_);
+    while (running_) {
+        const std::uint64_t next = NextWakeTickUnlocked();
+        if (next == kNoWake) {
+            wake_tick_ = next;
+            cv_.wait(lk);
+            continue;
+        }
+        const auto deadline = origin_ + tick_ * static_cast<Clock::rep>(next);
+        if (Clock::now() < deadline) {
+            wake_tick_ = next;
+            cv_.wait_until(lk, deadline);
+            continue;
+        }
+        wake_tick_ = 0;  // polling now; Add need not wake us
+        lk.unlock();
+        Poll(Clock::now());
+        lk.lock();
+    }
+    wake_tick_ = kNoWake;
+}
+
+}
@@ -64,6 +64,19 @@ TEST_F(ConfigLoaderTest, LoadsLoggingConfig) {
     EXPECT_EQ(cfg.thread_pool.config_path, "custom/thread_pool.json");
 }
 
+TEST_F(ConfigLoaderTest, LoadsRpcMode) {
+    auto default_cfg = meeting::common::ConfigLoader::Load(WriteTempConfig(R"({"server": {"port": 50052}})").string());
+    EXPECT_EQ(default_cfg.server.rpc_mode, "sync");
+
+    auto callback_cfg = meeting::common::ConfigLoader::Load(
+        WriteTempConfig(R"({"server": {"rpc_mode": "callback"}})").string());
+    EXPECT_EQ(callback_cfg.server.rpc_mode, "callback");
+
+    EXPECT_THROW(meeting::common::ConfigLoader::Load(
+                     WriteTempConfig(R"({"server": {"rpc_mode": "completion_queue"}})").string()),
+                 std::runtime_error);
+}
+
 class LoggerInitTest : public ::testing::Test {
 protected:
     void TearDown() override {
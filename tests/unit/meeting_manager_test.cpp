@@ -1,7 +1,19 @@
+#include "core/meeting/meeting_mailbox.hpp"
 #include "core/meeting/meeting_manager.hpp"
+#include "core/meeting/meeting_repository.hpp"
+#include "thread_pool/thread_pool.hpp"
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
 using namespace meeting::core;
 using namespace meeting::common;
 
@@ -105,3 +117,334 @@ TEST_F(MeetingManagerTest, JoinFailsWhenMeetingEnded) {
     EXPECT_FALSE(join_result.IsOk());
     EXPECT_EQ(join_result.GetStatus().Code(), StatusCode::kInvalidArgument);
 }
+
+TEST(MeetingManagerConcurrencyTest, ConcurrentJoinsRespectLimit) {
+    MeetingConfig config;
+    config.max_participants = 5;
+    MeetingManager manager(config);
+    auto created = manager.CreateMeeting(CreateMeetingCommand{1, "Limit"});
+    ASSERT_TRUE(created.IsOk());
+    const std::string meeting_id = created.Value().meeting_id;
+
+    // 校验与加入在存储库中一次原子完成, 并发加入不会超过上限
+    std::atomic<int> joined{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 8; ++t) {
+        workers.emplace_back([&, t]() {
+            if (manager.JoinMeeting(JoinMeetingCommand{meeting_id, static_cast<std::uint64_t>(100 + t)}).IsOk()) {
+                joined.fetch_add(1);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    EXPECT_EQ(joined.load(), 4);
+    EXPECT_EQ(manager.GetMeeting(meeting_id).Value().participants.size(), 5u);
+    EXPECT_EQ(manager.GetLoad().participants, 5u);
+
+    EXPECT_TRUE(manager.LeaveMeeting(LeaveMeetingCommand{meeting_id, 1}).IsOk());
+    EXPECT_EQ(manager.GetMeeting(meeting_id).Value().state, MeetingState::kEnded);
+    EXPECT_EQ(manager.GetLoad().active_meetings, 0u);
+    EXPECT_EQ(manager.GetLoad().participants, 0u);
+}
+
+TEST(InMemoryMeetingRepositoryTest, ShardedConcurrentJoinsAndLeaves) {
+    EXPECT_EQ(InMemoryMeetingRepository(0).ShardCount(), 1u);
+    EXPECT_EQ(InMemoryMeetingRepository(5).ShardCount(), 8u);
+
+    InMemoryMeetingRepository repository(8);
+    constexpr int kMeetings = 32;
+    constexpr int kThreads = 8;
+    constexpr int kPerThread = 50;
+    for (int m = 0; m < kMeetings; ++m) {
+        MeetingData data;
+        data.meeting_id = "meeting-" + std::to_string(m);
+        data.state = MeetingState::kScheduled;
+        ASSERT_TRUE(repository.CreateMeeting(data).IsOk());
+    }
+    EXPECT_EQ(repository.CreateMeeting(repository.GetMeeting("meeting-0").Value()).GetStatus().Code(),
+              StatusCode::kAlreadyExists);
+
+    // 每个线程向所有会议加入参与者并移除其中一半, 跨分片并发写不应丢失更新
+    std::vector<std::thread> workers;
+    for (int t = 0; t < kThreads; ++t) {
+        workers.emplace_back([&repository, t]() {
+            for (int i = 0; i < kPerThread; ++i) {
+                const std::uint64_t participant = static_cast<std::uint64_t>(t * kPerThread + i + 1);
+                for (int m = 0; m < kMeetings; ++m) {
+                    const std::string id = "meeting-" + std::to_string(m);
+                    EXPECT_TRUE(repository.AddParticipant(id, participant, false, meeting::core::kNextRevision).IsOk());
+                    if (i % 2 == 1) {
+                        EXPECT_TRUE(repository.RemoveParticipant(id, participant, meeting::core::kNextRevision).IsOk());
+                    }
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (int m = 0; m < kMeetings; ++m) {
+        auto participants = repository.ListParticipants("meeting-" + std::to_string(m));
+        ASSERT_TRUE(participants.IsOk());
+        EXPECT_EQ(participants.Value().size(), static_cast<std::size_t>(kThreads * kPerThread / 2));
+    }
+    EXPECT_EQ(repository.GetMeeting("missing").GetStatus().Code(), StatusCode::kNotFound);
+}
+
+TEST(MeetingManagerMailboxTest, SerializedJoinsRespectLimitAndFlushToRepository) {
+    thread_pool::ThreadPool pool(2);
+    pool.Start();
+    auto repository = std::make_shared<InMemoryMeetingRepository>();
+    MeetingConfig config;
+    config.max_participants = 10;
+    config.serialize_per_meeting = true;
+    config.mailbox_count = 4;
+    MeetingManager manager(config, repository, &pool);
+
+    auto created = manager.CreateMeeting(CreateMeetingCommand{1, "Mailbox"});
+    ASSERT_TRUE(created.IsOk());
+    const std::string meeting_id = created.Value().meeting_id;
+
+    // 并发加入同一会议: 检查与修改在邮箱中串行执行, 人数不会超过上限
+    constexpr int kThreads = 8;
+    constexpr int kPerThread = 4;
+    std::atomic<int> joined{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < kThreads; ++t) {
+        workers.emplace_back([&, t]() {
+            for (int i = 0; i < kPerThread; ++i) {
+                const std::uint64_t participant = static_cast<std::uint64_t>(100 + t * kPerThread + i);
+                auto result = manager.JoinMeeting(JoinMeetingCommand{meeting_id, participant});
+                if (result.IsOk()) {
+                    joined.fetch_add(1);
+                } else {
+                    EXPECT_EQ(result.GetStatus().Code(), StatusCode::kUnavailable);
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    EXPECT_EQ(joined.load(), 9);
+
+    auto meeting = manager.GetMeeting(meeting_id);
+    ASSERT_TRUE(meeting.IsOk());
+    EXPECT_EQ(meeting.Value().participants.size(), 10u);
+    EXPECT_EQ(meeting.Value().state, MeetingState::kRunning);
+
+    // 变更落库后存储库与内存状态一致
+    EXPECT_TRUE(manager.Flush().IsOk());
+    EXPECT_EQ(repository->ListParticipants(meeting_id).Value().size(), 10u);
+    EXPECT_EQ(repository->GetMeeting(meeting_id).Value().state, MeetingState::kRunning);
+
+    // 组织者离开结束会议, 已结束的会议从邮箱中移出后仍可从存储库读到
+    EXPECT_TRUE(manager.LeaveMeeting(LeaveMeetingCommand{meeting_id, 1}).IsOk());
+    EXPECT_TRUE(manager.Flush().IsOk());
+    EXPECT_EQ(repository->GetMeeting(meeting_id).Value().state, MeetingState::kEnded);
+    auto ended = manager.GetMeeting(meeting_id);
+    ASSERT_TRUE(ended.IsOk());
+    EXPECT_EQ(ended.Value().state, MeetingState::kEnded);
+    EXPECT_EQ(manager.JoinMeeting(JoinMeetingCommand{meeting_id, 999}).GetStatus().Code(), StatusCode::kInvalidArgument);
+    EXPECT_EQ(manager.GetMeeting("missing").GetStatus().Code(), StatusCode::kNotFound);
+}
+
+TEST(MeetingManagerMailboxTest, FlushedRevisionMatchesManager) {
+    thread_pool::ThreadPool pool(1);
+    pool.Start();
+    auto repository = std::make_shared<InMemoryMeetingRepository>();
+    MeetingConfig config;
+    config.serialize_per_meeting = true;
+    config.mailbox_count = 1;
+    MeetingManager manager(config, repository, &pool);
+
+    auto created = manager.CreateMeeting(CreateMeetingCommand{1, "Revision"});
+    ASSERT_TRUE(created.IsOk());
+    const std::string meeting_id = created.Value().meeting_id;
+
+    // 加入使会议进入进行中 (参与者与状态两条写入), 落库后版本号仍只前进 1
+    ASSERT_TRUE(manager.JoinMeeting(JoinMeetingCommand{meeting_id, 2001}).IsOk());
+    ASSERT_TRUE(manager.JoinMeeting(JoinMeetingCommand{meeting_id, 2002}).IsOk());
+    ASSERT_TRUE(manager.LeaveMeeting(LeaveMeetingCommand{meeting_id, 2001}).IsOk());
+    EXPECT_TRUE(manager.Flush().IsOk());
+    EXPECT_EQ(manager.GetMeeting(meeting_id).Value().revision, 4u);
+    EXPECT_EQ(repository->GetMeeting(meeting_id).Value().revision, 4u);
+
+    // 批内先加入后离开的写入被合并省去时, 版本号同样落库
+    for (std::uint64_t participant = 3000; participant < 3020; ++participant) {
+        ASSERT_TRUE(manager.JoinMeeting(JoinMeetingCommand{meeting_id, participant}).IsOk());
+        ASSERT_TRUE(manager.LeaveMeeting(LeaveMeetingCommand{meeting_id, participant}).IsOk());
+    }
+    EXPECT_TRUE(manager.Flush().IsOk());
+    EXPECT_EQ(manager.GetMeeting(meeting_id).Value().revision, 44u);
+    EXPECT_EQ(repository->GetMeeting(meeting_id).Value().revision, 44u);
+    EXPECT_EQ(repository->ListParticipants(meeting_id).Value().size(), 2u);
+
+    ASSERT_TRUE(manager.EndMeeting(EndMeetingCommand{meeting_id, 1}).IsOk());
+    EXPECT_TRUE(manager.Flush().IsOk());
+    EXPECT_EQ(repository->GetMeeting(meeting_id).Value().revision, 45u);
+    EXPECT_EQ(repository->GetMeeting(meeting_id).Value().state, MeetingState::kEnded);
+}
+
+namespace {
+
+// 按需让参与者写入失败的存储库, 模拟落库时数据库不可用
+class FailingParticipantRepository : public InMemoryMeetingRepository {
+public:
+    Status AddParticipant(const std::string& meeting_id, std::uint64_t participant_id, bool is_organizer,
+                          std::uint64_t revision) override {
+        if (fail_writes) {
+            return Status::Unavailable("injected write failure");
+        }
+        return InMemoryMeetingRepository::AddParticipant(meeting_id, participant_id, is_organizer, revision);
+    }
+
+    bool fail_writes = false;
+};
+
+}  // namespace
+
+TEST(MeetingManagerMailboxTest, FailedWriteSurfacesAndReloadsMeeting) {
+    auto repository = std::make_shared<FailingParticipantRepository>();
+    MeetingConfig config;
+    config.serialize_per_meeting = true;
+    config.mailbox_count = 1;
+    MeetingManager manager(config, repository);
+
+    auto created = manager.CreateMeeting(CreateMeetingCommand{1, "Write failure"});
+    ASSERT_TRUE(created.IsOk());
+    const std::string meeting_id = created.Value().meeting_id;
+
+    // 命令先于落库返回成功, 落库失败由 Flush 报告
+    repository->fail_writes = true;
+    ASSERT_TRUE(manager.JoinMeeting(JoinMeetingCommand{meeting_id, 2001}).IsOk());
+    EXPECT_EQ(manager.Flush().Code(), StatusCode::kUnavailable);
+    EXPECT_TRUE(manager.Flush().IsOk());
+
+    // 失败的会议已移出内存, 再次访问时以存储库为准
+    repository->fail_writes = false;
+    auto reloaded = manager.GetMeeting(meeting_id);
+    ASSERT_TRUE(reloaded.IsOk());
+    ASSERT_EQ(reloaded.Value().participants.size(), 1u);
+    EXPECT_EQ(reloaded.Value().participants[0], 1u);
+
+    ASSERT_TRUE(manager.JoinMeeting(JoinMeetingCommand{meeting_id, 2001}).IsOk());
+    EXPECT_TRUE(manager.Flush().IsOk());
+    EXPECT_EQ(repository->ListParticipants(meeting_id).Value().size(), 2u);
+}
+
+TEST(MeetingMailboxesTest, EvictsIdleMeetingsWithoutPendingWrites) {
+    auto repository = std::make_shared<InMemoryMeetingRepository>();
+    MeetingMailboxes mailboxes(1, repository, nullptr, std::chrono::milliseconds(20));
+
+    std::vector<std::string> meeting_ids;
+    for (std::uint64_t organizer = 1; organizer <= 3; ++organizer) {
+        MeetingData data;
+        data.meeting_id = "idle_" + std::to_string(organizer);
+        data.organizer_id = organizer;
+        auto created = repository->CreateMeeting(data);
+        ASSERT_TRUE(created.IsOk());
+        meeting_ids.push_back(created.Value().meeting_id);
+        mailboxes.Execute(meeting_ids.back(), [&created](MeetingMailboxContext& context) {
+            context.Adopt(created.Value());
+        });
+    }
+    EXPECT_EQ(mailboxes.Execute(meeting_ids[0], [](MeetingMailboxContext& context) { return context.CachedMeetings(); }),
+              3u);
+
+    // 空闲超时后, 下一条命令只留下它访问的会议
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto cached = mailboxes.Execute(meeting_ids[1], [&](MeetingMailboxContext& context) {
+        EXPECT_TRUE(context.Load(meeting_ids[1]).IsOk());
+        return context.CachedMeetings();
+    });
+    EXPECT_EQ(cached, 1u);
+
+    // 移出的会议再次访问时从存储库加载
+    auto reloaded = mailboxes.Execute(meeting_ids[2], [&](MeetingMailboxContext& context) {
+        auto meeting = context.Load(meeting_ids[2]);
+        return meeting.IsOk() ? meeting.Value()->data.organizer_id : 0;
+    });
+    EXPECT_EQ(reloaded, 3u);
+}
+
+TEST(ParticipantSetTest, MatchesReferenceSetAcrossIndexThreshold) {
+    // 随机加入/离开, 人数在建索引阈值上下反复穿越, 结果须与 std::set 一致
+    ParticipantSet participants;
+    std::set<std::uint64_t> expected;
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<std::uint64_t> pick(1, 4 * ParticipantSet::kLinearLimit);
+    for (int i = 0; i < 20000; ++i) {
+        const std::uint64_t id = pick(rng);
+        if (rng() % 2 == 0) {
+            EXPECT_EQ(participants.Insert(id), expected.insert(id).second);
+        } else {
+            EXPECT_EQ(participants.Erase(id), expected.erase(id) == 1);
+        }
+        ASSERT_EQ(participants.size(), expected.size());
+        EXPECT_EQ(participants.Contains(id), expected.count(id) == 1);
+    }
+    std::vector<std::uint64_t> ids(participants.begin(), participants.end());
+    std::sort(ids.begin(), ids.end());
+    EXPECT_TRUE(std::equal(ids.begin(), ids.end(), expected.begin(), expected.end()));
+
+    ParticipantSet copied(std::vector<std::uint64_t>{7, 3, 7, 5});
+    EXPECT_EQ(copied.size(), 3u);
+    EXPECT_EQ(copied[0], 7u);
+    EXPECT_TRUE(copied.Contains(5));
+}
+
+TEST(MeetingManagerDeltaTest, ReturnsParticipantChangesSinceRevision) {
+    for (bool serialize : {false, true}) {
+        MeetingConfig config;
+        config.serialize_per_meeting = serialize;
+        MeetingManager manager(config);
+        auto created = manager.CreateMeeting(CreateMeetingCommand{1001, "Webinar"});
+        ASSERT_TRUE(created.IsOk());
+        const std::string meeting_id = created.Value().meeting_id;
+        EXPECT_EQ(created.Value().revision, 1u);
+
+        ASSERT_TRUE(manager.JoinMeeting(JoinMeetingCommand{meeting_id, 2001}).IsOk());  // 版本 2
+        ASSERT_TRUE(manager.JoinMeeting(JoinMeetingCommand{meeting_id, 2002}).IsOk());  // 版本 3
+        ASSERT_TRUE(manager.LeaveMeeting(LeaveMeetingCommand{meeting_id, 2001}).IsOk()); // 版本 4
+
+        auto since_two = manager.GetMeetingSince(meeting_id, 2);
+        ASSERT_TRUE(since_two.IsOk());
+        EXPECT_TRUE(since_two.Value().incremental);
+        EXPECT_EQ(since_two.Value().meeting.revision, 4u);
+        EXPECT_TRUE(since_two.Value().meeting.participants.empty());
+        EXPECT_EQ(since_two.Value().added, std::vector<std::uint64_t>{2002});
+        EXPECT_EQ(since_two.Value().removed, std::vector<std::uint64_t>{2001});
+
+        // 先加入后离开的参与者不出现在增量中
+        auto since_created = manager.GetMeetingSince(meeting_id, 1);
+        ASSERT_TRUE(since_created.IsOk());
+        EXPECT_TRUE(since_created.Value().incremental);
+        EXPECT_EQ(since_created.Value().added, std::vector<std::uint64_t>{2002});
+        EXPECT_TRUE(since_created.Value().removed.empty());
+
+        auto unchanged = manager.GetMeetingSince(meeting_id, 4);
+        ASSERT_TRUE(unchanged.IsOk());
+        EXPECT_TRUE(unchanged.Value().incremental);
+        EXPECT_TRUE(unchanged.Value().added.empty() && unchanged.Value().removed.empty());
+
+        for (std::uint64_t since : {std::uint64_t{0}, std::uint64_t{99}}) {
+            auto full = manager.GetMeetingSince(meeting_id, since);
+            ASSERT_TRUE(full.IsOk());
+            EXPECT_FALSE(full.Value().incremental);
+            EXPECT_EQ(full.Value().meeting.participants.size(), 2u);
+        }
+    }
+
+    // 变更记录超出上限后, 早于保留窗口的版本不再能给出增量
+    ParticipantLog log;
+    const std::uint64_t last = ParticipantLog::kMaxChanges + 10;
+    for (std::uint64_t revision = 2; revision <= last; ++revision) {
+        log.Record(revision, revision, true);
+    }
+    EXPECT_EQ(log.size(), ParticipantLog::kMaxChanges);
+    EXPECT_FALSE(log.Covers(1));
+    EXPECT_TRUE(log.Covers(last - ParticipantLog::kMaxChanges));
+}
@@ -1,9 +1,16 @@
+#include "server/meeting_callback_service.hpp"
 #include "server/meeting_service_impl.hpp"
+#include "server/user_callback_service.hpp"
 #include "server/user_service_impl.hpp"
 #include "meeting_service.grpc.pb.h"
+#include "user_service.grpc.pb.h"
 #include "test_mysql_utils.hpp"
 
 #include <gtest/gtest.h>
+#include <grpcpp/grpcpp.h>
+
+#include <chrono>
+#include <string>
 
 using namespace meeting::server;
 
@@ -102,3 +109,74 @@ TEST_F(MeetingServiceTest, JoinLeaveAndEndFlow) {
     ASSERT_TRUE(get_status.ok());
     EXPECT_EQ(get_response.meeting().state(), "ENDED");
 }
+
+// 回调模式端到端: gRPC 线程经 DispatchToPool 投递请求, 工作线程执行业务并 Finish
+TEST(MeetingCallbackServiceTest, EndToEndThroughPoolAndRejection) {
+    testutils::ClearMysqlTestData();
+    thread_pool::ThreadPoolConfig pool_config;
+    pool_config.core_threads = 2;
+    pool_config.max_threads = 2;
+    thread_pool::ThreadPool pool(pool_config);
+    pool.Start();
+
+    UserServiceImpl user_service(pool);
+    MeetingServiceImpl meeting_service(pool);
+    UserCallbackService user_callback(user_service);
+    MeetingCallbackService meeting_callback(meeting_service);
+
+    int port = 0;
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort("127.0.0.1:0", grpc::InsecureServerCredentials(), &port);
+    builder.RegisterService(&user_callback);
+    builder.RegisterService(&meeting_callback);
+    auto server = builder.BuildAndStart();
+    ASSERT_TRUE(server);
+    auto channel = grpc::CreateChannel("127.0.0.1:" + std::to_string(port), grpc::InsecureChannelCredentials());
+    auto user_stub = proto::user::UserService::NewStub(channel);
+    auto meeting_stub = proto::meeting::MeetingService::NewStub(channel);
+
+    proto::user::RegisterRequest reg;
+    reg.set_user_name("callback_user");
+    reg.set_password("password123");
+    reg.set_email("callback@example.com");
+    proto::user::RegisterResponse reg_resp;
+    grpc::ClientContext reg_ctx;
+    ASSERT_TRUE(user_stub->Register(&reg_ctx, reg, &reg_resp).ok());
+    ASSERT_EQ(reg_resp.error().code(), 0) << reg_resp.error().message();
+
+    proto::user::LoginRequest login;
+    login.set_user_name("callback_user");
+    login.set_password("password123");
+    proto::user::LoginResponse login_resp;
+    grpc::ClientContext login_ctx;
+    ASSERT_TRUE(user_stub->Login(&login_ctx, login, &login_resp).ok());
+    ASSERT_EQ(login_resp.error().code(), 0) << login_resp.error().message();
+
+    proto::meeting::CreateMeetingRequest create;
+    create.set_session_token(login_resp.session_token());
+    create.set_topic("Callback Standup");
+    proto::meeting::CreateMeetingResponse create_resp;
+    grpc::ClientContext create_ctx;
+    auto create_status = meeting_stub->CreateMeeting(&create_ctx, create, &create_resp);
+    ASSERT_TRUE(create_status.ok()) << create_status.error_message();
+    ASSERT_EQ(create_resp.error().code(), 0) << create_resp.error().message();
+
+    proto::meeting::GetMeetingRequest get;
+    get.set_meeting_id(create_resp.meeting().meeting_id());
+    proto::meeting::GetMeetingResponse get_resp;
+    grpc::ClientContext get_ctx;
+    ASSERT_TRUE(meeting_stub->GetMeeting(&get_ctx, get, &get_resp).ok());
+    EXPECT_EQ(get_resp.meeting().topic(), "Callback Standup");
+    // 四个请求都由线程池执行
+    EXPECT_GE(pool.GetStatistics().statistic_total_completed, 4u);
+
+    // 线程池停止后请求无法调度, RPC 必须以 UNAVAILABLE 结束而不是悬挂
+    pool.Stop();
+    proto::meeting::GetMeetingResponse rejected_resp;
+    grpc::ClientContext rejected_ctx;
+    rejected_ctx.set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(10));
+    auto rejected = meeting_stub->GetMeeting(&rejected_ctx, get, &rejected_resp);
+    EXPECT_EQ(rejected.error_code(), grpc::StatusCode::UNAVAILABLE) << rejected.error_message();
+
+    server->Shutdown();
+}
@@ -86,7 +86,7 @@ meeting::core::MeetingData MakeMeeting(std::uint64_t organizer_id, const std::st
     data.state = meeting::core::MeetingState::kScheduled;
     data.created_at = 0;
     data.updated_at = 0;
-    data.participants.push_back(organizer_id);
+    data.participants.Insert(organizer_id);
     return data;
 }
 
@@ -117,14 +117,53 @@ TEST_F(MysqlMeetingRepositoryTest, AddAndRemoveParticipant) {
     auto created = repo_->CreateMeeting(data);
     ASSERT_TRUE(created.IsOk());
 
-    auto add_status = repo_->AddParticipant(data.meeting_id, participant, false);
+    auto add_status = repo_->AddParticipant(data.meeting_id, participant, false, meeting::core::kNextRevision);
     ASSERT_TRUE(add_status.IsOk());
     auto list = repo_->ListParticipants(data.meeting_id);
     ASSERT_TRUE(list.IsOk());
     EXPECT_GE(list.Value().size(), 1u);
 
-    auto rm = repo_->RemoveParticipant(data.meeting_id, participant);
+    auto rm = repo_->RemoveParticipant(data.meeting_id, participant, meeting::core::kNextRevision);
     ASSERT_TRUE(rm.IsOk());
 }
 
+TEST_F(MysqlMeetingRepositoryTest, JoinAndLeaveInOneTransaction) {
+    if (!repo_) {
+        GTEST_SKIP();
+    }
+    auto organizer = InsertUser(*pool_, "org3");
+    auto participant = InsertUser(*pool_, "userB");
+    ASSERT_NE(organizer, 0u);
+    ASSERT_NE(participant, 0u);
+    auto data = MakeMeeting(organizer, "org3");
+    ASSERT_TRUE(repo_->CreateMeeting(data).IsOk());
+
+    meeting::core::JoinRequest join;
+    join.meeting_id = data.meeting_id;
+    join.participant_id = participant;
+    join.max_participants = 2;
+    join.updated_at = 1700000000;
+    auto joined = repo_->JoinAndLoad(join);
+    ASSERT_TRUE(joined.IsOk()) << joined.GetStatus().Message();
+    EXPECT_EQ(joined.Value().participants.size(), 2u);
+    EXPECT_EQ(joined.Value().state, meeting::core::MeetingState::kRunning);
+    EXPECT_EQ(repo_->GetMeeting(data.meeting_id).Value().state, meeting::core::MeetingState::kRunning);
+    EXPECT_EQ(joined.Value().revision, 2u);
+    EXPECT_EQ(repo_->GetMeeting(data.meeting_id).Value().revision, 2u);
+    EXPECT_EQ(repo_->JoinAndLoad(join).GetStatus().Code(), meeting::common::StatusCode::kAlreadyExists);
+
+    meeting::core::LeaveRequest leave;
+    leave.meeting_id = data.meeting_id;
+    leave.participant_id = organizer;
+    leave.updated_at = 1700000001;
+    auto left = repo_->LeaveAndLoad(leave);
+    ASSERT_TRUE(left.IsOk()) << left.GetStatus().Message();
+    EXPECT_TRUE(left.Value().ended);
+    auto fetched = repo_->GetMeeting(data.meeting_id);
+    ASSERT_TRUE(fetched.IsOk());
+    EXPECT_EQ(fetched.Value().state, meeting::core::MeetingState::kEnded);
+    EXPECT_EQ(fetched.Value().participants.size(), 1u);
+    EXPECT_EQ(fetched.Value().revision, 3u);
+}
+
 }
@@ -1,7 +1,20 @@
 #include "geo/geo_location_service.hpp"
+#include "geo/mmdb_decoder.hpp"
+#include "geo/string_table.hpp"
+#include "thread_pool/thread_pool.hpp"
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
 using meeting::geo::GeoLocationService;
 
 TEST(GeoLocationServiceTest, InvalidIp) {
@@ -55,3 +68,337 @@ TEST(GeoLocationServiceTest, LookupWithRealDbIfExists) {
     EXPECT_EQ(info.iso_code, "US");
     EXPECT_FALSE(info.country.empty());
 }
+
+namespace {
+meeting::geo::IpKey V4Key(std::uint8_t last) {
+    meeting::geo::IpKey key;
+    key.bytes = {8, 8, 8, last};
+    return key;
+}
+} // namespace
+
+TEST(GeoLookupCacheTest, HitMissAndLruEviction) {
+    meeting::geo::GeoCacheOptions options;
+    options.capacity = 2;
+    options.shards = 1;
+    meeting::geo::GeoLookupCache cache(options);
+
+    meeting::geo::GeoInfo info;
+    info.iso_code = "US";
+    EXPECT_FALSE(cache.Get(V4Key(1)).has_value());
+    cache.Put(V4Key(1), info);
+    cache.Put(V4Key(2), info);
+    ASSERT_TRUE(cache.Get(V4Key(1)).has_value()); // 1 成为最近使用
+    cache.Put(V4Key(3), info);                    // 淘汰 2
+
+    EXPECT_TRUE(cache.Get(V4Key(1)).has_value());
+    EXPECT_FALSE(cache.Get(V4Key(2)).has_value());
+    EXPECT_EQ(cache.Get(V4Key(3))->iso_code, "US");
+
+    auto stats = cache.GetStats();
+    EXPECT_EQ(stats.hits, 3u);
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_EQ(stats.evictions, 1u);
+    EXPECT_EQ(stats.size, 2u);
+}
+
+TEST(GeoLookupCacheTest, SeparatesFamiliesAndExpires) {
+    meeting::geo::GeoCacheOptions options;
+    options.ttl = std::chrono::milliseconds(20);
+    meeting::geo::GeoLookupCache cache(options);
+
+    auto v6 = V4Key(1);
+    v6.is_v6 = true; // 相同字节的 IPv6 地址是不同的键
+    cache.Put(V4Key(1), meeting::geo::GeoInfo{});
+    EXPECT_FALSE(cache.Get(v6).has_value());
+    EXPECT_TRUE(cache.Get(V4Key(1)).has_value());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    EXPECT_FALSE(cache.Get(V4Key(1)).has_value());
+    EXPECT_EQ(cache.GetStats().expirations, 1u);
+}
+
+namespace {
+// 按 MaxMind DB 数据格式手工编码测试记录
+void PutString(std::vector<std::uint8_t>* out, const std::string& value) {
+    out->push_back(static_cast<std::uint8_t>((2 << 5) | value.size()));
+    out->insert(out->end(), value.begin(), value.end());
+}
+void PutMap(std::vector<std::uint8_t>* out, std::uint8_t pairs) {
+    out->push_back(static_cast<std::uint8_t>((7 << 5) | pairs));
+}
+void PutDouble(std::vector<std::uint8_t>* out, double value) {
+    std::uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    out->push_back(static_cast<std::uint8_t>((3 << 5) | 8));
+    for (int i = 7; i >= 0; --i) {
+        out->push_back(static_cast<std::uint8_t>(bits >> (8 * i)));
+    }
+}
+} // namespace
+
+TEST(MmdbDecoderTest, DecodesNeededFieldsInOnePass) {
+    std::vector<std::uint8_t> data;
+    PutString(&data, "Europe/London"); // 偏移 0, 供指针引用
+    const auto root = static_cast<std::uint32_t>(data.size());
+    PutMap(&data, 4);
+    PutString(&data, "continent"); // 不需要的字段被跳过
+    PutMap(&data, 1);
+    PutString(&data, "code");
+    PutString(&data, "EU");
+    PutString(&data, "country");
+    PutMap(&data, 2);
+    PutString(&data, "iso_code");
+    PutString(&data, "GB");
+    PutString(&data, "names");
+    PutMap(&data, 2);
+    PutString(&data, "de");
+    PutString(&data, "Vereinigtes Koenigreich");
+    PutString(&data, "en");
+    PutString(&data, "United Kingdom");
+    PutString(&data, "location");
+    PutMap(&data, 3);
+    PutString(&data, "latitude");
+    PutDouble(&data, 51.5);
+    PutString(&data, "longitude");
+    PutDouble(&data, -0.12);
+    PutString(&data, "time_zone");
+    data.push_back(1 << 5); // 指针, 目标偏移 0
+    data.push_back(0);
+    PutString(&data, "subdivisions");
+    data.push_back(1); // 扩展类型, 1 个元素
+    data.push_back(4); // 7 + 4 = 数组
+    PutMap(&data, 1);
+    PutString(&data, "names");
+    PutMap(&data, 1);
+    PutString(&data, "en");
+    PutString(&data, "England");
+
+    MMDB_s db{};
+    db.data_section = data.data();
+    db.data_section_size = static_cast<std::uint32_t>(data.size());
+    MMDB_entry_s entry{&db, root};
+    meeting::geo::GeoRecordView record;
+    ASSERT_TRUE(meeting::geo::DecodeGeoRecord(entry, &record));
+    EXPECT_EQ(record.iso_code, "GB");
+    EXPECT_EQ(record.country, "United Kingdom");
+    EXPECT_EQ(record.region, "England");
+    EXPECT_EQ(record.timezone, "Europe/London");
+    EXPECT_TRUE(record.city.empty());
+    ASSERT_TRUE(record.latitude.has_value());
+    EXPECT_DOUBLE_EQ(*record.latitude, 51.5);
+    EXPECT_DOUBLE_EQ(*record.longitude, -0.12);
+
+    // 截断的数据被拒绝而不是越界读取
+    db.data_section_size = root + 20;
+    meeting::geo::GeoRecordView truncated;
+    EXPECT_FALSE(meeting::geo::DecodeGeoRecord(entry, &truncated));
+
+    // 顺序遍历: 顶层字符串被跳过, 遇到元数据段标记时结束
+    const std::string marker("\xAB\xCD\xEFMaxMind.com", 14);
+    data.insert(data.end(), marker.begin(), marker.end());
+    PutMap(&data, 0);
+    db.data_section = data.data();
+    db.data_section_size = static_cast<std::uint32_t>(data.size());
+    std::vector<meeting::geo::GeoRecordView> visited;
+    EXPECT_TRUE(meeting::geo::ForEachGeoRecord(db, [&visited](const meeting::geo::GeoRecordView& r) {
+        visited.push_back(r);
+    }));
+    ASSERT_EQ(visited.size(), 1u);
+    EXPECT_EQ(visited[0].country, "United Kingdom");
+    // 指针引用的字符串指向被引用处, 与直接解码得到的位置相同
+    EXPECT_EQ(visited[0].timezone.data(), record.timezone.data());
+}
+
+TEST(StringTableTest, InternReturnsStableSharedViews) {
+    auto& table = meeting::geo::StringTable::Shared();
+    std::string first = "Asia/Tokyo";
+    auto a = table.Intern(first);
+    first.assign("overwritten");
+    auto b = table.Intern(std::string("Asia/Tokyo"));
+    EXPECT_EQ(a, "Asia/Tokyo");
+    EXPECT_EQ(a.data(), b.data());
+    EXPECT_TRUE(table.Intern("").empty());
+}
+
+namespace {
+std::string RealDbPathOrEmpty() {
+    std::string db_path;
+    if (const char* env = std::getenv("GEOIP_DB_PATH")) {
+        db_path = env;
+    }
+#ifdef GEOIP_TEST_DB_PATH
+    if (db_path.empty()) {
+        db_path = GEOIP_TEST_DB_PATH;
+    }
+#endif
+    if (db_path.empty() || !std::filesystem::exists(db_path)) {
+        return {};
+    }
+    return db_path;
+}
+} // namespace
+
+TEST(GeoLocationServiceTest, ReloadFailureKeepsCurrentState) {
+    GeoLocationService svc("nonexistent.mmdb");
+    EXPECT_EQ(svc.Generation(), 0u);
+    auto status = svc.Reload();
+    EXPECT_FALSE(status.IsOk());
+    EXPECT_EQ(status.Code(), meeting::common::StatusCode::kUnavailable);
+    EXPECT_FALSE(svc.IsAvailable());
+    EXPECT_EQ(svc.Generation(), 0u);
+}
+
+TEST(GeoLocationServiceTest, ReloadWhileLookupsInFlight) {
+    const auto db_path = RealDbPathOrEmpty();
+    if (db_path.empty()) {
+        GTEST_SKIP() << "No GeoIP DB available";
+    }
+    meeting::geo::GeoCacheOptions no_cache;
+    no_cache.capacity = 0; // 每次查询都访问数据库
+    GeoLocationService svc(db_path, no_cache);
+    ASSERT_TRUE(svc.IsAvailable());
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> unavailable{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&]() {
+            while (!stop.load()) {
+                auto res = svc.Lookup("8.8.8.8");
+                if (!res.IsOk() && res.GetStatus().Code() == meeting::common::StatusCode::kUnavailable) {
+                    unavailable.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (int i = 0; i < 20; ++i) {
+        ASSERT_TRUE(svc.Reload().IsOk());
+    }
+    stop.store(true);
+    for (auto& t : readers) {
+        t.join();
+    }
+    EXPECT_EQ(unavailable.load(), 0); // 替换期间查询始终可用
+    EXPECT_EQ(svc.Generation(), 21u);
+}
+
+TEST(GeoLocationServiceTest, WatcherLoadsDatabaseWhenFileAppears) {
+    const auto db_path = RealDbPathOrEmpty();
+    if (db_path.empty()) {
+        GTEST_SKIP() << "No GeoIP DB available";
+    }
+    auto target = std::filesystem::temp_directory_path()
+                  / ("meeting_geo_reload_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count())
+                     + ".mmdb");
+    GeoLocationService svc(target.string());
+    EXPECT_FALSE(svc.IsAvailable());
+    svc.StartWatching(std::chrono::milliseconds(10));
+
+    std::filesystem::copy_file(db_path, target);
+    for (int i = 0; i < 500 && !svc.IsAvailable(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    svc.StopWatching();
+    EXPECT_TRUE(svc.IsAvailable());
+    EXPECT_GE(svc.Generation(), 1u);
+    std::error_code ec;
+    std::filesystem::remove(target, ec);
+}
+
+TEST(GeoLocationServiceTest, LookupBatchKeepsInputOrder) {
+    GeoLocationService svc("nonexistent.mmdb");
+    const std::vector<std::string> ips = {"8.8.8.8", "not-an-ip", "10.0.0.1", "", "::1", "2001:4860:4860::8888"};
+    std::vector<meeting::common::StatusOr<meeting::geo::GeoInfo>> results;
+    svc.LookupBatch(ips, &results);
+    ASSERT_EQ(results.size(), ips.size());
+    EXPECT_EQ(results[0].GetStatus().Code(), meeting::common::StatusCode::kUnavailable);
+    EXPECT_EQ(results[1].GetStatus().Code(), meeting::common::StatusCode::kInvalidArgument);
+    ASSERT_TRUE(results[2].IsOk());
+    EXPECT_TRUE(results[2].Value().is_private);
+    EXPECT_EQ(results[3].GetStatus().Code(), meeting::common::StatusCode::kInvalidArgument);
+    ASSERT_TRUE(results[4].IsOk());
+    EXPECT_TRUE(results[4].Value().is_private);
+    EXPECT_EQ(results[5].GetStatus().Code(), meeting::common::StatusCode::kUnavailable);
+}
+
+TEST(GeoLocationServiceTest, LookupBatchMatchesLookup) {
+    const auto db_path = RealDbPathOrEmpty();
+    if (db_path.empty()) {
+        GTEST_SKIP() << "No GeoIP DB available";
+    }
+    meeting::geo::GeoCacheOptions no_cache;
+    no_cache.capacity = 0;
+    GeoLocationService svc(db_path, no_cache);
+    ASSERT_TRUE(svc.IsAvailable());
+
+    // 足够多的地址以触发线程池分段
+    std::vector<std::string> ips;
+    for (int i = 0; i < 5000; ++i) {
+        ips.push_back(std::to_string(1 + (i * 37) % 222) + "." + std::to_string((i * 13) % 256) + "."
+                      + std::to_string(i % 256) + ".1");
+    }
+    ips.push_back("192.168.0.1");
+    ips.push_back("bogus");
+
+    thread_pool::ThreadPool pool(4);
+    pool.Start();
+    std::vector<meeting::common::StatusOr<meeting::geo::GeoInfo>> serial;
+    std::vector<meeting::common::StatusOr<meeting::geo::GeoInfo>> parallel;
+    svc.LookupBatch(ips, &serial);
+    svc.LookupBatch(ips, &parallel, &pool);
+    pool.Stop();
+
+    ASSERT_EQ(serial.size(), ips.size());
+    ASSERT_EQ(parallel.size(), ips.size());
+    for (std::size_t i = 0; i < ips.size(); ++i) {
+        auto single = svc.Lookup(ips[i]);
+        ASSERT_EQ(serial[i].IsOk(), single.IsOk()) << ips[i];
+        ASSERT_EQ(parallel[i].IsOk(), single.IsOk()) << ips[i];
+        if (single.IsOk()) {
+            EXPECT_EQ(serial[i].Value().country, single.Value().country) << ips[i];
+            EXPECT_EQ(parallel[i].Value().city, single.Value().city) << ips[i];
+        } else {
+            EXPECT_EQ(parallel[i].GetStatus().Code(), single.GetStatus().Code()) << ips[i];
+        }
+    }
+}
+
+TEST(GeoLocationServiceTest, LookupBatchOnPoolWorkerRunsInline) {
+    const auto db_path = RealDbPathOrEmpty();
+    if (db_path.empty()) {
+        GTEST_SKIP() << "No GeoIP DB available";
+    }
+    meeting::geo::GeoCacheOptions no_cache;
+    no_cache.capacity = 0;
+    GeoLocationService svc(db_path, no_cache);
+    ASSERT_TRUE(svc.IsAvailable());
+
+    std::vector<std::string> ips;
+    for (int i = 0; i < 5000; ++i) {
+        ips.push_back(std::to_string(1 + (i * 29) % 222) + "." + std::to_string(i % 256) + ".7.1");
+    }
+
+    // 单工作线程的 work-stealing 线程池: 若在工作线程中投递分段并等待, 分段留在本线程队列上永远不会执行
+    thread_pool::ThreadPoolConfig cfg;
+    cfg.core_threads = 1;
+    cfg.max_threads = 1;
+    cfg.scheduler = thread_pool::SchedulerMode::WorkStealing;
+    thread_pool::ThreadPool pool(cfg);
+    pool.Start();
+    std::vector<meeting::common::StatusOr<meeting::geo::GeoInfo>> serial;
+    std::vector<meeting::common::StatusOr<meeting::geo::GeoInfo>> nested;
+    svc.LookupBatch(ips, &serial);
+    auto done = pool.Submit([&]() { svc.LookupBatch(ips, &nested, &pool); });
+    ASSERT_EQ(done.wait_for(std::chrono::seconds(30)), std::future_status::ready);
+    done.get();
+    pool.Stop();
+
+    ASSERT_EQ(nested.size(), serial.size());
+    for (std::size_t i = 0; i < ips.size(); ++i) {
+        ASSERT_EQ(nested[i].IsOk(), serial[i].IsOk()) << ips[i];
+        if (serial[i].IsOk()) {
+            EXPECT_EQ(nested[i].Value().city, serial[i].Value().city) << ips[i];
+        }
+    }
+}
@@ -0,0 +1,226 @@
+#include "scheduler/consistent_hash_ring.hpp"
+#include "scheduler/geo_index.hpp"
+#include "scheduler/load_balancer.hpp"
+#include "registry/server_registry.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using meeting::registry::NodeInfo;
+using meeting::scheduler::ConsistentHashRing;
+using meeting::scheduler::GeoIndex;
+using meeting::scheduler::GeoPoint;
+using meeting::scheduler::LoadBalancer;
+using meeting::scheduler::SelectionStrategy;
+
+NodeInfo MakeNode(const std::string& host, int weight, std::uint64_t participants, double busy = 0.0) {
+    NodeInfo node;
+    node.host = host;
+    node.port = 50051;
+    node.weight = weight;
+    node.load.participants = participants;
+    node.load.busy_ratio = busy;
+    return node;
+}
+
+NodeInfo MakeLocatedNode(const std::string& host, double latitude, double longitude, std::uint64_t participants = 0) {
+    NodeInfo node = MakeNode(host, 1, participants);
+    node.meta_json = R"({"latitude":)" + std::to_string(latitude) + R"(,"longitude":)" + std::to_string(longitude) + "}";
+    return node;
+}
+
+} // namespace
+
+TEST(NodeDataCodecTest, RoundTripKeepsMetaAndLoad) {
+    NodeInfo node = MakeNode("10.0.0.1", 3, 42, 0.5);
+    node.load.active_meetings = 7;
+    node.meta_json = R"({"zone":"a"})";
+
+    NodeInfo decoded;
+    meeting::registry::DecodeNodeData(meeting::registry::EncodeNodeData(node), &decoded);
+    EXPECT_EQ(decoded.weight, 3);
+    EXPECT_EQ(decoded.load.active_meetings, 7u);
+    EXPECT_EQ(decoded.load.participants, 42u);
+    EXPECT_DOUBLE_EQ(decoded.load.busy_ratio, 0.5);
+    // meta_json 不含 weight 与 load, 只有负载变化时保持不变 (空间索引不因负载上报重建)
+    EXPECT_EQ(decoded.meta_json, R"({"zone":"a"})");
+    node.load.active_meetings = 8;
+    NodeInfo reloaded;
+    meeting::registry::DecodeNodeData(meeting::registry::EncodeNodeData(node), &reloaded);
+    EXPECT_EQ(reloaded.meta_json, decoded.meta_json);
+}
+
+TEST(NodeDataCodecTest, InvalidDataKeepsDefaults) {
+    NodeInfo decoded;
+    meeting::registry::DecodeNodeData("not json", &decoded);
+    EXPECT_EQ(decoded.weight, 1);
+    EXPECT_EQ(decoded.load.participants, 0u);
+}
+
+TEST(LoadBalancerTest, ParseStrategy) {
+    EXPECT_EQ(meeting::scheduler::ParseSelectionStrategy("least_loaded"), SelectionStrategy::kLeastLoaded);
+    EXPECT_EQ(meeting::scheduler::ParseSelectionStrategy("power_of_two"), SelectionStrategy::kPowerOfTwoChoices);
+    EXPECT_FALSE(meeting::scheduler::ParseSelectionStrategy("front").has_value());
+}
+
+TEST(LoadBalancerTest, WeightedRoundRobinFollowsWeights) {
+    LoadBalancer lb(nullptr, SelectionStrategy::kWeightedRoundRobin);
+    std::vector<NodeInfo> nodes{MakeNode("a", 1, 0), MakeNode("b", 3, 0), MakeNode("c", 0, 0)};
+    std::map<std::string, int> counts;
+    for (int i = 0; i < 400; ++i) {
+        counts[lb.Pick(nodes)->host]++;
+    }
+    EXPECT_EQ(counts["a"], 100);
+    EXPECT_EQ(counts["b"], 300);
+    EXPECT_EQ(counts["c"], 0); // 权重为 0 的节点不分配流量
+}
+
+TEST(LoadBalancerTest, LeastLoadedPicksLowestScore) {
+    LoadBalancer lb(nullptr, SelectionStrategy::kLeastLoaded);
+    std::vector<NodeInfo> nodes{MakeNode("a", 1, 100), MakeNode("b", 1, 10, 0.9), MakeNode("c", 4, 60)};
+    EXPECT_EQ(lb.Pick(nodes)->host, "c"); // 61 / 4 < 11 * 1.9 < 101
+}
+
+TEST(LoadBalancerTest, PowerOfTwoAvoidsHotNode) {
+    LoadBalancer lb(nullptr, SelectionStrategy::kPowerOfTwoChoices);
+    std::vector<NodeInfo> nodes{MakeNode("hot", 1, 1000, 1.0), MakeNode("a", 1, 1), MakeNode("b", 1, 2)};
+    for (int i = 0; i < 200; ++i) {
+        EXPECT_NE(lb.Pick(nodes)->host, "hot");
+    }
+}
+
+TEST(LoadBalancerTest, EmptyCandidates) {
+    LoadBalancer lb(nullptr, SelectionStrategy::kLeastLoaded);
+    EXPECT_FALSE(lb.Pick({}).has_value());
+    EXPECT_FALSE(lb.Select(meeting::geo::GeoInfo{}).has_value());
+}
+
+TEST(ConsistentHashRingTest, MembershipChangeMovesOnlyRemovedNodeKeys) {
+    std::vector<NodeInfo> nodes{MakeNode("a", 1, 0), MakeNode("b", 1, 0), MakeNode("c", 1, 0), MakeNode("d", 1, 0)};
+    ConsistentHashRing full(nodes);
+    nodes.erase(nodes.begin() + 1); // 摘除 b
+    ConsistentHashRing reduced(nodes);
+
+    std::map<std::string, int> owned;
+    for (int i = 0; i < 2000; ++i) {
+        const auto key = "meeting-" + std::to_string(i);
+        const auto& before = full.Members()[*full.Locate(key)];
+        const auto& after = reduced.Members()[*reduced.Locate(key)];
+        owned[before.host]++;
+        if (before.host != "b") {
+            EXPECT_EQ(before.host, after.host) << key;
+        } else {
+            EXPECT_NE(after.host, "b");
+        }
+    }
+    // 虚拟节点使分布大致均匀
+    for (const auto& [host, count] : owned) {
+        EXPECT_GT(count, 300) << host;
+        EXPECT_LT(count, 700) << host;
+    }
+}
+
+TEST(LoadBalancerTest, MeetingAffinityIsStableAndSkipsDrainedNodes) {
+    LoadBalancer lb(nullptr);
+    std::vector<NodeInfo> nodes{MakeNode("a", 1, 0), MakeNode("b", 1, 0), MakeNode("c", 0, 0)};
+    for (int i = 0; i < 50; ++i) {
+        const auto id = "meeting-" + std::to_string(i);
+        auto first = lb.PickForMeeting(id, nodes);
+        ASSERT_TRUE(first.has_value());
+        EXPECT_NE(first->host, "c");
+        // 参与者加入顺序/节点列表顺序不影响归属
+        std::vector<NodeInfo> shuffled{nodes[2], nodes[1], nodes[0]};
+        EXPECT_EQ(lb.PickForMeeting(id, shuffled)->host, first->host);
+    }
+    EXPECT_FALSE(lb.PickForMeeting("m", {}).has_value());
+}
+
+TEST(LoadBalancerTest, MeetingOwnerIsIndependentOfLoadAndNode) {
+    // 两个节点各自的负载均衡器看到不同的负载与节点顺序, 对同一会议须选出同一归属
+    LoadBalancer lb_a(nullptr, SelectionStrategy::kLeastLoaded);
+    LoadBalancer lb_b(nullptr, SelectionStrategy::kPowerOfTwoChoices);
+    std::vector<NodeInfo> view_a{MakeNode("a", 1, 0), MakeNode("b", 1, 0), MakeNode("c", 1, 0)};
+    std::vector<NodeInfo> view_b{MakeNode("c", 1, 900, 0.9), MakeNode("a", 1, 10), MakeNode("b", 1, 500, 0.5)};
+    view_a[0].load.active_meetings = 40;
+    view_b[2].load.active_meetings = 40;
+    for (int i = 0; i < 200; ++i) {
+        const auto id = "meeting-" + std::to_string(i);
+        auto owner_a = lb_a.PickForMeeting(id, view_a);
+        auto owner_b = lb_b.PickForMeeting(id, view_b);
+        ASSERT_TRUE(owner_a.has_value());
+        ASSERT_TRUE(owner_b.has_value());
+        EXPECT_EQ(owner_a->host, owner_b->host) << id;
+    }
+
+    // 节点被摘除时其会议迁到其他节点, 恢复后迁回; 结果不依赖此前的选择
+    auto owner = lb_a.PickForMeeting("meeting-hot", view_a);
+    ASSERT_TRUE(owner.has_value());
+    for (auto& n : view_a) {
+        n.weight = n.host == owner->host ? 0 : 1;
+    }
+    auto moved = lb_a.PickForMeeting("meeting-hot", view_a);
+    ASSERT_TRUE(moved.has_value());
+    EXPECT_NE(moved->host, owner->host);
+    EXPECT_EQ(lb_b.PickForMeeting("meeting-hot", view_a)->host, moved->host);
+    for (auto& n : view_a) {
+        n.weight = 1;
+    }
+    EXPECT_EQ(lb_a.PickForMeeting("meeting-hot", view_a)->host, owner->host);
+}
+
+TEST(GeoIndexTest, NearestMatchesBruteForce) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> lat(-80.0, 80.0);
+    std::uniform_real_distribution<double> lon(-180.0, 180.0);
+    std::vector<NodeInfo> nodes;
+    for (int i = 0; i < 200; ++i) {
+        nodes.push_back(MakeLocatedNode("n" + std::to_string(i), lat(rng), lon(rng)));
+    }
+    nodes.push_back(MakeNode("no-location", 1, 0)); // 无坐标节点不进入索引
+    GeoIndex index(nodes);
+    ASSERT_EQ(index.Size(), 200u);
+
+    // 含跨越 180 度经线的查询点
+    std::vector<GeoPoint> queries{{35.68, 139.69}, {51.5, -0.12}, {-33.9, 151.2}, {10.0, 179.9}, {10.0, -179.9}};
+    for (int i = 0; i < 20; ++i) {
+        queries.push_back(GeoPoint{lat(rng), lon(rng)});
+    }
+    for (const auto& q : queries) {
+        std::vector<std::pair<double, std::size_t>> expected;
+        for (std::size_t i = 0; i + 1 < nodes.size(); ++i) {
+            expected.emplace_back(meeting::scheduler::DistanceKm(q, *meeting::scheduler::NodeLocation(nodes[i])), i);
+        }
+        std::sort(expected.begin(), expected.end());
+        auto nearest = index.Nearest(q, 3);
+        ASSERT_EQ(nearest.size(), 3u);
+        for (std::size_t k = 0; k < nearest.size(); ++k) {
+            EXPECT_EQ(nearest[k], expected[k].second) << q.latitude << "," << q.longitude;
+        }
+    }
+}
+
+TEST(LoadBalancerTest, PickNearestChoosesAmongClosestNodes) {
+    LoadBalancer lb(nullptr, SelectionStrategy::kLeastLoaded, {}, 2);
+    std::vector<NodeInfo> nodes{
+        MakeLocatedNode("tokyo", 35.68, 139.69, 50),
+        MakeLocatedNode("osaka", 34.69, 135.50, 10),
+        MakeLocatedNode("london", 51.50, -0.12, 0), // 最空闲但距离远
+        MakeNode("unknown", 1, 0),
+    };
+    auto selected = lb.PickNearest(GeoPoint{35.0, 137.0}, nodes);
+    ASSERT_TRUE(selected.has_value());
+    EXPECT_EQ(selected->host, "osaka");
+
+    LoadBalancer closest_only(nullptr, SelectionStrategy::kLeastLoaded, {}, 1);
+    EXPECT_EQ(closest_only.PickNearest(GeoPoint{35.0, 137.0}, nodes)->host, "osaka");
+    nodes[1].weight = 0; // 摘除 osaka 后最近的是 tokyo
+    EXPECT_EQ(closest_only.PickNearest(GeoPoint{35.0, 137.0}, nodes)->host, "tokyo");
+    EXPECT_FALSE(lb.PickNearest(GeoPoint{35.0, 137.0}, {MakeNode("unknown", 1, 0)}).has_value());
+}
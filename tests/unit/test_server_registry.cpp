@@ -88,3 +88,37 @@ TEST(ServerRegistryIntegration, RegisterListUnregister) {
     auto after = registry.List(node.region);
     EXPECT_FALSE(ContainsNode(after, node));
 }
+
+TEST(ServerRegistryIntegration, WatchPropagatesRemoteChanges) {
+    const auto hosts = ZkHosts();
+    if (!CanConnectZk(hosts)) {
+        GTEST_SKIP() << "Zookeeper 不可用，跳过集成测试，hosts=" << hosts;
+    }
+
+    meeting::registry::ServerRegistry observer(hosts);
+    meeting::registry::ServerRegistry remote(hosts);
+    auto self_node = MakeNode();
+    observer.Register(self_node); // 建立连接并订阅 region
+
+    auto remote_node = self_node;
+    remote_node.port = self_node.port + 1;
+    remote.Register(remote_node);
+
+    // watch 推送后快照应包含远端节点
+    auto wait_until = [&](bool expected) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (std::chrono::steady_clock::now() < deadline) {
+            if (ContainsNode(observer.List(remote_node.region), remote_node) == expected) {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        return false;
+    };
+    EXPECT_TRUE(wait_until(true));
+
+    remote.Unregister(remote_node);
+    EXPECT_TRUE(wait_until(false));
+
+    observer.Unregister(self_node);
+}
@@ -0,0 +1,839 @@
+#include "mpmc/blocking_queue_adapter.hpp"
+#include "mpmc/bounded_circular_queue.hpp"
+#include "mpmc/work_stealing_deque.hpp"
+#include "thread_pool/completion.hpp"
+#include "thread_pool/config.hpp"
+#include "thread_pool/coroutine.hpp"
+#include "thread_pool/cpu_topology.hpp"
+#include "thread_pool/move_only_function.hpp"
+#include "thread_pool/task_allocator.hpp"
+#include "thread_pool/thread_pool.hpp"
+#include "thread_pool/timer_wheel.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace {
+thread_pool::ThreadPoolConfig MakeConfig(thread_pool::SchedulerMode mode) {
+    thread_pool::ThreadPoolConfig cfg;
+    cfg.core_threads = 4;
+    cfg.max_threads = 4;
+    cfg.queue_cap = 8192; // 容纳 ForkJoin 在 FIFO 调度下的全部待执行任务
+    cfg.scheduler = mode;
+    return cfg;
+}
+} // namespace
+
+TEST(WorkStealingDequeTest, OwnerLifoThiefFifoAndGrow) {
+    WorkStealingDeque<int> dq(2);
+    for (int i = 0; i < 100; ++i) {
+        dq.Push(i);
+    }
+    EXPECT_EQ(dq.Size(), 100u);
+    int v = -1;
+    ASSERT_TRUE(dq.Pop(v));
+    EXPECT_EQ(v, 99);
+    ASSERT_TRUE(dq.Steal(v));
+    EXPECT_EQ(v, 0);
+    EXPECT_EQ(dq.Size(), 98u);
+}
+
+TEST(WorkStealingDequeTest, ConcurrentStealsTakeEachItemOnce) {
+    constexpr int kItems = 200000;
+    WorkStealingDeque<int> dq;
+    std::vector<std::atomic<int>> seen(kItems);
+    std::atomic<bool> done{false};
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < 3; ++t) {
+        thieves.emplace_back([&]() {
+            int v = 0;
+            while (!done.load() || !dq.Empty()) {
+                if (dq.Steal(v)) {
+                    seen[v].fetch_add(1);
+                }
+            }
+        });
+    }
+    int v = 0;
+    for (int i = 0; i < kItems; ++i) {
+        dq.Push(i);
+        if (i % 3 == 0 && dq.Pop(v)) {
+            seen[v].fetch_add(1);
+        }
+    }
+    while (dq.Pop(v)) {
+        seen[v].fetch_add(1);
+    }
+    done.store(true);
+    for (auto& t : thieves) {
+        t.join();
+    }
+    for (int i = 0; i < kItems; ++i) {
+        ASSERT_EQ(seen[i].load(), 1) << "item " << i;
+    }
+}
+
+TEST(BlockingQueueAdapterTest, ParkedWaitersWakeOnPushPopAndClose) {
+    constexpr int kItems = 20000;
+    BlockingQueueAdapter<int> queue(8);  // 小容量: 生产者也会在满队列上休眠
+    std::atomic<long long> sum{0};
+    std::atomic<int> popped{0};
+    std::vector<std::thread> consumers;
+    for (int t = 0; t < 3; ++t) {
+        consumers.emplace_back([&]() {
+            int v = 0;
+            while (queue.WaitPop(v)) {
+                sum.fetch_add(v);
+                popped.fetch_add(1);
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));  // 让消费者进入休眠
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 2; ++t) {
+        producers.emplace_back([&, t]() {
+            for (int i = t; i < kItems; i += 2) {
+                ASSERT_TRUE(queue.WaitPush(i));
+            }
+        });
+    }
+    for (auto& p : producers) {
+        p.join();
+    }
+    while (popped.load() < kItems) {
+        std::this_thread::yield();
+    }
+    queue.Close();  // 唤醒仍在休眠的消费者
+    for (auto& c : consumers) {
+        c.join();
+    }
+    EXPECT_EQ(popped.load(), kItems);
+    EXPECT_EQ(sum.load(), static_cast<long long>(kItems) * (kItems - 1) / 2);
+    EXPECT_EQ(queue.Size(), 0u);
+    EXPECT_FALSE(queue.HasWaitingConsumers());
+
+    BlockingQueueAdapter<int> timed(2);
+    int v = 0;
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(timed.WaitPopFor(v, std::chrono::milliseconds(20)));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+    EXPECT_TRUE(timed.TryPush(1));
+    EXPECT_TRUE(timed.TryPush(2));
+    EXPECT_FALSE(timed.WaitPushFor(3, std::chrono::milliseconds(5)));
+    EXPECT_EQ(timed.DiscardCount(), 1u);
+    EXPECT_TRUE(timed.WaitPopFor(v, std::chrono::milliseconds(5)));
+    EXPECT_EQ(v, 1);
+}
+
+TEST(BoundedCircularQueueTest, PopBatchClaimsRangeOnce) {
+    BoundedCircularQueue<int> queue(16);
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(queue.TryPush(i));
+    }
+    std::array<int, 16> out{};
+    EXPECT_EQ(queue.TryPopBatch(out.begin(), 4), 4u);
+    EXPECT_EQ(out[0], 0);
+    EXPECT_EQ(out[3], 3);
+    EXPECT_EQ(queue.TryPopBatch(out.begin(), 16), 6u);  // 只取已发布的元素
+    EXPECT_EQ(out[5], 9);
+    EXPECT_EQ(queue.TryPopBatch(out.begin(), 16), 0u);
+
+    // 多个消费者按批次争抢: 每个元素恰好被取走一次
+    constexpr int kItems = 200000;
+    BoundedCircularQueue<int> shared(64);
+    std::vector<std::atomic<int>> seen(kItems);
+    std::atomic<int> taken{0};
+    std::vector<std::thread> consumers;
+    for (int t = 0; t < 3; ++t) {
+        consumers.emplace_back([&, t]() {
+            std::array<int, 8> batch{};
+            while (taken.load() < kItems) {
+                const auto n = shared.TryPopBatch(batch.begin(), 1 + t * 3);
+                for (std::size_t i = 0; i < n; ++i) {
+                    seen[batch[i]].fetch_add(1);
+                }
+                taken.fetch_add(static_cast<int>(n));
+            }
+        });
+    }
+    for (int i = 0; i < kItems; ++i) {
+        while (!shared.TryPush(i)) {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& c : consumers) {
+        c.join();
+    }
+    for (int i = 0; i < kItems; ++i) {
+        ASSERT_EQ(seen[i].load(), 1) << "item " << i;
+    }
+}
+
+TEST(MoveOnlyFunctionTest, InlineHeapAndMoveOnlyCaptures) {
+    using Fn = thread_pool::MoveOnlyFunction<int()>;
+    auto owned = std::make_unique<int>(7);
+    Fn small([p = std::move(owned)]() { return *p; });
+    EXPECT_TRUE(small.IsInline());
+    EXPECT_EQ(small(), 7);
+
+    std::array<char, 128> big{};
+    big[0] = 3;
+    Fn large([big]() { return static_cast<int>(big[0]); });
+    EXPECT_FALSE(large.IsInline());
+
+    Fn moved(std::move(large));
+    EXPECT_FALSE(static_cast<bool>(large));
+    EXPECT_EQ(moved(), 3);
+    moved = std::move(small);
+    EXPECT_EQ(moved(), 7);
+    EXPECT_FALSE(static_cast<bool>(Fn(std::function<int()>{})));
+    EXPECT_THROW(Fn{}(), std::bad_function_call);
+}
+
+TEST(TaskAllocatorTest, RecyclesBlocksAcrossThreads) {
+    using thread_pool::TaskAllocator;
+    // 生产者分配、另一线程释放: 稳定后不再切分新的 slab
+    auto round = []() {
+        std::vector<void*> blocks;
+        for (int i = 0; i < 256; ++i) {
+            blocks.push_back(TaskAllocator::Allocate(100));
+        }
+        std::thread([&blocks]() {
+            for (void* b : blocks) {
+                TaskAllocator::Deallocate(b, 100);
+            }
+        }).join();
+    };
+    round();
+    const auto slabs = TaskAllocator::GetStats().slabs;
+    for (int i = 0; i < 20; ++i) {
+        round();
+    }
+    EXPECT_EQ(TaskAllocator::GetStats().slabs, slabs);
+
+    void* big = TaskAllocator::Allocate(TaskAllocator::kMaxBlock + 1);
+    EXPECT_GE(TaskAllocator::GetStats().oversize, 1u);
+    TaskAllocator::Deallocate(big, TaskAllocator::kMaxBlock + 1);
+}
+
+TEST(CompletionTest, ValueExceptionAndBrokenPromise) {
+    thread_pool::CompletionPromise<int> promise;
+    auto completion = promise.GetCompletion();
+    EXPECT_FALSE(completion.Ready());
+    std::thread producer([&promise]() { promise.SetValue(42); });
+    EXPECT_EQ(completion.Get(), 42);
+    EXPECT_FALSE(completion.Valid());
+    producer.join();
+
+    thread_pool::CompletionPromise<void> failing;
+    auto failed = failing.GetCompletion();
+    failing.SetException(std::make_exception_ptr(std::runtime_error("boom")));
+    EXPECT_THROW(failed.Get(), std::runtime_error);
+    EXPECT_THROW(failing.SetValue(), std::logic_error);
+
+    thread_pool::Completion<int> orphan;
+    {
+        thread_pool::CompletionPromise<int> dropped;
+        orphan = dropped.GetCompletion();
+    }
+    EXPECT_TRUE(orphan.Ready());
+    EXPECT_THROW(orphan.Get(), std::runtime_error);
+}
+
+TEST(CompletionTest, ThenChainsAndPropagatesErrors) {
+    thread_pool::CompletionPromise<int> promise;
+    auto chained = promise.GetCompletion()
+                       .Then([](int v) { return v * 2; })
+                       .Then([](int v) { return std::to_string(v); });
+    promise.SetValue(21);
+    EXPECT_EQ(chained.Get(), "42");
+
+    // 已完成的 completion 上挂回调: 在当前线程立即执行
+    thread_pool::CompletionPromise<int> ready;
+    auto late = ready.GetCompletion();
+    ready.SetValue(1);
+    bool ran = false;
+    late.OnComplete([&ran](thread_pool::Completion<int> done) { ran = done.Get() == 1; });
+    EXPECT_TRUE(ran);
+
+    thread_pool::CompletionPromise<int> failing;
+    bool skipped = true;
+    auto after_error = failing.GetCompletion().Then([&skipped](int) { skipped = false; });
+    failing.SetException(std::make_exception_ptr(std::runtime_error("boom")));
+    EXPECT_THROW(after_error.Get(), std::runtime_error);
+    EXPECT_TRUE(skipped);
+}
+
+TEST(TimerWheelTest, CascadesRepeatsAndCancels) {
+    using Clock = thread_pool::TimerWheel::Clock;
+    using namespace std::chrono_literals;
+    std::vector<int> fired;
+    thread_pool::TimerWheel wheel(1ms, [](thread_pool::TimerWheel::Callback cb) { cb(); });  // 在 Poll 线程内直接执行
+    const auto t0 = Clock::now();
+    auto mark = [&fired](int v) { return [&fired, v]() { fired.push_back(v); }; };
+
+    wheel.Add(t0 + 5ms, Clock::duration::zero(), mark(1));        // 第 0 层
+    wheel.Add(t0 + 300ms, Clock::duration::zero(), mark(2));      // 第 1 层
+    wheel.Add(t0 + 70s, Clock::duration::zero(), mark(3));        // 第 2 层
+    const auto cancelled = wheel.Add(t0 + 10ms, Clock::duration::zero(), mark(4));
+    const auto repeating = wheel.Add(t0 + 10ms, 10ms, mark(5));
+    EXPECT_EQ(wheel.Size(), 5u);
+    EXPECT_TRUE(wheel.Cancel(cancelled));
+    EXPECT_FALSE(wheel.Cancel(cancelled));
+    EXPECT_FALSE(wheel.Cancel(thread_pool::kInvalidTimer));
+
+    wheel.Poll(t0 + 3ms);
+    EXPECT_TRUE(fired.empty());
+    wheel.Poll(t0 + 7ms);
+    EXPECT_EQ(fired, (std::vector<int>{1}));
+    wheel.Poll(t0 + 37ms);  // 周期任务补齐 10/20/30ms 三次
+    EXPECT_EQ(std::count(fired.begin(), fired.end(), 5), 3);
+    EXPECT_TRUE(wheel.Cancel(repeating));
+    wheel.Poll(t0 + 298ms);
+    EXPECT_EQ(std::count(fired.begin(), fired.end(), 2), 0);
+    wheel.Poll(t0 + 302ms);
+    EXPECT_EQ(std::count(fired.begin(), fired.end(), 2), 1);
+    wheel.Poll(t0 + 69990ms);
+    EXPECT_EQ(std::count(fired.begin(), fired.end(), 3), 0);
+    wheel.Poll(t0 + 70002ms);
+    EXPECT_EQ(std::count(fired.begin(), fired.end(), 3), 1);
+    EXPECT_EQ(std::count(fired.begin(), fired.end(), 4), 0);
+    EXPECT_EQ(std::count(fired.begin(), fired.end(), 5), 3);
+    EXPECT_EQ(wheel.Size(), 0u);
+}
+
+TEST(TimerWheelTest, ManyTimersOrderedByDeadline) {
+    using Clock = thread_pool::TimerWheel::Clock;
+    using namespace std::chrono_literals;
+    constexpr int kTimers = 100000;
+    std::vector<int> order;
+    order.reserve(kTimers);
+    thread_pool::TimerWheel wheel(1ms, [](thread_pool::TimerWheel::Callback cb) { cb(); });
+    const auto t0 = Clock::now();
+    std::vector<thread_pool::TimerId> ids;
+    for (int i = 0; i < kTimers; ++i) {
+        const int delay_ms = 1 + (i * 7919) % 100000;  // 覆盖第 0~2 层
+        ids.push_back(wheel.Add(t0 + std::chrono::milliseconds(delay_ms), Clock::duration::zero(),
+                                [&order, delay_ms]() { order.push_back(delay_ms); }));
+    }
+    for (int i = 0; i < kTimers; i += 2) {
+        ASSERT_TRUE(wheel.Cancel(ids[i]));
+    }
+    EXPECT_EQ(wheel.Size(), static_cast<std::size_t>(kTimers / 2));
+    for (auto now = t0; now < t0 + 101s; now += 997ms) {
+        wheel.Poll(now);
+    }
+    ASSERT_EQ(order.size(), static_cast<std::size_t>(kTimers / 2));
+    EXPECT_TRUE(std::is_sorted(order.begin(), order.end()));
+}
+
+TEST(ThreadPoolSchedulerTest, ConfigParsesScheduler) {
+    auto loader = thread_pool::ThreadPoolConfigLoader::FromString(R"({"scheduler": "WorkStealing"})");
+    ASSERT_TRUE(loader.has_value());
+    EXPECT_EQ(loader->GetConfig().scheduler, thread_pool::SchedulerMode::WorkStealing);
+    EXPECT_EQ(thread_pool::ThreadPoolConfigLoader::FromString("{}")->GetConfig().scheduler,
+              thread_pool::SchedulerMode::Mpmc);
+    EXPECT_FALSE(thread_pool::ThreadPoolConfigLoader::FromString(R"({"scheduler": "fifo"})").has_value());
+}
+
+TEST(ThreadPoolSchedulerTest, ConfigParsesLanes) {
+    auto loader = thread_pool::ThreadPoolConfigLoader::FromString(R"({
+        "core_threads": 2,
+        "lanes": [{"name": "rpc", "weight": 4, "min_workers": 2}, {"name": "bulk", "weight": 0}]
+    })");
+    ASSERT_TRUE(loader.has_value());
+    const auto& cfg = loader->GetConfig();
+    ASSERT_EQ(cfg.lanes.size(), 2u);
+    EXPECT_EQ(cfg.lanes[0].name, "rpc");
+    EXPECT_EQ(cfg.lanes[0].weight, 4u);
+    EXPECT_EQ(cfg.lanes[0].min_workers, 2u);
+    EXPECT_EQ(cfg.lanes[1].weight, 1u);       // 权重至少为 1
+    EXPECT_EQ(cfg.core_threads, 3u);          // 预留之外至少保留一个共享工作线程
+    EXPECT_FALSE(thread_pool::ThreadPoolConfigLoader::FromString(
+                     R"({"lanes": [{"name": "a"}, {"name": "a"}]})").has_value());
+    EXPECT_FALSE(thread_pool::ThreadPoolConfigLoader::FromString(R"({"lanes": [{"weight": 2}]})").has_value());
+}
+
+TEST(ThreadPoolSchedulerTest, ConfigParsesAffinity) {
+    auto loader = thread_pool::ThreadPoolConfigLoader::FromString(
+        R"({"affinity": "List", "cpus": [2, 0], "honor_cpu_quota": true})");
+    ASSERT_TRUE(loader.has_value());
+    const auto& cfg = loader->GetConfig();
+    EXPECT_EQ(cfg.affinity, thread_pool::AffinityMode::List);
+    EXPECT_EQ(cfg.cpus, (std::vector<int>{2, 0}));
+    EXPECT_TRUE(cfg.honor_cpu_quota);
+    EXPECT_EQ(thread_pool::ThreadPoolConfigLoader::FromString("{}")->GetConfig().affinity,
+              thread_pool::AffinityMode::None);
+    EXPECT_FALSE(thread_pool::ThreadPoolConfigLoader::FromString(R"({"affinity": "List"})").has_value());
+    EXPECT_FALSE(thread_pool::ThreadPoolConfigLoader::FromString(R"({"affinity": "spread"})").has_value());
+}
+
+TEST(CpuTopologyTest, PlacementFollowsNodes) {
+    EXPECT_EQ(thread_pool::CpuTopology::ParseCpuList("0-3,8,10-11\n"), (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_EQ(thread_pool::CpuTopology::ParseCpuList("x,5"), (std::vector<int>{5}));
+
+    // 两个 NUMA 节点, 各 3 个 CPU
+    const thread_pool::CpuTopology topo({{0, 1, 2}, {4, 5, 6}});
+    using thread_pool::AffinityMode;
+    EXPECT_EQ(topo.Placement(AffinityMode::Compact, {}), (std::vector<int>{0, 1, 2, 4, 5, 6}));
+    EXPECT_EQ(topo.Placement(AffinityMode::Scatter, {}), (std::vector<int>{0, 4, 1, 5, 2, 6}));
+    EXPECT_EQ(topo.Placement(AffinityMode::List, {5, 9, 1}), (std::vector<int>{5, 1}));  // 9 不在允许集合内
+    EXPECT_TRUE(topo.Placement(AffinityMode::None, {}).empty());
+    EXPECT_EQ(topo.NodeOf(5), 1u);
+
+    const auto detected = thread_pool::CpuTopology::Detect();
+    EXPECT_GE(detected.NodeCount(), 1u);
+    EXPECT_GE(detected.CpuCount(), 1u);
+}
+
+TEST(CpuTopologyTest, ReadsCgroupQuota) {
+    namespace fs = std::filesystem;
+    const fs::path root = fs::temp_directory_path() / ("tp_cgroup_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    fs::create_directories(root / "cpu");
+    auto write = [](const fs::path& path, const std::string& text) { std::ofstream(path) << text; };
+
+    EXPECT_FALSE(thread_pool::CpuTopology::CgroupCpuLimit(root.string()).has_value());
+    write(root / "cpu" / "cpu.cfs_quota_us", "-1\n");
+    write(root / "cpu" / "cpu.cfs_period_us", "100000\n");
+    EXPECT_FALSE(thread_pool::CpuTopology::CgroupCpuLimit(root.string()).has_value());  // v1 不限额
+    write(root / "cpu" / "cpu.cfs_quota_us", "250000\n");
+    EXPECT_DOUBLE_EQ(thread_pool::CpuTopology::CgroupCpuLimit(root.string()).value_or(0), 2.5);
+    write(root / "cpu.max", "150000 100000\n");  // v2 优先
+    EXPECT_DOUBLE_EQ(thread_pool::CpuTopology::CgroupCpuLimit(root.string()).value_or(0), 1.5);
+    fs::remove_all(root);
+}
+
+class ThreadPoolModeTest : public ::testing::TestWithParam<thread_pool::SchedulerMode> {};
+
+TEST_P(ThreadPoolModeTest, RunsExternalAndNestedTasks) {
+    thread_pool::ThreadPool pool(MakeConfig(GetParam()));
+    pool.Start();
+    EXPECT_EQ(pool.Scheduler(), GetParam());
+
+    // 外部提交的任务再派生子任务, 子任务在工作线程内提交
+    std::atomic<int> leaves{0};
+    std::vector<std::future<int>> futures;
+    for (int i = 0; i < 64; ++i) {
+        futures.push_back(pool.Submit([&pool, &leaves, i]() {
+            for (int j = 0; j < 32; ++j) {
+                pool.Post([&leaves]() { leaves.fetch_add(1); });
+            }
+            return i;
+        }));
+    }
+    for (int i = 0; i < 64; ++i) {
+        EXPECT_EQ(futures[i].get(), i);
+    }
+    pool.Stop(thread_pool::StopMode::Graceful);
+    EXPECT_EQ(leaves.load(), 64 * 32);
+    EXPECT_EQ(pool.Pending(), 0u);
+    EXPECT_EQ(pool.GetStatistics().statistic_total_completed, 64u + 64u * 32u);
+}
+
+TEST_P(ThreadPoolModeTest, InWorkerThreadOnlyOnOwnWorkers) {
+    thread_pool::ThreadPool pool(MakeConfig(GetParam()));
+    thread_pool::ThreadPool other(MakeConfig(GetParam()));
+    pool.Start();
+    other.Start();
+    EXPECT_FALSE(pool.InWorkerThread());
+    EXPECT_TRUE(pool.Submit([&pool]() { return pool.InWorkerThread(); }).get());
+    EXPECT_FALSE(other.Submit([&pool]() { return pool.InWorkerThread(); }).get());
+    other.Stop();
+    pool.Stop();
+}
+
+TEST_P(ThreadPoolModeTest, ForkJoinDoesNotStarve) {
+    thread_pool::ThreadPool pool(MakeConfig(GetParam()));
+    pool.Start();
+    // 递归派生: 父任务只派生不等待, 统计叶子数
+    std::atomic<int> leaves{0};
+    std::function<void(int)> spawn = [&](int depth) {
+        if (depth == 0) {
+            leaves.fetch_add(1);
+            return;
+        }
+        pool.Post([&spawn, depth]() { spawn(depth - 1); });
+        pool.Post([&spawn, depth]() { spawn(depth - 1); });
+    };
+    pool.Post([&spawn]() { spawn(12); });
+    for (int i = 0; i < 1000 && leaves.load() < (1 << 12); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    pool.Stop(thread_pool::StopMode::Graceful);
+    EXPECT_EQ(leaves.load(), 1 << 12);
+}
+
+TEST_P(ThreadPoolModeTest, ForceStopCancelsQueuedTasks) {
+    auto cfg = MakeConfig(GetParam());
+    cfg.core_threads = 1;
+    cfg.max_threads = 1;
+    thread_pool::ThreadPool pool(cfg);
+    pool.Start();
+    std::promise<void> release;
+    auto gate = release.get_future().share();
+    std::vector<std::future<void>> queued;
+    std::atomic<bool> spawned{false};
+    auto blocker = pool.Submit([&pool, &queued, &spawned, gate]() {
+        // 唯一的工作线程被阻塞时派生的任务留在队列中
+        for (int i = 0; i < 8; ++i) {
+            queued.push_back(pool.Submit([]() {}));
+        }
+        spawned.store(true);
+        gate.wait();
+    });
+    while (!spawned.load()) {
+        std::this_thread::yield();
+    }
+    std::thread stopper([&pool]() { pool.Stop(thread_pool::StopMode::Force); });
+    while (pool.State() != thread_pool::PoolState::FORCE_STOPPING && pool.State() != thread_pool::PoolState::STOPPED) {
+        std::this_thread::yield();
+    }
+    release.set_value();
+    stopper.join();
+    blocker.get();
+    for (auto& f : queued) {
+        EXPECT_THROW(f.get(), std::runtime_error);
+    }
+}
+
+TEST_P(ThreadPoolModeTest, ForceStopCancelsClaimedBatch) {
+    auto cfg = MakeConfig(GetParam());
+    cfg.core_threads = 1;
+    cfg.max_threads = 1;
+    thread_pool::ThreadPool pool(cfg);
+    pool.Start();
+    std::promise<void> release_blocker;
+    auto blocker = pool.Submit([gate = release_blocker.get_future()]() mutable { gate.wait(); });
+
+    // 工作线程被占用时积压 8 个任务, 放行后 Mpmc 工作线程一次认领整批
+    std::promise<void> started;
+    std::promise<void> release_head;
+    auto head = pool.Submit([&started, gate = release_head.get_future()]() mutable {
+        started.set_value();
+        gate.wait();
+    });
+    std::vector<std::future<void>> tail;
+    for (int i = 0; i < 7; ++i) {
+        tail.push_back(pool.Submit([]() {}));
+    }
+    release_blocker.set_value();
+    started.get_future().wait();
+    EXPECT_EQ(pool.Pending(), 7u);  // 已认领但未执行的任务仍计入 Pending
+
+    std::thread stopper([&pool]() { pool.Stop(thread_pool::StopMode::Force); });
+    while (pool.State() != thread_pool::PoolState::FORCE_STOPPING && pool.State() != thread_pool::PoolState::STOPPED) {
+        std::this_thread::yield();
+    }
+    release_head.set_value();
+    stopper.join();
+    blocker.get();
+    head.get();
+    for (auto& f : tail) {
+        EXPECT_THROW(f.get(), std::runtime_error);
+    }
+    EXPECT_EQ(pool.Pending(), 0u);
+}
+
+TEST_P(ThreadPoolModeTest, CompletionsAndCallbacks) {
+    thread_pool::ThreadPool pool(MakeConfig(GetParam()));
+    pool.Start();
+    EXPECT_EQ(pool.SubmitCompletion([](int a, int b) { return a + b; }, 2, 3).Get(), 5);
+    EXPECT_THROW(pool.SubmitCompletion([]() -> int { throw std::runtime_error("boom"); }).Get(),
+                 std::runtime_error);
+
+    constexpr int kTasks = 1000;
+    std::atomic<int> sum{0};
+    std::atomic<int> on_caller{0};
+    const auto caller = std::this_thread::get_id();
+    thread_pool::CompletionPromise<void> all_done;
+    auto finished = all_done.GetCompletion();
+    std::atomic<int> remaining{kTasks};
+    for (int i = 0; i < kTasks; ++i) {
+        pool.SubmitWithCallback([i]() { return i; }, [&, caller](thread_pool::Completion<int> done) {
+            sum.fetch_add(done.Get());
+            if (std::this_thread::get_id() == caller) {
+                on_caller.fetch_add(1);
+            }
+            if (remaining.fetch_sub(1) == 1) {
+                all_done.SetValue();
+            }
+        });
+    }
+    finished.Get();
+    EXPECT_EQ(sum.load(), kTasks * (kTasks - 1) / 2);
+    EXPECT_EQ(on_caller.load(), 0);  // 回调在完成任务的工作线程上执行
+
+    auto chained = pool.SubmitCompletion([]() { return 20; }).Then([](int v) { return v + 1; });
+    EXPECT_EQ(chained.Get(), 21);
+    pool.Stop();
+
+    // 停止后提交: 不抛出, 回调以异常结果执行恰好一次
+    int calls = 0;
+    bool rejected = false;
+    pool.SubmitWithCallback([]() {}, [&](thread_pool::Completion<void> done) {
+        ++calls;
+        try {
+            done.Get();
+        } catch (const std::runtime_error&) {
+            rejected = true;
+        }
+    });
+    EXPECT_EQ(calls, 1);
+    EXPECT_TRUE(rejected);
+}
+
+TEST_P(ThreadPoolModeTest, StatisticsAggregateAcrossThreads) {
+    thread_pool::ThreadPool pool(MakeConfig(GetParam()));
+    pool.Start();
+    constexpr int kProducers = 4;
+    constexpr int kPerProducer = 2000;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&pool]() {
+            for (int i = 0; i < kPerProducer; ++i) {
+                pool.Post([i]() {
+                    if (i % 100 == 0) {
+                        throw std::runtime_error("counted as failed");
+                    }
+                });
+            }
+        });
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+    pool.Stop();
+
+    // 计数器按线程分片, 统计时汇总所有分片
+    const auto stats = pool.GetStatistics();
+    EXPECT_EQ(stats.statistic_total_submitted, static_cast<std::size_t>(kProducers * kPerProducer));
+    EXPECT_EQ(stats.statistic_total_completed + stats.statistic_total_failed,
+              static_cast<std::size_t>(kProducers * kPerProducer));
+    EXPECT_EQ(stats.statistic_total_failed, static_cast<std::size_t>(kProducers * kPerProducer / 100));
+    EXPECT_EQ(stats.statistic_active_threads, 0u);
+    EXPECT_EQ(pool.ActiveTasks(), 0u);
+
+    pool.ResetStatistics();
+    EXPECT_EQ(pool.GetStatistics().statistic_total_submitted, 0u);
+}
+
+TEST_P(ThreadPoolModeTest, ReservedLaneProgressesWhileSharedWorkersBlocked) {
+    auto cfg = MakeConfig(GetParam());
+    cfg.core_threads = 3;
+    cfg.max_threads = 3;
+    cfg.lanes = {{"bulk", 3, 0}, {"rpc", 1, 1}};
+    thread_pool::ThreadPool pool(cfg);
+    EXPECT_EQ(pool.LaneCount(), 2u);
+    const auto rpc = pool.FindLane("rpc");
+    EXPECT_EQ(rpc, 1u);
+    EXPECT_EQ(pool.FindLane("missing"), thread_pool::kDefaultLane);
+    pool.Start();
+
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    std::vector<std::future<void>> blocked;
+    for (int i = 0; i < 4; ++i) {
+        blocked.push_back(pool.Submit([opened]() { opened.wait(); }));
+    }
+    // 两个共享线程都被 bulk 任务占住, rpc 的预留线程仍能处理请求
+    auto reply = pool.SubmitTo(rpc, []() { return 7; });
+    ASSERT_EQ(reply.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_EQ(reply.get(), 7);
+    EXPECT_GE(pool.LanePending(thread_pool::kDefaultLane), 2u);
+
+    gate.set_value();
+    for (auto& f : blocked) {
+        f.get();
+    }
+    pool.Stop();
+}
+
+TEST(ThreadPoolWorkStealingTest, WorkerSubmitsToReservedLaneThroughItsQueue) {
+    auto cfg = MakeConfig(thread_pool::SchedulerMode::WorkStealing);
+    cfg.core_threads = 3;
+    cfg.max_threads = 3;
+    cfg.lanes = {{"bulk", 3, 0}, {"rpc", 1, 1}};
+    thread_pool::ThreadPool pool(cfg);
+    pool.Start();
+    const auto rpc = pool.FindLane("rpc");
+
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    auto blocker = pool.Submit([opened]() { opened.wait(); });
+    // 两个共享线程一个被占住, 另一个在任务中向 rpc 通道提交并等待: 任务须进入 rpc 队列由预留线程执行,
+    // 留在提交者本地队列时预留线程不会窃取, 只能等到超时
+    auto nested = pool.Submit([&pool, rpc]() {
+        auto reply = pool.SubmitTo(rpc, []() { return 7; });
+        return reply.wait_for(std::chrono::seconds(5)) == std::future_status::ready ? reply.get() : -1;
+    });
+    EXPECT_EQ(nested.get(), 7);
+
+    gate.set_value();
+    blocker.get();
+    pool.Stop();
+}
+
+TEST_P(ThreadPoolModeTest, BackloggedLanesShareByWeight) {
+    auto cfg = MakeConfig(GetParam());
+    cfg.core_threads = 1;
+    cfg.max_threads = 1;
+    cfg.lanes = {{"heavy", 3, 0}, {"light", 1, 0}};
+    thread_pool::ThreadPool pool(cfg);
+    pool.Start();
+    const auto light = pool.FindLane("light");
+
+    std::promise<void> gate;
+    std::atomic<bool> started{false};
+    auto gated = pool.Submit([&started, opened = gate.get_future()]() mutable {
+        started.store(true);
+        opened.wait();
+    });
+    while (!started.load()) {
+        std::this_thread::yield();
+    }
+
+    // 唯一的工作线程被占住时两条通道积压, 放行后按 3:1 的权重交替出队
+    constexpr int kPerLane = 40;
+    std::vector<int> order;
+    std::vector<std::future<void>> done;
+    for (int i = 0; i < kPerLane; ++i) {
+        done.push_back(pool.Submit([&order]() { order.push_back(0); }));
+        done.push_back(pool.SubmitTo(light, [&order]() { order.push_back(1); }));
+    }
+    gate.set_value();
+    gated.get();
+    for (auto& f : done) {
+        f.get();
+    }
+    pool.Stop();
+
+    ASSERT_EQ(order.size(), 2u * kPerLane);
+    int heavy_first = 0;
+    for (int i = 0; i < kPerLane; ++i) {
+        heavy_first += order[i] == 0 ? 1 : 0;
+    }
+    EXPECT_GE(heavy_first, 27);
+    EXPECT_LE(heavy_first, 33);
+}
+
+TEST_P(ThreadPoolModeTest, ScheduledTasksFireAndCancel) {
+    using namespace std::chrono_literals;
+    thread_pool::ThreadPool pool(MakeConfig(GetParam()));
+    pool.Start();
+    std::promise<void> once;
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_NE(pool.ScheduleAfter(20ms, [&once]() { once.set_value(); }), thread_pool::kInvalidTimer);
+    std::atomic<bool> cancelled_ran{false};
+    const auto cancelled = pool.ScheduleAt(start + 30ms, [&cancelled_ran]() { cancelled_ran.store(true); });
+    EXPECT_TRUE(pool.CancelTimer(cancelled));
+    std::atomic<int> ticks{0};
+    const auto every = pool.ScheduleEvery(5ms, [&ticks]() { ticks.fetch_add(1); });
+    EXPECT_THROW(pool.ScheduleEvery(0ms, []() {}), std::invalid_argument);
+
+    once.get_future().wait();
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 20ms);
+    while (ticks.load() < 3) {
+        std::this_thread::sleep_for(1ms);
+    }
+    EXPECT_TRUE(pool.CancelTimer(every));
+    std::this_thread::sleep_for(40ms);
+    EXPECT_FALSE(cancelled_ran.load());
+    EXPECT_EQ(pool.PendingTimers(), 0u);
+
+    pool.ScheduleAfter(1h, []() {});
+    EXPECT_EQ(pool.PendingTimers(), 1u);
+    pool.Stop(thread_pool::StopMode::Graceful);  // 停止时丢弃未到期的定时器
+    EXPECT_EQ(pool.PendingTimers(), 0u);
+    EXPECT_EQ(pool.ScheduleAfter(1ms, []() {}), thread_pool::kInvalidTimer);
+}
+
+TEST_P(ThreadPoolModeTest, PinnedWorkersRunTasks) {
+    auto cfg = MakeConfig(GetParam());
+    cfg.affinity = thread_pool::AffinityMode::Scatter;
+    thread_pool::ThreadPool pool(cfg);
+    pool.Start();
+    std::vector<std::future<int>> cpus;
+    for (int i = 0; i < 32; ++i) {
+        cpus.push_back(pool.Submit([]() {
+            int allowed = 1;
+#if defined(__linux__)
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+                allowed = CPU_COUNT(&set);
+            }
+#endif
+            return allowed;
+        }));
+    }
+    for (auto& f : cpus) {
+        EXPECT_EQ(f.get(), 1);  // 每个工作线程只绑定一个 CPU
+    }
+    pool.Stop(thread_pool::StopMode::Graceful);
+}
+
+#if defined(THREAD_POOL_HAS_COROUTINES)
+namespace {
+
+thread_pool::Task<int> HopToWorker(thread_pool::ThreadPool& pool, int value, std::thread::id caller) {
+    co_await pool.Schedule();
+    if (std::this_thread::get_id() == caller) {
+        throw std::logic_error("resumed on the caller thread");
+    }
+    co_return value;
+}
+
+thread_pool::Task<int> SumHops(thread_pool::ThreadPool& pool, int count, std::thread::id caller) {
+    int sum = 0;
+    for (int i = 0; i < count; ++i) {
+        sum += co_await HopToWorker(pool, i, caller);
+    }
+    sum += co_await pool.SubmitCompletion([]() { return 1000; });
+    co_return sum;
+}
+
+thread_pool::Task<void> FailOnWorker(thread_pool::ThreadPool& pool) {
+    co_await pool.Schedule();
+    throw std::runtime_error("boom");
+}
+
+}  // namespace
+
+TEST_P(ThreadPoolModeTest, CoroutinesResumeOnWorkers) {
+    thread_pool::ThreadPool pool(MakeConfig(GetParam()));
+    pool.Start();
+    const auto caller = std::this_thread::get_id();
+    std::vector<thread_pool::Completion<int>> results;
+    for (int i = 0; i < 64; ++i) {
+        results.push_back(thread_pool::Spawn(pool, SumHops(pool, 16, caller)));
+    }
+    for (auto& result : results) {
+        EXPECT_EQ(result.Get(), 120 + 1000);
+    }
+    EXPECT_THROW(thread_pool::Spawn(pool, FailOnWorker(pool)).Get(), std::runtime_error);
+    pool.Stop(thread_pool::StopMode::Graceful);
+
+    // 停止后 Schedule 被拒绝, 协程收到异常并经 Completion 传回
+    EXPECT_THROW(thread_pool::Spawn(pool, SumHops(pool, 1, caller)).Get(), std::runtime_error);
+}
+#endif
+
+INSTANTIATE_TEST_SUITE_P(Schedulers, ThreadPoolModeTest,
+                         ::testing::Values(thread_pool::SchedulerMode::Mpmc, thread_pool::SchedulerMode::WorkStealing));